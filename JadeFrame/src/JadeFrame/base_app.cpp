@@ -2,6 +2,7 @@
 #include "base_app.h"
 #include "JadeFrame/platform/platform_shared.h"
 #include "graphics/graphics_shared.h"
+#include "graphics/render_thread.h"
 
 #include "gui.h"
 
@@ -111,13 +112,17 @@ Instance::Instance()
 //**************************************************************
 
 Application::Application(const Desc& desc)
-    : m_gui() {
+    : m_is_headless(desc.is_headless)
+    , m_is_render_threaded(desc.is_render_threaded)
+    , m_frame_count(desc.frame_count)
+    , m_gui() {
     Logger::info("Creating Window....");
     Instance*    i = Instance::get_singleton();
     Window::Desc win_desc = {
         .title = desc.title,
         .size = desc.size,
         .position = desc.position,
+        .is_headless = desc.is_headless,
     };
     Window*            requested_window = i->m_system_manager.request_window(win_desc);
     const std::string& title = requested_window->get_title();
@@ -139,7 +144,8 @@ Application::Application(const Desc& desc)
         );
     });
 
-    m_gui.init(requested_window, desc.api);
+    // The GUI backends need a native X11 or Win32 window.
+    if (!m_is_headless) { m_gui.init(requested_window, desc.api); }
 
     m_windows[0] = requested_window;
     m_current_window_p = m_windows[0];
@@ -159,34 +165,84 @@ auto Application::start() -> void {
     this->m_on_init_fn();
 
     IRenderer* renderer = m_render_system.m_renderer.get();
-    f64        previous_frame_time = platform.get_time();
+    // The OpenGL context is current on this thread, and the software and terminal
+    // renderers present through the window, whose events this thread polls.
+    std::unique_ptr<RenderThread> render_thread;
+    if (m_is_render_threaded && m_render_system.m_api == GRAPHICS_API::VULKAN) {
+        render_thread = std::make_unique<RenderThread>(m_render_system);
+    } else if (m_is_render_threaded) {
+        Logger::warn(
+            "Rendering on a thread of its own is not supported with '{}'",
+            to_string(m_render_system.m_api)
+        );
+    }
+
+    const f64  start_time = platform.get_time();
+    f64        previous_frame_time = start_time;
+    u64        visible_count = 0;
+    u64        culled_count = 0;
     while (m_is_running) {
         auto      frame_time_start = platform.get_time();
         const f64 delta_time = frame_time_start - previous_frame_time;
         previous_frame_time = frame_time_start;
 
+        if (render_thread != nullptr) { render_thread->begin_frame(); }
         this->m_on_update_fn();
+        m_render_system.m_transforms.update();
+        m_render_system.m_scene.update();
 
         // if (m_current_window_p->get_window_state() != Window::WINDOW_STATE::MINIMIZED)
         // {
-        renderer->clear_background();
+        if (render_thread == nullptr) { renderer->clear_background(); }
 
         if (m_gui.m_is_initialized) { m_gui.new_frame(); }
         control_camera(m_camera, m_windows[0]->m_input_state, delta_time);
 
         this->m_on_draw_fn();
 
-        renderer->render(m_camera);
+        CullStats cull_stats;
+        if (render_thread != nullptr) {
+            // The render thread draws it while the next frame is built.
+            cull_stats = render_thread->end_frame(m_camera);
+        } else {
+            renderer->render(m_camera);
+            cull_stats = m_render_system.m_render_queue.get_cull_stats();
+        }
+        visible_count += cull_stats.m_visible;
+        culled_count += cull_stats.m_culled;
         if (m_gui.m_is_initialized) { m_gui.render(); }
 
-        renderer->present();
+        if (render_thread == nullptr) { renderer->present(); }
+        m_render_system.end_frame();
         m_tick += 1;
         //}
         this->poll_events();
+        if (m_frame_count != 0 && m_tick >= m_frame_count) { m_is_running = false; }
+        // Headless runs measure throughput, so they are not limited to the target FPS.
+        if (m_is_headless) { continue; }
         const f64  frame_time_end = platform.get_time();
         const auto frame_work_time = frame_time_end - frame_time_start;
         platform.frame_control(frame_work_time);
     }
+    // Draws the frames which are still queued.
+    render_thread.reset();
+
+    if (m_tick != 0) {
+        const f64 total_time = platform.get_time() - start_time;
+        const f64 frame_time = total_time / static_cast<f64>(m_tick);
+        Logger::info(
+            "Rendered {} frames in {:.3f}s, {:.3f}ms per frame, {:.1f} FPS",
+            m_tick,
+            total_time,
+            frame_time * 1000.0,
+            1.0 / frame_time
+        );
+        Logger::info(
+            "Drew {} and culled {} objects per frame",
+            visible_count / m_tick,
+            culled_count / m_tick
+        );
+    }
 }
 
 auto Application::poll_events() -> void {
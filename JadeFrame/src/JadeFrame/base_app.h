@@ -42,6 +42,14 @@ public:
         v2u32        size;
         v2u32        position = v2u32::create(0, 0);
         GRAPHICS_API api;
+        // Renders offscreen without a display server and without the GUI.
+        bool is_headless = false;
+        // Stops after this many frames, 0 runs until the window is closed.
+        u64 frame_count = 0;
+        // Renders on a thread of its own while the next frame is built, see
+        // `RenderThread`. Only for Vulkan. Resources have to be registered in
+        // `m_on_init_fn` then.
+        bool is_render_threaded = false;
     };
 
     Application() = default;
@@ -62,6 +70,9 @@ public:
 
 public:
     bool m_is_running = true;
+    bool m_is_headless = false;
+    bool m_is_render_threaded = false;
+    u64  m_frame_count = 0;
 
     // Window stuff
     using WindowID = i32;
@@ -203,6 +203,10 @@ auto Camera::get_view_projection(const char* api) const -> mat4x4 {
     return result;
 }
 
+auto Camera::get_frustum() const -> Frustum {
+    return Frustum::from_view_projection(this->get_view_projection("OpenGL"));
+}
+
 auto Camera::calc_projection(const char* api) const -> mat4x4 {
     auto   ss = GRAPHICS_API::OPENGL;
     mat4x4 proj = mat4x4::identity();
@@ -1,6 +1,7 @@
 #pragma once
 #include "JadeFrame/math/mat_4.h"
 #include "JadeFrame/math/vec.h"
+#include "culling.h"
 
 namespace JadeFrame {
 enum class PROJECTION_TYPE : u8 {
@@ -90,6 +91,8 @@ public:
     ) -> Camera;
 
     [[nodiscard]] auto get_view_projection(const char* api) const -> mat4x4;
+    /// The frustum in world space. It does not depend on the clip space of the API.
+    [[nodiscard]] auto get_frustum() const -> Frustum;
 
     auto calc_projection(const char* api) const -> mat4x4;
 
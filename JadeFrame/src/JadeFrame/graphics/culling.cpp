@@ -0,0 +1,185 @@
+#include "culling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "mesh.h"
+#include "software/raster_kernel.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+namespace JadeFrame {
+
+/*---------------------------
+    Bounds
+---------------------------*/
+
+auto BoundingSphere::infinite() -> BoundingSphere {
+    return BoundingSphere{
+        .m_center = v3::zero(),
+        .m_radius = std::numeric_limits<f32>::infinity(),
+    };
+}
+
+auto BoundingSphere::transformed(const mat4x4& transform) const -> BoundingSphere {
+    const v4  center = transform * v4::from_v3(m_center, 1.0F);
+    const f32 scale_x = transform.x_axis.x * transform.x_axis.x +
+                        transform.x_axis.y * transform.x_axis.y +
+                        transform.x_axis.z * transform.x_axis.z;
+    const f32 scale_y = transform.y_axis.x * transform.y_axis.x +
+                        transform.y_axis.y * transform.y_axis.y +
+                        transform.y_axis.z * transform.y_axis.z;
+    const f32 scale_z = transform.z_axis.x * transform.z_axis.x +
+                        transform.z_axis.y * transform.z_axis.y +
+                        transform.z_axis.z * transform.z_axis.z;
+    return BoundingSphere{
+        .m_center = v3::create(center.x, center.y, center.z),
+        .m_radius = m_radius * std::sqrt(std::max({scale_x, scale_y, scale_z})),
+    };
+}
+
+auto MeshBounds::from_mesh(const Mesh& mesh) -> MeshBounds {
+    const std::vector<f32>* positions = mesh.attribute_values(Mesh::POSITION.m_id);
+    if (positions == nullptr || positions->size() < 3) {
+        return MeshBounds{
+            .m_aabb = {.m_min = v3::zero(), .m_max = v3::zero()},
+            .m_sphere = BoundingSphere::infinite(),
+        };
+    }
+
+    const std::vector<f32>& p = *positions;
+    v3                      min = v3::create(p[0], p[1], p[2]);
+    v3                      max = min;
+    for (size_t i = 3; i + 2 < p.size(); i += 3) {
+        min.x = std::min(min.x, p[i + 0]);
+        min.y = std::min(min.y, p[i + 1]);
+        min.z = std::min(min.z, p[i + 2]);
+        max.x = std::max(max.x, p[i + 0]);
+        max.y = std::max(max.y, p[i + 1]);
+        max.z = std::max(max.z, p[i + 2]);
+    }
+
+    // Centered on the box, but only as large as the farthest vertex, which is tighter
+    // than the half diagonal for most shapes.
+    const v3 center = (min + max) * 0.5F;
+    f32      radius_squared = 0.0F;
+    for (size_t i = 0; i + 2 < p.size(); i += 3) {
+        const v3 offset = v3::create(p[i], p[i + 1], p[i + 2]) - center;
+        radius_squared = std::max(radius_squared, offset.dot(offset));
+    }
+    return MeshBounds{
+        .m_aabb = {.m_min = min, .m_max = max},
+        .m_sphere = {.m_center = center, .m_radius = std::sqrt(radius_squared)},
+    };
+}
+
+/*---------------------------
+    Frustum
+---------------------------*/
+
+auto Frustum::from_view_projection(const mat4x4& view_projection) -> Frustum {
+    // Gribb and Hartmann: a clip space point is inside if -w <= x <= w and so on, each
+    // side of that is the dot product of a sum or difference of two rows with the point.
+    const mat4x4& m = view_projection;
+    const v4      x = v4::create(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const v4      y = v4::create(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const v4      z = v4::create(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const v4      w = v4::create(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum result;
+    result.m_planes[LEFT] = w + x;
+    result.m_planes[RIGHT] = w - x;
+    result.m_planes[BOTTOM] = w + y;
+    result.m_planes[TOP] = w - y;
+    result.m_planes[NEAR] = w + z;
+    result.m_planes[FAR] = w - z;
+    for (v4& plane : result.m_planes) {
+        const f32 length =
+            std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        // A degenerate matrix gives a zero plane, which culls nothing.
+        plane = length > 0.0F ? plane * (1.0F / length) : v4::splat(0.0F);
+    }
+    return result;
+}
+
+auto Frustum::is_visible(const BoundingSphere& sphere) const -> bool {
+    const v3& c = sphere.m_center;
+    for (const v4& plane : m_planes) {
+        const f32 distance = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+        if (distance < -sphere.m_radius) { return false; }
+    }
+    return true;
+}
+
+/*---------------------------
+    Culling
+---------------------------*/
+
+auto cull_spheres_scalar(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32 {
+    u32 visible_count = 0;
+    for (u32 i = 0; i < count; i++) {
+        const BoundingSphere sphere = {
+            .m_center = v3::create(spheres.m_x[i], spheres.m_y[i], spheres.m_z[i]),
+            .m_radius = spheres.m_radius[i],
+        };
+        const bool is_visible = frustum.is_visible(sphere);
+        visible[i] = is_visible ? 1 : 0;
+        visible_count += is_visible ? 1 : 0;
+    }
+    return visible_count;
+}
+
+auto cull_spheres(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32 {
+#if JF_SOFTWARE_X86_KERNELS
+    if (software::is_supported(software::RASTER_KERNEL::AVX2)) {
+        return cull_spheres_avx2(frustum, spheres, count, visible);
+    }
+#endif
+    return cull_spheres_scalar(frustum, spheres, count, visible);
+}
+
+auto cull_spheres(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible,
+    ThreadPool*         pool
+) -> u32 {
+    // Below this a chunk is not worth waking a worker for. A multiple of the 8 spheres
+    // the AVX2 kernel tests at once.
+    constexpr u32 MIN_SPHERES_PER_CHUNK = 4096;
+    u32           chunk_count = 1;
+    if (pool != nullptr) {
+        chunk_count =
+            std::clamp<u32>(count / MIN_SPHERES_PER_CHUNK, 1, pool->worker_count());
+    }
+    if (chunk_count == 1) { return cull_spheres(frustum, spheres, count, visible); }
+
+    const u32 chunk_size = (count + chunk_count - 1) / chunk_count;
+    pool->parallel_for(chunk_count, [&](u32 chunk, u32 /*worker*/) {
+        const u32          begin = chunk * chunk_size;
+        const u32          end = std::min(begin + chunk_size, count);
+        const SphereArrays chunk_spheres = {
+            .m_x = spheres.m_x + begin,
+            .m_y = spheres.m_y + begin,
+            .m_z = spheres.m_z + begin,
+            .m_radius = spheres.m_radius + begin,
+        };
+        cull_spheres(frustum, chunk_spheres, end - begin, visible + begin);
+    });
+    u32 visible_count = 0;
+    for (u32 i = 0; i < count; i++) { visible_count += visible[i]; }
+    return visible_count;
+}
+
+} // namespace JadeFrame
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/mat_4.h"
+#include "JadeFrame/math/vec.h"
+
+namespace JadeFrame {
+class Mesh;
+class ThreadPool;
+
+struct AABB {
+    v3 m_min;
+    v3 m_max;
+};
+
+struct BoundingSphere {
+    v3  m_center;
+    f32 m_radius = 0.0F;
+
+    /// Contains everything, used for meshes without positions. Never culled.
+    static auto infinite() -> BoundingSphere;
+    /// The sphere around this one after `transform`. A non uniform scale grows the
+    /// radius by the largest scale.
+    [[nodiscard]] auto transformed(const mat4x4& transform) const -> BoundingSphere;
+};
+
+/// The bounds of a mesh in its local space, computed from the `Mesh::POSITION` attribute.
+struct MeshBounds {
+    AABB           m_aabb;
+    BoundingSphere m_sphere;
+
+    static auto from_mesh(const Mesh& mesh) -> MeshBounds;
+};
+
+/*
+    The six planes of a view frustum, each stored as `(normal, distance)` with the normal
+   pointing inwards and normalized, so `dot(normal, p) + distance` is the signed distance
+   of `p` to the plane.
+*/
+struct Frustum {
+    enum PLANE : u8 {
+        LEFT,
+        RIGHT,
+        BOTTOM,
+        TOP,
+        NEAR,
+        FAR,
+        MAX,
+    };
+
+    std::array<v4, PLANE::MAX> m_planes;
+
+    /// Extracts the planes from the rows of a view projection matrix with OpenGL clip
+    /// space, i.e. -w <= z <= w.
+    static auto from_view_projection(const mat4x4& view_projection) -> Frustum;
+
+    [[nodiscard]] auto is_visible(const BoundingSphere& sphere) const -> bool;
+};
+
+/// Bounding spheres stored one array per component, so consecutive spheres load as
+/// vectors.
+struct SphereArrays {
+    f32* m_x = nullptr;
+    f32* m_y = nullptr;
+    f32* m_z = nullptr;
+    f32* m_radius = nullptr;
+};
+
+struct CullStats {
+    u32 m_visible = 0;
+    u32 m_culled = 0;
+};
+
+/// Sets `visible[i]` to 1 for every sphere in [0, count) intersecting `frustum` and to 0
+/// otherwise. Returns the number of visible spheres.
+auto cull_spheres(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32;
+
+/// Like the above, but large counts are split across `pool` if one is given.
+auto cull_spheres(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible,
+    ThreadPool*         pool
+) -> u32;
+
+/// The kernels `cull_spheres` picks from. The AVX2 one tests 8 spheres per iteration, is
+/// only built for x86-64 and must only be called if
+/// `software::is_supported(RASTER_KERNEL::AVX2)`.
+auto cull_spheres_scalar(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32;
+auto cull_spheres_avx2(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32;
+
+} // namespace JadeFrame
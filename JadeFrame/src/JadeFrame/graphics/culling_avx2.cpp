@@ -0,0 +1,59 @@
+#include "culling.h"
+
+#include "software/raster_kernel.h"
+
+// NOTE: The code after `JF_BEGIN_AVX2` is compiled for AVX2, it must only be entered
+// after the check in `cull_spheres`.
+#if JF_SOFTWARE_X86_KERNELS
+    #include <bit>
+
+    #include <immintrin.h>
+
+JF_BEGIN_AVX2
+namespace JadeFrame {
+
+auto cull_spheres_avx2(
+    const Frustum&      frustum,
+    const SphereArrays& spheres,
+    u32                 count,
+    u8*                 visible
+) -> u32 {
+    u32       visible_count = 0;
+    const u32 full_count = count - count % 8;
+    for (u32 i = 0; i < full_count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(spheres.m_x + i);
+        const __m256 y = _mm256_loadu_ps(spheres.m_y + i);
+        const __m256 z = _mm256_loadu_ps(spheres.m_z + i);
+        const __m256 neg_radius =
+            _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.m_radius + i));
+
+        // Same operations in the same order as `Frustum::is_visible`, so both kernels
+        // agree on spheres touching a plane.
+        __m256 outside = _mm256_setzero_ps();
+        for (const v4& plane : frustum.m_planes) {
+            __m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+            distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+            outside =
+                _mm256_or_ps(outside, _mm256_cmp_ps(distance, neg_radius, _CMP_LT_OQ));
+        }
+
+        const u32 mask = ~static_cast<u32>(_mm256_movemask_ps(outside)) & 0xFF;
+        for (u32 lane = 0; lane < 8; lane++) { visible[i + lane] = (mask >> lane) & 1; }
+        visible_count += static_cast<u32>(std::popcount(mask));
+    }
+
+    const SphereArrays rest = {
+        .m_x = spheres.m_x + full_count,
+        .m_y = spheres.m_y + full_count,
+        .m_z = spheres.m_z + full_count,
+        .m_radius = spheres.m_radius + full_count,
+    };
+    return visible_count +
+           cull_spheres_scalar(frustum, rest, count - full_count, visible + full_count);
+}
+
+} // namespace JadeFrame
+JF_END_AVX2
+#endif
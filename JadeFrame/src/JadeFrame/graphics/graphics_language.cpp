@@ -37,11 +37,23 @@ enum class IMAGE_COMPARE_FUNCTION : u8 {
     NEVER
 };
 
+auto hash_spirv(std::span<const u32> code) -> u64 {
+    // FNV-1a over the words.
+    u64 hash = 14695981039346656037ULL;
+    for (const u32 word : code) {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 auto convert_SPIRV_to_GLSL(const std::vector<u32>& spirv) -> std::string {
     spirv_cross::CompilerGLSL::Options options;
     options.version = 450;
     options.es = false;
     options.vulkan_semantics = false;
+    // Instanced draws always start at instance 0, `gl_InstanceIndex` is `gl_InstanceID`.
+    options.vertex.support_nonzero_base_instance = false;
 
     spirv_cross::CompilerGLSL glsl(spirv);
     glsl.set_common_options(options);
@@ -77,9 +89,15 @@ auto remap_for_opengl(
     spv_c::CompilerGLSL::Options options;
     options.version = 450;
     options.es = false;
-    options.vulkan_semantics = true;
-    compiler.set_common_options(options);
+    // OpenGL GLSL has no `gl_InstanceIndex`, without the Vulkan semantics it is written
+    // as `gl_InstanceID`. The descriptor sets are removed below either way.
+    options.vulkan_semantics = false;
     spv_c::ShaderResources resources = compiler.get_shader_resources();
+    // Shaders with storage buffers are drawn indirectly, where the instances of a draw
+    // start at its first instance. `gl_InstanceIndex` then has to include
+    // `gl_BaseInstanceARB`, which needs GL_ARB_shader_draw_parameters.
+    options.vertex.support_nonzero_base_instance = !resources.storage_buffers.empty();
+    compiler.set_common_options(options);
 
     using Set = std::vector<spv_c::Resource*>;
     std::array<Set, 4> sets;
@@ -113,6 +131,15 @@ auto remap_for_opengl(
             binding++;
         }
     }
+    // Storage buffers have bindings of their own in OpenGL.
+    u32 storage_binding = 0;
+    for (const spv_c::Resource& sb : resources.storage_buffers) {
+        u32 set = compiler.get_decoration(sb.id, spv::DecorationDescriptorSet);
+        JF_ASSERT(set <= 3, "Only 4 descriptor sets are supported. (0, 1, 2, 3)");
+        compiler.unset_decoration(sb.id, spv::DecorationDescriptorSet);
+        compiler.set_decoration(sb.id, spv::DecorationBinding, storage_binding);
+        storage_binding++;
+    }
     auto source = compiler.compile();
     if (out_source != nullptr) { *out_source = source; }
     return GLSL_to_SPIRV(source, stage, GRAPHICS_API::OPENGL);
@@ -1,3 +1,6 @@
+#pragma once
+#include <span>
+
 #include "graphics_shared.h"
 #include "JadeFrame/prelude.h"
 
@@ -10,5 +13,7 @@ auto remap_for_opengl(
     std::string*                      out_source
 ) -> ShadingCode::Module::SPIRV;
 auto convert_SPIRV_to_GLSL(const std::vector<u32>& spirv) -> std::string;
+/// Hash of the SPIR-V words, which identifies a module in the caches of the renderers.
+auto hash_spirv(std::span<const u32> code) -> u64;
 
 } // namespace JadeFrame
\ No newline at end of file
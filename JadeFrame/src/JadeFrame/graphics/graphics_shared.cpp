@@ -6,6 +6,8 @@
 #include "vulkan/renderer.h"
 #include "vulkan/shader.h"
 #include "opengl/opengl_renderer.h"
+#include "software/software_renderer.h"
+#include "terminal/terminal_renderer.h"
 #include "graphics_language.h"
 
 #include "JadeFrame/utils/assert.h"
@@ -97,6 +99,18 @@ static auto delete_vulkan_material(void* handle) noexcept -> void {
     delete static_cast<Vulkan_Material*>(handle);
 }
 
+static auto delete_software_texture(void* handle) noexcept -> void {
+    delete static_cast<software::Texture*>(handle);
+}
+
+static auto delete_software_shader(void* handle) noexcept -> void {
+    delete static_cast<software::Shader*>(handle);
+}
+
+static auto delete_software_material(void* handle) noexcept -> void {
+    delete static_cast<software::Material*>(handle);
+}
+
 /*---------------------------
     Image
 ---------------------------*/
@@ -198,6 +212,8 @@ auto GPUBuffer::release() -> void {
         case GRAPHICS_API::OPENGL:
             // OpenGL buffers are owned by opengl::Context and released with the context.
             break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL:
         case GRAPHICS_API::UNDEFINED: break;
         default: assert(false); break;
     }
@@ -228,36 +244,88 @@ GPUBuffer::GPUBuffer(RenderSystem* system, void* data, size_t size, TYPE usage)
 
             m_handle = device->create_buffer(to_vulkan(usage), data, size);
         } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: {
+            // NOTE: The software renderer reads vertices straight from the `Mesh`, there
+            // is nothing to upload.
+        } break;
+        default: assert(false);
+    }
+}
+
+auto GPUBuffer::write(const void* data, size_t size, size_t offset) -> u64 {
+    JF_ASSERT(offset + size <= m_size, "out of bounds");
+    u64 upload = 0;
+    switch (m_api) {
+        case GRAPHICS_API::OPENGL: {
+            auto* buffer = static_cast<opengl::Buffer*>(m_handle);
+            buffer->write(data, static_cast<GLuint>(size), static_cast<GLint>(offset));
+        } break;
+        case GRAPHICS_API::VULKAN: {
+            upload = static_cast<vulkan::Buffer*>(m_handle)->upload(data, size, offset);
+        } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: break;
         default: assert(false);
     }
+    return upload;
 }
 
 GPUMeshData::GPUMeshData(
     RenderSystem* system,
     const Mesh&   vertex_data,
     bool          interleaved
-) {
+)
+    : m_bounds(MeshBounds::from_mesh(vertex_data))
+    , m_arena(&system->m_mesh_arena) {
 
     const std::vector<f32> flat_data = convert_into_data(vertex_data, interleaved);
 
-    void*  data = (void*)flat_data.data();
-    size_t size = sizeof(flat_data[0]) * flat_data.size();
-    m_vertex_buffer =
-        std::make_unique<GPUBuffer>(system, data, size, GPUBuffer::TYPE::VERTEX);
+    const auto&  position = vertex_data.m_attributes.at(Mesh::POSITION.m_id);
+    const size_t vertex_count =
+        position.m_data.size() / component_count(Mesh::POSITION.m_format);
+    const u32 stride = static_cast<u32>(sizeof(f32) * flat_data.size() / vertex_count);
 
+    m_allocation = m_arena->allocate(flat_data, stride, vertex_data.m_indices);
+    m_vertex_offset = m_allocation.m_vertex_offset;
+    m_first_index = m_allocation.m_first_index;
+    m_upload = m_allocation.m_upload;
+    m_vertex_buffer = m_arena->get_vertex_buffer(m_allocation.m_arena);
     if (!vertex_data.m_indices.empty()) {
-        const auto& indices = vertex_data.m_indices;
-        void*       indices_data = (void*)indices.data();
-        size_t      indices_size = sizeof(indices[0]) * indices.size();
-        m_index_buffer = std::make_unique<GPUBuffer>(
-            system, indices_data, indices_size, GPUBuffer::TYPE::INDEX
-        );
+        m_index_buffer = m_arena->get_index_buffer(m_allocation.m_arena);
     }
 }
 
-GPUMeshData::~GPUMeshData() = default;
-GPUMeshData::GPUMeshData(GPUMeshData&& other) noexcept = default;
-auto GPUMeshData::operator=(GPUMeshData&& other) noexcept -> GPUMeshData& = default;
+GPUMeshData::~GPUMeshData() {
+    if (m_arena != nullptr) { m_arena->free(m_allocation); }
+}
+
+GPUMeshData::GPUMeshData(GPUMeshData&& other) noexcept
+    : m_vertex_buffer(std::exchange(other.m_vertex_buffer, nullptr))
+    , m_index_buffer(std::exchange(other.m_index_buffer, nullptr))
+    , m_vertex_offset(other.m_vertex_offset)
+    , m_first_index(other.m_first_index)
+    , m_bounds(other.m_bounds)
+    , m_id(other.m_id)
+    , m_upload(other.m_upload)
+    , m_arena(std::exchange(other.m_arena, nullptr))
+    , m_allocation(other.m_allocation) {}
+
+auto GPUMeshData::operator=(GPUMeshData&& other) noexcept -> GPUMeshData& {
+    if (this == &other) { return *this; }
+    if (m_arena != nullptr) { m_arena->free(m_allocation); }
+
+    m_vertex_buffer = std::exchange(other.m_vertex_buffer, nullptr);
+    m_index_buffer = std::exchange(other.m_index_buffer, nullptr);
+    m_vertex_offset = other.m_vertex_offset;
+    m_first_index = other.m_first_index;
+    m_bounds = other.m_bounds;
+    m_id = other.m_id;
+    m_upload = other.m_upload;
+    m_arena = std::exchange(other.m_arena, nullptr);
+    m_allocation = other.m_allocation;
+    return *this;
+}
 
 /*---------------------------
     Texture Handle
@@ -271,7 +339,8 @@ TextureHandle::TextureHandle(TextureHandle&& other) noexcept
     : m_size(other.m_size)
     , m_num_components(other.m_num_components)
     , m_api(other.m_api)
-    , m_handle(std::move(other.m_handle)) {
+    , m_handle(std::move(other.m_handle))
+    , m_upload(std::exchange(other.m_upload, 0)) {
     other.m_size = v2u32::create(0, 0);
     other.m_num_components = 0;
     other.m_api = GRAPHICS_API::UNDEFINED;
@@ -288,6 +357,7 @@ auto TextureHandle::operator=(TextureHandle&& other) noexcept -> TextureHandle&
     m_num_components = other.m_num_components;
     m_api = other.m_api;
     m_handle = std::move(other.m_handle);
+    m_upload = std::exchange(other.m_upload, 0);
 
     other.m_size = v2u32::create(0, 0);
     other.m_num_components = 0;
@@ -305,6 +375,7 @@ auto TextureHandle::release() -> void {
     m_api = GRAPHICS_API::UNDEFINED;
     m_size = v2u32::create(0, 0);
     m_num_components = 0;
+    m_upload = 0;
 }
 
 /*---------------------------
@@ -317,7 +388,8 @@ ShaderHandle::ShaderHandle(const Desc& desc)
 ShaderHandle::ShaderHandle(ShaderHandle&& other) noexcept
     : m_code(std::move(other.m_code))
     , m_api(other.m_api)
-    , m_handle(std::move(other.m_handle)) {
+    , m_handle(std::move(other.m_handle))
+    , m_id(other.m_id) {
 
     other.m_api = GRAPHICS_API::UNDEFINED;
     other.m_handle = nullptr;
@@ -331,6 +403,7 @@ auto ShaderHandle::operator=(ShaderHandle&& other) noexcept -> ShaderHandle& {
     m_code = std::move(other.m_code);
     m_api = other.m_api;
     m_handle = std::move(other.m_handle);
+    m_id = other.m_id;
 
     other.m_api = GRAPHICS_API::UNDEFINED;
     other.m_handle = nullptr;
@@ -376,7 +449,8 @@ MaterialHandle::MaterialHandle(MaterialHandle&& other) noexcept
     , m_texture(std::exchange(other.m_texture, nullptr))
     , m_handle(std::move(other.m_handle))
     , m_info(std::move(other.m_info))
-    , m_api(std::exchange(other.m_api, GRAPHICS_API::UNDEFINED)) {}
+    , m_api(std::exchange(other.m_api, GRAPHICS_API::UNDEFINED))
+    , m_id(other.m_id) {}
 
 auto MaterialHandle::operator=(MaterialHandle&& other) noexcept -> MaterialHandle& {
     if (this == &other) { return *this; }
@@ -388,6 +462,7 @@ auto MaterialHandle::operator=(MaterialHandle&& other) noexcept -> MaterialHandl
     m_handle = std::move(other.m_handle);
     m_info = std::move(other.m_info);
     m_api = std::exchange(other.m_api, GRAPHICS_API::UNDEFINED);
+    m_id = other.m_id;
     return *this;
 }
 
@@ -421,7 +496,8 @@ VertexFormat::VertexFormat(const std::vector<VertexAttribute>& attributes)
 ---------------------------*/
 
 RenderSystem::RenderSystem(GRAPHICS_API api, Window* window)
-    : m_api(api) {
+    : m_api(api)
+    , m_mesh_arena(this) {
 
     switch (api) {
         case GRAPHICS_API::OPENGL: {
@@ -431,6 +507,12 @@ RenderSystem::RenderSystem(GRAPHICS_API api, Window* window)
         case GRAPHICS_API::VULKAN: {
             m_renderer = std::make_unique<Vulkan_Renderer>(*this, window);
         } break;
+        case GRAPHICS_API::SOFTWARE: {
+            m_renderer = std::make_unique<Software_Renderer>(*this, window);
+        } break;
+        case GRAPHICS_API::TERMINAL: {
+            m_renderer = std::make_unique<Terminal_Renderer>(*this, window);
+        } break;
         default: assert(false);
     }
 }
@@ -446,7 +528,11 @@ auto RenderSystem::init(GRAPHICS_API api, Window* window) -> void {
     m_registered_materials.clear();
     m_registered_shaders.clear();
     m_registered_textures.clear();
-    m_render_commands.clear();
+    m_render_queue.clear();
+    m_transforms = {};
+    m_scene = {};
+    m_mesh_arena = {};
+    m_frame = 0;
     m_renderer.reset();
 
     m_api = api;
@@ -457,17 +543,23 @@ auto RenderSystem::init(GRAPHICS_API api, Window* window) -> void {
         case GRAPHICS_API::VULKAN: {
             m_renderer = std::make_unique<Vulkan_Renderer>(*this, window);
         } break;
+        case GRAPHICS_API::SOFTWARE: {
+            m_renderer = std::make_unique<Software_Renderer>(*this, window);
+        } break;
+        case GRAPHICS_API::TERMINAL: {
+            m_renderer = std::make_unique<Terminal_Renderer>(*this, window);
+        } break;
         default: {
             Logger::err("Unsupported graphics api: {}", to_string(api));
             assert(false);
         }
     }
+    m_mesh_arena = MeshArena(this);
 }
 
-auto RenderSystem::register_texture(Image& image) -> TextureHandle* {
-
-    m_registered_textures.emplace_back();
-    TextureHandle& tex = m_registered_textures.back();
+auto RenderSystem::register_texture(Image& image) -> TextureId {
+    const TextureId id = m_registered_textures.create();
+    TextureHandle&  tex = *m_registered_textures.get(id);
     tex.m_size.x = image.width;
     tex.m_size.y = image.height;
     tex.m_num_components = image.num_components;
@@ -498,25 +590,33 @@ auto RenderSystem::register_texture(Image& image) -> TextureHandle* {
                     );
                     assert(false);
             }
+            auto* texture = new vulkan::Vulkan_Texture(
+                *device, image.data.data(), tex.m_size, format
+            );
+            tex.m_upload = texture->m_upload;
+            tex.m_handle = NativeHandle(texture, delete_vulkan_texture);
+
+        } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: {
             tex.m_handle = NativeHandle(
-                new vulkan::Vulkan_Texture(
-                    *device, image.data.data(), tex.m_size, format
+                new software::Texture(
+                    image.data.data(), tex.m_size, tex.m_num_components
                 ),
-                delete_vulkan_texture
+                delete_software_texture
             );
-
         } break;
         default: assert(false);
     }
-    return &tex;
+    return id;
 }
 
-auto RenderSystem::register_shader(const ShaderHandle::Desc& desc) -> ShaderHandle* {
-
-    m_registered_shaders.emplace_back();
-    ShaderHandle& shader = m_registered_shaders.back();
+auto RenderSystem::register_shader(const ShaderHandle::Desc& desc) -> ShaderId {
+    const ShaderId id = m_registered_shaders.create();
+    ShaderHandle&  shader = *m_registered_shaders.get(id);
     shader.m_code = desc.shading_code;
     shader.m_api = m_api;
+    shader.m_id = id.index();
 
     switch (m_api) {
         case GRAPHICS_API::OPENGL: {
@@ -559,21 +659,43 @@ auto RenderSystem::register_shader(const ShaderHandle::Desc& desc) -> ShaderHand
                 new Vulkan_Shader(*ctx, *ren, shader_desc), delete_vulkan_shader
             );
         } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: {
+            software::ShaderCache* cache =
+                m_api == GRAPHICS_API::SOFTWARE
+                    ? &dynamic_cast<Software_Renderer*>(m_renderer.get())->m_shader_cache
+                    : &dynamic_cast<Terminal_Renderer*>(m_renderer.get())->m_shader_cache;
+
+            // The rasterizer falls back to its fixed pipeline if a program is null.
+            auto* handle = new software::Shader;
+            for (const ShadingCode::Module& module : shader.m_code.m_modules) {
+                switch (module.m_stage) {
+                    case SHADER_STAGE::VERTEX:
+                        handle->m_vertex = cache->get(module);
+                        break;
+                    case SHADER_STAGE::FRAGMENT:
+                        handle->m_fragment = cache->get(module);
+                        break;
+                    default: break;
+                }
+            }
+            shader.m_handle = NativeHandle(handle, delete_software_shader);
+        } break;
         default: assert(false);
     }
-    return &shader;
+    return id;
 }
 
 /**
  * @brief Registers a mesh on the GPU and returns an id to it.
  *
- * @param format
  * @param data
- * @return u32
+ * @return MeshId
  */
-auto RenderSystem::register_mesh(const Mesh& data) -> GPUMeshData* {
-    m_registered_meshes.emplace_back(this, data);
-    return &m_registered_meshes.back();
+auto RenderSystem::register_mesh(const Mesh& data) -> MeshId {
+    const MeshId id = m_registered_meshes.create(this, data);
+    m_registered_meshes.get(id)->m_id = id.index();
+    return id;
 }
 
 auto RenderSystem::list_available_graphics_apis() -> std::vector<GRAPHICS_API> {
@@ -600,14 +722,23 @@ auto RenderSystem::list_available_graphics_apis() -> std::vector<GRAPHICS_API> {
 #endif
     if (vulkan != nullptr) { result.push_back(GRAPHICS_API::VULKAN); }
 
+    // The software and terminal renderers only need the CPU.
+    result.push_back(GRAPHICS_API::SOFTWARE);
+    result.push_back(GRAPHICS_API::TERMINAL);
+
     return result;
 }
 
-auto RenderSystem::register_material(ShaderHandle* shader, TextureHandle* texture)
-    -> MaterialHandle* {
-    m_registered_materials.emplace_back();
-    auto& material = m_registered_materials.back();
+auto RenderSystem::register_material(ShaderId shader_id, TextureId texture_id)
+    -> MaterialId {
+    ShaderHandle*  shader = this->get(shader_id);
+    TextureHandle* texture = this->get(texture_id);
+    JF_ASSERT(shader != nullptr, "the shader of a material must not be released");
 
+    const MaterialId id = m_registered_materials.create();
+    MaterialHandle&  material = *m_registered_materials.get(id);
+
+    material.m_id = id.index();
     material.m_shader = shader;
     material.m_texture = texture;
     material.m_api = m_api;
@@ -649,21 +780,134 @@ auto RenderSystem::register_material(ShaderHandle* shader, TextureHandle* textur
             );
             if (texture != nullptr) {}
         } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: {
+            auto* tex = texture == nullptr
+                            ? nullptr
+                            : static_cast<software::Texture*>(texture->m_handle.get());
+            auto* sh = static_cast<software::Shader*>(shader->m_handle.get());
+            material.m_handle = NativeHandle(
+                new software::Material{.m_texture = tex, .m_shader = sh},
+                delete_software_material
+            );
+        } break;
         default: assert(false);
     }
 
-    return &material;
+    return id;
+}
+
+auto RenderSystem::get(TextureId id) -> TextureHandle* {
+    return m_registered_textures.get(id);
+}
+
+auto RenderSystem::get(ShaderId id) -> ShaderHandle* {
+    return m_registered_shaders.get(id);
+}
+
+auto RenderSystem::get(MaterialId id) -> MaterialHandle* {
+    return m_registered_materials.get(id);
+}
+
+auto RenderSystem::get(MeshId id) -> GPUMeshData* {
+    return m_registered_meshes.get(id);
+}
+
+auto RenderSystem::is_ready(TextureId id) -> bool {
+    const TextureHandle* texture = this->get(id);
+    return texture != nullptr && this->is_upload_done(texture->m_upload);
+}
+
+auto RenderSystem::is_ready(MeshId id) -> bool {
+    const GPUMeshData* mesh = this->get(id);
+    return mesh != nullptr && this->is_upload_done(mesh->m_upload);
+}
+
+auto RenderSystem::is_upload_done(u64 upload) const -> bool {
+    if (upload == 0) { return true; }
+    switch (m_api) {
+        case GRAPHICS_API::VULKAN: {
+            auto* renderer = dynamic_cast<Vulkan_Renderer*>(m_renderer.get());
+            return renderer->m_logical_device->m_uploader->is_done(upload);
+        }
+        default: return true;
+    }
+}
+
+auto RenderSystem::begin_upload_batch() -> void {
+    // The other APIs write right away.
+    if (m_api != GRAPHICS_API::VULKAN) { return; }
+    auto* renderer = dynamic_cast<Vulkan_Renderer*>(m_renderer.get());
+    renderer->m_logical_device->m_uploader->begin_batch();
+}
+
+auto RenderSystem::end_upload_batch() -> u64 {
+    if (m_api != GRAPHICS_API::VULKAN) { return 0; }
+    auto* renderer = dynamic_cast<Vulkan_Renderer*>(m_renderer.get());
+    return renderer->m_logical_device->m_uploader->end_batch();
+}
+
+// NOTE: A resource released in frame `n` may be drawn by the frames up to `n`, which the
+// renderer may still be working on until it starts frame `n + get_frames_in_flight()`.
+
+auto RenderSystem::release(TextureId id) -> void {
+    m_registered_textures.release(id, m_frame + m_renderer->get_frames_in_flight());
+}
+
+auto RenderSystem::release(ShaderId id) -> void {
+    m_registered_shaders.release(id, m_frame + m_renderer->get_frames_in_flight());
+}
+
+auto RenderSystem::release(MaterialId id) -> void {
+    m_registered_materials.release(id, m_frame + m_renderer->get_frames_in_flight());
+}
+
+auto RenderSystem::release(MeshId id) -> void {
+    m_registered_meshes.release(id, m_frame + m_renderer->get_frames_in_flight());
 }
 
 auto RenderSystem::submit(const Object& obj) -> void {
     // TODO(artur): Check whether the vertex data is matches the shader's vertex format
-    const RenderCommand command = {
-        .transform = obj.m_transform.calculate(),
-        .vertex_data = obj.m_vertex_data,
-        .material = obj.m_material,
-        .m_mesh = obj.m_mesh,
-    };
-    m_render_commands.push_back(command);
+    const RenderCommand  command = obj.get_render_command();
+    const BoundingSphere bounds = obj.get_bounds();
+    if (obj.m_transform_id != TransformPool::INVALID) {
+        m_submit_queue->push(command, m_transforms.get_world(obj.m_transform_id), bounds);
+    } else {
+        m_submit_queue->push(command, obj.m_transform.calculate(), bounds);
+    }
+}
+
+auto RenderSystem::prepare_queue(
+    RenderQueue&  queue,
+    const Camera& camera,
+    ThreadPool*   pool,
+    bool          copy_scene_transforms
+) -> void {
+    const Frustum frustum = camera.get_frustum();
+    queue.cull(frustum, pool);
+    queue.sort(camera);
+    const std::span<const RenderCommand> scene_commands = m_scene.cull(frustum, pool);
+    queue.append(scene_commands, m_scene.get_cull_stats(), copy_scene_transforms);
+}
+
+auto RenderSystem::prepare_draw_queue(const Camera& camera, ThreadPool* pool)
+    -> RenderQueue& {
+    if (m_prepared_queue != nullptr) { return *m_prepared_queue; }
+    this->prepare_queue(m_render_queue, camera, pool);
+    return m_render_queue;
+}
+
+auto RenderSystem::get_draw_queue() -> RenderQueue& {
+    return m_prepared_queue != nullptr ? *m_prepared_queue : m_render_queue;
+}
+
+auto RenderSystem::end_frame() -> void {
+    // Materials point to their shader and texture, so they go first.
+    m_registered_materials.collect(m_frame);
+    m_registered_meshes.collect(m_frame);
+    m_registered_shaders.collect(m_frame);
+    m_registered_textures.collect(m_frame);
+    m_frame++;
 }
 
 } // namespace JadeFrame
@@ -1,15 +1,20 @@
 #pragma once
 #include <cassert>
-#include <deque>
 #include <memory>
 #include <string>
 
 #include "camera.h"
+#include "mesh_arena.h"
+#include "render_queue.h"
+#include "render_scene.h"
+#include "transform.h"
+#include "JadeFrame/utils/handle_pool.h"
 
 namespace JadeFrame {
 
 class Windows_Window;
 class Object;
+class ThreadPool;
 class RGBAColor;
 class Window;
 
@@ -228,6 +233,8 @@ struct ShadingCode {
         using SPIRV = std::vector<u32>;
         SPIRV        m_code;
         SHADER_STAGE m_stage;
+
+        auto operator==(const Module& other) const -> bool = default;
     };
 
     SHADING_LANGUAGE    m_shading_language;
@@ -251,6 +258,8 @@ public:
 
     GRAPHICS_API m_api = GRAPHICS_API::UNDEFINED;
     NativeHandle m_handle = {nullptr, noop_native_handle_deleter};
+    /// See `RenderSystem::is_ready`.
+    u64          m_upload = 0;
 
 private:
     auto release() -> void;
@@ -278,6 +287,8 @@ public:
 
     GRAPHICS_API m_api = GRAPHICS_API::UNDEFINED;
     NativeHandle m_handle = {nullptr, noop_native_handle_deleter};
+    /// Index of the pool slot, used for the pipeline bits of the sort key.
+    u32 m_id = 0;
 
 private:
     auto release() -> void;
@@ -337,6 +348,8 @@ struct MaterialHandle {
     NativeHandle m_handle = {nullptr, noop_native_handle_deleter};
     MaterialInfo m_info;
     GRAPHICS_API m_api = GRAPHICS_API::UNDEFINED;
+    /// Index of the pool slot, used for the material bits of the sort key.
+    u32 m_id = 0;
 
 private:
     auto release() -> void;
@@ -373,8 +386,13 @@ public:
     GPUBuffer(GPUBuffer&& other) noexcept;
     auto operator=(GPUBuffer&& other) noexcept -> GPUBuffer&;
 
+    /// `data` may be `nullptr` to leave the contents undefined until `write`.
     GPUBuffer(RenderSystem* system, void* data, size_t size, TYPE usage);
 
+    /// Returns the value to pass to `RenderSystem::is_upload_done`, Vulkan copies on a
+    /// transfer queue. 0 if the data is written already.
+    auto write(const void* data, size_t size, size_t offset) -> u64;
+
 public:
     RenderSystem* m_system = nullptr;
     GRAPHICS_API  m_api = GRAPHICS_API::UNDEFINED;
@@ -400,17 +418,26 @@ public:
     GPUMeshData(RenderSystem* system, const Mesh& vertex_data, bool interleaved = true);
 
 public:
-    std::unique_ptr<GPUBuffer> m_vertex_buffer;
-    std::unique_ptr<GPUBuffer> m_index_buffer;
-};
-class Mesh;
+    /// Shared with the other meshes in the same arena of `RenderSystem::m_mesh_arena`.
+    /// `m_index_buffer` is `nullptr` if the mesh has no indices.
+    GPUBuffer* m_vertex_buffer = nullptr;
+    GPUBuffer* m_index_buffer = nullptr;
+    /// Where the mesh starts in the buffers, in vertices and indices.
+    u32        m_vertex_offset = 0;
+    u32        m_first_index = 0;
+
+    /// Bounds in the local space of the mesh, used for frustum culling.
+    MeshBounds m_bounds;
+    /// Index of the pool slot, used for the mesh bits of the sort key.
+    u32        m_id = 0;
+    /// See `RenderSystem::is_ready`.
+    u64        m_upload = 0;
 
-struct RenderCommand {
-    mat4x4          transform = {};
-    Mesh*           vertex_data = nullptr;
-    MaterialHandle* material = nullptr;
-    GPUMeshData*    m_mesh = nullptr;
+private:
+    MeshArena*            m_arena = nullptr;
+    MeshArena::Allocation m_allocation;
 };
+class Mesh;
 
 /*
         TODO: Consider whether this is a good way and whether it is worth it to introdcue
@@ -449,6 +476,8 @@ public: // more internal stuff
     virtual auto render(const Camera& cam) -> void = 0;
     virtual auto present() -> void = 0;
     virtual auto wait_until_idle() -> void = 0;
+    /// How many frames after the current one may still be using its resources.
+    [[nodiscard]] virtual auto get_frames_in_flight() const -> u32 = 0;
 };
 
 inline auto get_size(const SHADER_TYPE type) -> u32 {
@@ -487,26 +516,46 @@ struct MaterialHandle;
 struct TextureHandle;
 struct ShaderHandle;
 
-class Transform {
+class Object {
 public:
-    [[nodiscard]] auto calculate() const -> mat4x4 {
-        return m_translation * m_rotation * m_scale;
+    /// The command to draw the object, without a transform. The depth of the key is filled
+    /// in by `RenderQueue::sort`.
+    [[nodiscard]] auto get_render_command() const -> RenderCommand {
+        // NOTE: There is only one pass so far.
+        const MaterialHandle* material = m_material;
+        const u32 pipeline = material != nullptr && material->m_shader != nullptr
+                                 ? material->m_shader->m_id
+                                 : 0;
+        const u32 material_id = material != nullptr ? material->m_id : 0;
+        const u32 mesh_id = m_mesh != nullptr ? m_mesh->m_id : 0;
+        return RenderCommand{
+            .m_key = sort_key::create(0, pipeline, material_id, mesh_id, 0),
+            .vertex_data = m_vertex_data,
+            .material = m_material,
+            .m_mesh = m_mesh,
+        };
     }
 
-public:
-    mat4x4 m_scale = mat4x4::identity();
-    mat4x4 m_rotation = mat4x4::identity();
-    mat4x4 m_translation = mat4x4::identity();
-};
+    /// In the local space of the mesh.
+    [[nodiscard]] auto get_bounds() const -> BoundingSphere {
+        return m_mesh != nullptr ? m_mesh->m_bounds.m_sphere : BoundingSphere::infinite();
+    }
 
-class Object {
 public:
-    GPUMeshData*    m_mesh = nullptr;
-    Mesh*           m_vertex_data = nullptr;
-    MaterialHandle* m_material = nullptr;
-    Transform       m_transform;
+    GPUMeshData*      m_mesh = nullptr;
+    Mesh*             m_vertex_data = nullptr;
+    MaterialHandle*   m_material = nullptr;
+    Transform         m_transform;
+    /// If set, the world matrix is taken from `RenderSystem::m_transforms` and
+    /// `m_transform` is ignored. Meant for objects which live longer than a frame.
+    TransformPool::Id m_transform_id = TransformPool::INVALID;
 };
 
+using TextureId = PoolHandle<TextureHandle>;
+using ShaderId = PoolHandle<ShaderHandle>;
+using MaterialId = PoolHandle<MaterialHandle>;
+using MeshId = PoolHandle<GPUMeshData>;
+
 class RenderSystem {
 public:
     RenderSystem() = default;
@@ -520,13 +569,59 @@ public:
 
     auto init(GRAPHICS_API api, Window* window) -> void;
 
-    auto register_texture(Image& image) -> TextureHandle*;
-    auto register_shader(const ShaderHandle::Desc& desc) -> ShaderHandle*;
-    auto register_mesh(const Mesh& data) -> GPUMeshData*;
-    auto register_material(ShaderHandle* shader, TextureHandle* texture)
-        -> MaterialHandle*;
+    auto register_texture(Image& image) -> TextureId;
+    auto register_shader(const ShaderHandle::Desc& desc) -> ShaderId;
+    auto register_mesh(const Mesh& data) -> MeshId;
+    /// `texture` may be invalid for materials without one.
+    auto register_material(ShaderId shader, TextureId texture) -> MaterialId;
+
+    /// `nullptr` if the resource was released. The pointers stay valid until then.
+    [[nodiscard]] auto get(TextureId id) -> TextureHandle*;
+    [[nodiscard]] auto get(ShaderId id) -> ShaderHandle*;
+    [[nodiscard]] auto get(MaterialId id) -> MaterialHandle*;
+    [[nodiscard]] auto get(MeshId id) -> GPUMeshData*;
+
+    /// Whether the data of the resource reached the GPU. Registering does not wait for
+    /// the upload, a resource which is not ready should not be drawn yet. Released
+    /// resources are not ready.
+    [[nodiscard]] auto is_ready(TextureId id) -> bool;
+    [[nodiscard]] auto is_ready(MeshId id) -> bool;
+    /// For the values returned by `GPUBuffer::write`.
+    [[nodiscard]] auto is_upload_done(u64 upload) const -> bool;
+    /// The textures and meshes registered until `end_upload_batch` are uploaded with one
+    /// staging buffer and one submit, e.g. when loading a scene. Nothing may be waited
+    /// for or released in between.
+    auto begin_upload_batch() -> void;
+    /// Returns the value for `is_upload_done` of the whole batch.
+    auto end_upload_batch() -> u64;
+
+    /// The id is invalid right away. The resource is destroyed once the frames in flight
+    /// which may still use it have finished, see `end_frame`. Materials have to be
+    /// released before their shader and texture, and objects in `m_scene` before their
+    /// mesh and material.
+    auto release(TextureId id) -> void;
+    auto release(ShaderId id) -> void;
+    auto release(MaterialId id) -> void;
+    auto release(MeshId id) -> void;
 
     auto submit(const Object& obj) -> void;
+    /// Culls and sorts `queue` for `camera` and appends the visible items of `m_scene`.
+    /// With `copy_scene_transforms` the queue does not point into the scene afterwards,
+    /// so the scene may change while the queue is drawn.
+    auto prepare_queue(
+        RenderQueue&  queue,
+        const Camera& camera,
+        ThreadPool*   pool = nullptr,
+        bool          copy_scene_transforms = false
+    ) -> void;
+    /// Called by the renderers at the start of `render`. Prepares `m_render_queue`,
+    /// unless a `RenderThread` hands over a queue it prepared already.
+    auto prepare_draw_queue(const Camera& camera, ThreadPool* pool = nullptr)
+        -> RenderQueue&;
+    [[nodiscard]] auto get_draw_queue() -> RenderQueue&;
+    /// Called by the application after presenting. Destroys the released resources no
+    /// frame uses anymore.
+    auto end_frame() -> void;
 
 public:
     [[nodiscard]] static auto list_available_graphics_apis() -> std::vector<GRAPHICS_API>;
@@ -535,12 +630,27 @@ public:
     GRAPHICS_API               m_api = GRAPHICS_API::UNDEFINED;
     std::unique_ptr<IRenderer> m_renderer;
 
-    mutable std::deque<RenderCommand> m_render_commands;
+    mutable RenderQueue m_render_queue;
+    /// Where `submit` pushes to. A `RenderThread` points it to the packet being built.
+    RenderQueue*        m_submit_queue = &m_render_queue;
+    /// Set by a `RenderThread` to the prepared queue of the packet it draws.
+    RenderQueue*        m_prepared_queue = nullptr;
+    /// Updated by the application once per frame, before drawing.
+    TransformPool       m_transforms;
+    /// Drawn every frame next to the submitted objects. Updated like `m_transforms`.
+    RenderScene         m_scene;
+    /// Holds the vertices and indices of the registered meshes. Declared before the
+    /// pools, so the meshes are returned to it before it is destroyed.
+    MeshArena           m_mesh_arena;
+
+    HandlePool<TextureHandle>  m_registered_textures;
+    HandlePool<ShaderHandle>   m_registered_shaders;
+    HandlePool<MaterialHandle> m_registered_materials;
+    HandlePool<GPUMeshData>    m_registered_meshes;
 
-    std::deque<TextureHandle>  m_registered_textures;
-    std::deque<ShaderHandle>   m_registered_shaders;
-    std::deque<MaterialHandle> m_registered_materials;
-    std::deque<GPUMeshData>    m_registered_meshes;
+private:
+    /// The number of `end_frame` calls since `init`.
+    u64 m_frame = 0;
 };
 
 } // namespace JadeFrame
@@ -0,0 +1,104 @@
+#include "indirect_draw.h"
+
+#include <cstring>
+
+#include "graphics_shared.h"
+#include "mesh.h"
+
+namespace JadeFrame {
+
+/// Draws in the same batch are issued with the same bound state, only their arguments
+/// differ. Meshes in the same arena share their buffers.
+static auto is_same_batch(const RenderCommand& a, const RenderCommand& b) -> bool {
+    return a.material == b.material &&
+           a.m_mesh->m_vertex_buffer == b.m_mesh->m_vertex_buffer &&
+           a.m_mesh->m_index_buffer == b.m_mesh->m_index_buffer;
+}
+
+auto IndirectDrawList::clear() -> void {
+    m_indexed_draws.clear();
+    m_draws.clear();
+    m_batches.clear();
+    m_transforms.clear();
+}
+
+auto IndirectDrawList::add(std::span<const RenderCommand> commands) -> void {
+    size_t i = 0;
+    while (i < commands.size()) {
+        const RenderCommand& first = commands[i];
+        const u32            first_instance = static_cast<u32>(m_transforms.size());
+        u32                  instance_count = 0;
+        while (i < commands.size()) {
+            const RenderCommand& cmd = commands[i];
+            if (cmd.m_mesh != first.m_mesh || cmd.vertex_data != first.vertex_data ||
+                cmd.material != first.material) {
+                break;
+            }
+            m_transforms.push_back(*cmd.transform);
+            instance_count++;
+            i++;
+        }
+
+        const Mesh&        mesh = *first.vertex_data;
+        const GPUMeshData& gpu_mesh = *first.m_mesh;
+        const bool         is_indexed = !mesh.m_indices.empty();
+        if (m_batches.empty() || m_batches.back().m_is_indexed != is_indexed ||
+            !is_same_batch(*m_batches.back().m_command, first)) {
+            const size_t draw_count =
+                is_indexed ? m_indexed_draws.size() : m_draws.size();
+            m_batches.push_back(Batch{
+                .m_command = &first,
+                .m_is_indexed = is_indexed,
+                .m_first = static_cast<u32>(draw_count),
+                .m_count = 0,
+            });
+        }
+        m_batches.back().m_count++;
+
+        if (is_indexed) {
+            m_indexed_draws.push_back(DrawIndexedIndirectCommand{
+                .m_index_count = static_cast<u32>(mesh.m_indices.size()),
+                .m_instance_count = instance_count,
+                .m_first_index = gpu_mesh.m_first_index,
+                .m_vertex_offset = static_cast<i32>(gpu_mesh.m_vertex_offset),
+                .m_first_instance = first_instance,
+            });
+        } else {
+            const auto& position = mesh.m_attributes.at(Mesh::POSITION.m_id);
+            const size_t component_num = component_count(Mesh::POSITION.m_format);
+            const size_t vertex_count = position.m_data.size() / component_num;
+            m_draws.push_back(DrawIndirectCommand{
+                .m_vertex_count = static_cast<u32>(vertex_count),
+                .m_instance_count = instance_count,
+                .m_first_vertex = gpu_mesh.m_vertex_offset,
+                .m_first_instance = first_instance,
+            });
+        }
+    }
+}
+
+auto IndirectDrawList::get_args_offset(const Batch& batch) const -> size_t {
+    if (batch.m_is_indexed) { return batch.m_first * sizeof(DrawIndexedIndirectCommand); }
+    return m_indexed_draws.size() * sizeof(DrawIndexedIndirectCommand) +
+           batch.m_first * sizeof(DrawIndirectCommand);
+}
+
+auto IndirectDrawList::get_args_size() const -> size_t {
+    return m_indexed_draws.size() * sizeof(DrawIndexedIndirectCommand) +
+           m_draws.size() * sizeof(DrawIndirectCommand);
+}
+
+auto IndirectDrawList::write_args(void* dst) const -> void {
+    const size_t indexed_size =
+        m_indexed_draws.size() * sizeof(DrawIndexedIndirectCommand);
+    if (indexed_size != 0) { std::memcpy(dst, m_indexed_draws.data(), indexed_size); }
+    if (!m_draws.empty()) {
+        std::memcpy(
+            static_cast<u8*>(dst) + indexed_size,
+            m_draws.data(),
+            m_draws.size() * sizeof(DrawIndirectCommand)
+        );
+    }
+}
+
+} // namespace JadeFrame
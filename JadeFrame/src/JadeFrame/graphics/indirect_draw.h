@@ -0,0 +1,88 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/mat_4.h"
+#include "render_queue.h"
+
+namespace JadeFrame {
+
+/// Laid out like `VkDrawIndexedIndirectCommand` and the `DrawElementsIndirectCommand` of
+/// OpenGL, so an array of them can be copied into an indirect buffer as is.
+struct DrawIndexedIndirectCommand {
+    u32 m_index_count = 0;
+    u32 m_instance_count = 0;
+    u32 m_first_index = 0;
+    i32 m_vertex_offset = 0;
+    u32 m_first_instance = 0;
+};
+static_assert(sizeof(DrawIndexedIndirectCommand) == 5 * sizeof(u32));
+
+/// Laid out like `VkDrawIndirectCommand` and `DrawArraysIndirectCommand`.
+struct DrawIndirectCommand {
+    u32 m_vertex_count = 0;
+    u32 m_instance_count = 0;
+    u32 m_first_vertex = 0;
+    u32 m_first_instance = 0;
+};
+static_assert(sizeof(DrawIndirectCommand) == 4 * sizeof(u32));
+
+/*
+    The draws of a frame as arguments for indirect draw calls. Every run of the same mesh
+   and material becomes one instanced draw, and the transforms of all draws are packed
+   into one array. The shaders index it with the instance index, which starts at the
+   `m_first_instance` of the draw, so no per object data has to be bound between draws.
+    Consecutive draws which only differ in their arguments are grouped into a `Batch`,
+   which the renderers issue with one multi draw call. Draws of different meshes in the
+   same buffers only differ in their first index and vertex offset, see `MeshArena`.
+    The indexed and the other draws are stored in two arrays. `write_args` copies both
+   into one buffer, the indexed ones first.
+*/
+class IndirectDrawList {
+public:
+    struct Batch {
+        /// The first command of the batch, for its material and mesh buffers.
+        const RenderCommand* m_command = nullptr;
+        bool                 m_is_indexed = false;
+        /// Into the indexed or the other draws.
+        u32                  m_first = 0;
+        u32                  m_count = 0;
+    };
+
+    auto clear() -> void;
+    /// Appends sorted commands. Their transforms are copied, so they do not need to be
+    /// next to each other.
+    auto add(std::span<const RenderCommand> commands) -> void;
+
+    [[nodiscard]] auto get_indexed_draws() const
+        -> std::span<const DrawIndexedIndirectCommand> {
+        return m_indexed_draws;
+    }
+
+    [[nodiscard]] auto get_draws() const -> std::span<const DrawIndirectCommand> {
+        return m_draws;
+    }
+
+    [[nodiscard]] auto get_batches() const -> std::span<const Batch> { return m_batches; }
+
+    [[nodiscard]] auto get_transforms() const -> std::span<const mat4x4> {
+        return m_transforms;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return m_batches.empty(); }
+
+    /// The offset of the first draw of `batch` in the buffer written by `write_args`.
+    [[nodiscard]] auto get_args_offset(const Batch& batch) const -> size_t;
+    [[nodiscard]] auto get_args_size() const -> size_t;
+    /// `dst` has to hold `get_args_size` bytes.
+    auto write_args(void* dst) const -> void;
+
+private:
+    std::vector<DrawIndexedIndirectCommand> m_indexed_draws;
+    std::vector<DrawIndirectCommand>        m_draws;
+    std::vector<Batch>                      m_batches;
+    std::vector<mat4x4>                     m_transforms;
+};
+
+} // namespace JadeFrame
@@ -0,0 +1,218 @@
+#include "mesh_arena.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "graphics_shared.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+/*---------------------------
+    OffsetAllocator
+---------------------------*/
+
+OffsetAllocator::OffsetAllocator(u64 capacity)
+    : m_capacity(capacity) {
+    if (capacity != 0) { this->insert_free(0, capacity); }
+}
+
+auto OffsetAllocator::allocate(u64 size, u64 alignment) -> Allocation {
+    JF_ASSERT(alignment != 0, "alignment must not be 0");
+    if (size == 0) { return {}; }
+
+    // The smallest range which fits, with the padding in front of the aligned offset.
+    for (auto it = m_free_by_size.lower_bound(size); it != m_free_by_size.end(); ++it) {
+        const u64 free_size = it->first;
+        const u64 free_offset = it->second;
+        const u64 offset = (free_offset + alignment - 1) / alignment * alignment;
+        const u64 padding = offset - free_offset;
+        if (padding + size > free_size) { continue; }
+
+        this->erase_free(m_free_by_offset.find(free_offset));
+        // The neighbours of the range are in use, so the rest does not need merging.
+        if (padding != 0) { this->insert_free(free_offset, padding); }
+        const u64 rest = free_size - padding - size;
+        if (rest != 0) { this->insert_free(offset + size, rest); }
+
+        m_used += size;
+        m_allocation_count++;
+        return Allocation{.m_offset = offset, .m_size = size};
+    }
+    return {};
+}
+
+auto OffsetAllocator::free(const Allocation& allocation) -> void {
+    if (!allocation.is_valid()) { return; }
+    JF_ASSERT(allocation.m_offset + allocation.m_size <= m_capacity, "not from here");
+    u64 offset = allocation.m_offset;
+    u64 size = allocation.m_size;
+    m_used -= size;
+    m_allocation_count--;
+
+    auto next = m_free_by_offset.lower_bound(offset);
+    JF_ASSERT(
+        next == m_free_by_offset.end() || next->first >= offset + size, "double free"
+    );
+    if (next != m_free_by_offset.end() && next->first == offset + size) {
+        size += next->second;
+        next = std::next(next);
+        this->erase_free(std::prev(next));
+    }
+    if (next != m_free_by_offset.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            this->erase_free(previous);
+        }
+    }
+    this->insert_free(offset, size);
+}
+
+auto OffsetAllocator::get_stats() const -> Stats {
+    return Stats{
+        .m_capacity = m_capacity,
+        .m_used = m_used,
+        .m_largest_free = m_free_by_size.empty() ? 0 : m_free_by_size.rbegin()->first,
+        .m_allocation_count = m_allocation_count,
+        .m_free_range_count = static_cast<u32>(m_free_by_offset.size()),
+    };
+}
+
+auto OffsetAllocator::insert_free(u64 offset, u64 size) -> void {
+    m_free_by_offset.emplace(offset, size);
+    m_free_by_size.emplace(size, offset);
+}
+
+auto OffsetAllocator::erase_free(std::map<u64, u64>::iterator it) -> void {
+    auto [first, last] = m_free_by_size.equal_range(it->second);
+    for (auto sized = first; sized != last; ++sized) {
+        if (sized->second == it->first) {
+            m_free_by_size.erase(sized);
+            break;
+        }
+    }
+    m_free_by_offset.erase(it);
+}
+
+/*---------------------------
+    MeshArena
+---------------------------*/
+
+MeshArena::MeshArena(RenderSystem* system, u64 vertex_capacity, u64 index_capacity)
+    : m_system(system)
+    , m_vertex_capacity(vertex_capacity)
+    , m_index_capacity(index_capacity) {}
+
+MeshArena::~MeshArena() = default;
+MeshArena::MeshArena(MeshArena&&) noexcept = default;
+auto MeshArena::operator=(MeshArena&&) noexcept -> MeshArena& = default;
+
+auto MeshArena::allocate(
+    std::span<const f32> vertices,
+    u32                  stride,
+    std::span<const u32> indices
+) -> Allocation {
+    JF_ASSERT(!vertices.empty() && stride != 0, "a mesh needs vertices");
+    const u64 vertex_size = vertices.size_bytes();
+    const u64 index_size = indices.size_bytes();
+
+    auto place = [&](u32 index) -> Allocation {
+        Arena&     arena = m_arenas[index];
+        const auto vertex_range = arena.m_vertices.allocate(vertex_size, stride);
+        if (!vertex_range.is_valid()) { return {}; }
+        OffsetAllocator::Allocation index_range;
+        if (index_size != 0) {
+            index_range = arena.m_indices.allocate(index_size, sizeof(u32));
+            if (!index_range.is_valid()) {
+                arena.m_vertices.free(vertex_range);
+                return {};
+            }
+        }
+        return Allocation{
+            .m_arena = index,
+            .m_vertices = vertex_range,
+            .m_indices = index_range,
+            .m_vertex_offset = static_cast<u32>(vertex_range.m_offset / stride),
+            .m_first_index = static_cast<u32>(index_range.m_offset / sizeof(u32)),
+        };
+    };
+
+    Allocation result;
+    for (u32 i = 0; i < m_arenas.size() && result.m_arena == INVALID; i++) {
+        result = place(i);
+    }
+    if (result.m_arena == INVALID) {
+        // Meshes larger than an arena get one of their own.
+        const u32 index = this->create_arena(
+            std::max(m_vertex_capacity, vertex_size),
+            std::max(m_index_capacity, index_size)
+        );
+        result = place(index);
+        JF_ASSERT(result.m_arena == index, "a new arena has room for the mesh");
+    }
+
+    Arena&    arena = m_arenas[result.m_arena];
+    const u64 vertex_offset = result.m_vertices.m_offset;
+    result.m_upload =
+        arena.m_vertex_buffer->write(vertices.data(), vertex_size, vertex_offset);
+    if (index_size != 0) {
+        // The values only grow, so the second upload is done after the first.
+        const u64 index_offset = result.m_indices.m_offset;
+        result.m_upload =
+            arena.m_index_buffer->write(indices.data(), index_size, index_offset);
+    }
+    return result;
+}
+
+auto MeshArena::free(const Allocation& allocation) -> void {
+    if (allocation.m_arena == INVALID) { return; }
+    Arena& arena = m_arenas[allocation.m_arena];
+    arena.m_vertices.free(allocation.m_vertices);
+    arena.m_indices.free(allocation.m_indices);
+}
+
+auto MeshArena::get_vertex_buffer(u32 arena) const -> GPUBuffer* {
+    return m_arenas[arena].m_vertex_buffer.get();
+}
+
+auto MeshArena::get_index_buffer(u32 arena) const -> GPUBuffer* {
+    return m_arenas[arena].m_index_buffer.get();
+}
+
+static auto add(OffsetAllocator::Stats& sum, const OffsetAllocator::Stats& stats)
+    -> void {
+    sum.m_capacity += stats.m_capacity;
+    sum.m_used += stats.m_used;
+    sum.m_largest_free = std::max(sum.m_largest_free, stats.m_largest_free);
+    sum.m_allocation_count += stats.m_allocation_count;
+    sum.m_free_range_count += stats.m_free_range_count;
+}
+
+auto MeshArena::get_stats() const -> Stats {
+    Stats result;
+    result.m_arena_count = static_cast<u32>(m_arenas.size());
+    for (const Arena& arena : m_arenas) {
+        add(result.m_vertices, arena.m_vertices.get_stats());
+        add(result.m_indices, arena.m_indices.get_stats());
+    }
+    return result;
+}
+
+auto MeshArena::create_arena(u64 vertex_capacity, u64 index_capacity) -> u32 {
+    JF_ASSERT(m_system != nullptr, "the arena was not created by a RenderSystem");
+    Arena arena;
+    arena.m_vertex_buffer = std::make_unique<GPUBuffer>(
+        m_system, nullptr, vertex_capacity, GPUBuffer::TYPE::VERTEX
+    );
+    arena.m_index_buffer = std::make_unique<GPUBuffer>(
+        m_system, nullptr, index_capacity, GPUBuffer::TYPE::INDEX
+    );
+    arena.m_vertices = OffsetAllocator(vertex_capacity);
+    arena.m_indices = OffsetAllocator(index_capacity);
+    m_arenas.push_back(std::move(arena));
+    return static_cast<u32>(m_arenas.size() - 1);
+}
+
+} // namespace JadeFrame
@@ -0,0 +1,146 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+
+namespace JadeFrame {
+class RenderSystem;
+class GPUBuffer;
+
+/*
+    Hands out ranges of a buffer which is allocated once. The free ranges are kept by
+   offset, so a freed range is merged with its free neighbours right away, and by size,
+   so `allocate` takes the smallest free range which fits.
+    Only the bookkeeping, it does not touch any memory.
+*/
+class OffsetAllocator {
+public:
+    struct Allocation {
+        u64 m_offset = 0;
+        /// 0 if the allocation failed or nothing was allocated.
+        u64 m_size = 0;
+
+        [[nodiscard]] auto is_valid() const -> bool { return m_size != 0; }
+    };
+
+    struct Stats {
+        u64 m_capacity = 0;
+        u64 m_used = 0;
+        u64 m_largest_free = 0;
+        u32 m_allocation_count = 0;
+        u32 m_free_range_count = 0;
+
+        [[nodiscard]] auto get_free() const -> u64 { return m_capacity - m_used; }
+
+        /// 0 if all free memory is in one range, towards 1 the more it is split up.
+        [[nodiscard]] auto get_fragmentation() const -> f32 {
+            const u64 free = this->get_free();
+            if (free == 0) { return 0.0F; }
+            return 1.0F - static_cast<f32>(m_largest_free) / static_cast<f32>(free);
+        }
+    };
+
+    OffsetAllocator() = default;
+    explicit OffsetAllocator(u64 capacity);
+
+    /// The offset is a multiple of `alignment`, which does not have to be a power of
+    /// two, so vertices can be aligned to their stride. Fails if no free range fits.
+    auto allocate(u64 size, u64 alignment = 1) -> Allocation;
+    auto free(const Allocation& allocation) -> void;
+
+    [[nodiscard]] auto get_stats() const -> Stats;
+
+    [[nodiscard]] auto get_capacity() const -> u64 { return m_capacity; }
+
+private:
+    auto insert_free(u64 offset, u64 size) -> void;
+    auto erase_free(std::map<u64, u64>::iterator it) -> void;
+
+private:
+    /// The free ranges, offset to size.
+    std::map<u64, u64>      m_free_by_offset;
+    /// The same ranges, size to offset.
+    std::multimap<u64, u64> m_free_by_size;
+    u64                     m_capacity = 0;
+    u64                     m_used = 0;
+    u32                     m_allocation_count = 0;
+};
+
+/*
+    The vertices and indices of all registered meshes, in a few large buffers instead of
+   two buffers per mesh. A mesh is placed into the first arena with room for both, a new
+   arena is only created if none has. The draws select the mesh with the first index and
+   the vertex offset, so meshes in the same arena are drawn without binding other
+   buffers.
+    The vertices of a mesh are aligned to its stride, so the vertex offset counts whole
+   vertices.
+*/
+class MeshArena {
+public:
+    constexpr static u64 DEFAULT_VERTEX_CAPACITY = u64{32} * 1024 * 1024;
+    constexpr static u64 DEFAULT_INDEX_CAPACITY = u64{8} * 1024 * 1024;
+    constexpr static u32 INVALID = ~u32{0};
+
+    struct Allocation {
+        u32                         m_arena = INVALID;
+        OffsetAllocator::Allocation m_vertices;
+        OffsetAllocator::Allocation m_indices;
+        /// In vertices and indices, as passed to the draws.
+        u32                         m_vertex_offset = 0;
+        u32                         m_first_index = 0;
+        /// See `GPUBuffer::write`.
+        u64                         m_upload = 0;
+    };
+
+    /// The stats of all arenas added together.
+    struct Stats {
+        u32                    m_arena_count = 0;
+        OffsetAllocator::Stats m_vertices;
+        OffsetAllocator::Stats m_indices;
+    };
+
+    MeshArena() = default;
+    ~MeshArena();
+    MeshArena(const MeshArena&) = delete;
+    auto operator=(const MeshArena&) -> MeshArena& = delete;
+    MeshArena(MeshArena&&) noexcept;
+    auto operator=(MeshArena&&) noexcept -> MeshArena&;
+
+    explicit MeshArena(
+        RenderSystem* system,
+        u64           vertex_capacity = DEFAULT_VERTEX_CAPACITY,
+        u64           index_capacity = DEFAULT_INDEX_CAPACITY
+    );
+
+    /// Allocates the ranges and starts uploading `vertices` and `indices` into them.
+    /// `indices` may be empty.
+    auto allocate(std::span<const f32> vertices, u32 stride, std::span<const u32> indices)
+        -> Allocation;
+    /// The ranges must not be used by any frame in flight anymore.
+    auto free(const Allocation& allocation) -> void;
+
+    [[nodiscard]] auto get_vertex_buffer(u32 arena) const -> GPUBuffer*;
+    [[nodiscard]] auto get_index_buffer(u32 arena) const -> GPUBuffer*;
+    [[nodiscard]] auto get_stats() const -> Stats;
+
+private:
+    struct Arena {
+        std::unique_ptr<GPUBuffer> m_vertex_buffer;
+        std::unique_ptr<GPUBuffer> m_index_buffer;
+        OffsetAllocator            m_vertices;
+        OffsetAllocator            m_indices;
+    };
+
+    auto create_arena(u64 vertex_capacity, u64 index_capacity) -> u32;
+
+private:
+    RenderSystem*      m_system = nullptr;
+    std::vector<Arena> m_arenas;
+    u64                m_vertex_capacity = DEFAULT_VERTEX_CAPACITY;
+    u64                m_index_capacity = DEFAULT_INDEX_CAPACITY;
+};
+
+} // namespace JadeFrame
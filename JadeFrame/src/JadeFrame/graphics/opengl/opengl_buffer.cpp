@@ -64,7 +64,9 @@ auto Buffer::reserve(GLuint size) -> void {
 auto Buffer::alloc(const void* data, GLuint size) -> void {
     u32 usage = 0;
     switch (m_type) {
-        case TYPE::UNIFORM: usage = GL_DYNAMIC_DRAW; break;
+        case TYPE::UNIFORM:
+        case TYPE::STORAGE:
+        case TYPE::INDIRECT: usage = GL_DYNAMIC_DRAW; break;
         default: usage = GL_STATIC_DRAW; break;
     }
     glNamedBufferData(m_id, size, data, usage);
@@ -21,7 +21,9 @@ public:
         VERTEX,
         INDEX,
         UNIFORM,
-        STAGING
+        STAGING,
+        STORAGE,
+        INDIRECT,
     };
 
     static auto create(opengl::Context& context, TYPE type, const void* data, GLuint size)
@@ -32,9 +34,10 @@ public:
 private:
     Buffer(opengl::Context& context, TYPE type, const void* data, GLuint size);
     auto alloc(const void* data, GLuint size) -> void;
-    auto reserve(GLuint size) -> void;
 
 public:
+    /// Grows the buffer if it is smaller than `size`. The contents are lost then.
+    auto reserve(GLuint size) -> void;
     auto write(const void* data, GLuint size, GLint offset) const -> void;
 
     template<typename T>
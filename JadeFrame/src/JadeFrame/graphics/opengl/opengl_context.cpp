@@ -174,10 +174,19 @@ Context::Context(Window* window) {
     #undef linux
     #if !defined(linux)
     auto* win = dynamic_cast<JadeFrame::X11_NativeWindow*>(window->m_native_window.get());
-    m_swapchain_context.m_render_context = opengl::linux::load_glx_funcs(win);
-    opengl::linux::load_opengl_funcs();
-    m_swapchain_context.m_display = win->m_display;
-    m_swapchain_context.m_window = win->m_window;
+    if (win != nullptr) {
+        m_swapchain_context.m_render_context = opengl::linux::load_glx_funcs(win);
+        opengl::linux::load_opengl_funcs();
+        m_swapchain_context.m_display = win->m_display;
+        m_swapchain_context.m_window = win->m_window;
+    } else {
+        m_swapchain_context.m_egl_context = opengl::linux::create_egl_context(
+            window->get_size(),
+            &m_swapchain_context.m_egl_display,
+            &m_swapchain_context.m_egl_surface
+        );
+        opengl::linux::load_opengl_funcs_egl();
+    }
     #endif
 #else
     {
@@ -273,6 +282,16 @@ Context::~Context() {
         );
         m_swapchain_context.m_render_context = nullptr;
     }
+    if (m_swapchain_context.m_egl_display != EGL_NO_DISPLAY) {
+        EGLDisplay display = m_swapchain_context.m_egl_display;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, m_swapchain_context.m_egl_context);
+        eglDestroySurface(display, m_swapchain_context.m_egl_surface);
+        eglTerminate(display);
+        m_swapchain_context.m_egl_display = EGL_NO_DISPLAY;
+        m_swapchain_context.m_egl_surface = EGL_NO_SURFACE;
+        m_swapchain_context.m_egl_context = EGL_NO_CONTEXT;
+    }
 #endif
 }
 
@@ -280,6 +299,12 @@ auto SwapchainContext::swap_buffers() -> void {
 #ifdef _WIN32
     ::SwapBuffers(m_device_context); // TODO: This is Windows specific. Abstract his away!
 #elif __linux__
+    if (m_egl_display != EGL_NO_DISPLAY) {
+        // A pbuffer has nothing to swap. Waiting for the frame keeps the CPU from
+        // running ahead, so headless frame times include the GPU work.
+        glFinish();
+        return;
+    }
     glXSwapBuffers(m_display, m_window);
 #endif
 }
@@ -9,6 +9,7 @@
     #include "JadeFrame/platform/windows/windows_window.h"
 #elif __linux__
     #include <GL/glx.h>
+    #include <EGL/egl.h>
 #endif
 
 #include "JadeFrame/graphics/mesh.h" // For Color
@@ -103,6 +104,10 @@ public:
     ::Display*   m_display = nullptr;
     ::GLXContext m_render_context = nullptr;
     ::Window     m_window = 0;
+    // Only used for headless windows, which render into an EGL pbuffer instead.
+    ::EGLDisplay m_egl_display = EGL_NO_DISPLAY;
+    ::EGLSurface m_egl_surface = EGL_NO_SURFACE;
+    ::EGLContext m_egl_context = EGL_NO_CONTEXT;
 #endif
     auto swap_buffers() -> void;
 };
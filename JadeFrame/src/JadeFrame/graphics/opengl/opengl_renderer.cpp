@@ -1,5 +1,6 @@
 
 
+#include <algorithm>
 #include <cassert>
 #ifdef _WIN32
     #include "Windows.h"
@@ -76,12 +77,23 @@ OpenGL_Renderer::OpenGL_Renderer(RenderSystem& system, Window* window)
 #if JF_OPENGL_FB
     m_render_target.init(&m_context, m_system);
 #endif
+    const auto& extensions = m_context.extentenions;
+    const auto  it = std::ranges::find(extensions, "GL_ARB_shader_draw_parameters");
+    m_has_draw_parameters = it != extensions.end();
+    using BT = opengl::Buffer::TYPE;
+    m_indirect_transform_buffer = m_context.create_buffer(BT::STORAGE, nullptr, 0);
+    m_indirect_args_buffer = m_context.create_buffer(BT::INDIRECT, nullptr, 0);
 }
 
 auto OpenGL_Renderer::present() -> void { m_context.m_swapchain_context.swap_buffers(); }
 
 auto OpenGL_Renderer::wait_until_idle() -> void { glFinish(); }
 
+auto OpenGL_Renderer::get_frames_in_flight() const -> u32 {
+    // NOTE: The driver keeps deleted objects alive until the commands using them are done.
+    return 0;
+}
+
 auto OpenGL_Renderer::render(const Camera& camera) -> void {
 
 #if JF_OPENGL_FB
@@ -96,40 +108,68 @@ auto OpenGL_Renderer::render(const Camera& camera) -> void {
     const u32 CAM_BINDING = 0;
     const u32 TRANSFORM_BINDING = 1;
 
-    std::deque<RenderCommand>& render_commands = m_system->m_render_commands;
-
-    for (size_t i = 0; i < render_commands.size(); ++i) {
-        const RenderCommand&  cmd = render_commands[i];
+    RenderQueue& render_queue = m_system->prepare_draw_queue(camera);
+
+    // The commands are sorted by pipeline and material, so the per material state is only
+    // set where they change. Runs of the same mesh are drawn instanced, the transforms of
+    // all their instances are uploaded at once.
+    const mat4x4          view_projection = camera.get_view_projection("OpenGL");
+    const auto            commands = render_queue.get_commands();
+    const MaterialHandle* bound_material = nullptr;
+    u32                   max_instances = 1;
+    for (size_t i = 0; i < commands.size();) {
+        const RenderCommand&  cmd = commands[i];
         const MaterialHandle& mh = *cmd.material;
 
-        auto* material = static_cast<opengl::Material*>(mh.m_handle.get());
-        auto* shader = static_cast<opengl::Shader*>(mh.m_shader->m_handle.get());
-        m_context.bind_shader(*shader);
+        auto*      material = static_cast<opengl::Material*>(mh.m_handle.get());
+        auto*      shader = static_cast<opengl::Shader*>(mh.m_shader->m_handle.get());
+        const bool is_indirect = !shader->m_reflected_interface.m_storage_buffers.empty();
+        if (bound_material != &mh) {
+            m_context.bind_shader(*shader);
 
-        // NOTE: As of right now this is not optimal, as it only needs to be updated once
-        // outside the loop. But because of how the code is arranged one has to update it
-        // every iteration of the loop. Later on one HAS TO fix this.
-
-        // ub_cam
-        mat4x4 view_projection = camera.get_view_projection("OpenGL");
-        material->write_ub(CAM_BINDING, &view_projection, sizeof(view_projection), 0);
-
-        // ub_tran
-        material->write_ub(TRANSFORM_BINDING, &cmd.transform, sizeof(cmd.transform), 0);
+            // ub_cam
+            material->write_ub(
+                CAM_BINDING, &view_projection, sizeof(view_projection), 0
+            );
 
-        if (mh.m_texture != nullptr) {
-            auto* texture = static_cast<opengl::Texture*>(mh.m_texture->m_handle.get());
+            if (mh.m_texture != nullptr) {
+                auto* texture =
+                    static_cast<opengl::Texture*>(mh.m_texture->m_handle.get());
+
+                u32              texture_unit = 0;
+                opengl::Sampler* sampler = m_context.m_default_sampler;
+                m_context.m_texture_manager.bind_texture_and_sampler_to_unit(
+                    *texture, sampler, texture_unit
+                );
+            }
+            if (!is_indirect) {
+                const opengl::Buffer* ub_tran =
+                    material->m_uniform_buffers.at(TRANSFORM_BINDING);
+                max_instances = static_cast<u32>(ub_tran->m_size / sizeof(mat4x4));
+            }
+            bound_material = &mh;
+        }
 
-            u32              texture_unit = 0;
-            opengl::Sampler* sampler = m_context.m_default_sampler;
-            m_context.m_texture_manager.bind_texture_and_sampler_to_unit(
-                *texture, sampler, texture_unit
-            );
+        // All draws of the material at once, with the transforms in a storage buffer.
+        if (is_indirect) {
+            size_t end = i + 1;
+            while (end < commands.size() && commands[end].material == &mh) { end++; }
+            m_indirect.clear();
+            m_indirect.add(commands.subspan(i, end - i));
+            this->render_indirect(&shader->m_vertex_array);
+            i = end;
+            continue;
         }
 
+        // ub_tran, `sort` stored the transforms of the run next to each other.
+        const u32 instance_count = count_instances(commands.subspan(i), max_instances);
+        const auto size = static_cast<u32>(instance_count * sizeof(mat4x4));
+        material->write_ub(TRANSFORM_BINDING, cmd.transform, size, 0);
+
         OpenGL_Renderer::render_mesh(
-            cmd.vertex_data, cmd.m_mesh, &shader->m_vertex_array
+            cmd.vertex_data, cmd.m_mesh, &shader->m_vertex_array, instance_count
         );
+        i += instance_count;
     }
 #if JF_OPENGL_FB
     m_context.unbind_framebuffer();
@@ -138,13 +178,14 @@ auto OpenGL_Renderer::render(const Camera& camera) -> void {
     m_context.m_state.set_depth_test(true);
 #endif
 #undef JF_OPENGL_FB
-    render_commands.clear();
+    render_queue.clear();
 }
 
 auto OpenGL_Renderer::render_mesh(
     const Mesh*        vertex_data,
     const GPUMeshData* gpu_data,
-    OGLW_VertexArray*  vao
+    OGLW_VertexArray*  vao,
+    u32                instance_count
 ) -> void {
     // TODO: Considering we are replicating Vulkan's way of doing things, the primitive
     // type should be defined in the pipeline or shader, and here it should be simply
@@ -165,14 +206,80 @@ auto OpenGL_Renderer::render_mesh(
         auto* index_buffer =
             static_cast<opengl::Buffer*>(gpu_data->m_index_buffer->m_handle);
         glVertexArrayElementBuffer(vao->m_ID, index_buffer->m_id);
-        glDrawElements(prim_type, num_indices, gl_type, nullptr);
+        // The index buffer is shared, the offset of the mesh is passed as a pointer.
+        const void* first_index =
+            reinterpret_cast<const void*>(gpu_data->m_first_index * sizeof(u32));
+        glDrawElementsInstancedBaseVertex(
+            prim_type,
+            num_indices,
+            gl_type,
+            first_index,
+            static_cast<GLsizei>(instance_count),
+            static_cast<GLint>(gpu_data->m_vertex_offset)
+        );
     } else {
         const auto& position_attribute =
             vertex_data->m_attributes.at(Mesh::POSITION.m_id);
         auto num_vertices = static_cast<GLsizei>(
             position_attribute.m_data.size() / component_count(Mesh::POSITION.m_format)
         );
-        glDrawArrays(prim_type, 0, num_vertices);
+        glDrawArraysInstanced(
+            prim_type,
+            static_cast<GLint>(gpu_data->m_vertex_offset),
+            num_vertices,
+            static_cast<GLsizei>(instance_count)
+        );
+    }
+}
+
+auto OpenGL_Renderer::render_indirect(OGLW_VertexArray* vao) -> void {
+    if (!m_has_draw_parameters) {
+        Logger::err("Indirect drawing needs GL_ARB_shader_draw_parameters");
+        assert(false);
+        return;
+    }
+    // The only storage buffer of the shaders, see `remap_for_opengl`.
+    const u32 TRANSFORM_STORAGE_BINDING = 0;
+
+    // The driver synchronizes the writes with the draws of the previous material.
+    const std::span<const mat4x4> transforms = m_indirect.get_transforms();
+    const auto                    transform_size =
+        static_cast<GLuint>(transforms.size_bytes());
+    m_indirect_transform_buffer->reserve(transform_size);
+    m_indirect_transform_buffer->write(transforms.data(), transform_size, 0);
+    glBindBufferBase(
+        GL_SHADER_STORAGE_BUFFER,
+        TRANSFORM_STORAGE_BINDING,
+        m_indirect_transform_buffer->m_id
+    );
+
+    m_indirect_args.resize(m_indirect.get_args_size());
+    m_indirect.write_args(m_indirect_args.data());
+    const auto args_size = static_cast<GLuint>(m_indirect_args.size());
+    m_indirect_args_buffer->reserve(args_size);
+    m_indirect_args_buffer->write(m_indirect_args.data(), args_size, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_args_buffer->m_id);
+
+    m_context.bind_vertex_array(*vao);
+    const auto prim_type = static_cast<GLenum>(PRIMITIVE_TYPE::TRIANGLES);
+    for (const IndirectDrawList::Batch& batch : m_indirect.get_batches()) {
+        const GPUMeshData* gpu_data = batch.m_command->m_mesh;
+        auto*              vertex_buffer =
+            static_cast<opengl::Buffer*>(gpu_data->m_vertex_buffer->m_handle);
+        vao->bind_buffer(*vertex_buffer);
+
+        // The offset into the bound indirect buffer is passed as a pointer.
+        const void* offset =
+            reinterpret_cast<const void*>(m_indirect.get_args_offset(batch));
+        const auto count = static_cast<GLsizei>(batch.m_count);
+        if (batch.m_is_indexed) {
+            auto* index_buffer =
+                static_cast<opengl::Buffer*>(gpu_data->m_index_buffer->m_handle);
+            glVertexArrayElementBuffer(vao->m_ID, index_buffer->m_id);
+            glMultiDrawElementsIndirect(prim_type, GL_UNSIGNED_INT, offset, count, 0);
+        } else {
+            glMultiDrawArraysIndirect(prim_type, offset, count, 0);
+        }
     }
 }
 
@@ -249,7 +356,7 @@ auto OpenGL_Renderer::RenderTarget::init(opengl::Context* context, RenderSystem*
     // m_index_buffer = context->create_buffer(opengl::Buffer::TYPE::INDEX, nullptr, 0);
     ShaderHandle::Desc shader_handle_desc;
     shader_handle_desc.shading_code = GLSLCodeLoader::get_by_name("framebuffer_test");
-    m_shader = system->register_shader(shader_handle_desc);
+    m_shader = system->get(system->register_shader(shader_handle_desc));
 }
 
 auto OpenGL_Renderer::RenderTarget::render(RenderSystem* /*system*/) -> void {
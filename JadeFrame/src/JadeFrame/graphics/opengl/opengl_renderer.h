@@ -10,6 +10,7 @@
 #include "JadeFrame/math/mat_4.h"
 #include "JadeFrame/graphics/mesh.h"
 #include "JadeFrame/graphics/graphics_shared.h"
+#include "JadeFrame/graphics/indirect_draw.h"
 
 #include "opengl_texture.h"
 #include "opengl_buffer.h"
@@ -37,6 +38,7 @@ public:
 
     auto present() -> void override;
     auto wait_until_idle() -> void override;
+    [[nodiscard]] auto get_frames_in_flight() const -> u32 override;
     auto clear_background() -> void override;
     auto render(const Camera& camera) -> void override;
 
@@ -49,13 +51,25 @@ private:
     auto render_mesh(
         const Mesh*        vertex_data,
         const GPUMeshData* gpu_data,
-        OGLW_VertexArray*  vao
+        OGLW_VertexArray*  vao,
+        u32                instance_count
     ) -> void;
+    /// Draws `m_indirect` with one multi draw call per batch.
+    auto render_indirect(OGLW_VertexArray* vao) -> void;
 
 public:
     opengl::Context m_context;
     RenderSystem*   m_system = nullptr;
 
+    /// The draws of the current material, if its shader reads the transforms from a
+    /// storage buffer.
+    IndirectDrawList m_indirect;
+    std::vector<u8>  m_indirect_args;
+    opengl::Buffer*  m_indirect_transform_buffer = nullptr;
+    opengl::Buffer*  m_indirect_args_buffer = nullptr;
+    /// The shaders need `gl_BaseInstanceARB` for the instance index of indirect draws.
+    bool             m_has_draw_parameters = false;
+
     struct RenderTarget {
         Object                m_fb;
         opengl::Texture*      m_texture = nullptr;
@@ -184,7 +184,10 @@ Material::Material(opengl::Context& context, Shader& shader, Texture* texture)
         u32 binding = uniform_buffer.binding;
         u32 size = uniform_buffer.size;
 
-        JF_ASSERT(size == sizeof(mat4x4), "Uniform buffer size is not 64 bytes");
+        JF_ASSERT(
+            size % sizeof(mat4x4) == 0,
+            "Uniform buffer size is not a multiple of 64 bytes"
+        );
 
         using namespace opengl;
 
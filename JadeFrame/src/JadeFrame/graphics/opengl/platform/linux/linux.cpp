@@ -310,6 +310,111 @@ auto load_opengl_funcs() -> bool {
     return true;
 }
 
+static auto get_egl_display() -> EGLDisplay {
+    // Prefer Mesa's surfaceless platform, it works without any display server, e.g. with
+    // llvmpipe on a CI machine. The default display may still want X11 or Wayland.
+    const char* client_exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (client_exts != nullptr &&
+        is_extension_supported(client_exts, "EGL_MESA_platform_surfaceless")) {
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT")
+        );
+        if (get_platform_display != nullptr) {
+            EGLDisplay display = get_platform_display(
+                EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr
+            );
+            if (display != EGL_NO_DISPLAY) { return display; }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+auto create_egl_context(
+    const v2u32& size,
+    EGLDisplay*  out_display,
+    EGLSurface*  out_surface
+) -> EGLContext {
+    EGLDisplay display = get_egl_display();
+    EGLint     egl_major = 0;
+    EGLint     egl_minor = 0;
+    if (display == EGL_NO_DISPLAY ||
+        eglInitialize(display, &egl_major, &egl_minor) == 0) {
+        Logger::err("Failed to initialize EGL.");
+        std::exit(1);
+    }
+    Logger::info("EGL version: {}.{}", egl_major, egl_minor);
+    if (eglBindAPI(EGL_OPENGL_API) == 0) {
+        Logger::err("EGL does not support desktop OpenGL.");
+        std::exit(1);
+    }
+
+    std::map<int, int> config_attrib_map = {
+        {  EGL_SURFACE_TYPE, EGL_PBUFFER_BIT},
+        {EGL_RENDERABLE_TYPE,  EGL_OPENGL_BIT},
+        {       EGL_RED_SIZE,               8},
+        {     EGL_GREEN_SIZE,               8},
+        {      EGL_BLUE_SIZE,               8},
+        {     EGL_ALPHA_SIZE,               8},
+        {     EGL_DEPTH_SIZE,              24},
+        {   EGL_STENCIL_SIZE,               8},
+    };
+    std::vector<int> config_attribs = map_to_array(config_attrib_map);
+    config_attribs.back() = EGL_NONE;
+
+    EGLConfig config = nullptr;
+    EGLint    config_count = 0;
+    if (eglChooseConfig(display, config_attribs.data(), &config, 1, &config_count) == 0 ||
+        config_count == 0) {
+        Logger::err("Failed to find an EGL config with a pbuffer.");
+        std::exit(1);
+    }
+
+    const EGLint surface_attribs[] = {
+        EGL_WIDTH,
+        static_cast<EGLint>(size.x),
+        EGL_HEIGHT,
+        static_cast<EGLint>(size.y),
+        EGL_NONE,
+    };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surface_attribs);
+    if (surface == EGL_NO_SURFACE) {
+        Logger::err("Failed to create an EGL pbuffer of {}x{}.", size.x, size.y);
+        std::exit(1);
+    }
+
+    // NOTE: 4.5 and not 4.6 like with GLX, llvmpipe only exposes 4.5 in some versions.
+    const int          major_min = 4;
+    const int          minor_min = 5;
+    std::map<int, int> context_attrib_map = {
+        {          EGL_CONTEXT_MAJOR_VERSION,                       major_min},
+        {          EGL_CONTEXT_MINOR_VERSION,                       minor_min},
+        {    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT},
+        {EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE,                         EGL_TRUE},
+        {             EGL_CONTEXT_OPENGL_DEBUG,                         EGL_TRUE},
+    };
+    std::vector<int> context_attribs = map_to_array(context_attrib_map);
+    context_attribs.back() = EGL_NONE;
+
+    EGLContext ctx =
+        eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs.data());
+    if (ctx == EGL_NO_CONTEXT) {
+        Logger::err("Failed to create EGL context.");
+        std::exit(1);
+    }
+    eglMakeCurrent(display, surface, surface, ctx);
+
+    *out_display = display;
+    *out_surface = surface;
+    return ctx;
+}
+
+auto load_opengl_funcs_egl() -> bool {
+    // `gladLoadGL` resolves through GLX, which is not there without a display server.
+    i32 result = gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress));
+    if (result != 1) { Logger::err("gladLoadGLLoader() failed."); }
+    return true;
+}
+
 } // namespace linux
 } // namespace opengl
 } // namespace JadeFrame
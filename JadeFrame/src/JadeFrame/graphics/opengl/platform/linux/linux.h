@@ -1,6 +1,8 @@
 
 #include "JadeFrame/platform/linux/linux_window.h"
 #include <GL/glx.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 namespace JadeFrame {
 namespace opengl {
@@ -12,6 +14,15 @@ namespace linux {
 auto load_glx_funcs(const X11_NativeWindow* win) -> GLXContext;
 auto load_opengl_funcs() -> bool;
 
+// For headless windows. Creates a context with a pbuffer of `size` as its default
+// framebuffer and makes it current, without needing a display server.
+auto create_egl_context(
+    const v2u32& size,
+    EGLDisplay*  out_display,
+    EGLSurface*  out_surface
+) -> EGLContext;
+auto load_opengl_funcs_egl() -> bool;
+
 } // namespace linux
 #endif
 } // namespace opengl
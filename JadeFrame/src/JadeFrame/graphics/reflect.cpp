@@ -270,16 +270,29 @@ static auto reflect_sampled_images(
         u32 descriptor_set = comp.get_decoration(rc.id, spv::DecorationDescriptorSet);
 
         u32 dimension = base_ty.image.dim;
-        u32 array_size = buf_ty.array[0];
 
-        if (array_size == 0) {
-            array_size = 1;
-        } else {
-            assert(false);
-        }
+        // Only single images and arrays without a size are supported.
+        const bool is_array = !buf_ty.array.empty();
+        JF_ASSERT(!is_array || buf_ty.array[0] == 0, "sized arrays are not supported");
         result[j].binding = binding;
         result[j].set = set;
         result[j].name = name;
+        result[j].is_runtime_array = is_array;
+    }
+    return result;
+}
+
+static auto reflect_storage_buffers(
+    spirv_cross::Compiler&                                 comp,
+    const spirv_cross::SmallVector<spirv_cross::Resource>& storage_buffers
+) -> std::vector<ReflectedModule::StorageBuffer> {
+    std::vector<ReflectedModule::StorageBuffer> result;
+    result.resize(storage_buffers.size());
+    for (u32 j = 0; j < storage_buffers.size(); j++) {
+        const spirv_cross::Resource& rc = storage_buffers[j];
+        result[j].name = rc.name;
+        result[j].binding = comp.get_decoration(rc.id, spv::DecorationBinding);
+        result[j].set = comp.get_decoration(rc.id, spv::DecorationDescriptorSet);
     }
     return result;
 }
@@ -300,25 +313,20 @@ auto ReflectedModule::reflect(const ShadingCode::Module::SPIRV& code, SHADER_STA
     result.m_outputs = reflect_outputs(compiler, resources.stage_outputs);
     result.m_uniform_buffers = reflect_uniforms(compiler, resources.uniform_buffers);
     result.m_sampled_images = reflect_sampled_images(compiler, resources.sampled_images);
+    result.m_storage_buffers =
+        reflect_storage_buffers(compiler, resources.storage_buffers);
 
     std::sort(result.m_inputs.begin(), result.m_inputs.end(), temp_cmp_1);
     // std::sort(result.m_outputs.begin(), result.m_outputs.end(), temp_cmp);
 
-    // result.m_push_constant_ranges.resize(resources.push_constant_buffers.size());
-    // for (u32 j = 0; j < resources.push_constant_buffers.size(); j++) {
-    //     const spirv_cross::Resource& resource = resources.push_constant_buffers[j];
-
-    //     const std::string&           buffer_name = resource.name;
-    //     const spirv_cross::SPIRType& buffer_type =
-    //     compiler.get_type(resource.base_type_id); u32 buffer_size =
-    //     (u32)compiler.get_declared_struct_size(buffer_type); u32 member_count =
-    //     uint32_t(buffer_type.member_types.size()); u32 buffer_offset = 0;
-
-    //     std::vector<VkPushConstantRange>& push_constant_ranges =
-    //     result.m_push_constant_ranges; push_constant_ranges[j].stageFlags =
-    //     VK_SHADER_STAGE_VERTEX_BIT; push_constant_ranges[j].size = buffer_size -
-    //     buffer_offset; push_constant_ranges[j].offset = buffer_offset;
-    // }
+    for (const spirv_cross::Resource& rc : resources.push_constant_buffers) {
+        const spirv_cross::SPIRType& ty = compiler.get_type(rc.base_type_id);
+        const auto end = static_cast<u32>(compiler.get_declared_struct_size(ty));
+        // The members are ordered by offset. A block may skip those of another stage
+        // with `layout(offset = N)`.
+        result.m_push_constant_offset = compiler.type_struct_member_offset(ty, 0);
+        result.m_push_constant_size = end - result.m_push_constant_offset;
+    }
     return result;
 }
 
@@ -371,6 +379,13 @@ auto ReflectedModule::into_interface(const std::span<const ReflectedModule>& mod
             } else {
             }
         }
+
+        for (const StorageBuffer& buffer : mod.m_storage_buffers) {
+            if (!uniform_locs.contains({buffer.set, buffer.binding})) {
+                result.m_storage_buffers.push_back(buffer);
+                uniform_locs.insert({buffer.set, buffer.binding});
+            }
+        }
     }
 
     return result;
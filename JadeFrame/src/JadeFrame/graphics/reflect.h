@@ -26,6 +26,15 @@ struct ReflectedModule {
         u32         binding;
         u32         set;
         u32         size;
+        /// `sampler2D name[]`, the shader indexes the textures of `BindlessTextures`.
+        bool        is_runtime_array = false;
+    };
+
+    /// Only the binding, its size depends on the runtime array at its end.
+    struct StorageBuffer {
+        std::string name;
+        u32         binding;
+        u32         set;
     };
 
     struct UniformBuffer {
@@ -50,7 +59,11 @@ struct ReflectedModule {
     std::vector<Output>        m_outputs;
     std::vector<UniformBuffer> m_uniform_buffers;
     std::vector<SampledImage>  m_sampled_images;
-    // std::vector<VkPushConstantRange> m_push_constant_ranges;
+    std::vector<StorageBuffer> m_storage_buffers;
+    /// The bytes of the one push constant block a stage may have, from the offset of its
+    /// first member. The size is 0 without one.
+    u32                        m_push_constant_offset = 0;
+    u32                        m_push_constant_size = 0;
     static auto reflect(const ShadingCode::Module::SPIRV& code, SHADER_STAGE stage)
         -> ReflectedModule;
     static auto into_interface(const std::span<const ReflectedModule>& modules)
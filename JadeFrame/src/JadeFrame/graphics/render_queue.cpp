@@ -0,0 +1,281 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "camera.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+/*---------------------------
+    FrameArena
+---------------------------*/
+
+FrameArena::FrameArena(size_t block_size)
+    : m_block_size(block_size) {}
+
+auto FrameArena::allocate(size_t size, size_t alignment) -> void* {
+    JF_ASSERT((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+    while (m_block_index < m_blocks.size()) {
+        Block&          block = m_blocks[m_block_index];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.m_data.get());
+        const uintptr_t next = (base + m_offset + alignment - 1) & ~(alignment - 1);
+        const size_t    aligned = next - base;
+        if (aligned + size <= block.m_size) {
+            m_offset = aligned + size;
+            return block.m_data.get() + aligned;
+        }
+        m_block_index++;
+        m_offset = 0;
+    }
+
+    // Every block so far is full, the next one is at least as large as all of them.
+    const size_t capacity = this->get_capacity();
+    const size_t block_size = std::max({m_block_size, capacity, size + alignment});
+    m_blocks.push_back(Block{
+        .m_data = std::make_unique_for_overwrite<u8[]>(block_size),
+        .m_size = block_size,
+    });
+    m_block_index = m_blocks.size() - 1;
+    m_offset = 0;
+    return this->allocate(size, alignment);
+}
+
+auto FrameArena::reset() -> void {
+    if (m_blocks.size() > 1) {
+        const size_t capacity = this->get_capacity();
+        m_blocks.clear();
+        m_blocks.push_back(Block{
+            .m_data = std::make_unique_for_overwrite<u8[]>(capacity),
+            .m_size = capacity,
+        });
+    }
+    m_block_index = 0;
+    m_offset = 0;
+}
+
+auto FrameArena::get_capacity() const -> size_t {
+    size_t result = 0;
+    for (const Block& block : m_blocks) { result += block.m_size; }
+    return result;
+}
+
+/*---------------------------
+    RenderQueue
+---------------------------*/
+
+auto radix_sort(std::span<RenderCommand> commands, RenderCommand* scratch) -> void {
+    constexpr u32 RADIX_BITS = 8;
+    constexpr u32 RADIX = 1U << RADIX_BITS;
+    constexpr u32 PASS_COUNT = 64 / RADIX_BITS;
+    if (commands.size() < 2) { return; }
+
+    std::array<std::array<u32, RADIX>, PASS_COUNT> counts = {};
+    for (const RenderCommand& command : commands) {
+        for (u32 pass = 0; pass < PASS_COUNT; pass++) {
+            counts[pass][(command.m_key >> (pass * RADIX_BITS)) & (RADIX - 1)]++;
+        }
+    }
+
+    const size_t   count = commands.size();
+    RenderCommand* src = commands.data();
+    RenderCommand* dst = scratch;
+    for (u32 pass = 0; pass < PASS_COUNT; pass++) {
+        std::array<u32, RADIX>& offsets = counts[pass];
+        const u32               shift = pass * RADIX_BITS;
+        // Every key has the same digit, the pass would not move anything.
+        if (offsets[(src[0].m_key >> shift) & (RADIX - 1)] == count) { continue; }
+
+        u32 sum = 0;
+        for (u32& offset : offsets) {
+            const u32 digit_count = offset;
+            offset = sum;
+            sum += digit_count;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[offsets[(src[i].m_key >> shift) & (RADIX - 1)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != commands.data()) {
+        std::memcpy(commands.data(), src, count * sizeof(RenderCommand));
+    }
+}
+
+auto count_instances(std::span<const RenderCommand> commands, u32 max_count) -> u32 {
+    if (commands.empty()) { return 0; }
+    const RenderCommand& first = commands[0];
+    const size_t         limit = std::min<size_t>(commands.size(), max_count);
+    u32                  count = 1;
+    while (count < limit) {
+        const RenderCommand& cmd = commands[count];
+        if (cmd.m_mesh != first.m_mesh || cmd.vertex_data != first.vertex_data ||
+            cmd.material != first.material || cmd.transform != first.transform + count) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+auto count_scene_instances(std::span<const RenderCommand> commands, u32 max_count)
+    -> u32 {
+    if (commands.empty()) { return 0; }
+    const RenderCommand& first = commands[0];
+    if (first.m_scene_id == RenderCommand::NO_SCENE_ID) { return 1; }
+    const size_t limit = std::min<size_t>(commands.size(), max_count);
+    u32          count = 1;
+    while (count < limit) {
+        const RenderCommand& cmd = commands[count];
+        if (cmd.m_mesh != first.m_mesh || cmd.vertex_data != first.vertex_data ||
+            cmd.material != first.material ||
+            cmd.m_scene_id != first.m_scene_id + count) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+static auto grow_array(FrameArena& arena, f32*& array, u32 count, u32 capacity) -> void {
+    auto* grown = arena.allocate_array<f32>(capacity);
+    if (count != 0) { std::memcpy(grown, array, count * sizeof(f32)); }
+    array = grown;
+}
+
+auto RenderQueue::push(
+    RenderCommand         command,
+    const mat4x4&         transform,
+    const BoundingSphere& bounds
+) -> void {
+    if (m_count == m_capacity) {
+        // Starts with the size of the last frame, so a steady workload never grows. The
+        // old arrays stay in the arena until `clear`.
+        const u32 capacity = std::max({m_capacity * 2, m_previous_count, 256U});
+        auto*     commands = m_arena.allocate_array<RenderCommand>(capacity);
+        if (m_count != 0) {
+            std::memcpy(commands, m_commands, m_count * sizeof(RenderCommand));
+        }
+        m_commands = commands;
+        grow_array(m_arena, m_bounds.m_x, m_count, capacity);
+        grow_array(m_arena, m_bounds.m_y, m_count, capacity);
+        grow_array(m_arena, m_bounds.m_z, m_count, capacity);
+        grow_array(m_arena, m_bounds.m_radius, m_count, capacity);
+        m_capacity = capacity;
+    }
+
+    auto* stored_transform = m_arena.allocate_array<mat4x4>(1);
+    *stored_transform = transform;
+    command.transform = stored_transform;
+
+    const BoundingSphere world = bounds.transformed(transform);
+    m_bounds.m_x[m_count] = world.m_center.x;
+    m_bounds.m_y[m_count] = world.m_center.y;
+    m_bounds.m_z[m_count] = world.m_center.z;
+    m_bounds.m_radius[m_count] = world.m_radius;
+    m_commands[m_count++] = command;
+    m_pushed_count++;
+}
+
+auto RenderQueue::cull(const Frustum& frustum, ThreadPool* pool) -> void {
+    if (m_count == 0) {
+        m_cull_stats = {};
+        return;
+    }
+
+    u8*       visible = m_arena.allocate_array<u8>(m_count);
+    const u32 visible_count = cull_spheres(frustum, m_bounds, m_count, visible, pool);
+
+    m_cull_stats = {.m_visible = visible_count, .m_culled = m_count - visible_count};
+    if (visible_count == m_count) { return; }
+    u32 kept = 0;
+    for (u32 i = 0; i < m_count; i++) {
+        if (visible[i] == 0) { continue; }
+        m_commands[kept] = m_commands[i];
+        m_bounds.m_x[kept] = m_bounds.m_x[i];
+        m_bounds.m_y[kept] = m_bounds.m_y[i];
+        m_bounds.m_z[kept] = m_bounds.m_z[i];
+        m_bounds.m_radius[kept] = m_bounds.m_radius[i];
+        kept++;
+    }
+    m_count = kept;
+}
+
+auto RenderQueue::append(
+    std::span<const RenderCommand> commands,
+    CullStats                      stats,
+    bool                           copy_transforms
+) -> void {
+    m_cull_stats.m_visible += stats.m_visible;
+    m_cull_stats.m_culled += stats.m_culled;
+    if (commands.empty()) { return; }
+
+    const auto count = static_cast<u32>(commands.size());
+    if (m_count + count > m_capacity) {
+        // The bounds are not needed anymore, only the commands grow.
+        auto* grown = m_arena.allocate_array<RenderCommand>(m_count + count);
+        if (m_count != 0) {
+            std::memcpy(grown, m_commands, m_count * sizeof(RenderCommand));
+        }
+        m_commands = grown;
+        m_capacity = m_count + count;
+        m_bounds = {};
+    }
+    std::memcpy(m_commands + m_count, commands.data(), count * sizeof(RenderCommand));
+    if (copy_transforms) {
+        // In order, so runs which were next to each other still are.
+        auto* transforms = m_arena.allocate_array<mat4x4>(count);
+        for (u32 i = 0; i < count; i++) {
+            transforms[i] = *commands[i].transform;
+            m_commands[m_count + i].transform = &transforms[i];
+            m_commands[m_count + i].m_scene_id = RenderCommand::NO_SCENE_ID;
+        }
+    }
+    m_count += count;
+}
+
+auto RenderQueue::sort(const Camera& camera) -> void {
+    if (m_count < 2) { return; }
+
+    const v3& forward = camera.m_orientation.m_forward;
+    const f32 near = camera.m_volume.m_near;
+    const f32 far = camera.m_volume.m_far;
+    const f32 scale = far != near ? 1.0F / (far - near) : 0.0F;
+    const f32 max_depth = static_cast<f32>((1U << sort_key::DEPTH_BITS) - 1);
+    for (u32 i = 0; i < m_count; i++) {
+        RenderCommand& command = m_commands[i];
+        const mat4x4&  transform = *command.transform;
+        const v3       position =
+            v3::create(transform.w_axis.x, transform.w_axis.y, transform.w_axis.z);
+        const f32 distance = (position - camera.m_position).dot(forward);
+        // Also maps NaN to the front.
+        f32 depth = (distance - near) * scale;
+        depth = depth > 0.0F ? std::min(depth, 1.0F) : 0.0F;
+        const auto quantized = static_cast<u32>(depth * max_depth);
+        command.m_key = sort_key::with_depth(command.m_key, quantized);
+    }
+
+    RenderCommand* scratch = m_arena.allocate_array<RenderCommand>(m_count);
+    radix_sort({m_commands, m_count}, scratch);
+
+    auto* transforms = m_arena.allocate_array<mat4x4>(m_count);
+    for (u32 i = 0; i < m_count; i++) {
+        transforms[i] = *m_commands[i].transform;
+        m_commands[i].transform = &transforms[i];
+    }
+}
+
+auto RenderQueue::clear() -> void {
+    m_previous_count = m_pushed_count;
+    m_commands = nullptr;
+    m_bounds = {};
+    m_count = 0;
+    m_pushed_count = 0;
+    m_capacity = 0;
+    m_arena.reset();
+}
+
+} // namespace JadeFrame
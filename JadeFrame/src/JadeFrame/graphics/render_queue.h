@@ -0,0 +1,196 @@
+#pragma once
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/mat_4.h"
+#include "culling.h"
+
+namespace JadeFrame {
+class Camera;
+class ThreadPool;
+class Mesh;
+class GPUMeshData;
+struct MaterialHandle;
+
+/*
+    Bump allocator for data which only lives for one frame, `reset` frees all of it at
+   once. Memory is taken from blocks. If a frame needed more than one block, they are
+   merged into one on `reset`, so a steady workload stops allocating after a few frames.
+*/
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    FrameArena() = default;
+    ~FrameArena() = default;
+    FrameArena(const FrameArena&) = delete;
+    auto operator=(const FrameArena&) -> FrameArena& = delete;
+    FrameArena(FrameArena&&) noexcept = default;
+    auto operator=(FrameArena&&) noexcept -> FrameArena& = default;
+
+    explicit FrameArena(size_t block_size);
+
+    /// The memory is not initialized and stays valid until the next `reset`.
+    auto allocate(size_t size, size_t alignment) -> void*;
+
+    template<typename T>
+    auto allocate_array(size_t count) -> T* {
+        static_assert(std::is_trivially_destructible_v<T>, "no destructors are run");
+        return static_cast<T*>(this->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    auto reset() -> void;
+
+    [[nodiscard]] auto get_block_count() const -> size_t { return m_blocks.size(); }
+
+    [[nodiscard]] auto get_capacity() const -> size_t;
+
+private:
+    struct Block {
+        std::unique_ptr<u8[]> m_data;
+        size_t                m_size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t             m_block_size = DEFAULT_BLOCK_SIZE;
+    size_t             m_block_index = 0;
+    size_t             m_offset = 0;
+};
+
+/*
+    Draws are ordered by a 64 bit key. From the most significant bits: pass, pipeline,
+   material, mesh and depth. The renderers only change state where the key changes, so
+   the state which is the most expensive to change is in the highest bits.
+    Ids which do not fit their bits wrap around. That only costs batching, the renderers
+   compare the handles themselves before skipping a state change.
+*/
+namespace sort_key {
+constexpr u32 PASS_BITS = 4;
+constexpr u32 PIPELINE_BITS = 12;
+constexpr u32 MATERIAL_BITS = 16;
+constexpr u32 MESH_BITS = 16;
+constexpr u32 DEPTH_BITS = 16;
+
+constexpr u32 DEPTH_SHIFT = 0;
+constexpr u32 MESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+constexpr u32 MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+constexpr u32 PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+constexpr u32 PASS_SHIFT = PIPELINE_SHIFT + PIPELINE_BITS;
+static_assert(PASS_SHIFT + PASS_BITS == 64);
+
+constexpr auto field(u64 value, u32 bits, u32 shift) -> u64 {
+    return (value & ((u64{1} << bits) - 1)) << shift;
+}
+
+constexpr auto create(u32 pass, u32 pipeline, u32 material, u32 mesh, u32 depth) -> u64 {
+    return field(pass, PASS_BITS, PASS_SHIFT) |
+           field(pipeline, PIPELINE_BITS, PIPELINE_SHIFT) |
+           field(material, MATERIAL_BITS, MATERIAL_SHIFT) |
+           field(mesh, MESH_BITS, MESH_SHIFT) | field(depth, DEPTH_BITS, DEPTH_SHIFT);
+}
+
+constexpr auto with_depth(u64 key, u32 depth) -> u64 {
+    const u64 mask = ((u64{1} << DEPTH_BITS) - 1) << DEPTH_SHIFT;
+    return (key & ~mask) | field(depth, DEPTH_BITS, DEPTH_SHIFT);
+}
+} // namespace sort_key
+
+struct RenderCommand {
+    constexpr static u32 NO_SCENE_ID = ~0U;
+
+    u64             m_key = 0;
+    const mat4x4*   transform = nullptr;
+    Mesh*           vertex_data = nullptr;
+    MaterialHandle* material = nullptr;
+    GPUMeshData*    m_mesh = nullptr;
+    /// The id of the item in the `RenderScene`, whose matrix renderers may keep on the
+    /// GPU. `NO_SCENE_ID` for the submitted commands.
+    u32             m_scene_id = NO_SCENE_ID;
+};
+
+/// Stable LSD radix sort by `m_key`. `scratch` must hold as many commands. Bytes in which
+/// all keys agree are skipped, which with few pipelines and materials is most of them.
+auto radix_sort(std::span<RenderCommand> commands, RenderCommand* scratch) -> void;
+
+/// Counts how many commands from the start of `commands` draw the same mesh with the same
+/// material and have their transforms next to each other, at most `max_count`. The
+/// renderers draw such a run as one instanced draw.
+auto count_instances(std::span<const RenderCommand> commands, u32 max_count) -> u32;
+/// Like `count_instances`, but the commands have to have consecutive scene ids instead.
+/// Renderers which keep the matrices of the scene by id draw such a run as one.
+auto count_scene_instances(std::span<const RenderCommand> commands, u32 max_count)
+    -> u32;
+
+/*
+    The draws submitted for one frame. The commands and their transforms live in a
+   `FrameArena`, so submitting allocates nothing once the arena has grown to the size of a
+   frame. The renderers call `cull` and `sort` before walking the commands and `clear`
+   after.
+*/
+class RenderQueue {
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+    RenderQueue(const RenderQueue&) = delete;
+    auto operator=(const RenderQueue&) -> RenderQueue& = delete;
+    RenderQueue(RenderQueue&&) = delete;
+    auto operator=(RenderQueue&&) -> RenderQueue& = delete;
+
+    /// Copies the transform into the arena and points the command to it. `bounds` is in
+    /// the local space of the mesh.
+    auto push(
+        RenderCommand         command,
+        const mat4x4&         transform,
+        const BoundingSphere& bounds = BoundingSphere::infinite()
+    ) -> void;
+    /// Removes the commands whose bounds are outside `frustum`, keeping the order of the
+    /// rest. Large queues are split across `pool` if one is given. Has to be called
+    /// before `sort`, which does not reorder the bounds.
+    auto cull(const Frustum& frustum, ThreadPool* pool = nullptr) -> void;
+    /// Fills in the depth of every key, front to back as seen from `camera`, and sorts.
+    /// Afterwards the transforms are stored in the order of the commands, so the
+    /// transforms of a run of commands can be uploaded with one copy.
+    auto sort(const Camera& camera) -> void;
+    /// Adds commands which are already culled and sorted, e.g. the visible items of a
+    /// `RenderScene`, after the sorted ones. Their transforms are only copied with
+    /// `copy_transforms`, otherwise they have to stay valid until the frame is drawn.
+    /// Copied commands lose their scene id, as the scene may change meanwhile. Has to be
+    /// called after `sort`.
+    auto append(
+        std::span<const RenderCommand> commands,
+        CullStats                      stats,
+        bool                           copy_transforms = false
+    ) -> void;
+    auto clear() -> void;
+
+    [[nodiscard]] auto get_commands() const -> std::span<const RenderCommand> {
+        return {m_commands, m_count};
+    }
+
+    [[nodiscard]] auto size() const -> size_t { return m_count; }
+
+    [[nodiscard]] auto empty() const -> bool { return m_count == 0; }
+
+    /// The result of the last `cull`. Stays valid after `clear`, so it can be shown after
+    /// the frame.
+    [[nodiscard]] auto get_cull_stats() const -> const CullStats& { return m_cull_stats; }
+
+public:
+    FrameArena m_arena;
+
+private:
+    RenderCommand* m_commands = nullptr;
+    /// The world space bounds of the commands, parallel to `m_commands`.
+    SphereArrays   m_bounds;
+    CullStats      m_cull_stats;
+    u32            m_count = 0;
+    /// Including the culled commands, the next frame starts with this capacity.
+    u32            m_pushed_count = 0;
+    u32            m_capacity = 0;
+    u32            m_previous_count = 0;
+};
+
+} // namespace JadeFrame
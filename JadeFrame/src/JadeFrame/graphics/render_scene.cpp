@@ -0,0 +1,195 @@
+#include "render_scene.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "graphics_shared.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+auto RenderScene::add(const Object& obj) -> Id {
+    Id id = INVALID;
+    if (!m_free_ids.empty()) {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+    } else {
+        id = static_cast<Id>(m_indices.size());
+        m_indices.push_back(INVALID);
+        m_is_dirty.push_back(0);
+    }
+
+    // Appended unsorted, `update` moves it to its place.
+    const auto index = static_cast<u32>(m_commands.size());
+    m_indices[id] = index;
+    m_commands.push_back(obj.get_render_command());
+    m_commands.back().m_scene_id = id;
+    m_local_bounds.push_back(obj.get_bounds());
+    m_ids.push_back(id);
+    m_transforms.create(obj.m_transform);
+    m_bounds_x.push_back(0.0F);
+    m_bounds_y.push_back(0.0F);
+    m_bounds_z.push_back(0.0F);
+    m_bounds_radius.push_back(0.0F);
+    m_is_changed.push_back(1);
+    m_changed.push_back(index);
+    this->mark_dirty(id);
+    m_count++;
+    m_is_sorted = false;
+    return id;
+}
+
+auto RenderScene::remove(Id id) -> void {
+    JF_ASSERT(id < m_indices.size() && m_indices[id] != INVALID, "invalid draw item id");
+    m_ids[m_indices[id]] = INVALID;
+    m_indices[id] = INVALID;
+    m_free_ids.push_back(id);
+    m_count--;
+    m_is_sorted = false;
+}
+
+auto RenderScene::set_transform(Id id, const Transform& transform) -> void {
+    JF_ASSERT(id < m_indices.size() && m_indices[id] != INVALID, "invalid draw item id");
+    const u32 index = m_indices[id];
+    m_transforms.set(index, transform);
+    if (m_is_changed[index] == 0) {
+        m_is_changed[index] = 1;
+        m_changed.push_back(index);
+    }
+    this->mark_dirty(id);
+}
+
+auto RenderScene::set_material(Id id, MaterialHandle* material) -> void {
+    JF_ASSERT(id < m_indices.size() && m_indices[id] != INVALID, "invalid draw item id");
+    RenderCommand& command = m_commands[m_indices[id]];
+    Object         obj;
+    obj.m_mesh = command.m_mesh;
+    obj.m_vertex_data = command.vertex_data;
+    obj.m_material = material;
+    command = obj.get_render_command();
+    command.m_scene_id = id;
+    m_is_sorted = false;
+}
+
+auto RenderScene::get_transform(Id id) const -> Transform {
+    JF_ASSERT(id < m_indices.size() && m_indices[id] != INVALID, "invalid draw item id");
+    return m_transforms.get(m_indices[id]);
+}
+
+auto RenderScene::get_world(Id id) const -> const mat4x4& {
+    JF_ASSERT(this->contains(id), "invalid draw item id");
+    return m_transforms.get_world(m_indices[id]);
+}
+
+auto RenderScene::update() -> void {
+    // Sorted, so runs of ids added together become one range.
+    m_dirty_ranges.clear();
+    std::sort(m_dirty_ids.begin(), m_dirty_ids.end());
+    for (const Id id : m_dirty_ids) {
+        m_is_dirty[id] = 0;
+        if (!m_dirty_ranges.empty()) {
+            IdRange& last = m_dirty_ranges.back();
+            if (last.m_first + last.m_count == id) {
+                last.m_count++;
+                continue;
+            }
+        }
+        m_dirty_ranges.push_back({.m_first = id, .m_count = 1});
+    }
+    m_dirty_ids.clear();
+
+    if (!m_is_sorted) { this->sort(); }
+    if (m_changed.empty()) { return; }
+
+    m_transforms.update();
+    for (const u32 index : m_changed) {
+        this->update_bounds(index);
+        m_is_changed[index] = 0;
+    }
+    m_changed.clear();
+}
+
+auto RenderScene::cull(const Frustum& frustum, ThreadPool* pool)
+    -> std::span<const RenderCommand> {
+    JF_ASSERT(m_is_sorted && m_changed.empty(), "the scene was changed after `update`");
+    m_visible_commands.clear();
+    if (m_count == 0) {
+        m_cull_stats = {};
+        return {};
+    }
+
+    m_visible.resize(m_count);
+    const SphereArrays spheres = {
+        .m_x = m_bounds_x.data(),
+        .m_y = m_bounds_y.data(),
+        .m_z = m_bounds_z.data(),
+        .m_radius = m_bounds_radius.data(),
+    };
+    const u32 visible_count =
+        cull_spheres(frustum, spheres, m_count, m_visible.data(), pool);
+    m_cull_stats = {.m_visible = visible_count, .m_culled = m_count - visible_count};
+
+    m_visible_commands.reserve(visible_count);
+    for (u32 i = 0; i < m_count; i++) {
+        if (m_visible[i] != 0) { m_visible_commands.push_back(m_commands[i]); }
+    }
+    return m_visible_commands;
+}
+
+auto RenderScene::sort() -> void {
+    // Only the live items, by key. Items with the same key keep the order they were added
+    // in, so a frame does not reshuffle instances which did not change.
+    std::vector<u32> order(m_commands.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::erase_if(order, [&](u32 index) { return m_ids[index] == INVALID; });
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        return m_commands[a].m_key < m_commands[b].m_key;
+    });
+
+    std::vector<RenderCommand>  commands(order.size());
+    std::vector<BoundingSphere> local_bounds(order.size());
+    std::vector<Id>             ids(order.size());
+    TransformPool               transforms;
+    for (u32 i = 0; i < order.size(); i++) {
+        const u32 index = order[i];
+        commands[i] = m_commands[index];
+        local_bounds[i] = m_local_bounds[index];
+        ids[i] = m_ids[index];
+        transforms.create(m_transforms.get(index));
+        m_indices[ids[i]] = i;
+    }
+    m_commands = std::move(commands);
+    m_local_bounds = std::move(local_bounds);
+    m_ids = std::move(ids);
+    m_transforms = std::move(transforms);
+
+    // Every matrix moved, so they are all composed again. The commands point to them
+    // after the next `update`.
+    m_bounds_x.resize(m_count);
+    m_bounds_y.resize(m_count);
+    m_bounds_z.resize(m_count);
+    m_bounds_radius.resize(m_count);
+    m_is_changed.assign(m_count, 1);
+    m_changed.resize(m_count);
+    std::iota(m_changed.begin(), m_changed.end(), 0U);
+    m_is_sorted = true;
+}
+
+auto RenderScene::mark_dirty(Id id) -> void {
+    if (m_is_dirty[id] != 0) { return; }
+    m_is_dirty[id] = 1;
+    m_dirty_ids.push_back(id);
+}
+
+auto RenderScene::update_bounds(u32 index) -> void {
+    const mat4x4& world = m_transforms.get_world(index);
+    m_commands[index].transform = &world;
+
+    const BoundingSphere bounds = m_local_bounds[index].transformed(world);
+    m_bounds_x[index] = bounds.m_center.x;
+    m_bounds_y[index] = bounds.m_center.y;
+    m_bounds_z[index] = bounds.m_center.z;
+    m_bounds_radius[index] = bounds.m_radius;
+}
+
+} // namespace JadeFrame
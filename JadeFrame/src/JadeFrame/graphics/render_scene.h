@@ -0,0 +1,125 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "culling.h"
+#include "render_queue.h"
+#include "transform.h"
+
+namespace JadeFrame {
+class Object;
+class ThreadPool;
+struct MaterialHandle;
+
+/*
+    Draw items which live longer than a frame. An item is added once and afterwards only
+   touched when its transform or material changes, instead of being submitted every frame.
+    The items are kept sorted by their sort key, and their world matrices are stored in
+   that order, so runs of the same mesh and material are instanced without copying any
+   matrix. The order is only rebuilt after an item was added or removed or its material
+   changed. The matrices and world bounds are only recomputed for the items whose transform
+   changed.
+    Every frame `update` has to be called before drawing. The renderers `cull` the scene
+   and append the visible items to the `RenderQueue`. Renderers which keep the matrices on
+   the GPU store them by id, which sorting does not change, and only upload the ranges of
+   ids whose transform was set.
+*/
+class RenderScene {
+public:
+    using Id = u32;
+    constexpr static Id INVALID = ~Id{0};
+    static_assert(INVALID == RenderCommand::NO_SCENE_ID);
+
+    /// The ids `[m_first, m_first + m_count)`.
+    struct IdRange {
+        Id  m_first = 0;
+        u32 m_count = 0;
+    };
+
+    RenderScene() = default;
+    ~RenderScene() = default;
+    RenderScene(const RenderScene&) = delete;
+    auto operator=(const RenderScene&) -> RenderScene& = delete;
+    RenderScene(RenderScene&&) noexcept = default;
+    auto operator=(RenderScene&&) noexcept -> RenderScene& = default;
+
+    /// `obj.m_transform` is the initial transform, `obj.m_transform_id` is ignored. The
+    /// mesh and material have to outlive the item.
+    auto add(const Object& obj) -> Id;
+    auto remove(Id id) -> void;
+    auto set_transform(Id id, const Transform& transform) -> void;
+    auto set_material(Id id, MaterialHandle* material) -> void;
+    [[nodiscard]] auto get_transform(Id id) const -> Transform;
+
+    /// Sorts the items if needed and recomputes the changed matrices and bounds.
+    auto update() -> void;
+    /// The visible items in sorted order. Their transforms point into the scene and stay
+    /// valid until the next `update`. Large scenes are split across `pool` if one is
+    /// given.
+    auto cull(const Frustum& frustum, ThreadPool* pool = nullptr)
+        -> std::span<const RenderCommand>;
+
+    /// The result of the last `cull`.
+    [[nodiscard]] auto get_cull_stats() const -> CullStats { return m_cull_stats; }
+
+    [[nodiscard]] auto size() const -> u32 { return m_count; }
+
+    /// All ids are below this, including those of removed items.
+    [[nodiscard]] auto get_id_count() const -> u32 {
+        return static_cast<u32>(m_indices.size());
+    }
+
+    [[nodiscard]] auto contains(Id id) const -> bool {
+        return id < m_indices.size() && m_indices[id] != INVALID;
+    }
+
+    /// Valid after `update`.
+    [[nodiscard]] auto get_world(Id id) const -> const mat4x4&;
+    /// The ids which were added or had their transform set before the last `update`, in
+    /// ascending order. Some may have been removed since.
+    [[nodiscard]] auto get_dirty_ranges() const -> std::span<const IdRange> {
+        return m_dirty_ranges;
+    }
+
+private:
+    auto sort() -> void;
+    auto update_bounds(u32 index) -> void;
+    auto mark_dirty(Id id) -> void;
+
+private:
+    /// The items, in sorted order once `m_is_sorted`. Removed items stay until the next
+    /// `sort` with their id set to `INVALID`.
+    std::vector<RenderCommand>  m_commands;
+    std::vector<BoundingSphere> m_local_bounds;
+    std::vector<Id>             m_ids;
+    /// Indexed like the items.
+    TransformPool               m_transforms;
+    /// The world space bounds, one array per component, indexed like the items.
+    std::vector<f32>            m_bounds_x;
+    std::vector<f32>            m_bounds_y;
+    std::vector<f32>            m_bounds_z;
+    std::vector<f32>            m_bounds_radius;
+
+    /// The index of the item of every id, `INVALID` for ids which are free.
+    std::vector<u32> m_indices;
+    std::vector<Id>  m_free_ids;
+    /// Items whose transform was set since the last `update`.
+    std::vector<u32> m_changed;
+    std::vector<u8>  m_is_changed;
+
+    /// Ids whose transform was set since the last `update`. Unlike `m_changed`, `sort`
+    /// does not add to them.
+    std::vector<Id>      m_dirty_ids;
+    std::vector<u8>      m_is_dirty;
+    /// Those of the last `update`, see `get_dirty_ranges`.
+    std::vector<IdRange> m_dirty_ranges;
+
+    std::vector<u8>            m_visible;
+    std::vector<RenderCommand> m_visible_commands;
+    CullStats                  m_cull_stats;
+    u32                        m_count = 0;
+    bool                       m_is_sorted = true;
+};
+
+} // namespace JadeFrame
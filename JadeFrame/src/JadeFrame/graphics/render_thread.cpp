@@ -0,0 +1,51 @@
+#include "render_thread.h"
+
+#include "graphics_shared.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+RenderThread::RenderThread(RenderSystem& system)
+    : m_system(&system)
+    , m_thread([this]() -> void { this->run(); }) {}
+
+RenderThread::~RenderThread() {
+    JF_ASSERT(m_packet == nullptr, "the last frame was not ended");
+    m_packets.close();
+    m_thread.join();
+    m_system->m_submit_queue = &m_system->m_render_queue;
+}
+
+auto RenderThread::begin_frame() -> void {
+    JF_ASSERT(m_packet == nullptr, "the previous frame was not ended");
+    // The renderer cleared the queue after drawing it.
+    m_packet = &m_packets.begin_write();
+    m_system->m_submit_queue = &m_packet->m_render_queue;
+}
+
+auto RenderThread::end_frame(const Camera& camera) -> CullStats {
+    JF_ASSERT(m_packet != nullptr, "the frame was not begun");
+    m_packet->m_camera = camera;
+    m_system->prepare_queue(m_packet->m_render_queue, camera, nullptr, true);
+    const CullStats stats = m_packet->m_render_queue.get_cull_stats();
+
+    // Submitting is only valid between `begin_frame` and `end_frame`.
+    m_system->m_submit_queue = &m_system->m_render_queue;
+    m_packet = nullptr;
+    m_packets.end_write();
+    return stats;
+}
+
+auto RenderThread::run() -> void {
+    IRenderer* renderer = m_system->m_renderer.get();
+    while (FramePacket* packet = m_packets.begin_read()) {
+        m_system->m_prepared_queue = &packet->m_render_queue;
+        renderer->clear_background();
+        renderer->render(packet->m_camera);
+        renderer->present();
+        m_packets.end_read();
+    }
+    m_system->m_prepared_queue = nullptr;
+}
+
+} // namespace JadeFrame
@@ -0,0 +1,58 @@
+#pragma once
+#include <thread>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/utils/frame_ring.h"
+#include "camera.h"
+#include "render_queue.h"
+
+namespace JadeFrame {
+class RenderSystem;
+
+/// Everything the render thread needs to draw one frame.
+struct FramePacket {
+    RenderQueue m_render_queue;
+    Camera      m_camera;
+};
+
+/*
+    Runs `render` and `present` of the renderer on a thread of its own, while the thread
+   which owns the `RenderThread` builds the next frame. The frames are handed over in
+   `FramePacket`s through a `FrameRing`, so the builder is at most two frames ahead.
+    The builder prepares the queue of a packet before handing it over, which copies the
+   transforms of the visible scene items into it. So the render thread never reads
+   `RenderSystem::m_scene` or `m_transforms`, which are updated for the next frame
+   meanwhile.
+    Resources may not be registered or released while it runs, the render thread uses the
+   device at the same time.
+*/
+class RenderThread {
+public:
+    constexpr static u32 PACKET_COUNT = 3;
+
+    explicit RenderThread(RenderSystem& system);
+    /// Draws the frames handed over so far, then joins the thread.
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    auto operator=(const RenderThread&) -> RenderThread& = delete;
+    RenderThread(RenderThread&&) = delete;
+    auto operator=(RenderThread&&) -> RenderThread& = delete;
+
+    /// Points `RenderSystem::submit` to the packet of the next frame. Waits while the
+    /// render thread has not finished with it.
+    auto begin_frame() -> void;
+    /// Prepares the packet for `camera` and hands it to the render thread. Returns the
+    /// culling result of the frame.
+    auto end_frame(const Camera& camera) -> CullStats;
+
+private:
+    auto run() -> void;
+
+private:
+    RenderSystem*                        m_system = nullptr;
+    FrameRing<FramePacket, PACKET_COUNT> m_packets;
+    FramePacket*                         m_packet = nullptr;
+    std::thread                          m_thread;
+};
+
+} // namespace JadeFrame
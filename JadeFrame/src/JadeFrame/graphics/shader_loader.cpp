@@ -124,12 +124,15 @@ layout(std140, set = 0, binding = 0) uniform Camera {
     mat4 view_projection;
 } u_camera;
 
+// One model matrix per instance, the renderers draw runs of the same mesh and material
+// as one instanced draw.
 layout(std140, set = 3, binding = 0) uniform Transform {
-	mat4 model;
+	mat4 model[256];
 } u_transform;
 
 void main() {
-	gl_Position = u_camera.view_projection * u_transform.model * vec4(v_position, 1.0);
+	mat4 model = u_transform.model[gl_InstanceIndex];
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
 
 	f_color = v_color;
 }
@@ -264,15 +267,18 @@ layout(std140, set = 0, binding = 0) uniform Camera {
     mat4 view_projection;
 } u_camera;
 
+// One model matrix per instance, the renderers draw runs of the same mesh and material
+// as one instanced draw.
 layout(std140, set = 3, binding = 0) uniform Transform {
-	mat4 model;
+	mat4 model[256];
 } u_transform;
 
 void main() {
 	f_color = v_color;
 	f_texture_coord = v_texture_coord;
-	// vec3 fragment_position = vec3(u_transform.model * vec4(v_position, 1.0));
-	gl_Position = u_camera.view_projection * u_transform.model * vec4(v_position, 1.0);
+	mat4 model = u_transform.model[gl_InstanceIndex];
+	// vec3 fragment_position = vec3(model * vec4(v_position, 1.0));
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
 }
 	)";
     const char* fragment_shader =
@@ -304,6 +310,202 @@ void main() {
     return std::make_tuple(std::string(vertex_shader), std::string(fragment_shader));
 }
 
+/*
+    The variants for indirect drawing. The model matrices of all draws are in one storage
+   buffer, indexed by the instance index, which starts at the first instance of the draw.
+    The fragment shaders are the same.
+*/
+static auto get_shader_flat_indirect() -> std::tuple<std::string, std::string> {
+    static const char* vertex_shader =
+        R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 v_position;
+layout(location = 1) in vec4 v_color;
+
+layout(location = 0) out vec4 f_color;
+
+layout(std140, set = 0, binding = 0) uniform Camera {
+    mat4 view_projection;
+} u_camera;
+
+layout(std430, set = 3, binding = 0) readonly buffer Transform {
+	mat4 model[];
+} u_transform;
+
+void main() {
+	mat4 model = u_transform.model[gl_InstanceIndex];
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
+
+	f_color = v_color;
+}
+)";
+
+    auto [vs, fs] = get_shader_spirv_test_1();
+    return std::make_tuple(std::string(vertex_shader), std::move(fs));
+}
+
+static auto get_shader_with_texture_indirect() -> std::tuple<std::string, std::string> {
+    static const char* vertex_shader =
+        R"(
+#version 450 core
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec4 v_color;
+layout (location = 2) in vec2 v_texture_coord;
+
+layout(location = 0) out vec4 f_color;
+layout(location = 1) out vec2 f_texture_coord;
+
+layout(std140, set = 0, binding = 0) uniform Camera {
+    mat4 view_projection;
+} u_camera;
+
+layout(std430, set = 3, binding = 0) readonly buffer Transform {
+	mat4 model[];
+} u_transform;
+
+void main() {
+	f_color = v_color;
+	f_texture_coord = v_texture_coord;
+	mat4 model = u_transform.model[gl_InstanceIndex];
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
+}
+	)";
+
+    auto [vs, fs] = get_default_shader_with_texture();
+    return std::make_tuple(std::string(vertex_shader), std::move(fs));
+}
+
+/*
+    The variants which get the model matrix as push constant, only for Vulkan. A single
+   draw only pushes it, so it neither writes the ring of the renderer nor binds its per
+   object set again. Instanced runs do not fit, they keep the uniform buffer, only their
+   first instance is pushed.
+    The fragment shaders are the same.
+*/
+static auto get_shader_flat_push() -> std::tuple<std::string, std::string> {
+    static const char* vertex_shader =
+        R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 v_position;
+layout(location = 1) in vec4 v_color;
+
+layout(location = 0) out vec4 f_color;
+
+layout(std140, set = 0, binding = 0) uniform Camera {
+    mat4 view_projection;
+} u_camera;
+
+layout(std140, set = 3, binding = 0) uniform Transform {
+	mat4 model[256];
+} u_transform;
+
+layout(push_constant) uniform Object {
+	mat4 model;
+} u_object;
+
+void main() {
+	mat4 model = u_object.model;
+	if (gl_InstanceIndex != 0) { model = u_transform.model[gl_InstanceIndex]; }
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
+
+	f_color = v_color;
+}
+)";
+
+    auto [vs, fs] = get_shader_spirv_test_1();
+    return std::make_tuple(std::string(vertex_shader), std::move(fs));
+}
+
+static auto get_shader_with_texture_push() -> std::tuple<std::string, std::string> {
+    static const char* vertex_shader =
+        R"(
+#version 450 core
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec4 v_color;
+layout (location = 2) in vec2 v_texture_coord;
+
+layout(location = 0) out vec4 f_color;
+layout(location = 1) out vec2 f_texture_coord;
+
+layout(std140, set = 0, binding = 0) uniform Camera {
+    mat4 view_projection;
+} u_camera;
+
+layout(std140, set = 3, binding = 0) uniform Transform {
+	mat4 model[256];
+} u_transform;
+
+layout(push_constant) uniform Object {
+	mat4 model;
+} u_object;
+
+void main() {
+	f_color = v_color;
+	f_texture_coord = v_texture_coord;
+	mat4 model = u_object.model;
+	if (gl_InstanceIndex != 0) { model = u_transform.model[gl_InstanceIndex]; }
+	gl_Position = u_camera.view_projection * model * vec4(v_position, 1.0);
+}
+	)";
+
+    auto [vs, fs] = get_default_shader_with_texture();
+    return std::make_tuple(std::string(vertex_shader), std::move(fs));
+}
+
+/*
+    The variant for `BindlessTextures`, only for Vulkan with descriptor indexing. The
+   texture is looked up in the array of all of them, with the index in the parameters of
+   the material, which the renderer pushes for each material.
+    The vertex shader is the one which pushes the transforms.
+*/
+static auto get_shader_with_texture_bindless() -> std::tuple<std::string, std::string> {
+    static const char* fragment_shader =
+        R"(
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec4 f_color;
+layout(location = 1) in vec2 f_texture_coord;
+
+layout(location = 0) out vec4 o_color;
+
+struct MaterialParams {
+	uint texture;
+};
+
+layout(std430, set = 2, binding = 0) readonly buffer Materials {
+	MaterialParams params[];
+} u_materials;
+layout(set = 2, binding = 1) uniform sampler2D u_textures[];
+
+// After the model matrix of the vertex shader.
+layout(push_constant) uniform Draw {
+	layout(offset = 64) uint material;
+} u_draw;
+
+void main() {
+    if(!gl_FrontFacing) {
+        o_color = vec4(1.0, 0.412, 0.7, 1.0);
+        return;
+    }
+	// The same for the whole draw, so it needs no `nonuniformEXT`.
+	uint texture_index = u_materials.params[u_draw.material].texture;
+	o_color = texture(u_textures[texture_index], f_texture_coord);
+}
+)";
+
+    auto [vs, fs] = get_shader_with_texture_push();
+    return std::make_tuple(std::move(vs), std::string(fragment_shader));
+}
+
 static auto get_default_shader_depth_testing() -> std::tuple<std::string, std::string> {
     const char* vertex_shader =
         R"(
@@ -445,14 +647,19 @@ auto GLSLCodeLoader::get_by_name(const std::string& name) -> ShadingCode {
     // using ShaderGetter = std::function<std::tuple<std::string, std::string>()>;
     using ShaderGetterFn = std::tuple<std::string, std::string> (*)();
     static const std::unordered_map<std::string, ShaderGetterFn> shader_map = {
-        {          "flat_0",          &get_shader_spirv_test_1},
-        {  "with_texture_0",  &get_default_shader_with_texture},
-        {    "spirv_test_1",          &get_shader_spirv_test_1},
-        { "depth_testing_0", &get_default_shader_depth_testing},
-        {    "light_server",  &get_default_shader_light_server},
-        {    "light_client",  &get_default_shader_light_client},
-        {    "spirv_test_0",          &get_shader_spirv_test_0},
-        {"framebuffer_test",    &get_shader_framebuffer_test_0}
+        {                  "flat_0",          &get_shader_spirv_test_1},
+        {          "with_texture_0",  &get_default_shader_with_texture},
+        {         "flat_indirect_0",         &get_shader_flat_indirect},
+        { "with_texture_indirect_0", &get_shader_with_texture_indirect},
+        {             "flat_push_0",             &get_shader_flat_push},
+        {     "with_texture_push_0",     &get_shader_with_texture_push},
+        { "with_texture_bindless_0", &get_shader_with_texture_bindless},
+        {            "spirv_test_1",          &get_shader_spirv_test_1},
+        {         "depth_testing_0", &get_default_shader_depth_testing},
+        {            "light_server",  &get_default_shader_light_server},
+        {            "light_client",  &get_default_shader_light_client},
+        {            "spirv_test_0",          &get_shader_spirv_test_0},
+        {        "framebuffer_test",    &get_shader_framebuffer_test_0}
     };
 
     auto it = shader_map.find(name);
@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/vec.h"
+
+namespace JadeFrame {
+namespace software {
+
+/*
+    Colors are stored as 0xAARRGGBB. On little endian machines this is BGRA in memory,
+   which is what X11 TrueColor visuals expect, so presenting is a plain copy.
+*/
+inline auto pack_color(f32 r, f32 g, f32 b, f32 a) -> u32 {
+    auto to_u8 = [](f32 v) -> u32 {
+        return static_cast<u32>(std::clamp(v, 0.0F, 1.0F) * 255.0F + 0.5F);
+    };
+    return (to_u8(a) << 24) | (to_u8(r) << 16) | (to_u8(g) << 8) | to_u8(b);
+}
+
+inline auto pack_color(const v4& color) -> u32 {
+    return pack_color(color.x, color.y, color.z, color.w);
+}
+
+inline auto unpack_color(u32 color) -> v4 {
+    constexpr f32 SCALE = 1.0F / 255.0F;
+    return v4::create(
+        static_cast<f32>((color >> 16) & 0xFF) * SCALE,
+        static_cast<f32>((color >> 8) & 0xFF) * SCALE,
+        static_cast<f32>((color >> 0) & 0xFF) * SCALE,
+        static_cast<f32>((color >> 24) & 0xFF) * SCALE
+    );
+}
+
+/// Depth range of one `Framebuffer::COARSE_SIZE` square block of the depth buffer.
+struct DepthBounds {
+    f32 m_min = 1.0F;
+    f32 m_max = 1.0F;
+};
+
+/*
+    Color and depth target of the software rasterizer. Row 0 is the top of the image.
+    Next to the full resolution depth there is a coarse level with the depth range of
+   every 8x8 block. The bounds are conservative, `m_min` is never above and `m_max` never
+   below any depth in the block. Whatever writes `m_depth` has to keep it that way.
+*/
+class Framebuffer {
+public:
+    constexpr static u32 COARSE_SIZE = 8;
+
+    Framebuffer() = default;
+
+    Framebuffer(u32 width, u32 height) { this->resize(width, height); }
+
+    auto resize(u32 width, u32 height) -> void {
+        m_width = width;
+        m_height = height;
+        m_color.assign(static_cast<size_t>(width) * height, 0);
+        m_depth.assign(static_cast<size_t>(width) * height, 1.0F);
+        m_coarse_width = (width + COARSE_SIZE - 1) / COARSE_SIZE;
+        m_coarse_height = (height + COARSE_SIZE - 1) / COARSE_SIZE;
+        m_coarse_depth.assign(static_cast<size_t>(m_coarse_width) * m_coarse_height, {});
+    }
+
+    /// Clears the half-open rectangle [x0, x1) x [y0, y1).
+    auto clear_rect(u32 x0, u32 y0, u32 x1, u32 y1, u32 color, f32 depth) -> void {
+        if (x0 >= x1 || y0 >= y1) { return; }
+        for (u32 y = y0; y < y1; y++) {
+            const size_t row = static_cast<size_t>(y) * m_width;
+            std::fill(&m_color[row + x0], &m_color[row + x1], color);
+            std::fill(&m_depth[row + x0], &m_depth[row + x1], depth);
+        }
+
+        // Blocks only partly inside the rectangle keep the depth they had as well.
+        for (u32 by = y0 / COARSE_SIZE; by * COARSE_SIZE < y1; by++) {
+            for (u32 bx = x0 / COARSE_SIZE; bx * COARSE_SIZE < x1; bx++) {
+                DepthBounds& bounds = m_coarse_depth[by * m_coarse_width + bx];
+                const u32    end_x = std::min((bx + 1) * COARSE_SIZE, m_width);
+                const u32    end_y = std::min((by + 1) * COARSE_SIZE, m_height);
+                const bool   is_inside = bx * COARSE_SIZE >= x0 && end_x <= x1 &&
+                                       by * COARSE_SIZE >= y0 && end_y <= y1;
+                if (is_inside) {
+                    bounds = {depth, depth};
+                } else {
+                    bounds.m_min = std::min(bounds.m_min, depth);
+                    bounds.m_max = std::max(bounds.m_max, depth);
+                }
+            }
+        }
+    }
+
+public:
+    u32              m_width = 0;
+    u32              m_height = 0;
+    std::vector<u32> m_color;
+    std::vector<f32> m_depth;
+
+    u32                      m_coarse_width = 0;
+    u32                      m_coarse_height = 0;
+    std::vector<DepthBounds> m_coarse_depth;
+};
+
+/// CPU side texture. Texels are stored like the source image, row 0 being v == 0.
+class Texture {
+public:
+    Texture() = default;
+
+    Texture(const u8* data, const v2u32& size, u32 num_components)
+        : m_size(size) {
+        const size_t texel_count = static_cast<size_t>(size.x) * size.y;
+        m_texels.resize(texel_count);
+        for (size_t i = 0; i < texel_count; i++) {
+            const u8* texel = &data[i * num_components];
+            const u32 r = texel[0];
+            const u32 g = num_components > 1 ? texel[1] : r;
+            const u32 b = num_components > 2 ? texel[2] : r;
+            const u32 a = num_components > 3 ? texel[3] : 255;
+            m_texels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+
+    /// Nearest sampling with repeat addressing.
+    [[nodiscard]] auto sample(f32 u, f32 v) const -> u32 {
+        const f32 fu = u - std::floor(u);
+        const f32 fv = v - std::floor(v);
+        const auto x = std::min(u32(fu * static_cast<f32>(m_size.x)), m_size.x - 1);
+        const auto y = std::min(u32(fv * static_cast<f32>(m_size.y)), m_size.y - 1);
+        return m_texels[static_cast<size_t>(y) * m_size.x + x];
+    }
+
+public:
+    v2u32            m_size = {};
+    std::vector<u32> m_texels;
+};
+
+struct Shader;
+
+/// The software backend has no fixed function state, materials only carry the texture
+/// and the translated shader.
+struct Material {
+    const Texture* m_texture = nullptr;
+    const Shader*  m_shader = nullptr;
+};
+
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,144 @@
+#include "raster_kernel.h"
+
+#include <algorithm>
+
+#if JF_SOFTWARE_X86_KERNELS && defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace JadeFrame {
+namespace software {
+
+/*---------------------------
+    Dispatch
+---------------------------*/
+
+#if JF_SOFTWARE_X86_KERNELS
+static auto cpu_has_avx2() -> bool {
+    #if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    // Also checks that the OS saves the YMM registers.
+    return __builtin_cpu_supports("avx2") != 0;
+    #elif defined(_MSC_VER)
+    std::array<int, 4> info = {};
+    __cpuid(info.data(), 0);
+    if (info[0] < 7) { return false; }
+    __cpuid(info.data(), 1);
+    const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!has_osxsave || !has_avx) { return false; }
+    if ((_xgetbv(0) & 0x6) != 0x6) { return false; }
+    __cpuidex(info.data(), 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+    #else
+    return false;
+    #endif
+}
+#endif
+
+auto is_supported(RASTER_KERNEL kernel) -> bool {
+    switch (kernel) {
+        case RASTER_KERNEL::SCALAR: return true;
+#if JF_SOFTWARE_X86_KERNELS
+        case RASTER_KERNEL::SSE2: return true;
+        case RASTER_KERNEL::AVX2: {
+            static const bool has_avx2 = cpu_has_avx2();
+            return has_avx2;
+        }
+#endif
+        default: return false;
+    }
+}
+
+auto get_best_raster_kernel() -> RASTER_KERNEL {
+    if (is_supported(RASTER_KERNEL::AVX2)) { return RASTER_KERNEL::AVX2; }
+    if (is_supported(RASTER_KERNEL::SSE2)) { return RASTER_KERNEL::SSE2; }
+    return RASTER_KERNEL::SCALAR;
+}
+
+auto get_rasterize_fn(RASTER_KERNEL kernel) -> RasterizeTriangleFn {
+    if (!is_supported(kernel)) { return &rasterize_triangle_scalar; }
+    switch (kernel) {
+#if JF_SOFTWARE_X86_KERNELS
+        case RASTER_KERNEL::SSE2: return &rasterize_triangle_sse2;
+        case RASTER_KERNEL::AVX2: return &rasterize_triangle_avx2;
+#endif
+        default: return &rasterize_triangle_scalar;
+    }
+}
+
+auto sample_lanes(
+    const Texture& texture,
+    const f32*     u,
+    const f32*     v,
+    u32            mask,
+    u32            lane_count,
+    u32*           out
+) -> void {
+    for (u32 i = 0; i < lane_count; i++) {
+        out[i] = (mask & (1U << i)) != 0 ? texture.sample(u[i], v[i]) : 0;
+    }
+}
+
+/*---------------------------
+    Scalar kernel
+---------------------------*/
+
+// The reference for the SIMD kernels. Every plane is evaluated directly instead of
+// incrementally, so the results match them bit for bit.
+static auto is_inside(f32 e, bool is_top_left) -> bool {
+    return e > 0.0F || (e == 0.0F && is_top_left);
+}
+
+auto rasterize_triangle_scalar(
+    const RasterTarget& target,
+    const Triangle&     tri,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void {
+    const auto& edges = tri.m_edges;
+    const auto& attr = tri.m_attributes;
+
+    for (i32 y = min_y; y <= max_y; y++) {
+        const f32    py = static_cast<f32>(y) + 0.5F;
+        const size_t row = static_cast<size_t>(y) * target.m_width;
+        for (i32 x = min_x; x <= max_x; x++) {
+            const f32 px = static_cast<f32>(x) + 0.5F;
+            if (!is_inside(edges[0].at(px, py), tri.m_is_top_left[0]) ||
+                !is_inside(edges[1].at(px, py), tri.m_is_top_left[1]) ||
+                !is_inside(edges[2].at(px, py), tri.m_is_top_left[2])) {
+                continue;
+            }
+
+            const size_t index = row + static_cast<size_t>(x);
+            const f32    depth = attr[Triangle::DEPTH].at(px, py);
+            if (!(depth < target.m_depth[index])) { continue; }
+
+            const f32 w = 1.0F / attr[Triangle::INV_W].at(px, py);
+            v4        color = v4::create(
+                attr[Triangle::R_OVER_W].at(px, py) * w,
+                attr[Triangle::G_OVER_W].at(px, py) * w,
+                attr[Triangle::B_OVER_W].at(px, py) * w,
+                attr[Triangle::A_OVER_W].at(px, py) * w
+            );
+            if (tri.m_texture != nullptr) {
+                const f32 u = attr[Triangle::U_OVER_W].at(px, py) * w;
+                const f32 v = attr[Triangle::V_OVER_W].at(px, py) * w;
+                color = color * unpack_color(tri.m_texture->sample(u, v));
+            }
+
+            target.m_depth[index] = depth;
+            target.m_color[index] = pack_color(color);
+
+            const u32    bx = static_cast<u32>(x) / Framebuffer::COARSE_SIZE;
+            const u32    by = static_cast<u32>(y) / Framebuffer::COARSE_SIZE;
+            DepthBounds& bounds = target.m_coarse_depth[by * target.m_coarse_width + bx];
+            bounds.m_min = std::min(bounds.m_min, depth);
+        }
+    }
+}
+
+} // namespace software
+} // namespace JadeFrame
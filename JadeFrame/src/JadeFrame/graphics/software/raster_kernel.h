@@ -0,0 +1,170 @@
+#pragma once
+#include <array>
+
+#include "JadeFrame/prelude.h"
+
+#include "framebuffer.h"
+
+// The SIMD kernels are only built for x86-64, where SSE2 is part of the baseline.
+#if defined(__x86_64__) || defined(_M_X64)
+    #define JF_SOFTWARE_X86_KERNELS 1
+#else
+    #define JF_SOFTWARE_X86_KERNELS 0
+#endif
+
+// The functions between the two are compiled for AVX2, they go after all includes. So the
+// inline functions of the headers are not, the linker could keep those copies for the
+// whole program. MSVC allows the intrinsics without any flag.
+#if defined(__clang__)
+    #define JF_BEGIN_AVX2 \
+    _Pragma("clang attribute push(__attribute__((target(\"avx2\"))),apply_to=function)")
+    #define JF_END_AVX2 _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+    #define JF_BEGIN_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+    #define JF_END_AVX2   _Pragma("GCC pop_options")
+#else
+    #define JF_BEGIN_AVX2
+    #define JF_END_AVX2
+#endif
+
+namespace JadeFrame {
+namespace software {
+
+/// A screen space plane `value(x, y) = m_base + m_dx * x + m_dy * y`.
+struct Plane {
+    f32 m_base = 0.0F;
+    f32 m_dx = 0.0F;
+    f32 m_dy = 0.0F;
+
+    [[nodiscard]] auto at(f32 x, f32 y) const -> f32 {
+        return m_base + m_dx * x + m_dy * y;
+    }
+};
+
+/*
+    A triangle after clipping and setup. Everything that varies over the triangle is
+   stored as a plane equation in pixel coordinates, so a pixel only has to evaluate
+   planes. Attributes are stored divided by w and recovered per pixel for perspective
+   correct interpolation.
+*/
+struct Triangle {
+    enum ATTRIBUTE : u8 {
+        DEPTH,
+        INV_W,
+        R_OVER_W,
+        G_OVER_W,
+        B_OVER_W,
+        A_OVER_W,
+        U_OVER_W,
+        V_OVER_W,
+        MAX,
+    };
+
+    /// Edge functions, a pixel center is covered if all three are inside.
+    std::array<Plane, 3>              m_edges;
+    /// Whether the edge is a top or left edge, those own pixels lying exactly on them.
+    std::array<bool, 3>               m_is_top_left = {};
+    std::array<Plane, ATTRIBUTE::MAX> m_attributes;
+
+    /// Inclusive pixel bounding box, already clamped to the viewport.
+    i32 m_min_x = 0;
+    i32 m_min_y = 0;
+    i32 m_max_x = 0;
+    i32 m_max_y = 0;
+
+    const Texture* m_texture = nullptr;
+};
+
+/// The raw view of a `Framebuffer` the kernels write to.
+struct RasterTarget {
+    u32*         m_color = nullptr;
+    f32*         m_depth = nullptr;
+    DepthBounds* m_coarse_depth = nullptr;
+    u32          m_width = 0;
+    u32          m_height = 0;
+    u32          m_coarse_width = 0;
+};
+
+/*
+    Fills the pixels of `triangle` inside the inclusive rectangle [min_x, max_x] x
+   [min_y, max_y].
+    The SIMD kernels work on aligned 8x8 blocks and may rewrite pixels of a touched block
+   outside the rectangle with their current value, so the caller has to own every block
+   the rectangle touches. Rectangles inside one `Rasterizer::TILE_SIZE` tile are fine.
+    The SIMD kernels skip blocks where the triangle lies behind the coarse depth and
+   refresh the coarse depth of every block they wrote to. The scalar kernel only keeps
+   it conservative.
+    All kernels evaluate the planes with the same operations in the same order, so they
+   produce bit identical images.
+*/
+using RasterizeTriangleFn = void (*)(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+);
+
+enum class RASTER_KERNEL : u8 {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+inline auto to_string(RASTER_KERNEL kernel) -> const char* {
+    switch (kernel) {
+        case RASTER_KERNEL::SCALAR: return "SCALAR";
+        case RASTER_KERNEL::SSE2: return "SSE2";
+        case RASTER_KERNEL::AVX2: return "AVX2";
+        default: return "UNKNOWN";
+    }
+}
+
+/// Whether the kernel was built and the CPU is able to run it.
+auto is_supported(RASTER_KERNEL kernel) -> bool;
+/// The widest supported kernel, detected once at runtime.
+auto get_best_raster_kernel() -> RASTER_KERNEL;
+/// Returns the scalar kernel if `kernel` is not supported.
+auto get_rasterize_fn(RASTER_KERNEL kernel) -> RasterizeTriangleFn;
+
+auto rasterize_triangle_scalar(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void;
+#if JF_SOFTWARE_X86_KERNELS
+auto rasterize_triangle_sse2(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void;
+auto rasterize_triangle_avx2(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void;
+#endif
+
+/// Samples `texture` for every lane set in `mask`. Lets the SIMD kernels, which are
+/// built with different instruction sets, share the scalar sampling code.
+auto sample_lanes(
+    const Texture& texture,
+    const f32*     u,
+    const f32*     v,
+    u32            mask,
+    u32            lane_count,
+    u32*           out
+) -> void;
+
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,140 @@
+#include "raster_kernel.h"
+
+// NOTE: Only the code after `JF_BEGIN_AVX2` is compiled for AVX2, see
+// `raster_kernel_simd.h` for what that means for the code it may call.
+#if JF_SOFTWARE_X86_KERNELS
+    #include <cfloat>
+
+    #include <immintrin.h>
+
+JF_BEGIN_AVX2
+    #include "raster_kernel_simd.h"
+
+namespace JadeFrame {
+namespace software {
+namespace {
+
+// Two 2x2 quads per register, the lanes are laid out as two rows of 4 pixels.
+struct AVX2 {
+    using F = __m256;
+    constexpr static u32 WIDTH = 8;
+    constexpr static i32 GROUP_WIDTH = 4;
+
+    static auto splat(f32 v) -> F { return _mm256_set1_ps(v); }
+
+    static auto splat_mask(bool v) -> F {
+        return _mm256_castsi256_ps(_mm256_set1_epi32(v ? -1 : 0));
+    }
+
+    static auto lane_x() -> F { return _mm256_setr_ps(0, 1, 2, 3, 0, 1, 2, 3); }
+
+    static auto lane_y() -> F { return _mm256_setr_ps(0, 0, 0, 0, 1, 1, 1, 1); }
+
+    static auto add(F a, F b) -> F { return _mm256_add_ps(a, b); }
+
+    static auto mul(F a, F b) -> F { return _mm256_mul_ps(a, b); }
+
+    static auto div(F a, F b) -> F { return _mm256_div_ps(a, b); }
+
+    static auto min(F a, F b) -> F { return _mm256_min_ps(a, b); }
+
+    static auto max(F a, F b) -> F { return _mm256_max_ps(a, b); }
+
+    static auto reduce_min(F v) -> f32 {
+        __m128 half = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    static auto reduce_max(F v) -> f32 {
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    static auto cmp_gt(F a, F b) -> F { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+
+    static auto cmp_lt(F a, F b) -> F { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+
+    static auto cmp_eq(F a, F b) -> F { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+    static auto bit_and(F a, F b) -> F { return _mm256_and_ps(a, b); }
+
+    static auto bit_or(F a, F b) -> F { return _mm256_or_ps(a, b); }
+
+    /// Takes `b` where `mask` is set, `a` elsewhere.
+    static auto blend(F a, F b, F mask) -> F { return _mm256_blendv_ps(a, b, mask); }
+
+    static auto movemask(F mask) -> u32 {
+        return static_cast<u32>(_mm256_movemask_ps(mask));
+    }
+
+    static auto load(const void* src) -> F {
+        return _mm256_castsi256_ps(_mm256_loadu_si256(static_cast<const __m256i*>(src)));
+    }
+
+    static auto store(void* dst, F v) -> void {
+        _mm256_storeu_si256(static_cast<__m256i*>(dst), _mm256_castps_si256(v));
+    }
+
+    static auto load_rows(const void* row0, const void* row1) -> F {
+        const __m128i lo = _mm_loadu_si128(static_cast<const __m128i*>(row0));
+        const __m128i hi = _mm_loadu_si128(static_cast<const __m128i*>(row1));
+        return _mm256_castsi256_ps(
+            _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1)
+        );
+    }
+
+    static auto store_rows(void* row0, void* row1, F v) -> void {
+        const __m256i bits = _mm256_castps_si256(v);
+        _mm_storeu_si128(static_cast<__m128i*>(row0), _mm256_castsi256_si128(bits));
+        _mm_storeu_si128(
+            static_cast<__m128i*>(row1), _mm256_extracti128_si256(bits, 1)
+        );
+    }
+
+    // Not a lambda, GCC would not compile the function it converts to for AVX2.
+    static auto to_u8(F v) -> __m256i {
+        const F zero = _mm256_setzero_ps();
+        v = _mm256_min_ps(_mm256_max_ps(v, zero), _mm256_set1_ps(1.0F));
+        v = _mm256_mul_ps(v, _mm256_set1_ps(255.0F));
+        return _mm256_cvttps_epi32(_mm256_add_ps(v, _mm256_set1_ps(0.5F)));
+    }
+
+    // Same rounding as `pack_color`.
+    static auto pack_color(F r, F g, F b, F a) -> F {
+        __m256i color = _mm256_slli_epi32(to_u8(a), 24);
+        color = _mm256_or_si256(color, _mm256_slli_epi32(to_u8(r), 16));
+        color = _mm256_or_si256(color, _mm256_slli_epi32(to_u8(g), 8));
+        color = _mm256_or_si256(color, to_u8(b));
+        return _mm256_castsi256_ps(color);
+    }
+
+    // Same rounding as `unpack_color`.
+    template<int SHIFT>
+    static auto unpack_channel(F color) -> F {
+        const __m256i bits = _mm256_srli_epi32(_mm256_castps_si256(color), SHIFT);
+        const __m256i channel = _mm256_and_si256(bits, _mm256_set1_epi32(0xFF));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(channel), _mm256_set1_ps(1.0F / 255.0F));
+    }
+};
+
+} // namespace
+
+auto rasterize_triangle_avx2(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void {
+    rasterize_triangle_simd<AVX2>(target, triangle, min_x, min_y, max_x, max_y);
+}
+
+} // namespace software
+} // namespace JadeFrame
+JF_END_AVX2
+#endif
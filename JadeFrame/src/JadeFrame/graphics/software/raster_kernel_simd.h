@@ -0,0 +1,352 @@
+#pragma once
+/*
+    Shared body of the SIMD rasterizer kernels. It is included by one translation unit per
+   instruction set, each providing a `Simd` type with the handful of operations used here.
+
+    NOTE: Those translation units may compile this file for a wider instruction set, see
+   `JF_BEGIN_AVX2`. Inline functions with external linkage defined here would be picked
+   by the linker for the whole program and crash on CPUs without that instruction set.
+   Keep everything in this file in the anonymous namespace and reach shared code only
+   through out of line functions like `sample_lanes`.
+*/
+#include <cfloat>
+
+#include "raster_kernel.h"
+
+namespace JadeFrame {
+namespace software {
+namespace {
+
+// Blocks are trivially accepted or rejected before any pixel is looked at. They are the
+// blocks of the coarse depth buffer.
+constexpr i32 BLOCK_SIZE = static_cast<i32>(Framebuffer::COARSE_SIZE);
+
+auto absolute(f32 v) -> f32 { return v < 0.0F ? -v : v; }
+
+auto minimum(f32 a, f32 b) -> f32 { return a < b ? a : b; }
+
+auto maximum(f32 a, f32 b) -> f32 { return a > b ? a : b; }
+
+// `Plane::at` is not called here, see the note at the top.
+auto evaluate(const Plane& plane, f32 x, f32 y) -> f32 {
+    return plane.m_base + plane.m_dx * x + plane.m_dy * y;
+}
+
+// Bound of the rounding error of evaluating `plane` anywhere in [0, far_x] x [0, far_y].
+auto get_tolerance(const Plane& plane, f32 far_x, f32 far_y) -> f32 {
+    const f32 magnitude = absolute(plane.m_base) + absolute(plane.m_dx) * far_x +
+                          absolute(plane.m_dy) * far_y;
+    return 4.0F * FLT_EPSILON * magnitude;
+}
+
+// The range of `plane` over the pixel centers of a block.
+auto get_block_range(const Plane& plane, i32 bx, i32 by, f32& lo, f32& hi) -> void {
+    const f32 x0 = static_cast<f32>(bx) + 0.5F;
+    const f32 y0 = static_cast<f32>(by) + 0.5F;
+    const f32 x1 = static_cast<f32>(bx + BLOCK_SIZE - 1) + 0.5F;
+    const f32 y1 = static_cast<f32>(by + BLOCK_SIZE - 1) + 0.5F;
+    const f32 c00 = evaluate(plane, x0, y0);
+    const f32 c10 = evaluate(plane, x1, y0);
+    const f32 c01 = evaluate(plane, x0, y1);
+    const f32 c11 = evaluate(plane, x1, y1);
+    lo = minimum(minimum(c00, c10), minimum(c01, c11));
+    hi = maximum(maximum(c00, c10), maximum(c01, c11));
+}
+
+template<typename Simd>
+struct SimdPlane {
+    using F = typename Simd::F;
+
+    F m_base;
+    F m_dx;
+    F m_dy;
+
+    explicit SimdPlane(const Plane& plane)
+        : m_base(Simd::splat(plane.m_base))
+        , m_dx(Simd::splat(plane.m_dx))
+        , m_dy(Simd::splat(plane.m_dy)) {}
+
+    // Same operations in the same order as `Plane::at`.
+    [[nodiscard]] auto at(F x, F y) const -> F {
+        return Simd::add(Simd::add(m_base, Simd::mul(m_dx, x)), Simd::mul(m_dy, y));
+    }
+};
+
+template<typename Simd>
+struct SimdTriangle {
+    using F = typename Simd::F;
+
+    explicit SimdTriangle(const Triangle& tri)
+        : m_edges{
+              SimdPlane<Simd>(tri.m_edges[0]),
+              SimdPlane<Simd>(tri.m_edges[1]),
+              SimdPlane<Simd>(tri.m_edges[2]),
+          }
+        , m_is_top_left{
+              Simd::splat_mask(tri.m_is_top_left[0]),
+              Simd::splat_mask(tri.m_is_top_left[1]),
+              Simd::splat_mask(tri.m_is_top_left[2]),
+          }
+        , m_depth(tri.m_attributes[Triangle::DEPTH])
+        , m_inv_w(tri.m_attributes[Triangle::INV_W])
+        , m_r(tri.m_attributes[Triangle::R_OVER_W])
+        , m_g(tri.m_attributes[Triangle::G_OVER_W])
+        , m_b(tri.m_attributes[Triangle::B_OVER_W])
+        , m_a(tri.m_attributes[Triangle::A_OVER_W])
+        , m_u(tri.m_attributes[Triangle::U_OVER_W])
+        , m_v(tri.m_attributes[Triangle::V_OVER_W]) {}
+
+    [[nodiscard]] auto coverage(F x, F y) const -> F {
+        F mask = Simd::splat_mask(true);
+        for (u32 i = 0; i < 3; i++) {
+            const F e = m_edges[i].at(x, y);
+            const F zero = Simd::splat(0.0F);
+            const F is_on_edge = Simd::bit_and(Simd::cmp_eq(e, zero), m_is_top_left[i]);
+            mask = Simd::bit_and(mask, Simd::bit_or(Simd::cmp_gt(e, zero), is_on_edge));
+        }
+        return mask;
+    }
+
+    SimdPlane<Simd> m_edges[3];
+    F               m_is_top_left[3];
+    SimdPlane<Simd> m_depth;
+    SimdPlane<Simd> m_inv_w;
+    SimdPlane<Simd> m_r;
+    SimdPlane<Simd> m_g;
+    SimdPlane<Simd> m_b;
+    SimdPlane<Simd> m_a;
+    SimdPlane<Simd> m_u;
+    SimdPlane<Simd> m_v;
+};
+
+/*
+    Depth test and shading of one group of pixels, two rows of `Simd::GROUP_WIDTH`. A
+   group is made of 2x2 quads, so derivatives can be taken between neighbouring lanes.
+*/
+template<typename Simd>
+auto shade_group(
+    const RasterTarget&       target,
+    const Triangle&           tri,
+    const SimdTriangle<Simd>& stri,
+    i32                       x,
+    i32                       y,
+    typename Simd::F          px,
+    typename Simd::F          py,
+    typename Simd::F          coverage,
+    bool                      is_depth_accepted
+) -> bool {
+    using F = typename Simd::F;
+    constexpr u32 LANES = Simd::WIDTH;
+    constexpr i32 GROUP_WIDTH = Simd::GROUP_WIDTH;
+
+    const size_t index = static_cast<size_t>(y) * target.m_width + static_cast<size_t>(x);
+    f32*         depth_rows[2] = {&target.m_depth[index], &target.m_depth[index]};
+    u32*         color_rows[2] = {&target.m_color[index], &target.m_color[index]};
+    depth_rows[1] += target.m_width;
+    color_rows[1] += target.m_width;
+
+    // Groups hanging over the right or bottom border of the framebuffer go through a
+    // scratch copy, a full width access could touch pixels owned by another tile.
+    alignas(32) f32 depth_scratch[LANES];
+    alignas(32) u32 color_scratch[LANES];
+    const bool      is_partial = x + GROUP_WIDTH > static_cast<i32>(target.m_width) ||
+                            y + 1 >= static_cast<i32>(target.m_height);
+    if (is_partial) {
+        for (u32 i = 0; i < LANES; i++) {
+            const i32 lx = x + static_cast<i32>(i) % GROUP_WIDTH;
+            const i32 ly = y + static_cast<i32>(i) / GROUP_WIDTH;
+            depth_scratch[i] = 0.0F;
+            color_scratch[i] = 0;
+            if (lx < static_cast<i32>(target.m_width) &&
+                ly < static_cast<i32>(target.m_height)) {
+                const size_t lane = static_cast<size_t>(ly) * target.m_width + lx;
+                depth_scratch[i] = target.m_depth[lane];
+                color_scratch[i] = target.m_color[lane];
+            }
+        }
+        depth_rows[0] = &depth_scratch[0];
+        depth_rows[1] = &depth_scratch[GROUP_WIDTH];
+        color_rows[0] = &color_scratch[0];
+        color_rows[1] = &color_scratch[GROUP_WIDTH];
+    }
+
+    const F old_depth = Simd::load_rows(depth_rows[0], depth_rows[1]);
+    const F depth = stri.m_depth.at(px, py);
+    const F   mask = is_depth_accepted
+                           ? coverage
+                           : Simd::bit_and(coverage, Simd::cmp_lt(depth, old_depth));
+    const u32 lanes = Simd::movemask(mask);
+    if (lanes == 0) { return false; }
+
+    const F w = Simd::div(Simd::splat(1.0F), stri.m_inv_w.at(px, py));
+    F       r = Simd::mul(stri.m_r.at(px, py), w);
+    F       g = Simd::mul(stri.m_g.at(px, py), w);
+    F       b = Simd::mul(stri.m_b.at(px, py), w);
+    F       a = Simd::mul(stri.m_a.at(px, py), w);
+    if (tri.m_texture != nullptr) {
+        alignas(32) f32 u[LANES];
+        alignas(32) f32 v[LANES];
+        alignas(32) u32 texels[LANES];
+        Simd::store(u, Simd::mul(stri.m_u.at(px, py), w));
+        Simd::store(v, Simd::mul(stri.m_v.at(px, py), w));
+        sample_lanes(*tri.m_texture, u, v, lanes, LANES, texels);
+
+        const F texel = Simd::load(texels);
+        r = Simd::mul(r, Simd::template unpack_channel<16>(texel));
+        g = Simd::mul(g, Simd::template unpack_channel<8>(texel));
+        b = Simd::mul(b, Simd::template unpack_channel<0>(texel));
+        a = Simd::mul(a, Simd::template unpack_channel<24>(texel));
+    }
+
+    const F old_color = Simd::load_rows(color_rows[0], color_rows[1]);
+    const F color = Simd::pack_color(r, g, b, a);
+    Simd::store_rows(depth_rows[0], depth_rows[1], Simd::blend(old_depth, depth, mask));
+    Simd::store_rows(color_rows[0], color_rows[1], Simd::blend(old_color, color, mask));
+
+    if (is_partial) {
+        for (u32 i = 0; i < LANES; i++) {
+            if ((lanes & (1U << i)) == 0) { continue; }
+            const i32    lx = x + static_cast<i32>(i) % GROUP_WIDTH;
+            const i32    ly = y + static_cast<i32>(i) / GROUP_WIDTH;
+            const size_t lane = static_cast<size_t>(ly) * target.m_width + lx;
+            target.m_depth[lane] = depth_scratch[i];
+            target.m_color[lane] = color_scratch[i];
+        }
+    }
+    return true;
+}
+
+// Recomputes the coarse depth of a block from the full resolution depth.
+template<typename Simd>
+auto update_depth_bounds(const RasterTarget& target, i32 bx, i32 by, DepthBounds& bounds)
+    -> void {
+    using F = typename Simd::F;
+    const i32 width = static_cast<i32>(target.m_width);
+    const i32 height = static_cast<i32>(target.m_height);
+
+    if (bx + BLOCK_SIZE > width || by + BLOCK_SIZE > height) {
+        f32 lo = FLT_MAX;
+        f32 hi = -FLT_MAX;
+        for (i32 y = by; y < by + BLOCK_SIZE && y < height; y++) {
+            for (i32 x = bx; x < bx + BLOCK_SIZE && x < width; x++) {
+                const f32 depth = target.m_depth[static_cast<size_t>(y) * width + x];
+                lo = minimum(lo, depth);
+                hi = maximum(hi, depth);
+            }
+        }
+        bounds = {lo, hi};
+        return;
+    }
+
+    const f32* row = &target.m_depth[static_cast<size_t>(by) * width + bx];
+    F          lo = Simd::load(row);
+    F          hi = lo;
+    for (i32 y = 0; y < BLOCK_SIZE; y++, row += width) {
+        for (i32 x = 0; x < BLOCK_SIZE; x += static_cast<i32>(Simd::WIDTH)) {
+            const F depth = Simd::load(&row[x]);
+            lo = Simd::min(lo, depth);
+            hi = Simd::max(hi, depth);
+        }
+    }
+    bounds = {Simd::reduce_min(lo), Simd::reduce_max(hi)};
+}
+
+template<typename Simd>
+auto rasterize_triangle_simd(
+    const RasterTarget& target,
+    const Triangle&     tri,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void {
+    using F = typename Simd::F;
+    constexpr i32 GROUP_WIDTH = Simd::GROUP_WIDTH;
+
+    const SimdTriangle<Simd> stri(tri);
+    const F lane_x = Simd::add(Simd::lane_x(), Simd::splat(0.5F));
+    const F lane_y = Simd::add(Simd::lane_y(), Simd::splat(0.5F));
+    const F rect_min_x = Simd::splat(static_cast<f32>(min_x));
+    const F rect_min_y = Simd::splat(static_cast<f32>(min_y));
+    const F rect_max_x = Simd::splat(static_cast<f32>(max_x + 1));
+    const F rect_max_y = Simd::splat(static_cast<f32>(max_y + 1));
+
+    // A block decision must agree with what every single pixel would decide, so the
+    // corner values have to clear the rounding error of evaluating an edge anywhere in
+    // the touched blocks.
+    const f32 far_x = static_cast<f32>(max_x + BLOCK_SIZE);
+    const f32 far_y = static_cast<f32>(max_y + BLOCK_SIZE);
+    f32       tolerance[3];
+    for (u32 i = 0; i < 3; i++) {
+        tolerance[i] = get_tolerance(tri.m_edges[i], far_x, far_y);
+    }
+    const Plane& depth_plane = tri.m_attributes[Triangle::DEPTH];
+    const f32    depth_tolerance = get_tolerance(depth_plane, far_x, far_y);
+
+    const i32 block_min_x = (min_x / BLOCK_SIZE) * BLOCK_SIZE;
+    const i32 block_min_y = (min_y / BLOCK_SIZE) * BLOCK_SIZE;
+    for (i32 by = block_min_y; by <= max_y; by += BLOCK_SIZE) {
+        for (i32 bx = block_min_x; bx <= max_x; bx += BLOCK_SIZE) {
+            f32 lo = 0.0F;
+            f32 hi = 0.0F;
+
+            // Hierarchical depth test, with `LESS` the whole block fails if the triangle
+            // is nowhere closer than the farthest depth stored in it.
+            const size_t coarse_index =
+                static_cast<size_t>(by / BLOCK_SIZE) * target.m_coarse_width +
+                static_cast<size_t>(bx / BLOCK_SIZE);
+            DepthBounds& bounds = target.m_coarse_depth[coarse_index];
+            get_block_range(depth_plane, bx, by, lo, hi);
+            if (lo - depth_tolerance >= bounds.m_max) { continue; }
+            const bool is_depth_accepted = hi + depth_tolerance < bounds.m_min;
+
+            bool is_rejected = false;
+            bool is_accepted = true;
+            for (u32 i = 0; i < 3; i++) {
+                get_block_range(tri.m_edges[i], bx, by, lo, hi);
+                if (hi < -tolerance[i]) {
+                    is_rejected = true;
+                    break;
+                }
+                if (!(lo > tolerance[i])) { is_accepted = false; }
+            }
+            if (is_rejected) { continue; }
+
+            bool       is_written = false;
+            const bool is_inside_rect = bx >= min_x && by >= min_y &&
+                                        bx + BLOCK_SIZE - 1 <= max_x &&
+                                        by + BLOCK_SIZE - 1 <= max_y;
+            for (i32 y = by; y < by + BLOCK_SIZE; y += 2) {
+                if (y + 1 < min_y || y > max_y) { continue; }
+                const F py = Simd::add(Simd::splat(static_cast<f32>(y)), lane_y);
+                for (i32 x = bx; x < bx + BLOCK_SIZE; x += GROUP_WIDTH) {
+                    if (x + GROUP_WIDTH - 1 < min_x || x > max_x) { continue; }
+                    const F px = Simd::add(Simd::splat(static_cast<f32>(x)), lane_x);
+
+                    F coverage = Simd::splat_mask(true);
+                    if (!is_inside_rect) {
+                        const F in_x = Simd::bit_and(
+                            Simd::cmp_gt(px, rect_min_x), Simd::cmp_lt(px, rect_max_x)
+                        );
+                        const F in_y = Simd::bit_and(
+                            Simd::cmp_gt(py, rect_min_y), Simd::cmp_lt(py, rect_max_y)
+                        );
+                        coverage = Simd::bit_and(in_x, in_y);
+                    }
+                    if (!is_accepted) {
+                        coverage = Simd::bit_and(coverage, stri.coverage(px, py));
+                    }
+                    if (Simd::movemask(coverage) == 0) { continue; }
+                    is_written |= shade_group<Simd>(
+                        target, tri, stri, x, y, px, py, coverage, is_depth_accepted
+                    );
+                }
+            }
+            if (is_written) { update_depth_bounds<Simd>(target, bx, by, bounds); }
+        }
+    }
+}
+
+} // namespace
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,127 @@
+#include "raster_kernel.h"
+
+#if JF_SOFTWARE_X86_KERNELS
+    #include <emmintrin.h>
+
+    #include "raster_kernel_simd.h"
+
+namespace JadeFrame {
+namespace software {
+namespace {
+
+// One 2x2 quad per register.
+struct SSE2 {
+    using F = __m128;
+    constexpr static u32 WIDTH = 4;
+    constexpr static i32 GROUP_WIDTH = 2;
+
+    static auto splat(f32 v) -> F { return _mm_set1_ps(v); }
+
+    static auto splat_mask(bool v) -> F {
+        return _mm_castsi128_ps(_mm_set1_epi32(v ? -1 : 0));
+    }
+
+    static auto lane_x() -> F { return _mm_setr_ps(0, 1, 0, 1); }
+
+    static auto lane_y() -> F { return _mm_setr_ps(0, 0, 1, 1); }
+
+    static auto add(F a, F b) -> F { return _mm_add_ps(a, b); }
+
+    static auto mul(F a, F b) -> F { return _mm_mul_ps(a, b); }
+
+    static auto div(F a, F b) -> F { return _mm_div_ps(a, b); }
+
+    static auto min(F a, F b) -> F { return _mm_min_ps(a, b); }
+
+    static auto max(F a, F b) -> F { return _mm_max_ps(a, b); }
+
+    static auto reduce_min(F v) -> f32 {
+        v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+
+    static auto reduce_max(F v) -> f32 {
+        v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+
+    static auto cmp_gt(F a, F b) -> F { return _mm_cmpgt_ps(a, b); }
+
+    static auto cmp_lt(F a, F b) -> F { return _mm_cmplt_ps(a, b); }
+
+    static auto cmp_eq(F a, F b) -> F { return _mm_cmpeq_ps(a, b); }
+
+    static auto bit_and(F a, F b) -> F { return _mm_and_ps(a, b); }
+
+    static auto bit_or(F a, F b) -> F { return _mm_or_ps(a, b); }
+
+    /// Takes `b` where `mask` is set, `a` elsewhere.
+    static auto blend(F a, F b, F mask) -> F {
+        return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+    }
+
+    static auto movemask(F mask) -> u32 {
+        return static_cast<u32>(_mm_movemask_ps(mask));
+    }
+
+    static auto load(const void* src) -> F {
+        return _mm_castsi128_ps(_mm_loadu_si128(static_cast<const __m128i*>(src)));
+    }
+
+    static auto store(void* dst, F v) -> void {
+        _mm_storeu_si128(static_cast<__m128i*>(dst), _mm_castps_si128(v));
+    }
+
+    static auto load_rows(const void* row0, const void* row1) -> F {
+        const __m128i lo = _mm_loadl_epi64(static_cast<const __m128i*>(row0));
+        const __m128i hi = _mm_loadl_epi64(static_cast<const __m128i*>(row1));
+        return _mm_castsi128_ps(_mm_unpacklo_epi64(lo, hi));
+    }
+
+    static auto store_rows(void* row0, void* row1, F v) -> void {
+        const __m128i bits = _mm_castps_si128(v);
+        _mm_storel_epi64(static_cast<__m128i*>(row0), bits);
+        _mm_storel_epi64(static_cast<__m128i*>(row1), _mm_unpackhi_epi64(bits, bits));
+    }
+
+    // Same rounding as `pack_color`.
+    static auto pack_color(F r, F g, F b, F a) -> F {
+        auto to_u8 = [](F v) -> __m128i {
+            v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0F));
+            v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0F)), _mm_set1_ps(0.5F));
+            return _mm_cvttps_epi32(v);
+        };
+        __m128i color = _mm_slli_epi32(to_u8(a), 24);
+        color = _mm_or_si128(color, _mm_slli_epi32(to_u8(r), 16));
+        color = _mm_or_si128(color, _mm_slli_epi32(to_u8(g), 8));
+        color = _mm_or_si128(color, to_u8(b));
+        return _mm_castsi128_ps(color);
+    }
+
+    // Same rounding as `unpack_color`.
+    template<int SHIFT>
+    static auto unpack_channel(F color) -> F {
+        const __m128i bits = _mm_srli_epi32(_mm_castps_si128(color), SHIFT);
+        const __m128i channel = _mm_and_si128(bits, _mm_set1_epi32(0xFF));
+        return _mm_mul_ps(_mm_cvtepi32_ps(channel), _mm_set1_ps(1.0F / 255.0F));
+    }
+};
+
+} // namespace
+
+auto rasterize_triangle_sse2(
+    const RasterTarget& target,
+    const Triangle&     triangle,
+    i32                 min_x,
+    i32                 min_y,
+    i32                 max_x,
+    i32                 max_y
+) -> void {
+    rasterize_triangle_simd<SSE2>(target, triangle, min_x, min_y, max_x, max_y);
+}
+
+} // namespace software
+} // namespace JadeFrame
+#endif
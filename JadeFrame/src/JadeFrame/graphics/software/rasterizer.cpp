@@ -0,0 +1,702 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "JadeFrame/graphics/mesh.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+namespace JadeFrame {
+namespace software {
+
+// Triangles whose doubled screen space area is below this are dropped.
+static constexpr f32 MIN_TRIANGLE_AREA = 1e-8F;
+// Number of geometry jobs per worker, more jobs balance better but cost more bins.
+static constexpr u32 JOBS_PER_WORKER = 4;
+
+static auto lerp(const Vertex& a, const Vertex& b, f32 t) -> Vertex {
+    Vertex result;
+    result.m_position = a.m_position + (b.m_position - a.m_position) * t;
+    result.m_color = a.m_color + (b.m_color - a.m_color) * t;
+    result.m_uv = a.m_uv + (b.m_uv - a.m_uv) * t;
+    return result;
+}
+
+static auto lerp(const ShadedVertex& a, const ShadedVertex& b, f32 t) -> ShadedVertex {
+    ShadedVertex result;
+    result.m_position = a.m_position + (b.m_position - a.m_position) * t;
+    for (u32 i = 0; i < ShadedVertex::MAX_VARYINGS; i++) {
+        result.m_varyings[i] = a.m_varyings[i] + (b.m_varyings[i] - a.m_varyings[i]) * t;
+    }
+    return result;
+}
+
+/*---------------------------
+    Clipping
+---------------------------*/
+
+// Signed distance to the near (z >= 0) and far (z <= w) planes of a zero-to-one clip
+// volume. Clipping against x and y is not needed, the bounding box is clamped to the
+// viewport and the edge functions handle the rest.
+static auto near_distance(const v4& position) -> f32 { return position.z; }
+
+static auto far_distance(const v4& position) -> f32 { return position.w - position.z; }
+
+// Sutherland-Hodgman against a single plane. A triangle clipped by two planes has at
+// most 5 vertices.
+template<typename V, typename DistanceFn>
+static auto clip_polygon(
+    const std::array<V, 8>& in,
+    u32                     in_count,
+    std::array<V, 8>&       out,
+    DistanceFn              distance
+) -> u32 {
+    u32 out_count = 0;
+    for (u32 i = 0; i < in_count; i++) {
+        const V&  current = in[i];
+        const V&  next = in[(i + 1) % in_count];
+        const f32 d_current = distance(current.m_position);
+        const f32 d_next = distance(next.m_position);
+
+        if (d_current >= 0.0F) { out[out_count++] = current; }
+        if ((d_current >= 0.0F) != (d_next >= 0.0F)) {
+            const f32 t = d_current / (d_current - d_next);
+            out[out_count++] = lerp(current, next, t);
+        }
+    }
+    return out_count;
+}
+
+// Calls `setup(a, b, c)` for every triangle left after clipping.
+template<typename V, typename SetupFn>
+static auto clip_triangle(const V& v0, const V& v1, const V& v2, SetupFn setup) -> void {
+    const bool is_inside_near = near_distance(v0.m_position) >= 0.0F &&
+                                near_distance(v1.m_position) >= 0.0F &&
+                                near_distance(v2.m_position) >= 0.0F;
+    const bool is_inside_far = far_distance(v0.m_position) >= 0.0F &&
+                               far_distance(v1.m_position) >= 0.0F &&
+                               far_distance(v2.m_position) >= 0.0F;
+    if (is_inside_near && is_inside_far) {
+        setup(v0, v1, v2);
+        return;
+    }
+
+    std::array<V, 8> polygon = {v0, v1, v2};
+    std::array<V, 8> clipped;
+    u32              count = clip_polygon(polygon, 3, clipped, near_distance);
+    count = clip_polygon(clipped, count, polygon, far_distance);
+    for (u32 j = 1; j + 1 < count; j++) { setup(polygon[0], polygon[j], polygon[j + 1]); }
+}
+
+// Calls `fn(i0, i1, i2)` for every triangle of the mesh whose vertices all exist.
+template<typename Fn>
+static auto for_each_triangle(const Mesh& mesh, u32 vertex_count, Fn fn) -> void {
+    const std::vector<u32>& indices = mesh.m_indices;
+    const u32               index_count =
+        indices.empty() ? vertex_count : static_cast<u32>(indices.size());
+    for (u32 i = 0; i + 2 < index_count; i += 3) {
+        const u32 i0 = indices.empty() ? i + 0 : indices[i + 0];
+        const u32 i1 = indices.empty() ? i + 1 : indices[i + 1];
+        const u32 i2 = indices.empty() ? i + 2 : indices[i + 2];
+        if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) { continue; }
+        fn(i0, i1, i2);
+    }
+}
+
+/*---------------------------
+    Programs
+---------------------------*/
+
+static auto lane_mask(u32 lane_count) -> u32 { return (1U << lane_count) - 1; }
+
+// Component `c` of a vertex input. Missing components are (0, 0, 0, 1) like in the
+// other backends, every draw is a single instance.
+static auto read_vertex_input(
+    const ShaderProgram::Variable& input,
+    const Mesh::AttributeData*     data,
+    u32                            vertex,
+    u32                            c
+) -> f32 {
+    switch (input.m_builtin) {
+        case SHADER_BUILTIN::VERTEX_INDEX: return std::bit_cast<f32>(vertex);
+        case SHADER_BUILTIN::INSTANCE_INDEX: return std::bit_cast<f32>(0U);
+        default: break;
+    }
+    if (data != nullptr) {
+        const u32    count = data->m_attribute.count_components();
+        const size_t index = static_cast<size_t>(vertex) * count + c;
+        if (c < count && index < data->m_data.size()) { return data->m_data[index]; }
+    }
+    return c == 3 ? 1.0F : 0.0F;
+}
+
+static auto is_inside(f32 e, bool is_top_left) -> bool {
+    return e > 0.0F || (e == 0.0F && is_top_left);
+}
+
+/*---------------------------
+    Rasterizer
+---------------------------*/
+
+Rasterizer::Rasterizer() { this->set_kernel(get_best_raster_kernel()); }
+
+auto Rasterizer::set_kernel(RASTER_KERNEL kernel) -> void {
+    m_kernel = is_supported(kernel) ? kernel : RASTER_KERNEL::SCALAR;
+    m_rasterize_fn = get_rasterize_fn(m_kernel);
+}
+
+auto Rasterizer::draw(
+    Framebuffer&              target,
+    const Viewport&           viewport,
+    std::span<const DrawCall> draw_calls,
+    const Clear&              clear,
+    ThreadPool&               pool
+) -> void {
+    m_target = &target;
+    m_viewport = viewport;
+    if (m_viewport.m_width == 0 || m_viewport.m_height == 0) {
+        m_viewport = Viewport{0, 0, target.m_width, target.m_height};
+    }
+    m_tiles_x = (target.m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (target.m_height + TILE_SIZE - 1) / TILE_SIZE;
+    const u32 tile_count = m_tiles_x * m_tiles_y;
+    if (m_vms.size() < pool.worker_count()) { m_vms.resize(pool.worker_count()); }
+
+    const u32 draw_count = static_cast<u32>(draw_calls.size());
+    const u32 job_count = std::min(draw_count, pool.worker_count() * JOBS_PER_WORKER);
+    if (m_jobs.size() < job_count) { m_jobs.resize(job_count); }
+    for (u32 i = 0; i < job_count; i++) {
+        Job& job = m_jobs[i];
+        job.m_triangles.clear();
+        job.m_triangles_in = 0;
+        job.m_shaded_draws.clear();
+        job.m_shading.clear();
+        job.m_varyings.clear();
+        job.m_bins.resize(tile_count);
+        for (std::vector<u32>& bin : job.m_bins) { bin.clear(); }
+    }
+
+    pool.parallel_for(job_count, [&](u32 job_index, u32 worker) {
+        const size_t begin = static_cast<size_t>(draw_count) * job_index / job_count;
+        const size_t end = static_cast<size_t>(draw_count) * (job_index + 1) / job_count;
+        this->run_geometry(
+            m_jobs[job_index], draw_calls.subspan(begin, end - begin), worker
+        );
+    });
+
+    // Jobs beyond `job_count` may hold bins from an earlier frame, hide them.
+    m_stats = {};
+    m_stats.m_tiles = tile_count;
+    for (u32 i = 0; i < m_jobs.size(); i++) {
+        if (i >= job_count) {
+            m_jobs[i].m_triangles.clear();
+            m_jobs[i].m_shading.clear();
+            for (std::vector<u32>& bin : m_jobs[i].m_bins) { bin.clear(); }
+            continue;
+        }
+        m_stats.m_triangles_in += m_jobs[i].m_triangles_in;
+        m_stats.m_triangles_setup += static_cast<u32>(m_jobs[i].m_triangles.size());
+    }
+
+    pool.parallel_for(tile_count, [&](u32 tile_index, u32 worker) {
+        this->rasterize_tile(tile_index, clear, worker);
+    });
+}
+
+auto Rasterizer::get_vm(u32 worker, const ShaderProgram& program) -> ShaderVM& {
+    std::unordered_map<const ShaderProgram*, ShaderVM>& vms = m_vms[worker];
+    auto it = vms.find(&program);
+    if (it == vms.end()) { it = vms.emplace(&program, ShaderVM(program)).first; }
+    return it->second;
+}
+
+auto Rasterizer::link_programs(const DrawCall& draw_call, ShadedDraw& out) -> bool {
+    const ShaderProgram* vertex = draw_call.m_vertex;
+    const ShaderProgram* fragment = draw_call.m_fragment;
+    if (vertex == nullptr || fragment == nullptr) { return false; }
+    for (const ShaderProgram* program : {vertex, fragment}) {
+        if (program->m_uniform_buffers.size() > MAX_UNIFORM_BUFFERS ||
+            program->m_sampled_images.size() > MAX_TEXTURES) {
+            return false;
+        }
+    }
+
+    out.m_draw_call = &draw_call;
+    out.m_position = vertex->find_output(SHADER_BUILTIN::POSITION);
+    out.m_color = fragment->find_output(0);
+    out.m_frag_coord = fragment->find_input(SHADER_BUILTIN::FRAG_COORD);
+    out.m_front_facing = fragment->find_input(SHADER_BUILTIN::FRONT_FACING);
+    if (out.m_position == nullptr || out.m_position->m_registers.size() < 4 ||
+        out.m_color == nullptr || out.m_color->m_registers.size() < 3) {
+        return false;
+    }
+
+    out.m_varying_count = 0;
+    for (const ShaderProgram::Variable& input : fragment->m_inputs) {
+        if (input.m_builtin != SHADER_BUILTIN::NONE) { continue; }
+        const ShaderProgram::Variable* output = vertex->find_output(input.m_location);
+        for (u32 c = 0; c < input.m_registers.size(); c++) {
+            if (out.m_varying_count == ShadedVertex::MAX_VARYINGS) { return false; }
+            const bool is_written = output != nullptr && c < output->m_registers.size();
+            out.m_vertex_registers[out.m_varying_count] =
+                is_written ? output->m_registers[c] : ShadedDraw::NO_REGISTER;
+            out.m_fragment_registers[out.m_varying_count] = input.m_registers[c];
+            out.m_varying_count++;
+        }
+    }
+    out.m_textures.fill(draw_call.m_texture);
+    return true;
+}
+
+auto Rasterizer::run_geometry(
+    Job&                      job,
+    std::span<const DrawCall> draw_calls,
+    u32                       worker
+) -> void {
+    for (const DrawCall& draw_call : draw_calls) {
+        if (draw_call.m_mesh->m_topology != PRIMITIVE_TOPOLOGY::TRIANGLE_LIST) {
+            continue;
+        }
+
+        const u32  first_triangle = static_cast<u32>(job.m_triangles.size());
+        ShadedDraw shaded_draw;
+        if (link_programs(draw_call, shaded_draw)) {
+            job.m_shaded_draws.push_back(shaded_draw);
+            this->run_shaded_geometry(
+                job, static_cast<u32>(job.m_shaded_draws.size() - 1), worker
+            );
+        } else {
+            this->run_fixed_geometry(job, draw_call);
+        }
+
+        for (u32 i = first_triangle; i < job.m_triangles.size(); i++) {
+            job.m_triangles[i].m_texture = draw_call.m_texture;
+            this->bin_triangle(job, i);
+        }
+    }
+}
+
+auto Rasterizer::run_fixed_geometry(Job& job, const DrawCall& draw_call) -> void {
+    const Mesh& mesh = *draw_call.m_mesh;
+
+    const std::vector<f32>* positions = mesh.attribute_values(Mesh::POSITION.m_id);
+    if (positions == nullptr) { return; }
+    const std::vector<f32>* colors = mesh.attribute_values(Mesh::COLOR.m_id);
+    const std::vector<f32>* uvs = mesh.attribute_values(Mesh::UV.m_id);
+
+    // Vertex stage, every vertex is transformed exactly once.
+    const u32 vertex_count = static_cast<u32>(positions->size() / 3);
+    job.m_vertices.resize(vertex_count);
+    for (u32 i = 0; i < vertex_count; i++) {
+        Vertex&    vertex = job.m_vertices[i];
+        const f32* p = &(*positions)[i * 3];
+        vertex.m_position = draw_call.m_mvp * v4::create(p[0], p[1], p[2], 1.0F);
+
+        if (colors != nullptr && (i * 4 + 3) < colors->size()) {
+            const f32* c = &(*colors)[i * 4];
+            vertex.m_color = v4::create(c[0], c[1], c[2], c[3]);
+        } else {
+            vertex.m_color = v4::one();
+        }
+        if (uvs != nullptr && (i * 2 + 1) < uvs->size()) {
+            const f32* uv = &(*uvs)[i * 2];
+            vertex.m_uv = v2::create(uv[0], uv[1]);
+        } else {
+            vertex.m_uv = v2::zero();
+        }
+    }
+
+    for_each_triangle(mesh, vertex_count, [&](u32 i0, u32 i1, u32 i2) {
+        job.m_triangles_in++;
+        const std::vector<Vertex>& v = job.m_vertices;
+        clip_triangle(
+            v[i0],
+            v[i1],
+            v[i2],
+            [&](const Vertex& a, const Vertex& b, const Vertex& c) {
+                this->setup_triangle(job, a, b, c);
+            }
+        );
+    });
+}
+
+auto Rasterizer::run_shaded_geometry(Job& job, u32 draw_index, u32 worker) -> void {
+    const ShadedDraw&          draw = job.m_shaded_draws[draw_index];
+    const DrawCall&            draw_call = *draw.m_draw_call;
+    const Mesh&                mesh = *draw_call.m_mesh;
+    const Mesh::AttributeData* positions = mesh.attribute_data(Mesh::POSITION.m_id);
+    if (positions == nullptr) { return; }
+
+    // Vertex stage, `SHADER_LANES` vertices at a time.
+    const ShaderProgram& program = *draw_call.m_vertex;
+    ShaderVM&            vm = this->get_vm(worker, program);
+    const u32            vertex_count = positions->count();
+    job.m_shaded_vertices.resize(vertex_count);
+    for (u32 first = 0; first < vertex_count; first += SHADER_LANES) {
+        const u32 lane_count = std::min(SHADER_LANES, vertex_count - first);
+        for (const ShaderProgram::Variable& input : program.m_inputs) {
+            const Mesh::AttributeData* data = input.m_builtin == SHADER_BUILTIN::NONE
+                                                  ? mesh.attribute_data(input.m_location)
+                                                  : nullptr;
+            for (u32 c = 0; c < input.m_registers.size(); c++) {
+                ShaderVM::Register& reg = vm.get_register(input.m_registers[c]);
+                for (u32 lane = 0; lane < lane_count; lane++) {
+                    reg.m_lanes[lane] = read_vertex_input(input, data, first + lane, c);
+                }
+            }
+        }
+
+        vm.execute(lane_mask(lane_count), draw_call.m_vertex_uniforms, draw.m_textures);
+
+        const std::vector<u16>& position = draw.m_position->m_registers;
+        for (u32 lane = 0; lane < lane_count; lane++) {
+            ShadedVertex& vertex = job.m_shaded_vertices[first + lane];
+            vertex.m_position = v4::create(
+                vm.get_register(position[0]).m_lanes[lane],
+                vm.get_register(position[1]).m_lanes[lane],
+                vm.get_register(position[2]).m_lanes[lane],
+                vm.get_register(position[3]).m_lanes[lane]
+            );
+            for (u32 i = 0; i < draw.m_varying_count; i++) {
+                const u16 reg = draw.m_vertex_registers[i];
+                vertex.m_varyings[i] = reg == ShadedDraw::NO_REGISTER
+                                           ? 0.0F
+                                           : vm.get_register(reg).m_lanes[lane];
+            }
+        }
+    }
+
+    for_each_triangle(mesh, vertex_count, [&](u32 i0, u32 i1, u32 i2) {
+        job.m_triangles_in++;
+        const std::vector<ShadedVertex>& v = job.m_shaded_vertices;
+        clip_triangle(
+            v[i0],
+            v[i1],
+            v[i2],
+            [&](const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c) {
+                this->setup_shaded_triangle(job, draw_index, a, b, c);
+            }
+        );
+    });
+}
+
+auto Rasterizer::ScreenTriangle::plane(f32 f0, f32 f1, f32 f2) const -> Plane {
+    const std::array<f32, 3> f = {f0, f1, f2};
+    const f32 a = f[m_order[0]], b = f[m_order[1]], c = f[m_order[2]];
+    const f32 x0 = m_x[m_order[0]], x1 = m_x[m_order[1]], x2 = m_x[m_order[2]];
+    const f32 y0 = m_y[m_order[0]], y1 = m_y[m_order[1]], y2 = m_y[m_order[2]];
+
+    Plane plane;
+    plane.m_dx = ((b - a) * (y2 - y0) - (c - a) * (y1 - y0)) / m_area;
+    plane.m_dy = ((c - a) * (x1 - x0) - (b - a) * (x2 - x0)) / m_area;
+    plane.m_base = a - plane.m_dx * x0 - plane.m_dy * y0;
+    return plane;
+}
+
+auto Rasterizer::setup_edges(
+    Job&                     job,
+    std::array<const v4*, 3> positions,
+    ScreenTriangle&          screen
+) -> Triangle* {
+    const f32 vp_x = static_cast<f32>(m_viewport.m_x);
+    const f32 vp_y = static_cast<f32>(m_viewport.m_y);
+    const f32 vp_w = static_cast<f32>(m_viewport.m_width);
+    const f32 vp_h = static_cast<f32>(m_viewport.m_height);
+    for (u32 i = 0; i < 3; i++) {
+        const v4& p = *positions[i];
+        screen.m_inv_w[i] = 1.0F / p.w;
+        screen.m_x[i] = vp_x + (p.x * screen.m_inv_w[i] * 0.5F + 0.5F) * vp_w;
+        screen.m_y[i] = vp_y + (0.5F - p.y * screen.m_inv_w[i] * 0.5F) * vp_h;
+    }
+    const std::array<f32, 3>& x = screen.m_x;
+    const std::array<f32, 3>& y = screen.m_y;
+
+    f32 area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (std::abs(area) < MIN_TRIANGLE_AREA) { return nullptr; }
+
+    // There is no face culling, the winding is normalized so inside is always positive.
+    // Counter-clockwise is the front like in OpenGL, the area is negative for it as y
+    // points down on the screen.
+    screen.m_is_front_facing = area < 0.0F;
+    screen.m_order = {0, 1, 2};
+    if (area < 0.0F) {
+        std::swap(screen.m_order[1], screen.m_order[2]);
+        area = -area;
+    }
+    screen.m_area = area;
+    const std::array<u32, 3>& order = screen.m_order;
+    const f32                 x0 = x[order[0]], x1 = x[order[1]], x2 = x[order[2]];
+    const f32                 y0 = y[order[0]], y1 = y[order[1]], y2 = y[order[2]];
+
+    const i32 min_x = std::max(
+        static_cast<i32>(std::floor(std::min({x0, x1, x2}))),
+        static_cast<i32>(m_viewport.m_x)
+    );
+    const i32 min_y = std::max(
+        static_cast<i32>(std::floor(std::min({y0, y1, y2}))),
+        static_cast<i32>(m_viewport.m_y)
+    );
+    const u32 end_x = std::min(m_viewport.m_x + m_viewport.m_width, m_target->m_width);
+    const u32 end_y = std::min(m_viewport.m_y + m_viewport.m_height, m_target->m_height);
+    const i32 max_x = std::min(
+        static_cast<i32>(std::ceil(std::max({x0, x1, x2}))), static_cast<i32>(end_x) - 1
+    );
+    const i32 max_y = std::min(
+        static_cast<i32>(std::ceil(std::max({y0, y1, y2}))), static_cast<i32>(end_y) - 1
+    );
+    if (min_x > max_x || min_y > max_y) { return nullptr; }
+
+    Triangle& tri = job.m_triangles.emplace_back();
+    job.m_shading.emplace_back();
+    tri.m_min_x = min_x;
+    tri.m_min_y = min_y;
+    tri.m_max_x = max_x;
+    tri.m_max_y = max_y;
+
+    // Edge i goes from vertex i to vertex i + 1.
+    const std::array<f32, 3> ex = {x0, x1, x2};
+    const std::array<f32, 3> ey = {y0, y1, y2};
+    for (u32 i = 0; i < 3; i++) {
+        const u32 j = (i + 1) % 3;
+        Plane&    edge = tri.m_edges[i];
+        edge.m_dx = ey[i] - ey[j];
+        edge.m_dy = ex[j] - ex[i];
+        edge.m_base = -(edge.m_dx * ex[i] + edge.m_dy * ey[i]);
+        tri.m_is_top_left[i] =
+            edge.m_dx > 0.0F || (edge.m_dx == 0.0F && edge.m_dy > 0.0F);
+    }
+
+    // z / w is already linear in screen space, it is not divided again.
+    const std::array<f32, 3>& w = screen.m_inv_w;
+    tri.m_attributes[Triangle::DEPTH] = screen.plane(
+        positions[0]->z * w[0], positions[1]->z * w[1], positions[2]->z * w[2]
+    );
+    tri.m_attributes[Triangle::INV_W] = screen.plane(w[0], w[1], w[2]);
+    return &tri;
+}
+
+auto Rasterizer::setup_triangle(
+    Job&          job,
+    const Vertex& v0,
+    const Vertex& v1,
+    const Vertex& v2
+) -> void {
+    ScreenTriangle  screen;
+    const Triangle* tri = this->setup_edges(
+        job, {&v0.m_position, &v1.m_position, &v2.m_position}, screen
+    );
+    if (tri == nullptr) { return; }
+
+    const std::array<f32, 3>& w = screen.m_inv_w;
+    const v4                  c0 = v0.m_color * w[0];
+    const v4                  c1 = v1.m_color * w[1];
+    const v4                  c2 = v2.m_color * w[2];
+
+    auto& attr = job.m_triangles.back().m_attributes;
+    attr[Triangle::R_OVER_W] = screen.plane(c0.x, c1.x, c2.x);
+    attr[Triangle::G_OVER_W] = screen.plane(c0.y, c1.y, c2.y);
+    attr[Triangle::B_OVER_W] = screen.plane(c0.z, c1.z, c2.z);
+    attr[Triangle::A_OVER_W] = screen.plane(c0.w, c1.w, c2.w);
+    attr[Triangle::U_OVER_W] =
+        screen.plane(v0.m_uv.x * w[0], v1.m_uv.x * w[1], v2.m_uv.x * w[2]);
+    attr[Triangle::V_OVER_W] =
+        screen.plane(v0.m_uv.y * w[0], v1.m_uv.y * w[1], v2.m_uv.y * w[2]);
+}
+
+auto Rasterizer::setup_shaded_triangle(
+    Job&                job,
+    u32                 draw_index,
+    const ShadedVertex& v0,
+    const ShadedVertex& v1,
+    const ShadedVertex& v2
+) -> void {
+    ScreenTriangle  screen;
+    const Triangle* tri = this->setup_edges(
+        job, {&v0.m_position, &v1.m_position, &v2.m_position}, screen
+    );
+    if (tri == nullptr) { return; }
+
+    TriangleShading& shading = job.m_shading.back();
+    shading.m_draw = draw_index;
+    shading.m_first_varying = static_cast<u32>(job.m_varyings.size());
+    shading.m_is_front_facing = screen.m_is_front_facing;
+
+    const std::array<f32, 3>& w = screen.m_inv_w;
+    const u32 varying_count = job.m_shaded_draws[draw_index].m_varying_count;
+    for (u32 i = 0; i < varying_count; i++) {
+        job.m_varyings.push_back(screen.plane(
+            v0.m_varyings[i] * w[0], v1.m_varyings[i] * w[1], v2.m_varyings[i] * w[2]
+        ));
+    }
+}
+
+auto Rasterizer::bin_triangle(Job& job, u32 triangle_index) -> void {
+    const Triangle& tri = job.m_triangles[triangle_index];
+    const u32       tile_x0 = static_cast<u32>(tri.m_min_x) / TILE_SIZE;
+    const u32       tile_y0 = static_cast<u32>(tri.m_min_y) / TILE_SIZE;
+    const u32       tile_x1 = static_cast<u32>(tri.m_max_x) / TILE_SIZE;
+    const u32       tile_y1 = static_cast<u32>(tri.m_max_y) / TILE_SIZE;
+
+    for (u32 ty = tile_y0; ty <= tile_y1; ty++) {
+        for (u32 tx = tile_x0; tx <= tile_x1; tx++) {
+            // Reject the tile if it lies completely outside one of the edges. The most
+            // inside corner of the tile decides, which depends on the edge's gradient.
+            const f32 left = static_cast<f32>(tx * TILE_SIZE);
+            const f32 top = static_cast<f32>(ty * TILE_SIZE);
+            const f32 size = static_cast<f32>(TILE_SIZE);
+            bool      is_outside = false;
+            for (const Plane& edge : tri.m_edges) {
+                const f32 cx = edge.m_dx > 0.0F ? left + size : left;
+                const f32 cy = edge.m_dy > 0.0F ? top + size : top;
+                if (edge.at(cx, cy) < 0.0F) {
+                    is_outside = true;
+                    break;
+                }
+            }
+            if (is_outside) { continue; }
+            job.m_bins[ty * m_tiles_x + tx].push_back(triangle_index);
+        }
+    }
+}
+
+auto Rasterizer::rasterize_tile(u32 tile_index, const Clear& clear, u32 worker) -> void {
+    Framebuffer& target = *m_target;
+    const u32    tile_x = (tile_index % m_tiles_x) * TILE_SIZE;
+    const u32    tile_y = (tile_index / m_tiles_x) * TILE_SIZE;
+    const u32    tile_x_end = std::min(tile_x + TILE_SIZE, target.m_width);
+    const u32    tile_y_end = std::min(tile_y + TILE_SIZE, target.m_height);
+
+    if (clear.m_enabled) {
+        target.clear_rect(
+            tile_x, tile_y, tile_x_end, tile_y_end, clear.m_color, clear.m_depth
+        );
+    }
+
+    const RasterTarget raster_target = {
+        .m_color = target.m_color.data(),
+        .m_depth = target.m_depth.data(),
+        .m_coarse_depth = target.m_coarse_depth.data(),
+        .m_width = target.m_width,
+        .m_height = target.m_height,
+        .m_coarse_width = target.m_coarse_width,
+    };
+    for (const Job& job : m_jobs) {
+        for (const u32 triangle_index : job.m_bins[tile_index]) {
+            const Triangle& tri = job.m_triangles[triangle_index];
+            const i32       min_x = std::max(tri.m_min_x, static_cast<i32>(tile_x));
+            const i32       min_y = std::max(tri.m_min_y, static_cast<i32>(tile_y));
+            const i32 max_x = std::min(tri.m_max_x, static_cast<i32>(tile_x_end) - 1);
+            const i32 max_y = std::min(tri.m_max_y, static_cast<i32>(tile_y_end) - 1);
+            if (job.m_shading[triangle_index].m_draw == TriangleShading::FIXED) {
+                m_rasterize_fn(raster_target, tri, min_x, min_y, max_x, max_y);
+            } else {
+                this->shade_triangle(
+                    job, triangle_index, min_x, min_y, max_x, max_y, worker
+                );
+            }
+        }
+    }
+}
+
+auto Rasterizer::shade_triangle(
+    const Job& job,
+    u32        triangle_index,
+    i32        min_x,
+    i32        min_y,
+    i32        max_x,
+    i32        max_y,
+    u32        worker
+) -> void {
+    const Triangle&        tri = job.m_triangles[triangle_index];
+    const TriangleShading& shading = job.m_shading[triangle_index];
+    const ShadedDraw&      draw = job.m_shaded_draws[shading.m_draw];
+    const DrawCall&        draw_call = *draw.m_draw_call;
+    const Plane*           varyings = job.m_varyings.data() + shading.m_first_varying;
+    const auto&            edges = tri.m_edges;
+    const auto&            attr = tri.m_attributes;
+    Framebuffer&           target = *m_target;
+
+    ShaderVM& vm = this->get_vm(worker, *draw_call.m_fragment);
+    if (draw.m_front_facing != nullptr) {
+        const u32 bits = shading.m_is_front_facing ? ~0U : 0U;
+        vm.get_register(draw.m_front_facing->m_registers[0])
+            .m_lanes.fill(std::bit_cast<f32>(bits));
+    }
+    const std::vector<u16>& color = draw.m_color->m_registers;
+
+    // Runs the pixels of a row `SHADER_LANES` at a time. The depth test is done before
+    // the program, which can not write the depth.
+    for (i32 y = min_y; y <= max_y; y++) {
+        const f32    py = static_cast<f32>(y) + 0.5F;
+        const size_t row = static_cast<size_t>(y) * target.m_width;
+        for (i32 first_x = min_x; first_x <= max_x; first_x += SHADER_LANES) {
+            std::array<f32, SHADER_LANES> px;
+            std::array<f32, SHADER_LANES> depth;
+            u32                           mask = 0;
+            for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+                px[lane] = static_cast<f32>(first_x + static_cast<i32>(lane)) + 0.5F;
+                depth[lane] = attr[Triangle::DEPTH].at(px[lane], py);
+                if (first_x + static_cast<i32>(lane) > max_x) { continue; }
+                const size_t index = row + static_cast<size_t>(first_x) + lane;
+                if (is_inside(edges[0].at(px[lane], py), tri.m_is_top_left[0]) &&
+                    is_inside(edges[1].at(px[lane], py), tri.m_is_top_left[1]) &&
+                    is_inside(edges[2].at(px[lane], py), tri.m_is_top_left[2]) &&
+                    depth[lane] < target.m_depth[index]) {
+                    mask |= 1U << lane;
+                }
+            }
+            if (mask == 0) { continue; }
+
+            std::array<f32, SHADER_LANES> inv_w;
+            std::array<f32, SHADER_LANES> w;
+            for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+                inv_w[lane] = attr[Triangle::INV_W].at(px[lane], py);
+                w[lane] = 1.0F / inv_w[lane];
+            }
+            for (u32 i = 0; i < draw.m_varying_count; i++) {
+                ShaderVM::Register& reg = vm.get_register(draw.m_fragment_registers[i]);
+                for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+                    reg.m_lanes[lane] = varyings[i].at(px[lane], py) * w[lane];
+                }
+            }
+            if (draw.m_frag_coord != nullptr) {
+                const std::vector<u16>& frag_coord = draw.m_frag_coord->m_registers;
+                for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+                    const std::array<f32, 4> value = {
+                        px[lane], py, depth[lane], inv_w[lane]
+                    };
+                    for (u32 c = 0; c < frag_coord.size() && c < 4; c++) {
+                        vm.get_register(frag_coord[c]).m_lanes[lane] = value[c];
+                    }
+                }
+            }
+
+            const u32 alive =
+                vm.execute(mask, draw_call.m_fragment_uniforms, draw.m_textures);
+            for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+                if ((alive & (1U << lane)) == 0) { continue; }
+                const f32 alpha =
+                    color.size() > 3 ? vm.get_register(color[3]).m_lanes[lane] : 1.0F;
+                const u32    x = static_cast<u32>(first_x) + lane;
+                const size_t index = row + x;
+                target.m_depth[index] = depth[lane];
+                target.m_color[index] = pack_color(
+                    vm.get_register(color[0]).m_lanes[lane],
+                    vm.get_register(color[1]).m_lanes[lane],
+                    vm.get_register(color[2]).m_lanes[lane],
+                    alpha
+                );
+
+                const u32    bx = x / Framebuffer::COARSE_SIZE;
+                const u32    by = static_cast<u32>(y) / Framebuffer::COARSE_SIZE;
+                DepthBounds& bounds =
+                    target.m_coarse_depth[by * target.m_coarse_width + bx];
+                bounds.m_min = std::min(bounds.m_min, depth[lane]);
+            }
+        }
+    }
+}
+
+} // namespace software
+} // namespace JadeFrame
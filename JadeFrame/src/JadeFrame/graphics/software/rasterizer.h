@@ -0,0 +1,210 @@
+#pragma once
+#include <array>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/mat_4.h"
+#include "JadeFrame/math/vec.h"
+
+#include "framebuffer.h"
+#include "raster_kernel.h"
+#include "shader_program.h"
+
+namespace JadeFrame {
+class Mesh;
+class ThreadPool;
+
+namespace software {
+
+/// Output of the vertex stage, still in clip space.
+struct Vertex {
+    v4 m_position;
+    v4 m_color;
+    v2 m_uv;
+};
+
+/// Output of a vertex program, still in clip space.
+struct ShadedVertex {
+    constexpr static u32 MAX_VARYINGS = 16;
+
+    v4                            m_position;
+    std::array<f32, MAX_VARYINGS> m_varyings;
+};
+
+struct Viewport {
+    u32 m_x = 0;
+    u32 m_y = 0;
+    u32 m_width = 0;
+    u32 m_height = 0;
+};
+
+/*
+    A sort-middle tile rasterizer.
+    The frame is rendered in two parallel phases:
+        1. Geometry: draw calls are split into jobs, each job transforms, clips and sets
+   up its triangles and bins them into the screen tiles they touch.
+        2. Raster: every tile is processed by one worker, which walks the bins of all
+   jobs in submission order, so the result does not depend on the thread count.
+    Draw calls with a vertex and a fragment program run them, `SHADER_LANES` vertices
+   or pixels of a row at a time. The others use the fixed pipeline, which draws the
+   vertex color modulated by the texture with the SIMD kernels.
+*/
+class Rasterizer {
+public:
+    constexpr static u32 TILE_SIZE = 64;
+    /// Limits of a draw call running programs, the fixed pipeline draws those above.
+    constexpr static u32 MAX_UNIFORM_BUFFERS = 4;
+    constexpr static u32 MAX_TEXTURES = 4;
+
+    struct DrawCall {
+        /// Indexed by the uniform buffer slots of a program, empty if not bound.
+        using Uniforms = std::array<std::span<const u8>, MAX_UNIFORM_BUFFERS>;
+
+        mat4x4         m_mvp;
+        const Mesh*    m_mesh = nullptr;
+        const Texture* m_texture = nullptr;
+
+        /// Mesh attributes are the vertex inputs of the same location. The texture is
+        /// bound to every sampled image.
+        const ShaderProgram* m_vertex = nullptr;
+        const ShaderProgram* m_fragment = nullptr;
+        Uniforms             m_vertex_uniforms = {};
+        Uniforms             m_fragment_uniforms = {};
+    };
+
+    struct Clear {
+        bool m_enabled = false;
+        u32  m_color = 0;
+        f32  m_depth = 1.0F;
+    };
+
+    struct Stats {
+        u32 m_triangles_in = 0;
+        u32 m_triangles_setup = 0;
+        u32 m_tiles = 0;
+    };
+
+public:
+    Rasterizer();
+
+    auto draw(
+        Framebuffer&              target,
+        const Viewport&           viewport,
+        std::span<const DrawCall> draw_calls,
+        const Clear&              clear,
+        ThreadPool&               pool
+    ) -> void;
+
+    [[nodiscard]] auto get_stats() const -> const Stats& { return m_stats; }
+
+    /// Unsupported kernels fall back to `RASTER_KERNEL::SCALAR`.
+    auto               set_kernel(RASTER_KERNEL kernel) -> void;
+    [[nodiscard]] auto get_kernel() const -> RASTER_KERNEL { return m_kernel; }
+
+private:
+    /// A draw call running its programs. The vertex outputs are linked to the fragment
+    /// inputs by location, varying `i` is written from and read into the registers `i`.
+    struct ShadedDraw {
+        constexpr static u16 NO_REGISTER = 0xFFFF;
+
+        const DrawCall* m_draw_call = nullptr;
+        u32             m_varying_count = 0;
+        /// `NO_REGISTER` for fragment inputs the vertex program does not write.
+        std::array<u16, ShadedVertex::MAX_VARYINGS> m_vertex_registers = {};
+        std::array<u16, ShadedVertex::MAX_VARYINGS> m_fragment_registers = {};
+        const ShaderProgram::Variable*              m_position = nullptr;
+        const ShaderProgram::Variable*              m_color = nullptr;
+        const ShaderProgram::Variable*              m_frag_coord = nullptr;
+        const ShaderProgram::Variable*              m_front_facing = nullptr;
+        std::array<const Texture*, MAX_TEXTURES>    m_textures = {};
+    };
+
+    /// Per triangle, which shaded draw it belongs to and where its varyings start.
+    struct TriangleShading {
+        constexpr static u32 FIXED = ~0U;
+
+        u32  m_draw = FIXED;
+        u32  m_first_varying = 0;
+        bool m_is_front_facing = true;
+    };
+
+    struct Job {
+        std::vector<Vertex>           m_vertices;
+        std::vector<Triangle>         m_triangles;
+        std::vector<std::vector<u32>> m_bins;
+        u32                           m_triangles_in = 0;
+
+        std::vector<ShadedVertex> m_shaded_vertices;
+        std::vector<ShadedDraw>   m_shaded_draws;
+        /// Same order as `m_triangles`.
+        std::vector<TriangleShading> m_shading;
+        /// The planes of the varyings, divided by w like the other attributes.
+        std::vector<Plane> m_varyings;
+    };
+
+    /// Screen space positions of a triangle during setup.
+    struct ScreenTriangle {
+        std::array<f32, 3> m_x;
+        std::array<f32, 3> m_y;
+        std::array<f32, 3> m_inv_w;
+        /// The vertices in the winding which makes the edge functions positive inside.
+        std::array<u32, 3> m_order = {0, 1, 2};
+        f32                m_area = 0.0F;
+        bool               m_is_front_facing = true;
+
+        /// The plane through the values at the vertices, in the order they were given.
+        [[nodiscard]] auto plane(f32 f0, f32 f1, f32 f2) const -> Plane;
+    };
+
+    /// Fails if a program is missing or needs more than the limits.
+    static auto link_programs(const DrawCall& draw_call, ShadedDraw& out) -> bool;
+
+    auto run_geometry(Job& job, std::span<const DrawCall> draw_calls, u32 worker)
+        -> void;
+    auto run_fixed_geometry(Job& job, const DrawCall& draw_call) -> void;
+    auto run_shaded_geometry(Job& job, u32 draw_index, u32 worker) -> void;
+    auto setup_triangle(Job& job, const Vertex& v0, const Vertex& v1, const Vertex& v2)
+        -> void;
+    auto setup_shaded_triangle(
+        Job&                job,
+        u32                 draw_index,
+        const ShadedVertex& v0,
+        const ShadedVertex& v1,
+        const ShadedVertex& v2
+    ) -> void;
+    /// Adds the triangle with its edges and depth, or returns nullptr if it covers no
+    /// pixel.
+    auto setup_edges(Job& job, std::array<const v4*, 3> positions, ScreenTriangle& screen)
+        -> Triangle*;
+    auto bin_triangle(Job& job, u32 triangle_index) -> void;
+    auto rasterize_tile(u32 tile_index, const Clear& clear, u32 worker) -> void;
+    auto shade_triangle(
+        const Job& job,
+        u32        triangle_index,
+        i32        min_x,
+        i32        min_y,
+        i32        max_x,
+        i32        max_y,
+        u32        worker
+    ) -> void;
+    /// Every worker runs programs in its own VMs, kept as long as the rasterizer.
+    auto get_vm(u32 worker, const ShaderProgram& program) -> ShaderVM&;
+
+private:
+    Framebuffer*     m_target = nullptr;
+    Viewport         m_viewport;
+    u32              m_tiles_x = 0;
+    u32              m_tiles_y = 0;
+    std::vector<Job> m_jobs;
+    Stats            m_stats;
+
+    std::vector<std::unordered_map<const ShaderProgram*, ShaderVM>> m_vms;
+
+    RASTER_KERNEL       m_kernel = RASTER_KERNEL::SCALAR;
+    RasterizeTriangleFn m_rasterize_fn = nullptr;
+};
+
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,1795 @@
+#include "shader_program.h"
+
+#include <algorithm>
+#include <bit>
+#include <numbers>
+#include <string_view>
+#include <utility>
+
+#include "JadeFrame/graphics/graphics_language.h"
+#include "JadeFrame/graphics/reflect.h"
+#include "JadeFrame/utils/logger.h"
+#include "JadeFrame/utils/utils.h"
+
+#include "SPIRV-Cross/GLSL.std.450.h"
+#include "SPIRV-Cross/spirv.hpp"
+
+namespace JadeFrame {
+namespace software {
+
+auto ShaderProgram::find_input(u32 location) const -> const Variable* {
+    for (const Variable& input : m_inputs) {
+        if (input.m_builtin == SHADER_BUILTIN::NONE && input.m_location == location) {
+            return &input;
+        }
+    }
+    return nullptr;
+}
+
+auto ShaderProgram::find_input(SHADER_BUILTIN builtin) const -> const Variable* {
+    for (const Variable& input : m_inputs) {
+        if (input.m_builtin == builtin) { return &input; }
+    }
+    return nullptr;
+}
+
+auto ShaderProgram::find_output(u32 location) const -> const Variable* {
+    for (const Variable& output : m_outputs) {
+        if (output.m_builtin == SHADER_BUILTIN::NONE && output.m_location == location) {
+            return &output;
+        }
+    }
+    return nullptr;
+}
+
+auto ShaderProgram::find_output(SHADER_BUILTIN builtin) const -> const Variable* {
+    for (const Variable& output : m_outputs) {
+        if (output.m_builtin == builtin) { return &output; }
+    }
+    return nullptr;
+}
+
+/*---------------------------
+    Translator
+---------------------------*/
+
+namespace {
+
+constexpr u32 NO_VALUE = ~0U;
+constexpr u32 MAX_REGISTERS = 0xFFFF;
+// Never allocated, `MAX_REGISTERS` keeps the last one free.
+constexpr u16 NO_REGISTER = 0xFFFF;
+// SPIR-V does not allow recursion, this only guards against broken modules.
+constexpr u32 MAX_CALL_DEPTH = 64;
+// Matrices in uniform buffers without a MatrixStride decoration are packed vec4s.
+constexpr u32 DEFAULT_MATRIX_STRIDE = 16;
+
+struct Type {
+    enum KIND : u8 {
+        VOID,
+        BOOL,
+        INT,
+        FLOAT,
+        VECTOR,
+        MATRIX,
+        ARRAY,
+        STRUCT,
+        POINTER,
+        IMAGE,
+        SAMPLED_IMAGE,
+        SAMPLER,
+        FUNCTION,
+    };
+
+    KIND m_kind = VOID;
+    /// Component of a vector, column of a matrix, element of an array, pointee.
+    u32  m_element = 0;
+    /// Components of a vector, columns of a matrix, length of an array.
+    u32  m_count = 0;
+    /// How many registers a value of the type takes.
+    u32  m_size = 0;
+
+    std::vector<u32> m_members;
+};
+
+struct Decoration {
+    u32 m_location = NO_VALUE;
+    u32 m_builtin = NO_VALUE;
+    u32 m_binding = 0;
+    u32 m_set = 0;
+    u32 m_array_stride = 0;
+};
+
+struct MemberDecoration {
+    u32  m_offset = 0;
+    u32  m_matrix_stride = DEFAULT_MATRIX_STRIDE;
+    bool m_is_row_major = false;
+    u32  m_builtin = NO_VALUE;
+};
+
+/// What an id stands for while translating.
+struct Value {
+    enum KIND : u8 {
+        NONE,
+        REGISTERS,
+        // Points at components [m_first, m_first + size) of variable `m_index`.
+        VARIABLE,
+        // Points at byte `m_offset` of uniform buffer `m_index`, plus the per lane offset
+        // in register `m_dynamic_offset` if it was indexed by a variable.
+        UNIFORM,
+        // Texture slot `m_index`, both the variable and the loaded value.
+        TEXTURE,
+    };
+
+    KIND m_kind = NONE;
+    /// Type of the value, for pointers the type pointed at.
+    u32  m_type = 0;
+
+    std::vector<u16> m_registers = {};
+
+    u32  m_index = 0;
+    u32  m_first = 0;
+    u32  m_offset = 0;
+    u32  m_matrix_stride = DEFAULT_MATRIX_STRIDE;
+    bool m_is_row_major = false;
+    // The components of a column of a row major matrix are a matrix stride apart.
+    u32  m_vector_stride = 4;
+    u16  m_dynamic_offset = NO_REGISTER;
+};
+
+struct Block {
+    u32              m_label = 0;
+    size_t           m_begin = 0;
+    size_t           m_terminator = 0;
+    std::vector<u32> m_successors = {};
+};
+
+struct Function {
+    std::vector<u32>   m_parameters;
+    std::vector<Block> m_blocks;
+};
+
+struct Instruction {
+    spv::Op              m_op;
+    std::span<const u32> m_words;
+
+    [[nodiscard]] auto operand(size_t index) const -> u32 {
+        return index + 1 < m_words.size() ? m_words[index + 1] : 0;
+    }
+
+    [[nodiscard]] auto operand_count() const -> size_t { return m_words.size() - 1; }
+};
+
+auto to_builtin(u32 builtin) -> SHADER_BUILTIN {
+    switch (builtin) {
+        case spv::BuiltInPosition: return SHADER_BUILTIN::POSITION;
+        case spv::BuiltInPointSize: return SHADER_BUILTIN::POINT_SIZE;
+        case spv::BuiltInFragCoord: return SHADER_BUILTIN::FRAG_COORD;
+        case spv::BuiltInFrontFacing: return SHADER_BUILTIN::FRONT_FACING;
+        case spv::BuiltInVertexIndex: return SHADER_BUILTIN::VERTEX_INDEX;
+        case spv::BuiltInInstanceIndex: return SHADER_BUILTIN::INSTANCE_INDEX;
+        default: return SHADER_BUILTIN::NONE;
+    }
+}
+
+auto decode_string(std::span<const u32> words) -> std::string_view {
+    const auto*  chars = reinterpret_cast<const char*>(words.data());
+    const size_t max_length = words.size() * sizeof(u32);
+    size_t       length = 0;
+    while (length < max_length && chars[length] != '\0') { length++; }
+    return {chars, length};
+}
+
+class Translator {
+public:
+    Translator(
+        std::span<const u32>   code,
+        SHADER_STAGE           stage,
+        const ReflectedModule& reflected,
+        ShaderProgram&         program
+    )
+        : m_code(code)
+        , m_stage(stage)
+        , m_reflected(&reflected)
+        , m_program(&program) {}
+
+    auto translate() -> bool;
+
+public:
+    std::string m_error;
+
+private:
+    /// State of the function being inlined.
+    struct Frame {
+        const Function*              m_function = nullptr;
+        std::unordered_map<u32, u32> m_block_of = {};
+        /// Masks of the edges into every block, with the block they come from.
+        std::vector<std::vector<std::pair<u32, u16>>> m_edges = {};
+        u32                                           m_block = 0;
+        std::vector<u16>                              m_return_value = {};
+    };
+
+    auto fail(std::string message) -> bool {
+        if (m_error.empty()) { m_error = std::move(message); }
+        return false;
+    }
+
+    [[nodiscard]] auto is_failed() const -> bool { return !m_error.empty(); }
+
+    [[nodiscard]] auto instruction_at(size_t at) const -> Instruction {
+        return {
+            .m_op = static_cast<spv::Op>(m_code[at] & 0xFFFF),
+            .m_words = m_code.subspan(at, m_code[at] >> 16),
+        };
+    }
+
+    auto parse() -> bool;
+    auto parse_variable(const Instruction& in) -> bool;
+    auto add_variable(u32 id, u32 type, u32 initializer) -> void;
+    auto collect_interface() -> bool;
+
+    auto translate_function(
+        u32                  function_id,
+        u16                  entry_mask,
+        std::span<const u32> arguments,
+        std::vector<u16>*    out_result
+    ) -> bool;
+    auto sort_blocks(const Frame& frame, std::vector<u32>& out_order) -> bool;
+    auto translate_terminator(Frame& frame, const Instruction& in) -> bool;
+    auto translate_instruction(const Instruction& in) -> bool;
+    auto translate_access_chain(const Instruction& in) -> bool;
+    auto translate_extended(const Instruction& in) -> bool;
+    auto translate_phi(const Instruction& in) -> bool;
+    auto load_uniform(const Value& pointer, u32 type_id, std::vector<u16>& out) -> void;
+
+    auto allocate(u32 count) -> u16;
+    auto constant(u32 bits) -> u16;
+    auto constant(f32 value) -> u16 { return this->constant(std::bit_cast<u32>(value)); }
+    auto emit(SHADER_OPCODE opcode, u16 a, u16 b = 0, u16 c = 0) -> u16;
+    auto select(u16 mask, u16 if_true, u16 if_false) -> u16 {
+        return this->emit(SHADER_OPCODE::SELECT, mask, if_true, if_false);
+    }
+    auto dot(std::span<const u16> a, std::span<const u16> b) -> u16;
+
+    auto get_value(u32 id) -> Value&;
+    auto get_registers(u32 id) -> const std::vector<u16>&;
+    auto get_type(u32 id) -> const Type&;
+
+private:
+    std::span<const u32>   m_code;
+    SHADER_STAGE           m_stage;
+    const ReflectedModule* m_reflected;
+    ShaderProgram*         m_program;
+
+    std::vector<Type>                                      m_types;
+    std::vector<Decoration>                                m_decorations;
+    std::unordered_map<u32, std::vector<MemberDecoration>> m_member_decorations;
+    std::vector<Value>                                     m_values;
+    std::unordered_map<u32, u32>                           m_scalar_constants;
+    std::unordered_map<u32, Function>                      m_functions;
+    std::unordered_map<u32, u16>                           m_constant_registers;
+
+    u32 m_glsl_std_450 = NO_VALUE;
+    u32 m_entry_point = NO_VALUE;
+
+    std::vector<u32> m_inputs;
+    std::vector<u32> m_outputs;
+    /// The registers currently holding the components of every variable. Stores do not
+    /// write into them but replace them, so loads are free.
+    std::vector<std::vector<u16>> m_variables;
+
+    /// Mask of the lanes which run the current block.
+    u16    m_mask = 0;
+    u16    m_discard = 0;
+    Frame* m_frame = nullptr;
+    u32    m_call_depth = 0;
+};
+
+auto Translator::allocate(u32 count) -> u16 {
+    if (m_program->m_register_count + count > MAX_REGISTERS) {
+        this->fail("the shader needs too many registers");
+        return 0;
+    }
+    const u32 first = m_program->m_register_count;
+    m_program->m_register_count += count;
+    return static_cast<u16>(first);
+}
+
+auto Translator::constant(u32 bits) -> u16 {
+    if (auto it = m_constant_registers.find(bits); it != m_constant_registers.end()) {
+        return it->second;
+    }
+    const u16 reg = this->allocate(1);
+    m_program->m_constants.push_back({.m_register = reg, .m_bits = bits});
+    m_constant_registers.emplace(bits, reg);
+    return reg;
+}
+
+auto Translator::emit(SHADER_OPCODE opcode, u16 a, u16 b, u16 c) -> u16 {
+    const u16 dst = this->allocate(1);
+    m_program->m_code.push_back(
+        {.m_opcode = opcode, .m_dst = dst, .m_a = a, .m_b = b, .m_c = c}
+    );
+    return dst;
+}
+
+auto Translator::dot(std::span<const u16> a, std::span<const u16> b) -> u16 {
+    u16 sum = this->emit(SHADER_OPCODE::F_MUL, a[0], b[0]);
+    for (size_t i = 1; i < a.size() && i < b.size(); i++) {
+        const u16 product = this->emit(SHADER_OPCODE::F_MUL, a[i], b[i]);
+        sum = this->emit(SHADER_OPCODE::F_ADD, sum, product);
+    }
+    return sum;
+}
+
+auto Translator::get_value(u32 id) -> Value& {
+    static Value none;
+    if (id >= m_values.size()) {
+        this->fail(fmt::format("%{} is out of bounds", id));
+        none = {};
+        return none;
+    }
+    return m_values[id];
+}
+
+auto Translator::get_registers(u32 id) -> const std::vector<u16>& {
+    // Big enough for every type the callers index into, so they do not have to check.
+    // The error is reported either way.
+    static const std::vector<u16> none(16, 0);
+    if (id >= m_values.size() || m_values[id].m_kind != Value::REGISTERS ||
+        m_values[id].m_registers.empty()) {
+        this->fail(fmt::format("%{} is not a value", id));
+        return none;
+    }
+    return m_values[id].m_registers;
+}
+
+auto Translator::get_type(u32 id) -> const Type& {
+    static const Type none;
+    if (id >= m_types.size()) {
+        this->fail(fmt::format("%{} is not a type", id));
+        return none;
+    }
+    return m_types[id];
+}
+
+/*---------------------------
+    Parsing
+---------------------------*/
+
+// Collects types, decorations, constants, global variables and the blocks of every
+// function. Function bodies are translated later, when they are inlined.
+auto Translator::parse() -> bool {
+    if (m_code.size() < 5 || m_code[0] != spv::MagicNumber) {
+        return this->fail("the code is not SPIR-V");
+    }
+    if (m_stage != SHADER_STAGE::VERTEX && m_stage != SHADER_STAGE::FRAGMENT) {
+        const char* stage = to_string(m_stage);
+        return this->fail(fmt::format("{} shaders are not supported", stage));
+    }
+    const u32 bound = m_code[3];
+    m_types.resize(bound);
+    m_decorations.resize(bound);
+    m_values.resize(bound);
+
+    const u32 model = m_stage == SHADER_STAGE::VERTEX ? spv::ExecutionModelVertex
+                                                      : spv::ExecutionModelFragment;
+    Function* function = nullptr;
+    for (size_t at = 5; at < m_code.size();) {
+        const u32 word_count = m_code[at] >> 16;
+        if (word_count == 0 || at + word_count > m_code.size()) {
+            return this->fail("malformed instruction");
+        }
+        const Instruction in = this->instruction_at(at);
+        const u32         id_1 = in.operand(0);
+        const u32         id_2 = in.operand(1);
+
+        switch (in.m_op) {
+            case spv::OpExtInstImport: {
+                if (decode_string(in.m_words.subspan(2)) == "GLSL.std.450") {
+                    m_glsl_std_450 = id_1;
+                }
+            } break;
+            case spv::OpEntryPoint: {
+                if (id_1 == model && m_entry_point == NO_VALUE) { m_entry_point = id_2; }
+            } break;
+            case spv::OpDecorate: {
+                if (id_1 >= bound) { return this->fail("decoration out of bounds"); }
+                Decoration& deco = m_decorations[id_1];
+                switch (id_2) {
+                    case spv::DecorationLocation: deco.m_location = in.operand(2); break;
+                    case spv::DecorationBuiltIn: deco.m_builtin = in.operand(2); break;
+                    case spv::DecorationBinding: deco.m_binding = in.operand(2); break;
+                    case spv::DecorationDescriptorSet: deco.m_set = in.operand(2); break;
+                    case spv::DecorationArrayStride:
+                        deco.m_array_stride = in.operand(2);
+                        break;
+                    default: break;
+                }
+            } break;
+            case spv::OpMemberDecorate: {
+                if (id_2 > MAX_REGISTERS) { return this->fail("member out of bounds"); }
+                std::vector<MemberDecoration>& members = m_member_decorations[id_1];
+                if (members.size() <= id_2) { members.resize(id_2 + 1); }
+                MemberDecoration& deco = members[id_2];
+                switch (in.operand(2)) {
+                    case spv::DecorationOffset: deco.m_offset = in.operand(3); break;
+                    case spv::DecorationMatrixStride:
+                        deco.m_matrix_stride = in.operand(3);
+                        break;
+                    case spv::DecorationRowMajor: deco.m_is_row_major = true; break;
+                    case spv::DecorationColMajor: deco.m_is_row_major = false; break;
+                    case spv::DecorationBuiltIn: deco.m_builtin = in.operand(3); break;
+                    default: break;
+                }
+            } break;
+
+            case spv::OpTypeVoid:
+            case spv::OpTypeBool:
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+            case spv::OpTypeVector:
+            case spv::OpTypeMatrix:
+            case spv::OpTypeArray:
+            case spv::OpTypeStruct:
+            case spv::OpTypePointer:
+            case spv::OpTypeImage:
+            case spv::OpTypeSampler:
+            case spv::OpTypeSampledImage:
+            case spv::OpTypeFunction: {
+                if (id_1 >= bound) { return this->fail("type out of bounds"); }
+                Type type;
+                switch (in.m_op) {
+                    case spv::OpTypeVoid: type.m_kind = Type::VOID; break;
+                    case spv::OpTypeBool: {
+                        type.m_kind = Type::BOOL;
+                        type.m_size = 1;
+                    } break;
+                    case spv::OpTypeInt:
+                    case spv::OpTypeFloat: {
+                        if (id_2 != 32) {
+                            return this->fail("only 32 bit numbers are supported");
+                        }
+                        type.m_kind = in.m_op == spv::OpTypeInt ? Type::INT : Type::FLOAT;
+                        type.m_size = 1;
+                    } break;
+                    case spv::OpTypeVector:
+                    case spv::OpTypeMatrix: {
+                        type.m_kind =
+                            in.m_op == spv::OpTypeVector ? Type::VECTOR : Type::MATRIX;
+                        type.m_element = id_2;
+                        type.m_count = in.operand(2);
+                        type.m_size = this->get_type(id_2).m_size * type.m_count;
+                    } break;
+                    case spv::OpTypeArray: {
+                        auto length = m_scalar_constants.find(in.operand(2));
+                        if (length == m_scalar_constants.end()) {
+                            return this->fail("array lengths must be constants");
+                        }
+                        type.m_kind = Type::ARRAY;
+                        type.m_element = id_2;
+                        type.m_count = length->second;
+                        type.m_size = this->get_type(id_2).m_size * type.m_count;
+                    } break;
+                    case spv::OpTypeStruct: {
+                        type.m_kind = Type::STRUCT;
+                        for (size_t i = 1; i < in.operand_count(); i++) {
+                            type.m_members.push_back(in.operand(i));
+                            type.m_size += this->get_type(in.operand(i)).m_size;
+                        }
+                    } break;
+                    case spv::OpTypePointer: {
+                        type.m_kind = Type::POINTER;
+                        type.m_element = in.operand(2);
+                    } break;
+                    case spv::OpTypeImage: type.m_kind = Type::IMAGE; break;
+                    case spv::OpTypeSampler: type.m_kind = Type::SAMPLER; break;
+                    case spv::OpTypeSampledImage: {
+                        type.m_kind = Type::SAMPLED_IMAGE;
+                    } break;
+                    default: type.m_kind = Type::FUNCTION; break;
+                }
+                if (type.m_size > MAX_REGISTERS) { return this->fail("type is too big"); }
+                m_types[id_1] = std::move(type);
+            } break;
+
+            case spv::OpConstant:
+            case spv::OpSpecConstant:
+            case spv::OpConstantTrue:
+            case spv::OpConstantFalse:
+            case spv::OpSpecConstantTrue:
+            case spv::OpSpecConstantFalse:
+            case spv::OpConstantComposite:
+            case spv::OpSpecConstantComposite:
+            case spv::OpConstantNull:
+            case spv::OpUndef: {
+                // Undefs inside functions are translated with the function.
+                if (function != nullptr) { break; }
+                if (id_2 >= bound) { return this->fail("constant out of bounds"); }
+                Value value = {.m_kind = Value::REGISTERS, .m_type = id_1};
+                switch (in.m_op) {
+                    case spv::OpConstant:
+                    case spv::OpSpecConstant: {
+                        m_scalar_constants[id_2] = in.operand(2);
+                        value.m_registers = {this->constant(in.operand(2))};
+                    } break;
+                    case spv::OpConstantTrue:
+                    case spv::OpSpecConstantTrue: {
+                        value.m_registers = {this->constant(~0U)};
+                    } break;
+                    case spv::OpConstantFalse:
+                    case spv::OpSpecConstantFalse: {
+                        value.m_registers = {this->constant(0U)};
+                    } break;
+                    case spv::OpConstantComposite:
+                    case spv::OpSpecConstantComposite: {
+                        for (size_t i = 2; i < in.operand_count(); i++) {
+                            const auto& part = this->get_registers(in.operand(i));
+                            value.m_registers.insert(
+                                value.m_registers.end(), part.begin(), part.end()
+                            );
+                        }
+                    } break;
+                    default: {
+                        const u32 size = this->get_type(id_1).m_size;
+                        value.m_registers.assign(size, this->constant(0U));
+                    } break;
+                }
+                m_values[id_2] = std::move(value);
+            } break;
+
+            case spv::OpVariable: {
+                if (function == nullptr && !this->parse_variable(in)) { return false; }
+            } break;
+
+            case spv::OpFunction: function = &m_functions[id_2]; break;
+            case spv::OpFunctionParameter: {
+                if (function == nullptr) {
+                    return this->fail("parameter outside function");
+                }
+                function->m_parameters.push_back(id_2);
+            } break;
+            case spv::OpLabel: {
+                if (function == nullptr) { return this->fail("label outside function"); }
+                function->m_blocks.push_back(
+                    {.m_label = id_1, .m_begin = at + word_count}
+                );
+            } break;
+            case spv::OpBranch:
+            case spv::OpBranchConditional:
+            case spv::OpSwitch:
+            case spv::OpReturn:
+            case spv::OpReturnValue:
+            case spv::OpKill:
+            case spv::OpTerminateInvocation:
+            case spv::OpUnreachable: {
+                if (function == nullptr || function->m_blocks.empty()) {
+                    return this->fail("terminator outside block");
+                }
+                Block& block = function->m_blocks.back();
+                block.m_terminator = at;
+                if (in.m_op == spv::OpBranch) {
+                    block.m_successors = {id_1};
+                } else if (in.m_op == spv::OpBranchConditional) {
+                    block.m_successors = {id_2, in.operand(2)};
+                } else if (in.m_op == spv::OpSwitch) {
+                    block.m_successors = {id_2};
+                    for (size_t i = 3; i < in.operand_count(); i += 2) {
+                        block.m_successors.push_back(in.operand(i));
+                    }
+                }
+            } break;
+            case spv::OpFunctionEnd: function = nullptr; break;
+            default: break;
+        }
+        if (this->is_failed()) { return false; }
+        at += word_count;
+    }
+
+    if (m_entry_point == NO_VALUE || !m_functions.contains(m_entry_point)) {
+        return this->fail(fmt::format("no {} entry point", to_string(m_stage)));
+    }
+    return true;
+}
+
+auto Translator::add_variable(u32 id, u32 type, u32 initializer) -> void {
+    m_values[id] = {
+        .m_kind = Value::VARIABLE,
+        .m_type = type,
+        .m_index = static_cast<u32>(m_variables.size()),
+    };
+    if (initializer != NO_VALUE) {
+        m_variables.push_back(this->get_registers(initializer));
+        return;
+    }
+    // Inputs are written into these registers before the shader runs.
+    const u32        size = this->get_type(type).m_size;
+    const u16        first = this->allocate(size);
+    std::vector<u16> registers(size);
+    for (u32 i = 0; i < size; i++) { registers[i] = static_cast<u16>(first + i); }
+    m_variables.push_back(std::move(registers));
+}
+
+auto Translator::parse_variable(const Instruction& in) -> bool {
+    const u32 id = in.operand(1);
+    const u32 storage = in.operand(2);
+    if (id >= m_values.size()) { return this->fail("variable out of bounds"); }
+    const u32         type = this->get_type(in.operand(0)).m_element;
+    const Decoration& deco = m_decorations[id];
+
+    switch (storage) {
+        case spv::StorageClassInput:
+        case spv::StorageClassOutput:
+        case spv::StorageClassPrivate: {
+            const u32 initializer = in.operand_count() > 3 ? in.operand(3) : NO_VALUE;
+            this->add_variable(id, type, initializer);
+            if (storage == spv::StorageClassInput) { m_inputs.push_back(id); }
+            if (storage == spv::StorageClassOutput) { m_outputs.push_back(id); }
+        } break;
+        case spv::StorageClassUniform: {
+            const auto& buffers = m_reflected->m_uniform_buffers;
+            for (u32 i = 0; i < buffers.size(); i++) {
+                const auto& buffer = buffers[i];
+                if (buffer.set == deco.m_set && buffer.binding == deco.m_binding) {
+                    m_values[id] = {
+                        .m_kind = Value::UNIFORM,
+                        .m_type = type,
+                        .m_index = i,
+                    };
+                }
+            }
+            if (m_values[id].m_kind == Value::NONE) {
+                return this->fail(fmt::format(
+                    "uniform buffer (set {}, binding {}) is not reflected",
+                    deco.m_set,
+                    deco.m_binding
+                ));
+            }
+        } break;
+        case spv::StorageClassUniformConstant: {
+            const auto& images = m_reflected->m_sampled_images;
+            for (u32 i = 0; i < images.size(); i++) {
+                if (images[i].set == deco.m_set && images[i].binding == deco.m_binding) {
+                    m_values[id] = {
+                        .m_kind = Value::TEXTURE,
+                        .m_type = type,
+                        .m_index = i,
+                    };
+                }
+            }
+            if (m_values[id].m_kind == Value::NONE) {
+                return this->fail(fmt::format(
+                    "sampled image (set {}, binding {}) is not reflected",
+                    deco.m_set,
+                    deco.m_binding
+                ));
+            }
+        } break;
+        default: {
+            return this->fail(fmt::format("storage class {} is not supported", storage));
+        }
+    }
+    return !this->is_failed();
+}
+
+// Lists the registers of the inputs and outputs. For outputs these are the ones holding
+// the last value stored.
+auto Translator::collect_interface() -> bool {
+    for (const bool is_input : {true, false}) {
+        std::vector<ShaderProgram::Variable>& list =
+            is_input ? m_program->m_inputs : m_program->m_outputs;
+        for (const u32 id : is_input ? m_inputs : m_outputs) {
+            const Value&            value = m_values[id];
+            const std::vector<u16>& registers = m_variables[value.m_index];
+            const Decoration&       deco = m_decorations[id];
+            if (deco.m_location != NO_VALUE) {
+                list.push_back({.m_location = deco.m_location, .m_registers = registers});
+                continue;
+            }
+
+            // Builtins are either decorated directly or members of a block, like
+            // gl_PerVertex.
+            std::vector<std::pair<u32, std::span<const u16>>> builtins;
+            auto members = m_member_decorations.find(value.m_type);
+            if (deco.m_builtin != NO_VALUE) {
+                builtins.emplace_back(deco.m_builtin, registers);
+            } else if (members != m_member_decorations.end()) {
+                const Type& type = this->get_type(value.m_type);
+                u32         first = 0;
+                for (u32 m = 0; m < type.m_members.size(); m++) {
+                    const u32 size = this->get_type(type.m_members[m]).m_size;
+                    if (m < members->second.size() &&
+                        members->second[m].m_builtin != NO_VALUE) {
+                        builtins.emplace_back(
+                            members->second[m].m_builtin,
+                            std::span(registers).subspan(first, size)
+                        );
+                    }
+                    first += size;
+                }
+            }
+            for (const auto& [spirv_builtin, builtin_registers] : builtins) {
+                const SHADER_BUILTIN builtin = to_builtin(spirv_builtin);
+                if (builtin == SHADER_BUILTIN::NONE) {
+                    // Unknown outputs, like gl_ClipDistance, can be left out. Unknown
+                    // inputs would read garbage.
+                    if (is_input) {
+                        return this->fail(fmt::format(
+                            "builtin input {} is not supported", spirv_builtin
+                        ));
+                    }
+                    continue;
+                }
+                list.push_back({
+                    .m_builtin = builtin,
+                    .m_registers = {builtin_registers.begin(), builtin_registers.end()},
+                });
+            }
+        }
+    }
+    return !this->is_failed();
+}
+
+auto Translator::translate() -> bool {
+    m_program->m_live_mask = this->allocate(1);
+    if (!this->parse()) { return false; }
+
+    for (const auto& buffer : m_reflected->m_uniform_buffers) {
+        m_program->m_uniform_buffers.push_back(
+            {.m_set = buffer.set, .m_binding = buffer.binding, .m_size = buffer.size}
+        );
+    }
+    for (const auto& image : m_reflected->m_sampled_images) {
+        m_program->m_sampled_images.push_back(
+            {.m_set = image.set, .m_binding = image.binding, .m_size = image.size}
+        );
+    }
+
+    m_discard = this->constant(0U);
+    if (!this->translate_function(m_entry_point, m_program->m_live_mask, {}, nullptr)) {
+        return false;
+    }
+    m_program->m_discard_mask = m_discard;
+    return this->collect_interface();
+}
+
+/*---------------------------
+    Control flow
+---------------------------*/
+
+// Orders the blocks so that every block comes after its predecessors, which is only
+// possible without loops.
+auto Translator::sort_blocks(const Frame& frame, std::vector<u32>& out_order) -> bool {
+    enum STATE : u8 {
+        NEW,
+        VISITING,
+        DONE,
+    };
+    const std::vector<Block>&           blocks = frame.m_function->m_blocks;
+    std::vector<STATE>                  state(blocks.size(), NEW);
+    std::vector<std::pair<u32, size_t>> stack = {{0, 0}};
+    std::vector<u32>                    post_order;
+    state[0] = VISITING;
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const std::vector<u32>& successors = blocks[block].m_successors;
+        if (next == successors.size()) {
+            state[block] = DONE;
+            post_order.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        auto it = frame.m_block_of.find(successors[next++]);
+        if (it == frame.m_block_of.end()) {
+            return this->fail("branch to unknown block");
+        }
+        if (state[it->second] == VISITING) {
+            return this->fail("loops are not supported");
+        }
+        if (state[it->second] == NEW) {
+            state[it->second] = VISITING;
+            stack.emplace_back(it->second, 0);
+        }
+    }
+    out_order.assign(post_order.rbegin(), post_order.rend());
+    return true;
+}
+
+// Inlines a function. Every block runs with the mask of the lanes reaching it, so the
+// generated code has no jumps.
+auto Translator::translate_function(
+    u32                  function_id,
+    u16                  entry_mask,
+    std::span<const u32> arguments,
+    std::vector<u16>*    out_result
+) -> bool {
+    auto it = m_functions.find(function_id);
+    if (it == m_functions.end() || it->second.m_blocks.empty()) {
+        return this->fail(fmt::format("%{} is not a function", function_id));
+    }
+    const Function& function = it->second;
+    if (arguments.size() != function.m_parameters.size()) {
+        return this->fail("wrong number of arguments");
+    }
+    if (m_call_depth >= MAX_CALL_DEPTH) {
+        return this->fail("calls are nested too deep");
+    }
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const Value argument = this->get_value(arguments[i]);
+        this->get_value(function.m_parameters[i]) = argument;
+    }
+
+    Frame frame = {.m_function = &function};
+    for (u32 i = 0; i < function.m_blocks.size(); i++) {
+        frame.m_block_of[function.m_blocks[i].m_label] = i;
+    }
+    frame.m_edges.resize(function.m_blocks.size());
+    std::vector<u32> order;
+    if (!this->sort_blocks(frame, order)) { return false; }
+
+    Frame* const caller = std::exchange(m_frame, &frame);
+    const u16    caller_mask = m_mask;
+    m_call_depth++;
+
+    bool is_ok = true;
+    for (const u32 index : order) {
+        const Block& block = function.m_blocks[index];
+        frame.m_block = index;
+        if (index == 0) {
+            m_mask = entry_mask;
+        } else {
+            const auto& edges = frame.m_edges[index];
+            m_mask = edges[0].second;
+            for (size_t i = 1; i < edges.size(); i++) {
+                m_mask = this->emit(SHADER_OPCODE::OR, m_mask, edges[i].second);
+            }
+        }
+
+        for (size_t at = block.m_begin; is_ok && at < block.m_terminator;
+             at += m_code[at] >> 16) {
+            is_ok = this->translate_instruction(this->instruction_at(at));
+        }
+        if (!is_ok) { break; }
+        const Instruction terminator = this->instruction_at(block.m_terminator);
+        if (!this->translate_terminator(frame, terminator)) {
+            is_ok = false;
+            break;
+        }
+    }
+
+    m_call_depth--;
+    m_frame = caller;
+    m_mask = caller_mask;
+    if (out_result != nullptr) { *out_result = std::move(frame.m_return_value); }
+    return is_ok;
+}
+
+auto Translator::translate_terminator(Frame& frame, const Instruction& in) -> bool {
+    auto add_edge = [&](u32 label, u16 mask) {
+        auto& incoming = frame.m_edges[frame.m_block_of[label]];
+        for (auto& [from, edge_mask] : incoming) {
+            // Several switch cases can lead to the same block.
+            if (from == frame.m_block) {
+                edge_mask = this->emit(SHADER_OPCODE::OR, edge_mask, mask);
+                return;
+            }
+        }
+        incoming.emplace_back(frame.m_block, mask);
+    };
+
+    switch (in.m_op) {
+        case spv::OpBranch: add_edge(in.operand(0), m_mask); break;
+        case spv::OpBranchConditional: {
+            const u32 if_true = in.operand(1);
+            const u32 if_false = in.operand(2);
+            if (if_true == if_false) {
+                add_edge(if_true, m_mask);
+                break;
+            }
+            const u16 condition = this->get_registers(in.operand(0))[0];
+            add_edge(if_true, this->emit(SHADER_OPCODE::AND, m_mask, condition));
+            add_edge(if_false, this->emit(SHADER_OPCODE::AND_NOT, m_mask, condition));
+        } break;
+        case spv::OpSwitch: {
+            const u16 selector = this->get_registers(in.operand(0))[0];
+            u16       matched = this->constant(0U);
+            for (size_t i = 2; i + 1 < in.operand_count(); i += 2) {
+                const u16 value = this->constant(in.operand(i));
+                const u16 is_equal = this->emit(SHADER_OPCODE::I_EQUAL, selector, value);
+                matched = this->emit(SHADER_OPCODE::OR, matched, is_equal);
+                const u16 mask = this->emit(SHADER_OPCODE::AND, m_mask, is_equal);
+                add_edge(in.operand(i + 1), mask);
+            }
+            add_edge(in.operand(1), this->emit(SHADER_OPCODE::AND_NOT, m_mask, matched));
+        } break;
+        case spv::OpReturnValue: {
+            // Lanes return in different blocks, the values are merged by mask.
+            const std::vector<u16>& value = this->get_registers(in.operand(0));
+            std::vector<u16>&       result = frame.m_return_value;
+            if (result.empty()) {
+                result = value;
+            } else {
+                for (size_t i = 0; i < value.size() && i < result.size(); i++) {
+                    result[i] = this->select(m_mask, value[i], result[i]);
+                }
+            }
+        } break;
+        case spv::OpKill:
+        case spv::OpTerminateInvocation: {
+            m_discard = this->emit(SHADER_OPCODE::OR, m_discard, m_mask);
+        } break;
+        case spv::OpReturn:
+        case spv::OpUnreachable: break;
+        default: return this->fail("unknown terminator");
+    }
+    return !this->is_failed();
+}
+
+// A phi takes the value of the edge the lane came from. The edges into a block are
+// disjoint, so a chain of selects does.
+auto Translator::translate_phi(const Instruction& in) -> bool {
+    const auto&      edges = m_frame->m_edges[m_frame->m_block];
+    std::vector<u16> result;
+    for (size_t i = 2; i + 1 < in.operand_count(); i += 2) {
+        const std::vector<u16>& value = this->get_registers(in.operand(i));
+        auto block = m_frame->m_block_of.find(in.operand(i + 1));
+        if (block == m_frame->m_block_of.end()) {
+            return this->fail("unknown phi parent");
+        }
+        auto edge = std::ranges::find_if(edges, [&](const auto& e) {
+            return e.first == block->second;
+        });
+        // The parent was never reached, e.g. because it is unreachable.
+        if (edge == edges.end()) { continue; }
+        if (result.empty()) {
+            result = value;
+            continue;
+        }
+        for (size_t c = 0; c < result.size() && c < value.size(); c++) {
+            result[c] = this->select(edge->second, value[c], result[c]);
+        }
+    }
+    if (result.empty()) {
+        result.assign(this->get_type(in.operand(0)).m_size, this->constant(0U));
+    }
+    this->get_value(in.operand(1)) = {
+        .m_kind = Value::REGISTERS,
+        .m_type = in.operand(0),
+        .m_registers = std::move(result),
+    };
+    return !this->is_failed();
+}
+
+/*---------------------------
+    Memory
+---------------------------*/
+
+// Walks the indices, tracking both the first component for variables and the byte
+// offset for uniform buffers. Arrays in uniform buffers may be indexed by a variable,
+// the offset of such an index is added up per lane.
+auto Translator::translate_access_chain(const Instruction& in) -> bool {
+    Value pointer = this->get_value(in.operand(2));
+    if (pointer.m_kind != Value::VARIABLE && pointer.m_kind != Value::UNIFORM) {
+        return this->fail("access chain into something that is not a variable");
+    }
+
+    for (size_t i = 3; i < in.operand_count(); i++) {
+        const Type& type = this->get_type(pointer.m_type);
+        auto        constant = m_scalar_constants.find(in.operand(i));
+        if (constant == m_scalar_constants.end()) {
+            if (pointer.m_kind != Value::UNIFORM || type.m_kind != Type::ARRAY) {
+                return this->fail("only uniform arrays can be indexed dynamically");
+            }
+            const u32 stride = m_decorations[pointer.m_type].m_array_stride;
+            const u16 offset = this->emit(
+                SHADER_OPCODE::I_MUL,
+                this->get_registers(in.operand(i))[0],
+                this->constant(stride)
+            );
+            pointer.m_dynamic_offset =
+                pointer.m_dynamic_offset == NO_REGISTER
+                    ? offset
+                    : this->emit(SHADER_OPCODE::I_ADD, pointer.m_dynamic_offset, offset);
+            pointer.m_type = type.m_element;
+            continue;
+        }
+        const u32 index = constant->second;
+        const u32 count = type.m_kind == Type::STRUCT
+                              ? static_cast<u32>(type.m_members.size())
+                              : type.m_count;
+        if (index >= count) { return this->fail("index out of bounds"); }
+
+        u32 element = type.m_element;
+        switch (type.m_kind) {
+            case Type::STRUCT: {
+                element = type.m_members[index];
+                for (u32 m = 0; m < index; m++) {
+                    pointer.m_first += this->get_type(type.m_members[m]).m_size;
+                }
+                auto members = m_member_decorations.find(pointer.m_type);
+                if (members != m_member_decorations.end() &&
+                    index < members->second.size()) {
+                    const MemberDecoration& deco = members->second[index];
+                    pointer.m_offset += deco.m_offset;
+                    pointer.m_matrix_stride = deco.m_matrix_stride;
+                    pointer.m_is_row_major = deco.m_is_row_major;
+                }
+            } break;
+            case Type::ARRAY: {
+                pointer.m_first += index * this->get_type(element).m_size;
+                pointer.m_offset += index * m_decorations[pointer.m_type].m_array_stride;
+            } break;
+            case Type::MATRIX: {
+                pointer.m_first += index * this->get_type(element).m_size;
+                if (pointer.m_is_row_major) {
+                    pointer.m_offset += index * 4;
+                    pointer.m_vector_stride = pointer.m_matrix_stride;
+                } else {
+                    pointer.m_offset += index * pointer.m_matrix_stride;
+                    pointer.m_vector_stride = 4;
+                }
+            } break;
+            case Type::VECTOR: {
+                pointer.m_first += index;
+                pointer.m_offset += index * pointer.m_vector_stride;
+            } break;
+            default: return this->fail("access chain into a scalar");
+        }
+        pointer.m_type = element;
+    }
+    this->get_value(in.operand(1)) = std::move(pointer);
+    return !this->is_failed();
+}
+
+// Emits one load per component, laid out as the decorations say. The size comes from the
+// reflection, the VM reads 0 past the end of smaller buffers. Dynamic offsets are not
+// checked here, they are only known per lane.
+auto Translator::load_uniform(const Value& pointer, u32 type_id, std::vector<u16>& out)
+    -> void {
+    const Type& type = this->get_type(type_id);
+    switch (type.m_kind) {
+        case Type::BOOL:
+        case Type::INT:
+        case Type::FLOAT: {
+            const u32 size = m_program->m_uniform_buffers[pointer.m_index].m_size;
+            if (pointer.m_offset + 4 > size) {
+                this->fail("uniform access is out of bounds");
+                return;
+            }
+            const bool is_indexed = pointer.m_dynamic_offset != NO_REGISTER;
+            u16        reg = this->allocate(1);
+            m_program->m_code.push_back({
+                .m_opcode = is_indexed ? SHADER_OPCODE::LOAD_UNIFORM_INDEXED
+                                       : SHADER_OPCODE::LOAD_UNIFORM,
+                .m_slot = static_cast<u8>(pointer.m_index),
+                .m_dst = reg,
+                .m_a = static_cast<u16>(pointer.m_offset & 0xFFFF),
+                .m_b = static_cast<u16>(pointer.m_offset >> 16),
+                .m_c = is_indexed ? pointer.m_dynamic_offset : u16(0),
+            });
+            // Bools are stored as 0 or 1 but used as masks.
+            if (type.m_kind == Type::BOOL) {
+                const u16 is_zero =
+                    this->emit(SHADER_OPCODE::I_EQUAL, reg, this->constant(0U));
+                reg = this->emit(SHADER_OPCODE::NOT, is_zero);
+            }
+            out.push_back(reg);
+        } break;
+        case Type::VECTOR: {
+            Value component = pointer;
+            for (u32 i = 0; i < type.m_count; i++) {
+                component.m_offset = pointer.m_offset + i * pointer.m_vector_stride;
+                this->load_uniform(component, type.m_element, out);
+            }
+        } break;
+        case Type::MATRIX: {
+            Value column = pointer;
+            for (u32 i = 0; i < type.m_count; i++) {
+                if (pointer.m_is_row_major) {
+                    column.m_offset = pointer.m_offset + i * 4;
+                    column.m_vector_stride = pointer.m_matrix_stride;
+                } else {
+                    column.m_offset = pointer.m_offset + i * pointer.m_matrix_stride;
+                    column.m_vector_stride = 4;
+                }
+                this->load_uniform(column, type.m_element, out);
+            }
+        } break;
+        case Type::ARRAY: {
+            const u32 stride = m_decorations[type_id].m_array_stride;
+            Value     element = pointer;
+            for (u32 i = 0; i < type.m_count; i++) {
+                element.m_offset = pointer.m_offset + i * stride;
+                this->load_uniform(element, type.m_element, out);
+            }
+        } break;
+        case Type::STRUCT: {
+            auto members = m_member_decorations.find(type_id);
+            for (u32 m = 0; m < type.m_members.size(); m++) {
+                Value member = pointer;
+                if (members != m_member_decorations.end() && m < members->second.size()) {
+                    const MemberDecoration& deco = members->second[m];
+                    member.m_offset += deco.m_offset;
+                    member.m_matrix_stride = deco.m_matrix_stride;
+                    member.m_is_row_major = deco.m_is_row_major;
+                }
+                member.m_vector_stride = 4;
+                this->load_uniform(member, type.m_members[m], out);
+            }
+        } break;
+        default: this->fail("uniform of an unsupported type"); break;
+    }
+}
+
+/*---------------------------
+    Instructions
+---------------------------*/
+
+auto Translator::translate_instruction(const Instruction& in) -> bool {
+    const u32 type_id = in.operand(0);
+    Value     result = {.m_kind = Value::REGISTERS, .m_type = type_id};
+    auto&     out = result.m_registers;
+
+    // Applies `opcode` to every component, scalar operands are used for all of them.
+    auto componentwise = [&](SHADER_OPCODE opcode, u32 a_id, u32 b_id) {
+        const std::vector<u16>& a = this->get_registers(a_id);
+        const std::vector<u16>& b = this->get_registers(b_id);
+        const size_t            count = std::max(a.size(), b.size());
+        for (size_t i = 0; i < count; i++) {
+            const u16 a_i = a[std::min(i, a.size() - 1)];
+            const u16 b_i = b[std::min(i, b.size() - 1)];
+            out.push_back(this->emit(opcode, a_i, b_i));
+        }
+    };
+    auto binary = [&](SHADER_OPCODE opcode) {
+        componentwise(opcode, in.operand(2), in.operand(3));
+    };
+    auto unary = [&](SHADER_OPCODE opcode) {
+        componentwise(opcode, in.operand(2), in.operand(2));
+    };
+    // a > b is b < a.
+    auto swapped = [&](SHADER_OPCODE opcode) {
+        componentwise(opcode, in.operand(3), in.operand(2));
+    };
+    auto inverted = [&](SHADER_OPCODE opcode, bool is_swapped) {
+        if (is_swapped) {
+            swapped(opcode);
+        } else {
+            binary(opcode);
+        }
+        for (u16& reg : out) { reg = this->emit(SHADER_OPCODE::NOT, reg); }
+    };
+    auto matrix_shape = [&](u32 id, u32& out_rows, u32& out_columns) {
+        const Type& type = this->get_type(this->get_value(id).m_type);
+        out_rows = this->get_type(type.m_element).m_count;
+        out_columns = type.m_count;
+    };
+
+    switch (in.m_op) {
+        // Only describe the structure of the code.
+        case spv::OpNop:
+        case spv::OpLine:
+        case spv::OpNoLine:
+        case spv::OpSelectionMerge: return true;
+        case spv::OpLoopMerge: return this->fail("loops are not supported");
+
+        case spv::OpVariable: {
+            const u32 id = in.operand(1);
+            if (id >= m_values.size()) { return this->fail("variable out of bounds"); }
+            const u32 type = this->get_type(type_id).m_element;
+            if (in.operand_count() > 3) {
+                this->add_variable(id, type, in.operand(3));
+                return !this->is_failed();
+            }
+            // Function variables start out undefined, zero is as good as anything.
+            m_variables.emplace_back(this->get_type(type).m_size, this->constant(0U));
+            m_values[id] = {
+                .m_kind = Value::VARIABLE,
+                .m_type = type,
+                .m_index = static_cast<u32>(m_variables.size() - 1),
+            };
+            return !this->is_failed();
+        }
+        case spv::OpLoad: {
+            const Value& pointer = this->get_value(in.operand(2));
+            switch (pointer.m_kind) {
+                case Value::VARIABLE: {
+                    const std::vector<u16>& var = m_variables[pointer.m_index];
+                    const u32               size = this->get_type(type_id).m_size;
+                    if (pointer.m_first + size > var.size()) {
+                        return this->fail("load out of bounds");
+                    }
+                    const auto first = var.begin() + pointer.m_first;
+                    out.assign(first, first + size);
+                } break;
+                case Value::UNIFORM: this->load_uniform(pointer, type_id, out); break;
+                case Value::TEXTURE: result = pointer; break;
+                default: return this->fail("load from something that is not a pointer");
+            }
+        } break;
+        case spv::OpStore: {
+            const Value& pointer = this->get_value(in.operand(0));
+            if (pointer.m_kind != Value::VARIABLE) {
+                return this->fail("only variables can be stored to");
+            }
+            const std::vector<u16>& value = this->get_registers(in.operand(1));
+            std::vector<u16>&       var = m_variables[pointer.m_index];
+            if (pointer.m_first + value.size() > var.size()) {
+                return this->fail("store out of bounds");
+            }
+            for (size_t i = 0; i < value.size(); i++) {
+                u16& component = var[pointer.m_first + i];
+                // Where every lane stores, the old value does not matter.
+                component = m_mask == m_program->m_live_mask
+                                ? value[i]
+                                : this->select(m_mask, value[i], component);
+            }
+            return !this->is_failed();
+        }
+        case spv::OpAccessChain:
+        case spv::OpInBoundsAccessChain: return this->translate_access_chain(in);
+
+        case spv::OpCompositeExtract:
+        case spv::OpCompositeInsert: {
+            const bool is_insert = in.m_op == spv::OpCompositeInsert;
+            const u32  composite = in.operand(is_insert ? 3 : 2);
+            u32        type = this->get_value(composite).m_type;
+            u32        first = 0;
+            for (size_t i = is_insert ? 4 : 3; i < in.operand_count(); i++) {
+                const Type& outer = this->get_type(type);
+                const u32   index = in.operand(i);
+                if (outer.m_kind == Type::STRUCT) {
+                    if (index >= outer.m_members.size()) {
+                        return this->fail("index out of bounds");
+                    }
+                    for (u32 m = 0; m < index; m++) {
+                        first += this->get_type(outer.m_members[m]).m_size;
+                    }
+                    type = outer.m_members[index];
+                } else {
+                    if (index >= outer.m_count) {
+                        return this->fail("index out of bounds");
+                    }
+                    type = outer.m_element;
+                    first += index * this->get_type(type).m_size;
+                }
+            }
+            const std::vector<u16>& whole = this->get_registers(composite);
+            const u32               size = this->get_type(type).m_size;
+            if (first + size > whole.size()) { return this->fail("index out of bounds"); }
+            if (is_insert) {
+                const std::vector<u16>& part = this->get_registers(in.operand(2));
+                out = whole;
+                const size_t count = std::min<size_t>(size, part.size());
+                std::copy_n(part.begin(), count, &out[first]);
+            } else {
+                out.assign(whole.begin() + first, whole.begin() + first + size);
+            }
+        } break;
+        case spv::OpCompositeConstruct: {
+            for (size_t i = 2; i < in.operand_count(); i++) {
+                const std::vector<u16>& part = this->get_registers(in.operand(i));
+                out.insert(out.end(), part.begin(), part.end());
+            }
+        } break;
+        case spv::OpVectorShuffle: {
+            std::vector<u16> both = this->get_registers(in.operand(2));
+            const auto&      second = this->get_registers(in.operand(3));
+            both.insert(both.end(), second.begin(), second.end());
+            for (size_t i = 4; i < in.operand_count(); i++) {
+                const u32 index = in.operand(i);
+                out.push_back(index < both.size() ? both[index] : this->constant(0U));
+            }
+        } break;
+        case spv::OpCopyObject:
+        case spv::OpCopyLogical:
+        case spv::OpBitcast: {
+            result = this->get_value(in.operand(2));
+            result.m_type = type_id;
+        } break;
+        case spv::OpUndef:
+        case spv::OpConstantNull: {
+            out.assign(this->get_type(type_id).m_size, this->constant(0U));
+        } break;
+
+        case spv::OpFAdd: binary(SHADER_OPCODE::F_ADD); break;
+        case spv::OpFSub: binary(SHADER_OPCODE::F_SUB); break;
+        case spv::OpFMul: binary(SHADER_OPCODE::F_MUL); break;
+        case spv::OpFDiv: binary(SHADER_OPCODE::F_DIV); break;
+        case spv::OpFMod: binary(SHADER_OPCODE::F_MOD); break;
+        case spv::OpFRem: {
+            // Takes the sign of the dividend, a - b * trunc(a / b).
+            binary(SHADER_OPCODE::F_DIV);
+            const std::vector<u16>& a = this->get_registers(in.operand(2));
+            const std::vector<u16>& b = this->get_registers(in.operand(3));
+            for (size_t i = 0; i < out.size() && i < a.size() && i < b.size(); i++) {
+                const u16 quotient = this->emit(SHADER_OPCODE::F_TRUNC, out[i]);
+                const u16 product = this->emit(SHADER_OPCODE::F_MUL, b[i], quotient);
+                out[i] = this->emit(SHADER_OPCODE::F_SUB, a[i], product);
+            }
+        } break;
+        case spv::OpFNegate: unary(SHADER_OPCODE::F_NEGATE); break;
+        case spv::OpIAdd: binary(SHADER_OPCODE::I_ADD); break;
+        case spv::OpISub: binary(SHADER_OPCODE::I_SUB); break;
+        case spv::OpIMul: binary(SHADER_OPCODE::I_MUL); break;
+        case spv::OpSNegate: {
+            for (const u16 reg : this->get_registers(in.operand(2))) {
+                out.push_back(this->emit(SHADER_OPCODE::I_SUB, this->constant(0U), reg));
+            }
+        } break;
+
+        case spv::OpFOrdEqual: binary(SHADER_OPCODE::F_EQUAL); break;
+        case spv::OpFOrdLessThan: binary(SHADER_OPCODE::F_LESS); break;
+        case spv::OpFOrdGreaterThan: swapped(SHADER_OPCODE::F_LESS); break;
+        case spv::OpFOrdLessThanEqual: binary(SHADER_OPCODE::F_LESS_EQUAL); break;
+        case spv::OpFOrdGreaterThanEqual: swapped(SHADER_OPCODE::F_LESS_EQUAL); break;
+        case spv::OpFOrdNotEqual:
+        case spv::OpFUnordEqual: {
+            // a < b || b < a is an ordered not equal, its inverse an unordered equal.
+            binary(SHADER_OPCODE::F_LESS);
+            const std::vector<u16> less = std::move(out);
+            out.clear();
+            swapped(SHADER_OPCODE::F_LESS);
+            for (size_t i = 0; i < out.size() && i < less.size(); i++) {
+                out[i] = this->emit(SHADER_OPCODE::OR, less[i], out[i]);
+                if (in.m_op == spv::OpFUnordEqual) {
+                    out[i] = this->emit(SHADER_OPCODE::NOT, out[i]);
+                }
+            }
+        } break;
+        case spv::OpFUnordNotEqual: inverted(SHADER_OPCODE::F_EQUAL, false); break;
+        case spv::OpFUnordLessThan: inverted(SHADER_OPCODE::F_LESS_EQUAL, true); break;
+        case spv::OpFUnordGreaterThan:
+            inverted(SHADER_OPCODE::F_LESS_EQUAL, false);
+            break;
+        case spv::OpFUnordLessThanEqual: inverted(SHADER_OPCODE::F_LESS, true); break;
+        case spv::OpFUnordGreaterThanEqual: inverted(SHADER_OPCODE::F_LESS, false); break;
+        case spv::OpIsNan: unary(SHADER_OPCODE::F_UNORDERED); break;
+
+        case spv::OpIEqual: binary(SHADER_OPCODE::I_EQUAL); break;
+        case spv::OpINotEqual: inverted(SHADER_OPCODE::I_EQUAL, false); break;
+        case spv::OpSLessThan: binary(SHADER_OPCODE::S_LESS); break;
+        case spv::OpSLessThanEqual: binary(SHADER_OPCODE::S_LESS_EQUAL); break;
+        case spv::OpSGreaterThan: swapped(SHADER_OPCODE::S_LESS); break;
+        case spv::OpSGreaterThanEqual: swapped(SHADER_OPCODE::S_LESS_EQUAL); break;
+        case spv::OpULessThan: binary(SHADER_OPCODE::U_LESS); break;
+        case spv::OpULessThanEqual: binary(SHADER_OPCODE::U_LESS_EQUAL); break;
+        case spv::OpUGreaterThan: swapped(SHADER_OPCODE::U_LESS); break;
+        case spv::OpUGreaterThanEqual: swapped(SHADER_OPCODE::U_LESS_EQUAL); break;
+
+        case spv::OpLogicalAnd:
+        case spv::OpBitwiseAnd: binary(SHADER_OPCODE::AND); break;
+        case spv::OpLogicalOr:
+        case spv::OpBitwiseOr: binary(SHADER_OPCODE::OR); break;
+        case spv::OpLogicalNotEqual:
+        case spv::OpBitwiseXor: binary(SHADER_OPCODE::XOR); break;
+        case spv::OpLogicalEqual: inverted(SHADER_OPCODE::XOR, false); break;
+        case spv::OpLogicalNot:
+        case spv::OpNot: unary(SHADER_OPCODE::NOT); break;
+        case spv::OpAny:
+        case spv::OpAll: {
+            const std::vector<u16>& parts = this->get_registers(in.operand(2));
+            const SHADER_OPCODE     opcode =
+                in.m_op == spv::OpAny ? SHADER_OPCODE::OR : SHADER_OPCODE::AND;
+            u16 reduced = parts[0];
+            for (size_t i = 1; i < parts.size(); i++) {
+                reduced = this->emit(opcode, reduced, parts[i]);
+            }
+            out = {reduced};
+        } break;
+        case spv::OpSelect: {
+            const std::vector<u16>& condition = this->get_registers(in.operand(2));
+            const std::vector<u16>& if_true = this->get_registers(in.operand(3));
+            const std::vector<u16>& if_false = this->get_registers(in.operand(4));
+            for (size_t i = 0; i < if_true.size() && i < if_false.size(); i++) {
+                const u16 mask = condition[std::min(i, condition.size() - 1)];
+                out.push_back(this->select(mask, if_true[i], if_false[i]));
+            }
+        } break;
+
+        case spv::OpConvertFToS: unary(SHADER_OPCODE::F_TO_S); break;
+        case spv::OpConvertFToU: unary(SHADER_OPCODE::F_TO_U); break;
+        case spv::OpConvertSToF: unary(SHADER_OPCODE::S_TO_F); break;
+        case spv::OpConvertUToF: unary(SHADER_OPCODE::U_TO_F); break;
+
+        case spv::OpVectorTimesScalar:
+        case spv::OpMatrixTimesScalar: binary(SHADER_OPCODE::F_MUL); break;
+        case spv::OpDot: {
+            const std::vector<u16>& a = this->get_registers(in.operand(2));
+            const std::vector<u16>& b = this->get_registers(in.operand(3));
+            out = {this->dot(a, b)};
+        } break;
+        // Matrices are stored column by column.
+        case spv::OpVectorTimesMatrix: {
+            const std::vector<u16>& v = this->get_registers(in.operand(2));
+            const std::vector<u16>& m = this->get_registers(in.operand(3));
+            u32                     rows = 0;
+            u32                     columns = 0;
+            matrix_shape(in.operand(3), rows, columns);
+            if (v.size() != rows || m.size() != rows * columns) {
+                return this->fail("matrix sizes do not match");
+            }
+            for (u32 c = 0; c < columns; c++) {
+                out.push_back(this->dot(v, std::span(m).subspan(c * rows, rows)));
+            }
+        } break;
+        case spv::OpMatrixTimesVector:
+        case spv::OpMatrixTimesMatrix: {
+            const std::vector<u16>& a = this->get_registers(in.operand(2));
+            const std::vector<u16>& b = this->get_registers(in.operand(3));
+            u32                     rows = 0;
+            u32                     columns = 0;
+            matrix_shape(in.operand(2), rows, columns);
+            if (columns == 0 || a.size() != rows * columns || b.size() % columns != 0) {
+                return this->fail("matrix sizes do not match");
+            }
+            const u32 result_columns = static_cast<u32>(b.size()) / columns;
+            for (u32 rc = 0; rc < result_columns; rc++) {
+                for (u32 r = 0; r < rows; r++) {
+                    u16 sum = this->emit(SHADER_OPCODE::F_MUL, a[r], b[rc * columns]);
+                    for (u32 c = 1; c < columns; c++) {
+                        const u16 product = this->emit(
+                            SHADER_OPCODE::F_MUL, a[c * rows + r], b[rc * columns + c]
+                        );
+                        sum = this->emit(SHADER_OPCODE::F_ADD, sum, product);
+                    }
+                    out.push_back(sum);
+                }
+            }
+        } break;
+        case spv::OpOuterProduct: {
+            const std::vector<u16>& a = this->get_registers(in.operand(2));
+            const std::vector<u16>& b = this->get_registers(in.operand(3));
+            for (const u16 column : b) {
+                for (const u16 row : a) {
+                    out.push_back(this->emit(SHADER_OPCODE::F_MUL, row, column));
+                }
+            }
+        } break;
+        case spv::OpTranspose: {
+            const std::vector<u16>& a = this->get_registers(in.operand(2));
+            u32                     rows = 0;
+            u32                     columns = 0;
+            matrix_shape(in.operand(2), rows, columns);
+            if (a.size() != rows * columns) {
+                return this->fail("matrix sizes do not match");
+            }
+            for (u32 r = 0; r < rows; r++) {
+                for (u32 c = 0; c < columns; c++) { out.push_back(a[c * rows + r]); }
+            }
+        } break;
+
+        case spv::OpFunctionCall: {
+            const std::vector<u32> arguments(in.m_words.begin() + 4, in.m_words.end());
+            if (!this->translate_function(in.operand(2), m_mask, arguments, &out)) {
+                return false;
+            }
+            if (out.empty()) { result.m_kind = Value::NONE; }
+        } break;
+        case spv::OpPhi: return this->translate_phi(in);
+
+        case spv::OpSampledImage:
+        case spv::OpImage: {
+            result = this->get_value(in.operand(2));
+            if (result.m_kind != Value::TEXTURE) { return this->fail("unknown image"); }
+        } break;
+        case spv::OpImageSampleImplicitLod:
+        case spv::OpImageSampleExplicitLod:
+        case spv::OpImageSampleProjImplicitLod:
+        case spv::OpImageSampleProjExplicitLod: {
+            const Value& texture = this->get_value(in.operand(2));
+            if (texture.m_kind != Value::TEXTURE) { return this->fail("unknown image"); }
+            const std::vector<u16>& coordinate = this->get_registers(in.operand(3));
+            u16 u = coordinate[0];
+            u16 v = coordinate.size() > 1 ? coordinate[1] : this->constant(0.0F);
+            if (in.m_op == spv::OpImageSampleProjImplicitLod ||
+                in.m_op == spv::OpImageSampleProjExplicitLod) {
+                u = this->emit(SHADER_OPCODE::F_DIV, u, coordinate.back());
+                v = this->emit(SHADER_OPCODE::F_DIV, v, coordinate.back());
+            }
+            // Only the lanes running the block sample, the others may hold anything.
+            const u16 dst = this->allocate(4);
+            m_program->m_code.push_back({
+                .m_opcode = SHADER_OPCODE::SAMPLE,
+                .m_slot = static_cast<u8>(texture.m_index),
+                .m_dst = dst,
+                .m_a = u,
+                .m_b = v,
+                .m_c = m_mask,
+            });
+            for (u16 i = 0; i < 4; i++) { out.push_back(static_cast<u16>(dst + i)); }
+            out.resize(std::min<size_t>(4, this->get_type(type_id).m_size));
+        } break;
+
+        case spv::OpExtInst: return this->translate_extended(in);
+        case spv::OpDemoteToHelperInvocation: {
+            m_discard = this->emit(SHADER_OPCODE::OR, m_discard, m_mask);
+            return !this->is_failed();
+        }
+        case spv::OpDPdx:
+        case spv::OpDPdy:
+        case spv::OpFwidth:
+        case spv::OpDPdxFine:
+        case spv::OpDPdyFine:
+        case spv::OpFwidthFine:
+        case spv::OpDPdxCoarse:
+        case spv::OpDPdyCoarse:
+        case spv::OpFwidthCoarse: return this->fail("derivatives are not supported");
+        default: {
+            return this->fail(
+                fmt::format("instruction {} is not supported", static_cast<u32>(in.m_op))
+            );
+        }
+    }
+
+    this->get_value(in.operand(1)) = std::move(result);
+    return !this->is_failed();
+}
+
+// Lowers GLSL.std.450. Most instructions map onto one opcode per component, the rest
+// are expanded.
+auto Translator::translate_extended(const Instruction& in) -> bool {
+    const u32 type_id = in.operand(0);
+    if (in.operand(2) != m_glsl_std_450) {
+        // NonSemantic instructions, like debug info, have no results which are used.
+        if (this->get_type(type_id).m_kind == Type::VOID) { return !this->is_failed(); }
+        return this->fail("only the GLSL.std.450 instructions are supported");
+    }
+    const u32 op = in.operand(3);
+
+    std::vector<std::vector<u16>> args;
+    size_t                        size = 0;
+    for (size_t i = 4; i < in.operand_count(); i++) {
+        args.push_back(this->get_registers(in.operand(i)));
+        size = std::max(size, args.back().size());
+    }
+    if (this->is_failed()) { return false; }
+    // Scalar operands are used for every component.
+    auto arg = [&](size_t index, size_t component) -> u16 {
+        if (index >= args.size()) { return this->constant(0U); }
+        const std::vector<u16>& a = args[index];
+        return a[std::min(component, a.size() - 1)];
+    };
+    auto arg_vector = [&](size_t index) -> std::span<const u16> {
+        static const std::vector<u16> zero = {0};
+        return index < args.size() ? args[index] : zero;
+    };
+
+    std::vector<u16> out;
+    auto             unary = [&](SHADER_OPCODE opcode) {
+        for (size_t i = 0; i < size; i++) {
+            out.push_back(this->emit(opcode, arg(0, i)));
+        }
+    };
+    auto binary = [&](SHADER_OPCODE opcode) {
+        for (size_t i = 0; i < size; i++) {
+            out.push_back(this->emit(opcode, arg(0, i), arg(1, i)));
+        }
+    };
+    auto clamp = [&]() {
+        for (size_t i = 0; i < size; i++) {
+            const u16 lower = this->emit(SHADER_OPCODE::F_MAX, arg(0, i), arg(1, i));
+            out.push_back(this->emit(SHADER_OPCODE::F_MIN, lower, arg(2, i)));
+        }
+    };
+    // Integer min and max, `less` decides which operand is picked.
+    auto pick = [&](SHADER_OPCODE less, bool is_min) {
+        for (size_t i = 0; i < size; i++) {
+            const u16 a = arg(0, i);
+            const u16 b = arg(1, i);
+            const u16 is_less = this->emit(less, a, b);
+            out.push_back(
+                is_min ? this->select(is_less, a, b) : this->select(is_less, b, a)
+            );
+        }
+    };
+    auto scale = [&](f32 factor) {
+        const u16 reg = this->constant(factor);
+        for (size_t i = 0; i < size; i++) {
+            out.push_back(this->emit(SHADER_OPCODE::F_MUL, arg(0, i), reg));
+        }
+    };
+
+    switch (op) {
+        case GLSLstd450Round:
+        case GLSLstd450RoundEven: unary(SHADER_OPCODE::F_ROUND); break;
+        case GLSLstd450Trunc: unary(SHADER_OPCODE::F_TRUNC); break;
+        case GLSLstd450FAbs: unary(SHADER_OPCODE::F_ABS); break;
+        case GLSLstd450FSign: unary(SHADER_OPCODE::F_SIGN); break;
+        case GLSLstd450Floor: unary(SHADER_OPCODE::F_FLOOR); break;
+        case GLSLstd450Ceil: unary(SHADER_OPCODE::F_CEIL); break;
+        case GLSLstd450Fract: unary(SHADER_OPCODE::F_FRACT); break;
+        case GLSLstd450Sqrt: unary(SHADER_OPCODE::F_SQRT); break;
+        case GLSLstd450InverseSqrt: unary(SHADER_OPCODE::F_INVERSE_SQRT); break;
+        case GLSLstd450Exp: unary(SHADER_OPCODE::F_EXP); break;
+        case GLSLstd450Exp2: unary(SHADER_OPCODE::F_EXP2); break;
+        case GLSLstd450Log: unary(SHADER_OPCODE::F_LOG); break;
+        case GLSLstd450Log2: unary(SHADER_OPCODE::F_LOG2); break;
+        case GLSLstd450Sin: unary(SHADER_OPCODE::F_SIN); break;
+        case GLSLstd450Cos: unary(SHADER_OPCODE::F_COS); break;
+        case GLSLstd450Tan: unary(SHADER_OPCODE::F_TAN); break;
+        case GLSLstd450Asin: unary(SHADER_OPCODE::F_ASIN); break;
+        case GLSLstd450Acos: unary(SHADER_OPCODE::F_ACOS); break;
+        case GLSLstd450Atan: unary(SHADER_OPCODE::F_ATAN); break;
+        case GLSLstd450Atan2: binary(SHADER_OPCODE::F_ATAN2); break;
+        case GLSLstd450Pow: binary(SHADER_OPCODE::F_POW); break;
+        case GLSLstd450FMin:
+        case GLSLstd450NMin: binary(SHADER_OPCODE::F_MIN); break;
+        case GLSLstd450FMax:
+        case GLSLstd450NMax: binary(SHADER_OPCODE::F_MAX); break;
+        case GLSLstd450FClamp:
+        case GLSLstd450NClamp: clamp(); break;
+        case GLSLstd450SMin: pick(SHADER_OPCODE::S_LESS, true); break;
+        case GLSLstd450SMax: pick(SHADER_OPCODE::S_LESS, false); break;
+        case GLSLstd450UMin: pick(SHADER_OPCODE::U_LESS, true); break;
+        case GLSLstd450UMax: pick(SHADER_OPCODE::U_LESS, false); break;
+        case GLSLstd450SAbs: {
+            const u16 zero = this->constant(0U);
+            for (size_t i = 0; i < size; i++) {
+                const u16 is_negative =
+                    this->emit(SHADER_OPCODE::S_LESS, arg(0, i), zero);
+                const u16 negated = this->emit(SHADER_OPCODE::I_SUB, zero, arg(0, i));
+                out.push_back(this->select(is_negative, negated, arg(0, i)));
+            }
+        } break;
+        case GLSLstd450Radians: scale(std::numbers::pi_v<f32> / 180.0F); break;
+        case GLSLstd450Degrees: scale(180.0F / std::numbers::pi_v<f32>); break;
+        case GLSLstd450FMix: {
+            // x + (y - x) * a
+            for (size_t i = 0; i < size; i++) {
+                const u16 delta = this->emit(SHADER_OPCODE::F_SUB, arg(1, i), arg(0, i));
+                const u16 scaled = this->emit(SHADER_OPCODE::F_MUL, delta, arg(2, i));
+                out.push_back(this->emit(SHADER_OPCODE::F_ADD, arg(0, i), scaled));
+            }
+        } break;
+        case GLSLstd450Fma: {
+            for (size_t i = 0; i < size; i++) {
+                const u16 product =
+                    this->emit(SHADER_OPCODE::F_MUL, arg(0, i), arg(1, i));
+                out.push_back(this->emit(SHADER_OPCODE::F_ADD, product, arg(2, i)));
+            }
+        } break;
+        case GLSLstd450Step: {
+            // x < edge ? 0 : 1
+            const u16 zero = this->constant(0.0F);
+            const u16 one = this->constant(1.0F);
+            for (size_t i = 0; i < size; i++) {
+                const u16 is_below =
+                    this->emit(SHADER_OPCODE::F_LESS, arg(1, i), arg(0, i));
+                out.push_back(this->select(is_below, zero, one));
+            }
+        } break;
+        case GLSLstd450SmoothStep: {
+            // t * t * (3 - 2 * t) with t = clamp((x - edge0) / (edge1 - edge0), 0, 1)
+            for (size_t i = 0; i < size; i++) {
+                const u16 range = this->emit(SHADER_OPCODE::F_SUB, arg(1, i), arg(0, i));
+                const u16 offset = this->emit(SHADER_OPCODE::F_SUB, arg(2, i), arg(0, i));
+                u16       t = this->emit(SHADER_OPCODE::F_DIV, offset, range);
+                t = this->emit(SHADER_OPCODE::F_MAX, t, this->constant(0.0F));
+                t = this->emit(SHADER_OPCODE::F_MIN, t, this->constant(1.0F));
+                const u16 twice =
+                    this->emit(SHADER_OPCODE::F_MUL, t, this->constant(2.0F));
+                const u16 factor =
+                    this->emit(SHADER_OPCODE::F_SUB, this->constant(3.0F), twice);
+                const u16 squared = this->emit(SHADER_OPCODE::F_MUL, t, t);
+                out.push_back(this->emit(SHADER_OPCODE::F_MUL, squared, factor));
+            }
+        } break;
+        case GLSLstd450Length: {
+            const u16 squared = this->dot(arg_vector(0), arg_vector(0));
+            out = {this->emit(SHADER_OPCODE::F_SQRT, squared)};
+        } break;
+        case GLSLstd450Distance: {
+            std::vector<u16> delta;
+            for (size_t i = 0; i < size; i++) {
+                delta.push_back(this->emit(SHADER_OPCODE::F_SUB, arg(0, i), arg(1, i)));
+            }
+            out = {this->emit(SHADER_OPCODE::F_SQRT, this->dot(delta, delta))};
+        } break;
+        case GLSLstd450Normalize: {
+            const u16 squared = this->dot(arg_vector(0), arg_vector(0));
+            const u16 inverse_length = this->emit(SHADER_OPCODE::F_INVERSE_SQRT, squared);
+            for (size_t i = 0; i < size; i++) {
+                const u16 scaled =
+                    this->emit(SHADER_OPCODE::F_MUL, arg(0, i), inverse_length);
+                out.push_back(scaled);
+            }
+        } break;
+        case GLSLstd450Cross: {
+            if (size != 3) { return this->fail("cross needs 3 components"); }
+            for (size_t i = 0; i < 3; i++) {
+                const size_t j = (i + 1) % 3;
+                const size_t k = (i + 2) % 3;
+                const u16    a = this->emit(SHADER_OPCODE::F_MUL, arg(0, j), arg(1, k));
+                const u16    b = this->emit(SHADER_OPCODE::F_MUL, arg(0, k), arg(1, j));
+                out.push_back(this->emit(SHADER_OPCODE::F_SUB, a, b));
+            }
+        } break;
+        case GLSLstd450FaceForward: {
+            // dot(nref, i) < 0 ? n : -n
+            const u16 d = this->dot(arg_vector(2), arg_vector(1));
+            const u16 is_facing =
+                this->emit(SHADER_OPCODE::F_LESS, d, this->constant(0.0F));
+            for (size_t i = 0; i < size; i++) {
+                const u16 negated = this->emit(SHADER_OPCODE::F_NEGATE, arg(0, i));
+                out.push_back(this->select(is_facing, arg(0, i), negated));
+            }
+        } break;
+        case GLSLstd450Reflect: {
+            // i - 2 * dot(n, i) * n
+            const u16 d = this->dot(arg_vector(1), arg_vector(0));
+            const u16 twice = this->emit(SHADER_OPCODE::F_MUL, d, this->constant(2.0F));
+            for (size_t i = 0; i < size; i++) {
+                const u16 offset = this->emit(SHADER_OPCODE::F_MUL, twice, arg(1, i));
+                out.push_back(this->emit(SHADER_OPCODE::F_SUB, arg(0, i), offset));
+            }
+        } break;
+        default: {
+            return this->fail(
+                fmt::format("GLSL.std.450 instruction {} is not supported", op)
+            );
+        }
+    }
+
+    this->get_value(in.operand(1)) = {
+        .m_kind = Value::REGISTERS,
+        .m_type = type_id,
+        .m_registers = std::move(out),
+    };
+    return !this->is_failed();
+}
+
+} // namespace
+
+auto compile_shader(
+    const ShadingCode::Module& module,
+    const ReflectedModule&     reflected,
+    std::string*               out_error
+) -> std::optional<ShaderProgram> {
+    ShaderProgram program;
+    program.m_stage = module.m_stage;
+    program.m_hash = hash_spirv(module.m_code);
+
+    Translator translator(module.m_code, module.m_stage, reflected, program);
+    if (!translator.translate()) {
+        if (out_error != nullptr) { *out_error = std::move(translator.m_error); }
+        return std::nullopt;
+    }
+    return program;
+}
+
+/*---------------------------
+    ShaderCache
+---------------------------*/
+
+auto ShaderCache::KeyHash::operator()(const ShadingCode::Module& module) const
+    -> size_t {
+    return hash_combine(hash_spirv(module.m_code), static_cast<u64>(module.m_stage));
+}
+
+auto ShaderCache::get(const ShadingCode::Module& module) -> const ShaderProgram* {
+    // The same code can be used for several stages.
+    if (auto it = m_programs.find(module); it != m_programs.end()) {
+        return it->second.get();
+    }
+
+    const ReflectedModule reflected =
+        ReflectedModule::reflect(module.m_code, module.m_stage);
+    std::string                  error;
+    std::optional<ShaderProgram> program = compile_shader(module, reflected, &error);
+    if (!program.has_value()) {
+        Logger::warn(
+            "The software renderer can not run the {} shader: {}",
+            to_string(module.m_stage),
+            error
+        );
+        m_programs.emplace(module, nullptr);
+        return nullptr;
+    }
+    auto [it, _] =
+        m_programs.emplace(module, std::make_unique<ShaderProgram>(std::move(*program)));
+    return it->second.get();
+}
+
+} // namespace software
+} // namespace JadeFrame
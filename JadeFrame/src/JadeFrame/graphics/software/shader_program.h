@@ -0,0 +1,247 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/graphics/graphics_shared.h"
+
+#include "framebuffer.h"
+
+namespace JadeFrame {
+struct ReflectedModule;
+
+namespace software {
+
+/*
+    Shaders for the software backend. The SPIR-V of a module is translated once into a
+   small register based bytecode, which is then run for `SHADER_LANES` invocations at a
+   time, one per lane. Every instruction works on whole registers, so the cost of decoding
+   it is shared by all lanes and the per lane loops are plain enough for the compiler to
+   vectorize.
+    Vectors and matrices are split into one register per component while translating, so
+   swizzles, extracts and constructs cost nothing at runtime. Control flow is flattened,
+   every block runs with a mask of the lanes which reached it and stores only change
+   those lanes. Loops are not supported, and only arrays in uniform buffers can be
+   indexed by a variable.
+*/
+
+constexpr u32 SHADER_LANES = 8;
+
+enum class SHADER_OPCODE : u8 {
+    // dst = a ? b : c, bitwise, `a` is a mask.
+    SELECT,
+    // Float arithmetic, dst = op(a, b).
+    F_ADD,
+    F_SUB,
+    F_MUL,
+    F_DIV,
+    F_MOD,
+    F_MIN,
+    F_MAX,
+    F_POW,
+    F_ATAN2,
+    // Float functions, dst = op(a).
+    F_NEGATE,
+    F_ABS,
+    F_SIGN,
+    F_FLOOR,
+    F_CEIL,
+    F_TRUNC,
+    F_ROUND,
+    F_FRACT,
+    F_SQRT,
+    F_INVERSE_SQRT,
+    F_EXP,
+    F_EXP2,
+    F_LOG,
+    F_LOG2,
+    F_SIN,
+    F_COS,
+    F_TAN,
+    F_ASIN,
+    F_ACOS,
+    F_ATAN,
+    // Float comparisons, dst is a mask. Ordered, false if either is NaN.
+    F_EQUAL,
+    F_LESS,
+    F_LESS_EQUAL,
+    F_UNORDERED,
+    // Integer arithmetic, wrapping.
+    I_ADD,
+    I_SUB,
+    I_MUL,
+    // Integer comparisons, dst is a mask.
+    I_EQUAL,
+    S_LESS,
+    S_LESS_EQUAL,
+    U_LESS,
+    U_LESS_EQUAL,
+    // Conversions, out of range floats become 0.
+    S_TO_F,
+    U_TO_F,
+    F_TO_S,
+    F_TO_U,
+    // Bitwise, also used on masks.
+    AND,
+    AND_NOT,
+    OR,
+    XOR,
+    NOT,
+    // dst = the f32 at byte offset `a | b << 16` of uniform buffer `m_slot`.
+    LOAD_UNIFORM,
+    // Like `LOAD_UNIFORM`, plus the per lane byte offset in the u32 register `c`.
+    LOAD_UNIFORM_INDEXED,
+    // dst..dst+3 = rgba of texture `m_slot` at (a, b), for the lanes set in mask `c`.
+    SAMPLE,
+};
+
+struct ShaderInstruction {
+    SHADER_OPCODE m_opcode;
+    u8            m_slot = 0;
+    u16           m_dst = 0;
+    u16           m_a = 0;
+    u16           m_b = 0;
+    u16           m_c = 0;
+};
+
+enum class SHADER_BUILTIN : u8 {
+    NONE,
+    POSITION,
+    POINT_SIZE,
+    FRAG_COORD,
+    FRONT_FACING,
+    VERTEX_INDEX,
+    INSTANCE_INDEX,
+};
+
+inline auto to_string(SHADER_BUILTIN builtin) -> const char* {
+    switch (builtin) {
+        case SHADER_BUILTIN::NONE: return "NONE";
+        case SHADER_BUILTIN::POSITION: return "POSITION";
+        case SHADER_BUILTIN::POINT_SIZE: return "POINT_SIZE";
+        case SHADER_BUILTIN::FRAG_COORD: return "FRAG_COORD";
+        case SHADER_BUILTIN::FRONT_FACING: return "FRONT_FACING";
+        case SHADER_BUILTIN::VERTEX_INDEX: return "VERTEX_INDEX";
+        case SHADER_BUILTIN::INSTANCE_INDEX: return "INSTANCE_INDEX";
+        default: return "UNKNOWN";
+    }
+}
+
+class ShaderProgram {
+public:
+    struct Constant {
+        u16 m_register;
+        u32 m_bits;
+    };
+
+    /// A shader input or output, `m_location` is only valid without a builtin.
+    struct Variable {
+        u32              m_location = 0;
+        SHADER_BUILTIN   m_builtin = SHADER_BUILTIN::NONE;
+        std::vector<u16> m_registers;
+    };
+
+    /// A uniform buffer or sampled image, the slot is the index into the list.
+    struct Binding {
+        u32 m_set = 0;
+        u32 m_binding = 0;
+        u32 m_size = 0;
+    };
+
+public:
+    [[nodiscard]] auto find_input(u32 location) const -> const Variable*;
+    [[nodiscard]] auto find_input(SHADER_BUILTIN builtin) const -> const Variable*;
+    [[nodiscard]] auto find_output(u32 location) const -> const Variable*;
+    [[nodiscard]] auto find_output(SHADER_BUILTIN builtin) const -> const Variable*;
+
+public:
+    SHADER_STAGE m_stage = SHADER_STAGE::VERTEX;
+    u64          m_hash = 0;
+
+    std::vector<ShaderInstruction> m_code;
+    std::vector<Constant>          m_constants;
+    u32                            m_register_count = 0;
+
+    /// Ints, bools and floats share the registers, bools are all bits set or none.
+    std::vector<Variable> m_inputs;
+    std::vector<Variable> m_outputs;
+    /// Same order as in the `ReflectedModule` the program was compiled with.
+    std::vector<Binding>  m_uniform_buffers;
+    std::vector<Binding>  m_sampled_images;
+
+    /// Mask of the lanes to run, written by `ShaderVM::execute`.
+    u16 m_live_mask = 0;
+    /// Mask of the lanes which were discarded.
+    u16 m_discard_mask = 0;
+};
+
+/// Translates one module. Fails for instructions it does not support, like loops or
+/// derivatives, and describes why in `out_error`.
+auto compile_shader(
+    const ShadingCode::Module& module,
+    const ReflectedModule&     reflected,
+    std::string*               out_error
+) -> std::optional<ShaderProgram>;
+
+/*
+    Runs a `ShaderProgram`. Holds the registers, so every thread needs its own.
+    Inputs are written and outputs read through the registers the program lists for them.
+*/
+class ShaderVM {
+public:
+    struct alignas(32) Register {
+        std::array<f32, SHADER_LANES> m_lanes;
+    };
+
+public:
+    ShaderVM() = default;
+    explicit ShaderVM(const ShaderProgram& program);
+
+    [[nodiscard]] auto get_register(u16 index) -> Register& { return m_registers[index]; }
+
+    /// Runs the lanes set in `lane_mask` and returns the ones which were not discarded.
+    /// Uniform buffers and textures are indexed by the slots of the program. Loads past
+    /// the end of a buffer read 0, so a buffer may be smaller than its reflected size.
+    auto execute(
+        u32                                  lane_mask,
+        std::span<const std::span<const u8>> uniform_buffers,
+        std::span<const Texture* const>      textures
+    ) -> u32;
+
+public:
+    const ShaderProgram*  m_program = nullptr;
+    std::vector<Register> m_registers;
+};
+
+/// The native handle of a `ShaderHandle`. The programs are owned by the `ShaderCache` of
+/// the renderer, they are null if the module could not be translated.
+struct Shader {
+    const ShaderProgram* m_vertex = nullptr;
+    const ShaderProgram* m_fragment = nullptr;
+};
+
+/// Compiles every module once, keyed by its SPIR-V and stage.
+class ShaderCache {
+public:
+    /// Returns nullptr if the module can not be translated, without trying again.
+    auto get(const ShadingCode::Module& module) -> const ShaderProgram*;
+
+    [[nodiscard]] auto size() const -> size_t { return m_programs.size(); }
+
+private:
+    /// The module is the key itself, the hash only picks the bucket.
+    struct KeyHash {
+        auto operator()(const ShadingCode::Module& module) const -> size_t;
+    };
+
+    std::unordered_map<ShadingCode::Module, std::unique_ptr<ShaderProgram>, KeyHash>
+        m_programs;
+};
+
+} // namespace software
+} // namespace JadeFrame
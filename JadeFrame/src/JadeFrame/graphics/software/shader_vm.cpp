@@ -0,0 +1,349 @@
+#include "shader_program.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "JadeFrame/utils/assert.h"
+
+#include "raster_kernel.h"
+
+namespace JadeFrame {
+namespace software {
+
+using Register = ShaderVM::Register;
+
+constexpr u32 TRUE_BITS = ~0U;
+
+// The per lane loops are kept trivial, so they are vectorized.
+template<typename F>
+static auto lanes_f(Register& dst, const Register& a, const Register& b, F f) -> void {
+    for (u32 i = 0; i < SHADER_LANES; i++) {
+        dst.m_lanes[i] = f(a.m_lanes[i], b.m_lanes[i]);
+    }
+}
+
+template<typename F>
+static auto lanes_u(Register& dst, const Register& a, const Register& b, F f) -> void {
+    for (u32 i = 0; i < SHADER_LANES; i++) {
+        const u32 result =
+            f(std::bit_cast<u32>(a.m_lanes[i]), std::bit_cast<u32>(b.m_lanes[i]));
+        dst.m_lanes[i] = std::bit_cast<f32>(result);
+    }
+}
+
+template<typename F>
+static auto lanes_compare_f(Register& dst, const Register& a, const Register& b, F f)
+    -> void {
+    for (u32 i = 0; i < SHADER_LANES; i++) {
+        const u32 result = f(a.m_lanes[i], b.m_lanes[i]) ? TRUE_BITS : 0U;
+        dst.m_lanes[i] = std::bit_cast<f32>(result);
+    }
+}
+
+template<typename F>
+static auto lanes_compare_u(Register& dst, const Register& a, const Register& b, F f)
+    -> void {
+    lanes_u(dst, a, b, [&](u32 x, u32 y) { return f(x, y) ? TRUE_BITS : 0U; });
+}
+
+static auto to_lane_mask(const Register& reg) -> u32 {
+    u32 mask = 0;
+    for (u32 i = 0; i < SHADER_LANES; i++) {
+        if (std::bit_cast<u32>(reg.m_lanes[i]) != 0) { mask |= 1U << i; }
+    }
+    return mask;
+}
+
+ShaderVM::ShaderVM(const ShaderProgram& program)
+    : m_program(&program)
+    , m_registers(program.m_register_count, Register{}) {
+    for (const ShaderProgram::Constant& constant : program.m_constants) {
+        const f32 value = std::bit_cast<f32>(constant.m_bits);
+        m_registers[constant.m_register].m_lanes.fill(value);
+    }
+}
+
+auto ShaderVM::execute(
+    u32                                  lane_mask,
+    std::span<const std::span<const u8>> uniform_buffers,
+    std::span<const Texture* const>      textures
+) -> u32 {
+    JF_ASSERT(m_program != nullptr, "the VM has no program");
+    Register* regs = m_registers.data();
+
+    Register& live = regs[m_program->m_live_mask];
+    for (u32 i = 0; i < SHADER_LANES; i++) {
+        const u32 bits = (lane_mask & (1U << i)) != 0 ? TRUE_BITS : 0U;
+        live.m_lanes[i] = std::bit_cast<f32>(bits);
+    }
+
+    for (const ShaderInstruction& in : m_program->m_code) {
+        Register&       dst = regs[in.m_dst];
+        const Register& a = regs[in.m_a];
+        const Register& b = regs[in.m_b];
+        const Register& c = regs[in.m_c];
+
+        switch (in.m_opcode) {
+            case SHADER_OPCODE::SELECT: {
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const u32 mask = std::bit_cast<u32>(a.m_lanes[i]);
+                    const u32 x = std::bit_cast<u32>(b.m_lanes[i]);
+                    const u32 y = std::bit_cast<u32>(c.m_lanes[i]);
+                    dst.m_lanes[i] = std::bit_cast<f32>((x & mask) | (y & ~mask));
+                }
+            } break;
+
+            case SHADER_OPCODE::F_ADD:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return x + y; });
+                break;
+            case SHADER_OPCODE::F_SUB:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return x - y; });
+                break;
+            case SHADER_OPCODE::F_MUL:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return x * y; });
+                break;
+            case SHADER_OPCODE::F_DIV:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return x / y; });
+                break;
+            case SHADER_OPCODE::F_MOD:
+                lanes_f(dst, a, b, [](f32 x, f32 y) {
+                    return x - y * std::floor(x / y);
+                });
+                break;
+            // Like GLSL, which operand is returned for NaN is not defined.
+            case SHADER_OPCODE::F_MIN:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return y < x ? y : x; });
+                break;
+            case SHADER_OPCODE::F_MAX:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return x < y ? y : x; });
+                break;
+            case SHADER_OPCODE::F_POW:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return std::pow(x, y); });
+                break;
+            case SHADER_OPCODE::F_ATAN2:
+                lanes_f(dst, a, b, [](f32 x, f32 y) { return std::atan2(x, y); });
+                break;
+
+            case SHADER_OPCODE::F_NEGATE:
+                lanes_f(dst, a, a, [](f32 x, f32) { return -x; });
+                break;
+            case SHADER_OPCODE::F_ABS:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::fabs(x); });
+                break;
+            case SHADER_OPCODE::F_SIGN:
+                lanes_f(dst, a, a, [](f32 x, f32) {
+                    return x > 0.0F ? 1.0F : (x < 0.0F ? -1.0F : x);
+                });
+                break;
+            case SHADER_OPCODE::F_FLOOR:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::floor(x); });
+                break;
+            case SHADER_OPCODE::F_CEIL:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::ceil(x); });
+                break;
+            case SHADER_OPCODE::F_TRUNC:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::trunc(x); });
+                break;
+            case SHADER_OPCODE::F_ROUND:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::nearbyint(x); });
+                break;
+            case SHADER_OPCODE::F_FRACT:
+                lanes_f(dst, a, a, [](f32 x, f32) { return x - std::floor(x); });
+                break;
+            case SHADER_OPCODE::F_SQRT:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::sqrt(x); });
+                break;
+            case SHADER_OPCODE::F_INVERSE_SQRT:
+                lanes_f(dst, a, a, [](f32 x, f32) { return 1.0F / std::sqrt(x); });
+                break;
+            case SHADER_OPCODE::F_EXP:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::exp(x); });
+                break;
+            case SHADER_OPCODE::F_EXP2:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::exp2(x); });
+                break;
+            case SHADER_OPCODE::F_LOG:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::log(x); });
+                break;
+            case SHADER_OPCODE::F_LOG2:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::log2(x); });
+                break;
+            case SHADER_OPCODE::F_SIN:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::sin(x); });
+                break;
+            case SHADER_OPCODE::F_COS:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::cos(x); });
+                break;
+            case SHADER_OPCODE::F_TAN:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::tan(x); });
+                break;
+            case SHADER_OPCODE::F_ASIN:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::asin(x); });
+                break;
+            case SHADER_OPCODE::F_ACOS:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::acos(x); });
+                break;
+            case SHADER_OPCODE::F_ATAN:
+                lanes_f(dst, a, a, [](f32 x, f32) { return std::atan(x); });
+                break;
+
+            case SHADER_OPCODE::F_EQUAL:
+                lanes_compare_f(dst, a, b, [](f32 x, f32 y) { return x == y; });
+                break;
+            case SHADER_OPCODE::F_LESS:
+                lanes_compare_f(dst, a, b, [](f32 x, f32 y) { return x < y; });
+                break;
+            case SHADER_OPCODE::F_LESS_EQUAL:
+                lanes_compare_f(dst, a, b, [](f32 x, f32 y) { return x <= y; });
+                break;
+            case SHADER_OPCODE::F_UNORDERED:
+                lanes_compare_f(dst, a, b, [](f32 x, f32 y) { return x != x || y != y; });
+                break;
+
+            case SHADER_OPCODE::I_ADD:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x + y; });
+                break;
+            case SHADER_OPCODE::I_SUB:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x - y; });
+                break;
+            case SHADER_OPCODE::I_MUL:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x * y; });
+                break;
+
+            case SHADER_OPCODE::I_EQUAL:
+                lanes_compare_u(dst, a, b, [](u32 x, u32 y) { return x == y; });
+                break;
+            case SHADER_OPCODE::S_LESS:
+                lanes_compare_u(dst, a, b, [](u32 x, u32 y) {
+                    return static_cast<i32>(x) < static_cast<i32>(y);
+                });
+                break;
+            case SHADER_OPCODE::S_LESS_EQUAL:
+                lanes_compare_u(dst, a, b, [](u32 x, u32 y) {
+                    return static_cast<i32>(x) <= static_cast<i32>(y);
+                });
+                break;
+            case SHADER_OPCODE::U_LESS:
+                lanes_compare_u(dst, a, b, [](u32 x, u32 y) { return x < y; });
+                break;
+            case SHADER_OPCODE::U_LESS_EQUAL:
+                lanes_compare_u(dst, a, b, [](u32 x, u32 y) { return x <= y; });
+                break;
+
+            case SHADER_OPCODE::S_TO_F: {
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const i32 x = std::bit_cast<i32>(a.m_lanes[i]);
+                    dst.m_lanes[i] = static_cast<f32>(x);
+                }
+            } break;
+            case SHADER_OPCODE::U_TO_F: {
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const u32 x = std::bit_cast<u32>(a.m_lanes[i]);
+                    dst.m_lanes[i] = static_cast<f32>(x);
+                }
+            } break;
+            // Lanes which are not running hold anything, converting it must not be UB.
+            case SHADER_OPCODE::F_TO_S: {
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const f32 x = a.m_lanes[i];
+                    const bool is_in_range = x >= -2147483648.0F && x < 2147483648.0F;
+                    const i32  result = is_in_range ? static_cast<i32>(x) : 0;
+                    dst.m_lanes[i] = std::bit_cast<f32>(result);
+                }
+            } break;
+            case SHADER_OPCODE::F_TO_U: {
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const f32 x = a.m_lanes[i];
+                    const bool is_in_range = x > -1.0F && x < 4294967296.0F;
+                    const u32  result = is_in_range ? static_cast<u32>(x) : 0;
+                    dst.m_lanes[i] = std::bit_cast<f32>(result);
+                }
+            } break;
+
+            case SHADER_OPCODE::AND:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x & y; });
+                break;
+            case SHADER_OPCODE::AND_NOT:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x & ~y; });
+                break;
+            case SHADER_OPCODE::OR:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x | y; });
+                break;
+            case SHADER_OPCODE::XOR:
+                lanes_u(dst, a, b, [](u32 x, u32 y) { return x ^ y; });
+                break;
+            case SHADER_OPCODE::NOT:
+                lanes_u(dst, a, a, [](u32 x, u32) { return ~x; });
+                break;
+
+            case SHADER_OPCODE::LOAD_UNIFORM: {
+                // The compiler checked the offset against the reflected size, the bound
+                // buffer may still be shorter.
+                f32 value = 0.0F;
+                if (in.m_slot < uniform_buffers.size()) {
+                    const std::span<const u8> buffer = uniform_buffers[in.m_slot];
+                    const u32 offset = in.m_a | (static_cast<u32>(in.m_b) << 16);
+                    if (offset + sizeof(value) <= buffer.size()) {
+                        std::memcpy(&value, &buffer[offset], sizeof(value));
+                    }
+                }
+                dst.m_lanes.fill(value);
+            } break;
+            case SHADER_OPCODE::LOAD_UNIFORM_INDEXED: {
+                // The index is not checked by the compiler, lanes outside the buffer
+                // read 0.
+                const std::span<const u8> buffer =
+                    in.m_slot < uniform_buffers.size() ? uniform_buffers[in.m_slot]
+                                                       : std::span<const u8>();
+                const u64 base = in.m_a | (static_cast<u64>(in.m_b) << 16);
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const u64 offset = base + std::bit_cast<u32>(c.m_lanes[i]);
+                    f32       value = 0.0F;
+                    if (offset + sizeof(value) <= buffer.size()) {
+                        std::memcpy(&value, &buffer[offset], sizeof(value));
+                    }
+                    dst.m_lanes[i] = value;
+                }
+            } break;
+            case SHADER_OPCODE::SAMPLE: {
+                Register* rgba = &regs[in.m_dst];
+                const Texture* texture =
+                    in.m_slot < textures.size() ? textures[in.m_slot] : nullptr;
+                // Without a texture, opaque black.
+                if (texture == nullptr || texture->m_texels.empty()) {
+                    for (u32 i = 0; i < 3; i++) { rgba[i].m_lanes.fill(0.0F); }
+                    rgba[3].m_lanes.fill(1.0F);
+                    break;
+                }
+                Register u;
+                Register v;
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    u.m_lanes[i] = std::isfinite(a.m_lanes[i]) ? a.m_lanes[i] : 0.0F;
+                    v.m_lanes[i] = std::isfinite(b.m_lanes[i]) ? b.m_lanes[i] : 0.0F;
+                }
+                std::array<u32, SHADER_LANES> texels;
+                sample_lanes(
+                    *texture,
+                    u.m_lanes.data(),
+                    v.m_lanes.data(),
+                    to_lane_mask(c),
+                    SHADER_LANES,
+                    texels.data()
+                );
+                for (u32 i = 0; i < SHADER_LANES; i++) {
+                    const u32 texel = texels[i];
+                    rgba[0].m_lanes[i] = static_cast<f32>((texel >> 16) & 0xFF) / 255.0F;
+                    rgba[1].m_lanes[i] = static_cast<f32>((texel >> 8) & 0xFF) / 255.0F;
+                    rgba[2].m_lanes[i] = static_cast<f32>((texel >> 0) & 0xFF) / 255.0F;
+                    rgba[3].m_lanes[i] = static_cast<f32>((texel >> 24) & 0xFF) / 255.0F;
+                }
+            } break;
+        }
+    }
+
+    return lane_mask & ~to_lane_mask(regs[m_program->m_discard_mask]);
+}
+
+} // namespace software
+} // namespace JadeFrame
@@ -1,5 +1,181 @@
 #include "software_renderer.h"
 #include "JadeFrame/math/vec.h"
+#include "JadeFrame/graphics/color.h"
+#include "JadeFrame/graphics/mesh.h"
+#include "JadeFrame/platform/window.h"
+
+namespace JadeFrame {
+
+Software_Renderer::Software_Renderer(RenderSystem& system, Window* window)
+    : m_system(&system)
+    , m_swapchain(window) {
+
+    const v2u32 size = m_swapchain.get_size();
+    m_framebuffer.resize(size.x, size.y);
+    m_viewport = software::Viewport{0, 0, size.x, size.y};
+    Logger::info(
+        "Software renderer: {}x{} framebuffer, {} workers, {}x{} tiles",
+        size.x,
+        size.y,
+        m_thread_pool.worker_count(),
+        software::Rasterizer::TILE_SIZE,
+        software::Rasterizer::TILE_SIZE
+    );
+}
+
+auto Software_Renderer::set_clear_color(const RGBAColor& color) -> void {
+    m_clear_color = software::pack_color(color.r, color.g, color.b, color.a);
+}
+
+auto Software_Renderer::clear_background() -> void { m_is_clear_pending = true; }
+
+auto Software_Renderer::set_viewport(u32 x, u32 y, u32 width, u32 height) const -> void {
+    m_viewport = software::Viewport{x, y, width, height};
+}
+
+auto Software_Renderer::present() -> void { m_swapchain.present(m_framebuffer); }
+
+auto Software_Renderer::wait_until_idle() -> void {
+    // NOTE: Rendering is synchronous, once `render` returns all workers are idle.
+}
+
+auto Software_Renderer::get_frames_in_flight() const -> u32 { return 0; }
+
+auto Software_Renderer::render(const Camera& camera) -> void {
+    const v2u32 size = m_swapchain.get_size();
+    if (size.x != m_framebuffer.m_width || size.y != m_framebuffer.m_height) {
+        m_framebuffer.resize(size.x, size.y);
+        m_viewport = software::Viewport{0, 0, size.x, size.y};
+    }
+
+    // The rasterizer uses a zero-to-one depth range, like Vulkan.
+    const mat4x4 view_projection = camera.get_view_projection("Vulkan");
+
+    RenderQueue& render_queue = m_system->prepare_draw_queue(camera, &m_thread_pool);
+    software::to_draw_calls(render_queue.get_commands(), view_projection, m_draw_calls);
+
+    const software::Rasterizer::Clear clear = {
+        .m_enabled = m_is_clear_pending,
+        .m_color = m_clear_color,
+        .m_depth = 1.0F,
+    };
+    m_rasterizer.draw(m_framebuffer, m_viewport, m_draw_calls, clear, m_thread_pool);
+    m_is_clear_pending = false;
+
+    render_queue.clear();
+}
+
+auto Software_Renderer::take_screenshot(const char* /*filename*/) -> Image {
+    return software::to_image(m_framebuffer);
+}
+
+namespace software {
+
+// The bytes a program reads for the uniform buffer bound at `binding`. The material
+// describes which binding holds the camera and which the transform.
+static auto get_uniform_bytes(
+    const ShaderProgram::Binding& binding,
+    const MaterialInfo&           info,
+    const mat4x4&                 view_projection,
+    const mat4x4&                 transform
+) -> std::span<const u8> {
+    auto as_bytes = [](const mat4x4& matrix) -> std::span<const u8> {
+        return {reinterpret_cast<const u8*>(&matrix), sizeof(matrix)};
+    };
+    auto is_bound = [&](const char* name) -> bool {
+        const MaterialInfo::BindGroup* group = info.get_bind_group_by_name(name);
+        return group != nullptr && group->m_set == binding.m_set &&
+               group->m_binding == binding.m_binding;
+    };
+    // Every draw is a single instance, so the transform is the first of the array.
+    if (is_bound("Camera")) { return as_bytes(view_projection); }
+    if (is_bound("Transform")) { return as_bytes(transform); }
+    return {};
+}
+
+static auto bind_uniforms(
+    const ShaderProgram*            program,
+    const MaterialInfo&             info,
+    const mat4x4&                   view_projection,
+    const mat4x4&                   transform,
+    Rasterizer::DrawCall::Uniforms& out
+) -> void {
+    if (program == nullptr) { return; }
+    const size_t count =
+        std::min<size_t>(program->m_uniform_buffers.size(), out.size());
+    for (size_t i = 0; i < count; i++) {
+        out[i] = get_uniform_bytes(
+            program->m_uniform_buffers[i], info, view_projection, transform
+        );
+    }
+}
+
+auto to_draw_calls(
+    std::span<const RenderCommand>     render_commands,
+    const mat4x4&                      view_projection,
+    std::vector<Rasterizer::DrawCall>& draw_calls
+) -> void {
+    draw_calls.clear();
+    draw_calls.reserve(render_commands.size());
+    for (const RenderCommand& cmd : render_commands) {
+        if (cmd.vertex_data == nullptr) { continue; }
+
+        Rasterizer::DrawCall& draw_call = draw_calls.emplace_back(Rasterizer::DrawCall{
+            .m_mvp = view_projection * *cmd.transform,
+            .m_mesh = cmd.vertex_data,
+        });
+        if (cmd.material == nullptr || cmd.material->m_handle == nullptr) { continue; }
+
+        const auto* material = static_cast<const Material*>(cmd.material->m_handle.get());
+        draw_call.m_texture = material->m_texture;
+        if (material->m_shader == nullptr) { continue; }
+        const MaterialInfo& info = cmd.material->m_info;
+        draw_call.m_vertex = material->m_shader->m_vertex;
+        draw_call.m_fragment = material->m_shader->m_fragment;
+        bind_uniforms(
+            draw_call.m_vertex,
+            info,
+            view_projection,
+            *cmd.transform,
+            draw_call.m_vertex_uniforms
+        );
+        bind_uniforms(
+            draw_call.m_fragment,
+            info,
+            view_projection,
+            *cmd.transform,
+            draw_call.m_fragment_uniforms
+        );
+    }
+}
+
+auto to_image(const Framebuffer& framebuffer) -> Image {
+    const u32 width = framebuffer.m_width;
+    const u32 height = framebuffer.m_height;
+
+    // Same layout as `glReadPixels`, tightly packed RGB with the bottom row first.
+    std::vector<u8> data(static_cast<size_t>(width) * height * 3);
+    for (u32 y = 0; y < height; y++) {
+        const size_t src_row = static_cast<size_t>(height - 1 - y) * width;
+        const u32*   src = &framebuffer.m_color[src_row];
+        u8*          dst = &data[static_cast<size_t>(y) * width * 3];
+        for (u32 x = 0; x < width; x++) {
+            dst[x * 3 + 0] = static_cast<u8>(src[x] >> 16);
+            dst[x * 3 + 1] = static_cast<u8>(src[x] >> 8);
+            dst[x * 3 + 2] = static_cast<u8>(src[x] >> 0);
+        }
+    }
+
+    Image image;
+    image.data = std::move(data);
+    image.width = static_cast<i32>(width);
+    image.height = static_cast<i32>(height);
+    image.num_components = 3;
+    return image;
+}
+
+} // namespace software
+} // namespace JadeFrame
 
 enum COLOUR {
     FG_BLACK = 0x0000,
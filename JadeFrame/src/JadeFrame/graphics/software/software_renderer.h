@@ -1,14 +1,74 @@
 #pragma once
+#include <span>
+#include <vector>
+
 #include "JadeFrame/prelude.h"
+#include "JadeFrame/graphics/graphics_shared.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+#include "framebuffer.h"
+#include "rasterizer.h"
+#include "shader_program.h"
+#include "swapchain.h"
 
-struct Software_Context {};
-struct HWND__;
-typedef HWND__* HWND;
+namespace JadeFrame {
 
-class Software_Renderer {
+class RenderSystem;
+class Window;
+
+/*
+    A CPU renderer. It does not need any GPU or graphics driver, which makes it usable on
+   build machines and headless servers.
+    Shaders are translated into `ShaderProgram`s when they are registered and run by
+   the rasterizer, with the camera and the transform of the draw as their uniforms.
+   Materials whose shaders can not be translated are rendered as vertex color modulated
+   by their texture. Both use the depth test `LESS` and no face culling, matching the
+   defaults of the other backends.
+*/
+class Software_Renderer : public IRenderer {
 public:
-    auto set_context(const HWND& window) -> void;
+    Software_Renderer(RenderSystem& system, Window* window);
+
+    auto present() -> void override;
+    auto wait_until_idle() -> void override;
+    [[nodiscard]] auto get_frames_in_flight() const -> u32 override;
+    auto clear_background() -> void override;
+    auto render(const Camera& camera) -> void override;
+
+    auto set_clear_color(const RGBAColor& color) -> void override;
+    auto set_viewport(u32 x, u32 y, u32 width, u32 height) const -> void override;
+
+    auto take_screenshot(const char* filename) -> Image override;
+
+public:
+    RenderSystem* m_system = nullptr;
+
+    ThreadPool            m_thread_pool;
+    software::Framebuffer m_framebuffer;
+    software::Swapchain   m_swapchain;
+    software::Rasterizer  m_rasterizer;
+    software::ShaderCache m_shader_cache;
+
+    mutable software::Viewport m_viewport;
+    u32                        m_clear_color = software::pack_color(0, 0, 0, 1);
+    bool                       m_is_clear_pending = true;
 
 private:
-    Software_Context m_context;
-};
\ No newline at end of file
+    std::vector<software::Rasterizer::DrawCall> m_draw_calls;
+};
+
+static_assert(is_renderer<Software_Renderer>);
+
+namespace software {
+/// Turns the submitted render commands into draw calls for the `Rasterizer`. They point
+/// at `view_projection` and the transforms of the commands, which have to outlive them.
+auto to_draw_calls(
+    std::span<const RenderCommand>     render_commands,
+    const mat4x4&                      view_projection,
+    std::vector<Rasterizer::DrawCall>& draw_calls
+) -> void;
+/// Reads back the color buffer like `glReadPixels`, RGB with the bottom row first.
+auto to_image(const Framebuffer& framebuffer) -> Image;
+} // namespace software
+
+} // namespace JadeFrame
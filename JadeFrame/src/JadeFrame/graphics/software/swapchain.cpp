@@ -0,0 +1,117 @@
+#include "swapchain.h"
+
+#include <utility>
+
+#include "JadeFrame/platform/window.h"
+#include "JadeFrame/utils/assert.h"
+#if defined(JF_PLATFORM_LINUX)
+    #include "JadeFrame/platform/linux/linux_window.h"
+#endif
+
+namespace JadeFrame {
+namespace software {
+
+Swapchain::Swapchain(Window* window)
+    : m_window(window) {}
+
+Swapchain::Swapchain(Swapchain&& other) noexcept
+    : m_window(std::exchange(other.m_window, nullptr))
+#if defined(JF_PLATFORM_LINUX)
+    , m_gc(std::exchange(other.m_gc, nullptr))
+    , m_image(std::exchange(other.m_image, nullptr))
+#endif
+{
+}
+
+auto Swapchain::operator=(Swapchain&& other) noexcept -> Swapchain& {
+    if (this == &other) { return *this; }
+    this->release();
+
+    m_window = std::exchange(other.m_window, nullptr);
+#if defined(JF_PLATFORM_LINUX)
+    m_gc = std::exchange(other.m_gc, nullptr);
+    m_image = std::exchange(other.m_image, nullptr);
+#endif
+    return *this;
+}
+
+Swapchain::~Swapchain() { this->release(); }
+
+auto Swapchain::release() -> void {
+#if defined(JF_PLATFORM_LINUX)
+    if (m_window != nullptr) {
+        auto* win = dynamic_cast<X11_NativeWindow*>(m_window->m_native_window.get());
+        if (m_image != nullptr) {
+            // The pixels belong to the framebuffer, XDestroyImage must not free them.
+            m_image->data = nullptr;
+            XDestroyImage(m_image);
+        }
+        if (m_gc != nullptr && win != nullptr) { XFreeGC(win->m_display, m_gc); }
+    }
+    m_gc = nullptr;
+    m_image = nullptr;
+#endif
+    m_window = nullptr;
+}
+
+auto Swapchain::get_size() const -> v2u32 {
+    if (m_window == nullptr) { return v2u32::zero(); }
+    return m_window->get_size();
+}
+
+auto Swapchain::present(const Framebuffer& framebuffer) -> void {
+    if (m_window == nullptr || framebuffer.m_color.empty()) { return; }
+
+#if defined(JF_PLATFORM_LINUX)
+    auto* win = dynamic_cast<X11_NativeWindow*>(m_window->m_native_window.get());
+    if (win == nullptr) { return; }
+
+    const bool size_changed =
+        m_image != nullptr && (static_cast<u32>(m_image->width) != framebuffer.m_width ||
+                               static_cast<u32>(m_image->height) != framebuffer.m_height);
+    if (size_changed) {
+        m_image->data = nullptr;
+        XDestroyImage(m_image);
+        m_image = nullptr;
+    }
+
+    if (m_gc == nullptr) { m_gc = XCreateGC(win->m_display, win->m_window, 0, nullptr); }
+    if (m_image == nullptr) {
+        const int screen = DefaultScreen(win->m_display);
+        m_image = XCreateImage(
+            win->m_display,
+            DefaultVisual(win->m_display, screen),
+            static_cast<u32>(DefaultDepth(win->m_display, screen)),
+            ZPixmap,
+            0,
+            nullptr,
+            framebuffer.m_width,
+            framebuffer.m_height,
+            32,
+            static_cast<i32>(framebuffer.m_width * sizeof(u32))
+        );
+    }
+    if (m_image == nullptr) { return; }
+
+    // NOTE: X11 only reads from the buffer, the const_cast is fine.
+    m_image->data = reinterpret_cast<char*>(const_cast<u32*>(framebuffer.m_color.data()));
+    XPutImage(
+        win->m_display,
+        win->m_window,
+        m_gc,
+        m_image,
+        0,
+        0,
+        0,
+        0,
+        framebuffer.m_width,
+        framebuffer.m_height
+    );
+    XFlush(win->m_display);
+#else
+    JF_UNIMPLEMENTED("software presentation is only implemented for X11");
+#endif
+}
+
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,45 @@
+#pragma once
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/vec.h"
+
+#include "framebuffer.h"
+
+#if defined(JF_PLATFORM_LINUX)
+struct _XGC;
+struct _XImage;
+#endif
+
+namespace JadeFrame {
+class Window;
+
+namespace software {
+
+/// Copies a finished `Framebuffer` into the client area of a native window.
+class Swapchain {
+public:
+    Swapchain() = default;
+    ~Swapchain();
+    Swapchain(const Swapchain&) = delete;
+    auto operator=(const Swapchain&) -> Swapchain& = delete;
+    Swapchain(Swapchain&& other) noexcept;
+    auto operator=(Swapchain&& other) noexcept -> Swapchain&;
+
+    explicit Swapchain(Window* window);
+
+    auto present(const Framebuffer& framebuffer) -> void;
+
+    [[nodiscard]] auto get_size() const -> v2u32;
+
+private:
+    auto release() -> void;
+
+public:
+    Window* m_window = nullptr;
+#if defined(JF_PLATFORM_LINUX)
+    _XGC*    m_gc = nullptr;
+    _XImage* m_image = nullptr;
+#endif
+};
+
+} // namespace software
+} // namespace JadeFrame
@@ -0,0 +1,295 @@
+#include "swapchain.h"
+
+#include <charconv>
+#include <cstdio>
+#include <utility>
+
+#include "JadeFrame/utils/logger.h"
+#if defined(JF_PLATFORM_LINUX)
+    #include <cerrno>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+#endif
+
+namespace JadeFrame {
+namespace terminal {
+
+// Used when the size of the terminal can not be queried, e.g. when stdout is a pipe.
+constexpr u32 FALLBACK_COLUMNS = 80;
+constexpr u32 FALLBACK_ROWS = 24;
+// No 24-bit color has this value, it means the terminal state is not known.
+constexpr u32 UNKNOWN = ~0U;
+
+// UTF-8 encoded glyphs.
+constexpr std::string_view UPPER_HALF = "\xE2\x96\x80";
+constexpr std::string_view LOWER_HALF = "\xE2\x96\x84";
+constexpr std::string_view FULL_BLOCK = "\xE2\x96\x88";
+
+static auto append_number(std::string& out, u32 value) -> void {
+    char buffer[10];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+static auto append_rgb(std::string& out, u32 color) -> void {
+    append_number(out, (color >> 16) & 0xFF);
+    out += ';';
+    append_number(out, (color >> 8) & 0xFF);
+    out += ';';
+    append_number(out, (color >> 0) & 0xFF);
+}
+
+/*---------------------------
+    Encoder
+---------------------------*/
+
+/// Tracks what the terminal currently uses, to only send what changes.
+struct Encoder {
+    std::string& m_out;
+    u32          m_columns;
+    u32          m_foreground = UNKNOWN;
+    u32          m_background = UNKNOWN;
+    u32          m_cursor_x = UNKNOWN;
+    u32          m_cursor_y = UNKNOWN;
+
+    auto move_to(u32 x, u32 y) -> void {
+        if (x == m_cursor_x && y == m_cursor_y) { return; }
+        if (y == m_cursor_y && m_cursor_x != UNKNOWN && x > m_cursor_x) {
+            m_out += "\x1b[";
+            if (x - m_cursor_x > 1) { append_number(m_out, x - m_cursor_x); }
+            m_out += 'C';
+        } else {
+            m_out += "\x1b[";
+            append_number(m_out, y + 1);
+            m_out += ';';
+            append_number(m_out, x + 1);
+            m_out += 'H';
+        }
+        m_cursor_x = x;
+        m_cursor_y = y;
+    }
+
+    // Both colors go into one SGR sequence if both change.
+    auto set_colors(u32 foreground, u32 background) -> void {
+        const bool is_foreground_changed = foreground != m_foreground;
+        const bool is_background_changed = background != m_background;
+        if (!is_foreground_changed && !is_background_changed) { return; }
+        m_out += "\x1b[";
+        if (is_foreground_changed) {
+            m_out += "38;2;";
+            append_rgb(m_out, foreground);
+        }
+        if (is_foreground_changed && is_background_changed) { m_out += ';'; }
+        if (is_background_changed) {
+            m_out += "48;2;";
+            append_rgb(m_out, background);
+        }
+        m_out += 'm';
+        m_foreground = foreground;
+        m_background = background;
+    }
+
+    auto put(u32 x, u32 y, const Swapchain::Cell& cell) -> void {
+        this->move_to(x, y);
+
+        std::string_view glyph;
+        if (cell.m_top == cell.m_bottom) {
+            // Reuse whichever color is already set, a space shows the background.
+            if (cell.m_top == m_background) {
+                glyph = " ";
+            } else if (cell.m_top == m_foreground) {
+                glyph = FULL_BLOCK;
+            } else {
+                this->set_colors(m_foreground, cell.m_top);
+                glyph = " ";
+            }
+        } else {
+            // The upper half block draws the top in the foreground color, the lower half
+            // block the bottom. Take the one that needs fewer color changes.
+            const u32 upper_changes = static_cast<u32>(cell.m_top != m_foreground) +
+                                      static_cast<u32>(cell.m_bottom != m_background);
+            const u32 lower_changes = static_cast<u32>(cell.m_bottom != m_foreground) +
+                                      static_cast<u32>(cell.m_top != m_background);
+            if (upper_changes <= lower_changes) {
+                this->set_colors(cell.m_top, cell.m_bottom);
+                glyph = UPPER_HALF;
+            } else {
+                this->set_colors(cell.m_bottom, cell.m_top);
+                glyph = LOWER_HALF;
+            }
+        }
+        m_out += glyph;
+
+        // Writing the last column leaves the cursor in a pending wrap state, which
+        // terminals handle differently.
+        m_cursor_x = x + 1 < m_columns ? x + 1 : UNKNOWN;
+    }
+};
+
+/*---------------------------
+    Swapchain
+---------------------------*/
+
+Swapchain::Swapchain(i32 fd)
+    : m_fd(fd) {}
+
+Swapchain::Swapchain(Swapchain&& other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1))
+    , m_columns(std::exchange(other.m_columns, 0))
+    , m_rows(std::exchange(other.m_rows, 0))
+    , m_cells(std::move(other.m_cells))
+    , m_previous_cells(std::move(other.m_previous_cells))
+    , m_is_previous_valid(std::exchange(other.m_is_previous_valid, false))
+    , m_output(std::move(other.m_output)) {}
+
+auto Swapchain::operator=(Swapchain&& other) noexcept -> Swapchain& {
+    if (this == &other) { return *this; }
+    this->release();
+
+    m_fd = std::exchange(other.m_fd, -1);
+    m_columns = std::exchange(other.m_columns, 0);
+    m_rows = std::exchange(other.m_rows, 0);
+    m_cells = std::move(other.m_cells);
+    m_previous_cells = std::move(other.m_previous_cells);
+    m_is_previous_valid = std::exchange(other.m_is_previous_valid, false);
+    m_output = std::move(other.m_output);
+    return *this;
+}
+
+Swapchain::~Swapchain() { this->release(); }
+
+auto Swapchain::release() -> void {
+    if (m_fd >= 0 && m_is_previous_valid) {
+        // Give the terminal back with default colors, the cursor shown and below the
+        // last frame.
+        m_output = "\x1b[0m\x1b[?25h\x1b[";
+        append_number(m_output, m_rows);
+        m_output += ";1H\n";
+        Swapchain::write(m_fd, m_output);
+    }
+    m_fd = -1;
+    m_columns = 0;
+    m_rows = 0;
+    m_cells.clear();
+    m_previous_cells.clear();
+    m_is_previous_valid = false;
+    m_output.clear();
+}
+
+auto Swapchain::get_size() const -> v2u32 {
+#if defined(JF_PLATFORM_LINUX)
+    winsize size = {};
+    if (m_fd >= 0 && ::ioctl(m_fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 &&
+        size.ws_row > 0) {
+        return v2u32::create(size.ws_col, size.ws_row);
+    }
+#endif
+    return v2u32::create(FALLBACK_COLUMNS, FALLBACK_ROWS);
+}
+
+auto Swapchain::get_framebuffer_size() const -> v2u32 {
+    const v2u32 size = this->get_size();
+    return v2u32::create(size.x * SUPERSAMPLING, size.y * 2 * SUPERSAMPLING);
+}
+
+auto Swapchain::invalidate() -> void { m_is_previous_valid = false; }
+
+auto Swapchain::downsample(const software::Framebuffer& framebuffer) -> void {
+    constexpr u32 AREA = SUPERSAMPLING * SUPERSAMPLING;
+
+    m_columns = framebuffer.m_width / SUPERSAMPLING;
+    m_rows = framebuffer.m_height / (2 * SUPERSAMPLING);
+    m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+
+    // Box filters a `SUPERSAMPLING` sized square of pixels into one 0xRRGGBB color.
+    const u32* pixels = framebuffer.m_color.data();
+    const u32  width = framebuffer.m_width;
+    auto       average = [&](u32 x0, u32 y0) -> u32 {
+        u32 r = 0;
+        u32 g = 0;
+        u32 b = 0;
+        for (u32 y = y0; y < y0 + SUPERSAMPLING; y++) {
+            const u32* row = &pixels[static_cast<size_t>(y) * width];
+            for (u32 x = x0; x < x0 + SUPERSAMPLING; x++) {
+                r += (row[x] >> 16) & 0xFF;
+                g += (row[x] >> 8) & 0xFF;
+                b += (row[x] >> 0) & 0xFF;
+            }
+        }
+        r = (r + AREA / 2) / AREA;
+        g = (g + AREA / 2) / AREA;
+        b = (b + AREA / 2) / AREA;
+        return (r << 16) | (g << 8) | b;
+    };
+
+    for (u32 cy = 0; cy < m_rows; cy++) {
+        for (u32 cx = 0; cx < m_columns; cx++) {
+            const u32 x = cx * SUPERSAMPLING;
+            const u32 y = cy * 2 * SUPERSAMPLING;
+            m_cells[static_cast<size_t>(cy) * m_columns + cx] = Cell{
+                .m_top = average(x, y),
+                .m_bottom = average(x, y + SUPERSAMPLING),
+            };
+        }
+    }
+}
+
+auto Swapchain::encode(const software::Framebuffer& framebuffer) -> std::string_view {
+    const u32 previous_columns = m_columns;
+    const u32 previous_rows = m_rows;
+    this->downsample(framebuffer);
+
+    m_output.clear();
+    const bool is_full = !m_is_previous_valid || m_columns != previous_columns ||
+                         m_rows != previous_rows;
+    // Hide the cursor, reset the colors and clear the screen.
+    if (is_full) { m_output += "\x1b[?25l\x1b[0m\x1b[2J"; }
+
+    // Whatever was printed to the terminal in between is unknown, so every frame starts
+    // without assumptions.
+    Encoder encoder = {.m_out = m_output, .m_columns = m_columns};
+    for (u32 y = 0; y < m_rows; y++) {
+        for (u32 x = 0; x < m_columns; x++) {
+            const size_t index = static_cast<size_t>(y) * m_columns + x;
+            if (!is_full && m_cells[index] == m_previous_cells[index]) { continue; }
+            encoder.put(x, y, m_cells[index]);
+        }
+    }
+    // NOTE: Leave the default colors behind, in case anything else prints to the
+    // terminal. Whoever does has to call `invalidate`, or the next diff is drawn over
+    // stale cells.
+    if (!m_output.empty()) { m_output += "\x1b[0m"; }
+
+    std::swap(m_cells, m_previous_cells);
+    m_is_previous_valid = true;
+    return m_output;
+}
+
+auto Swapchain::present(const software::Framebuffer& framebuffer) -> void {
+    const std::string_view bytes = this->encode(framebuffer);
+    if (bytes.empty() || m_fd < 0) { return; }
+    Swapchain::write(m_fd, bytes);
+}
+
+auto Swapchain::write(i32 fd, std::string_view bytes) -> void {
+#if defined(JF_PLATFORM_LINUX)
+    // One call per frame. It only loops if the terminal takes the frame in parts.
+    while (!bytes.empty()) {
+        const ssize_t written = ::write(fd, bytes.data(), bytes.size());
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            Logger::err("Failed to write to the terminal: errno {}", errno);
+            return;
+        }
+        bytes.remove_prefix(static_cast<size_t>(written));
+    }
+#else
+    // NOTE: Only stdout is supported here.
+    (void)fd;
+    std::fwrite(bytes.data(), 1, bytes.size(), stdout);
+    std::fflush(stdout);
+#endif
+}
+
+} // namespace terminal
+} // namespace JadeFrame
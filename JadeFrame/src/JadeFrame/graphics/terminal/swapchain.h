@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/vec.h"
+#include "JadeFrame/graphics/software/framebuffer.h"
+
+namespace JadeFrame {
+namespace terminal {
+
+/*
+    Presents a `software::Framebuffer` on an ANSI terminal with 24-bit color.
+    Every character cell shows two pixels with a half-block glyph, one as foreground and
+   one as background color. The framebuffer is rendered at `SUPERSAMPLING` times that
+   resolution and box filtered down.
+    Only cells which changed since the last frame are written. Skipped cells are jumped
+   over with cursor movements and colors are only sent when they differ from the current
+   ones, so runs of same-colored cells share one escape sequence. A frame is written with
+   a single `write`.
+*/
+class Swapchain {
+public:
+    constexpr static u32 SUPERSAMPLING = 2;
+    constexpr static i32 STDOUT_FD = 1;
+
+    /// A cell is two pixels stacked on top of each other, as 0xRRGGBB.
+    struct Cell {
+        u32 m_top = 0;
+        u32 m_bottom = 0;
+
+        auto operator==(const Cell& other) const -> bool = default;
+    };
+
+public:
+    Swapchain() = default;
+    ~Swapchain();
+    Swapchain(const Swapchain&) = delete;
+    auto operator=(const Swapchain&) -> Swapchain& = delete;
+    Swapchain(Swapchain&& other) noexcept;
+    auto operator=(Swapchain&& other) noexcept -> Swapchain&;
+
+    /// `fd` is the file descriptor of the terminal, usually the one of stdout. Without
+    /// one, frames are only encoded.
+    explicit Swapchain(i32 fd);
+
+    auto present(const software::Framebuffer& framebuffer) -> void;
+    /// Builds the bytes `present` writes. The next frame is diffed against this one.
+    auto encode(const software::Framebuffer& framebuffer) -> std::string_view;
+    /// Forgets the previous frame, the next one is written completely. Needed after
+    /// anything else wrote to the terminal.
+    auto invalidate() -> void;
+
+    /// Size in character cells, queried from the terminal.
+    [[nodiscard]] auto get_size() const -> v2u32;
+    /// Size of the framebuffer which maps onto the cells.
+    [[nodiscard]] auto get_framebuffer_size() const -> v2u32;
+
+private:
+    auto release() -> void;
+    auto downsample(const software::Framebuffer& framebuffer) -> void;
+    static auto write(i32 fd, std::string_view bytes) -> void;
+
+public:
+    i32 m_fd = -1;
+
+    u32               m_columns = 0;
+    u32               m_rows = 0;
+    std::vector<Cell> m_cells;
+    std::vector<Cell> m_previous_cells;
+    bool              m_is_previous_valid = false;
+    std::string       m_output;
+};
+
+} // namespace terminal
+} // namespace JadeFrame
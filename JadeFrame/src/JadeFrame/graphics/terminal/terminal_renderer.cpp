@@ -0,0 +1,80 @@
+#include "terminal_renderer.h"
+
+#include "JadeFrame/graphics/color.h"
+#include "JadeFrame/graphics/software/software_renderer.h"
+
+namespace JadeFrame {
+
+Terminal_Renderer::Terminal_Renderer(RenderSystem& system, Window* /*window*/)
+    : m_system(&system)
+    , m_swapchain(terminal::Swapchain::STDOUT_FD) {
+    Logger::set_console_enabled(false);
+
+    const v2u32 size = m_swapchain.get_size();
+    const v2u32 fb_size = m_swapchain.get_framebuffer_size();
+    m_framebuffer.resize(fb_size.x, fb_size.y);
+    Logger::info(
+        "Terminal renderer: {}x{} cells, {}x{} framebuffer, {} workers",
+        size.x,
+        size.y,
+        fb_size.x,
+        fb_size.y,
+        m_thread_pool.worker_count()
+    );
+}
+
+Terminal_Renderer::~Terminal_Renderer() { Logger::set_console_enabled(true); }
+
+auto Terminal_Renderer::set_clear_color(const RGBAColor& color) -> void {
+    m_clear_color = software::pack_color(color.r, color.g, color.b, color.a);
+}
+
+auto Terminal_Renderer::clear_background() -> void { m_is_clear_pending = true; }
+
+auto Terminal_Renderer::set_viewport(
+    u32 /*x*/,
+    u32 /*y*/,
+    u32 /*width*/,
+    u32 /*height*/
+) const -> void {
+    // NOTE: The viewport follows the size of the terminal, see `render`.
+}
+
+auto Terminal_Renderer::present() -> void { m_swapchain.present(m_framebuffer); }
+
+auto Terminal_Renderer::wait_until_idle() -> void {
+    // NOTE: Rendering is synchronous, once `render` returns all workers are idle.
+}
+
+auto Terminal_Renderer::get_frames_in_flight() const -> u32 { return 0; }
+
+auto Terminal_Renderer::render(const Camera& camera) -> void {
+    const v2u32 size = m_swapchain.get_framebuffer_size();
+    if (size.x != m_framebuffer.m_width || size.y != m_framebuffer.m_height) {
+        m_framebuffer.resize(size.x, size.y);
+        m_is_clear_pending = true;
+    }
+
+    // The rasterizer uses a zero-to-one depth range, like Vulkan.
+    const mat4x4 view_projection = camera.get_view_projection("Vulkan");
+
+    RenderQueue& render_queue = m_system->prepare_draw_queue(camera, &m_thread_pool);
+    software::to_draw_calls(render_queue.get_commands(), view_projection, m_draw_calls);
+
+    const software::Rasterizer::Clear clear = {
+        .m_enabled = m_is_clear_pending,
+        .m_color = m_clear_color,
+        .m_depth = 1.0F,
+    };
+    const software::Viewport viewport = {0, 0, size.x, size.y};
+    m_rasterizer.draw(m_framebuffer, viewport, m_draw_calls, clear, m_thread_pool);
+    m_is_clear_pending = false;
+
+    render_queue.clear();
+}
+
+auto Terminal_Renderer::take_screenshot(const char* /*filename*/) -> Image {
+    return software::to_image(m_framebuffer);
+}
+
+} // namespace JadeFrame
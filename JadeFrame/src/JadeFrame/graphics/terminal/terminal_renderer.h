@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/graphics/graphics_shared.h"
+#include "JadeFrame/graphics/software/framebuffer.h"
+#include "JadeFrame/graphics/software/rasterizer.h"
+#include "JadeFrame/graphics/software/shader_program.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+#include "swapchain.h"
+
+namespace JadeFrame {
+
+class RenderSystem;
+class Window;
+
+/*
+    Renders into the terminal the program runs in, using the software rasterizer. Useful
+   over SSH and on machines without a display.
+    Materials are handled like in the `Software_Renderer`. The window is not used, the
+   frame always covers the whole terminal.
+    The logger is kept off the console while the renderer exists. Its lines would move the
+   cursor or scroll the terminal, and the frames after them are only diffs.
+*/
+class Terminal_Renderer : public IRenderer {
+public:
+    Terminal_Renderer(RenderSystem& system, Window* window);
+    ~Terminal_Renderer() override;
+
+    auto present() -> void override;
+    auto wait_until_idle() -> void override;
+    [[nodiscard]] auto get_frames_in_flight() const -> u32 override;
+    auto clear_background() -> void override;
+    auto render(const Camera& camera) -> void override;
+
+    auto set_clear_color(const RGBAColor& color) -> void override;
+    auto set_viewport(u32 x, u32 y, u32 width, u32 height) const -> void override;
+
+    auto take_screenshot(const char* filename) -> Image override;
+
+public:
+    RenderSystem* m_system = nullptr;
+
+    ThreadPool            m_thread_pool;
+    software::Framebuffer m_framebuffer;
+    terminal::Swapchain   m_swapchain;
+    software::Rasterizer  m_rasterizer;
+    software::ShaderCache m_shader_cache;
+
+    u32  m_clear_color = software::pack_color(0, 0, 0, 1);
+    bool m_is_clear_pending = true;
+
+private:
+    std::vector<software::Rasterizer::DrawCall> m_draw_calls;
+};
+
+static_assert(is_renderer<Terminal_Renderer>);
+
+} // namespace JadeFrame
@@ -0,0 +1,140 @@
+/*
+    Measures the fill rate of the software rasterizer kernels against the scalar one.
+    Usage: bench_raster_kernel [thread_count]
+    Every scene covers the whole 1920x1080 framebuffer several times with triangles of
+   different sizes. Most are drawn back to front so that every pixel passes the depth
+   test. The rate counts every pixel drawn, hidden or not.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "JadeFrame/graphics/mesh.h"
+#include "JadeFrame/graphics/software/rasterizer.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+using namespace JadeFrame;
+
+constexpr u32 WIDTH = 1920;
+constexpr u32 HEIGHT = 1080;
+constexpr u32 LAYERS = 4;
+
+struct Scene {
+    const char* m_name;
+    u32         m_cell_size;
+    bool        m_is_textured;
+    bool        m_is_front_to_back = false;
+};
+
+static auto to_ndc_x(u32 x) -> f32 { return -1.0F + 2.0F * static_cast<f32>(x) / WIDTH; }
+
+static auto to_ndc_y(u32 y) -> f32 { return 1.0F - 2.0F * static_cast<f32>(y) / HEIGHT; }
+
+// A grid of quads with cells of `cell_size` pixels, one grid per layer.
+static auto make_grid(u32 cell_size, bool is_front_to_back) -> Mesh {
+    std::vector<f32> positions;
+    std::vector<f32> uvs;
+    const u32        cells_x = (WIDTH + cell_size - 1) / cell_size;
+    const u32        cells_y = (HEIGHT + cell_size - 1) / cell_size;
+    for (u32 layer = 0; layer < LAYERS; layer++) {
+        const f32 step = 0.8F * static_cast<f32>(layer) / LAYERS;
+        const f32 z = is_front_to_back ? 0.1F + step : 0.9F - step;
+        for (u32 cy = 0; cy < cells_y; cy++) {
+            for (u32 cx = 0; cx < cells_x; cx++) {
+                const f32 x0 = to_ndc_x(cx * cell_size);
+                const f32 x1 = to_ndc_x((cx + 1) * cell_size);
+                const f32 y0 = to_ndc_y(cy * cell_size);
+                const f32 y1 = to_ndc_y((cy + 1) * cell_size);
+                positions.insert(
+                    positions.end(),
+                    {x0, y0, z, x1, y0, z, x1, y1, z, x0, y0, z, x1, y1, z, x0, y1, z}
+                );
+                uvs.insert(uvs.end(), {0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1});
+            }
+        }
+    }
+    Mesh mesh;
+    mesh.insert_attribute(Mesh::POSITION, positions);
+    mesh.insert_attribute(Mesh::UV, uvs);
+    return mesh;
+}
+
+int main(int argc, char** argv) {
+    const u32  thread_count = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 0;
+    ThreadPool pool(thread_count);
+
+    std::vector<u8> pixels(64 * 64 * 4);
+    for (size_t i = 0; i < pixels.size(); i++) { pixels[i] = static_cast<u8>(i * 31); }
+    const software::Texture texture(pixels.data(), v2u32::create(64, 64), 4);
+
+    const Scene scenes[] = {
+        {"fullscreen", WIDTH, false},
+        {"cells 64px", 64, false},
+        {"cells 16px", 16, false},
+        {"cells 4px", 4, false},
+        {"cells 64px textured", 64, true},
+        // Only the first layer is visible, the hierarchical depth test skips the rest.
+        {"cells 64px occluded", 64, true, true},
+    };
+    const software::RASTER_KERNEL kernels[] = {
+        software::RASTER_KERNEL::SCALAR,
+        software::RASTER_KERNEL::SSE2,
+        software::RASTER_KERNEL::AVX2,
+    };
+
+    std::printf(
+        "%ux%u, %u layers, %u worker(s)\n", WIDTH, HEIGHT, LAYERS, pool.worker_count()
+    );
+    std::printf("%-22s %-8s %10s %9s\n", "scene", "kernel", "MPix/s", "speedup");
+    for (const Scene& scene : scenes) {
+        const Mesh mesh = make_grid(scene.m_cell_size, scene.m_is_front_to_back);
+
+        const software::Rasterizer::DrawCall call = {
+            .m_mvp = mat4x4::identity(),
+            .m_mesh = &mesh,
+            .m_texture = scene.m_is_textured ? &texture : nullptr,
+        };
+        const software::Rasterizer::Clear clear = {.m_enabled = true};
+
+        f64                   scalar_rate = 0.0;
+        software::Framebuffer reference;
+        for (const software::RASTER_KERNEL kernel : kernels) {
+            if (!software::is_supported(kernel)) { continue; }
+            software::Framebuffer fb(WIDTH, HEIGHT);
+            software::Rasterizer  rasterizer;
+            rasterizer.set_kernel(kernel);
+
+            // One warm up frame, then as many frames as fit into half a second.
+            const std::span<const software::Rasterizer::DrawCall> calls(&call, 1);
+            rasterizer.draw(fb, software::Viewport{}, calls, clear, pool);
+            using Clock = std::chrono::steady_clock;
+            const auto start = Clock::now();
+            u32        frames = 0;
+            f64        seconds = 0.0;
+            while (seconds < 0.5) {
+                rasterizer.draw(fb, software::Viewport{}, calls, clear, pool);
+                frames++;
+                seconds = std::chrono::duration<f64>(Clock::now() - start).count();
+            }
+
+            const f64 pixels_drawn = static_cast<f64>(frames) * LAYERS * WIDTH * HEIGHT;
+            const f64 rate = pixels_drawn / seconds / 1e6;
+            if (kernel == software::RASTER_KERNEL::SCALAR) {
+                scalar_rate = rate;
+                reference = fb;
+            }
+            const bool is_matching =
+                fb.m_color == reference.m_color && fb.m_depth == reference.m_depth;
+            std::printf(
+                "%-22s %-8s %10.1f %8.2fx%s\n",
+                scene.m_name,
+                software::to_string(kernel),
+                rate,
+                rate / scalar_rate,
+                is_matching ? "" : "  (output differs from SCALAR)"
+            );
+        }
+    }
+    return 0;
+}
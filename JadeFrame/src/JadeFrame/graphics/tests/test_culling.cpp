@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "JadeFrame/graphics/camera.h"
+#include "JadeFrame/graphics/culling.h"
+#include "JadeFrame/graphics/mesh.h"
+#include "JadeFrame/graphics/render_queue.h"
+#include "JadeFrame/graphics/software/raster_kernel.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+using namespace JadeFrame;
+
+static auto make_camera() -> Camera {
+    return Camera::perspective(v3::create(1.0F, 2.0F, 3.0F), 1.5F, 1.0F, 0.1F, 100.0F);
+}
+
+static auto sphere(const v3& center, f32 radius) -> BoundingSphere {
+    return BoundingSphere{.m_center = center, .m_radius = radius};
+}
+
+TEST(Culling, MeshBoundsEncloseThePositions) {
+    Mesh mesh;
+    mesh.insert_attribute(Mesh::POSITION, {-1, 0, 0, 3, 2, 0, 1, 0, 4});
+    const MeshBounds bounds = MeshBounds::from_mesh(mesh);
+    EXPECT_EQ(bounds.m_aabb.m_min.x, -1.0F);
+    EXPECT_EQ(bounds.m_aabb.m_max.y, 2.0F);
+    EXPECT_EQ(bounds.m_aabb.m_max.z, 4.0F);
+    EXPECT_EQ(bounds.m_sphere.m_center.x, 1.0F);
+    EXPECT_FLOAT_EQ(bounds.m_sphere.m_radius, std::sqrt(9.0F));
+
+    // Without positions there is nothing to bound, so the mesh is never culled.
+    EXPECT_TRUE(std::isinf(MeshBounds::from_mesh(Mesh{}).m_sphere.m_radius));
+}
+
+TEST(Culling, FrustumOfTheCamera) {
+    const Camera  camera = make_camera();
+    const Frustum frustum = camera.get_frustum();
+    const v3&     position = camera.m_position;
+    const v3&     forward = camera.m_orientation.m_forward;
+    const v3&     right = camera.m_orientation.m_right;
+
+    EXPECT_TRUE(frustum.is_visible(sphere(position + forward * 10.0F, 0.5F)));
+    EXPECT_FALSE(frustum.is_visible(sphere(position - forward * 10.0F, 0.5F)));
+    EXPECT_FALSE(frustum.is_visible(sphere(position + forward * 200.0F, 0.5F)));
+    EXPECT_FALSE(
+        frustum.is_visible(sphere(position + forward * 10.0F + right * 1000.0F, 0.5F))
+    );
+    // Behind the near plane, but large enough to reach into the frustum.
+    EXPECT_TRUE(frustum.is_visible(sphere(position - forward * 10.0F, 20.0F)));
+    EXPECT_TRUE(frustum.is_visible(BoundingSphere::infinite()));
+}
+
+TEST(Culling, KernelsAgree) {
+    if (!software::is_supported(software::RASTER_KERNEL::AVX2)) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    const Frustum frustum = make_camera().get_frustum();
+
+    // Not a multiple of 8, so the tail is tested too.
+    constexpr u32                       COUNT = 1003;
+    std::mt19937                        rng(3);
+    std::uniform_real_distribution<f32> position(-150.0F, 150.0F);
+    std::uniform_real_distribution<f32> radius(0.0F, 20.0F);
+    std::vector<f32>                    x(COUNT);
+    std::vector<f32>                    y(COUNT);
+    std::vector<f32>                    z(COUNT);
+    std::vector<f32>                    r(COUNT);
+    for (u32 i = 0; i < COUNT; i++) {
+        x[i] = position(rng);
+        y[i] = position(rng);
+        z[i] = position(rng);
+        r[i] = radius(rng);
+    }
+    const SphereArrays spheres = {x.data(), y.data(), z.data(), r.data()};
+
+    std::vector<u8> scalar(COUNT);
+    std::vector<u8> avx2(COUNT);
+    const u32 scalar_count = cull_spheres_scalar(frustum, spheres, COUNT, scalar.data());
+    const u32 avx2_count = cull_spheres_avx2(frustum, spheres, COUNT, avx2.data());
+    EXPECT_GT(scalar_count, 0U);
+    EXPECT_LT(scalar_count, COUNT);
+    EXPECT_EQ(scalar_count, avx2_count);
+    EXPECT_EQ(scalar, avx2);
+}
+
+TEST(Culling, QueueKeepsTheVisibleCommandsInOrder) {
+    const Camera         camera = make_camera();
+    const v3             forward = camera.m_orientation.m_forward * 10.0F;
+    const v3             ahead = camera.m_position + forward;
+    const v3             behind = camera.m_position - forward;
+    const BoundingSphere unit = sphere(v3::zero(), 1.0F);
+
+    ThreadPool  pool(3);
+    RenderQueue queue;
+    for (u32 i = 0; i < 20000; i++) {
+        const v3 position = i % 4 == 0 ? ahead : behind;
+        queue.push({.m_key = i}, mat4x4::translation(position), unit);
+    }
+    queue.cull(camera.get_frustum(), &pool);
+
+    EXPECT_EQ(queue.get_cull_stats().m_visible, 5000U);
+    EXPECT_EQ(queue.get_cull_stats().m_culled, 15000U);
+    const std::span<const RenderCommand> commands = queue.get_commands();
+    ASSERT_EQ(commands.size(), 5000U);
+    for (u32 i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].m_key, i * 4) << i;
+    }
+
+    // The stats stay until the next cull.
+    queue.clear();
+    EXPECT_EQ(queue.get_cull_stats().m_visible, 5000U);
+}
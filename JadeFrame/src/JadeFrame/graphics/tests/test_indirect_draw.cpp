@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "JadeFrame/graphics/graphics_shared.h"
+#include "JadeFrame/graphics/indirect_draw.h"
+#include "JadeFrame/graphics/mesh.h"
+
+using namespace JadeFrame;
+
+static auto make_mesh(u32 vertex_count, u32 index_count) -> Mesh {
+    Mesh mesh;
+    mesh.m_attributes[Mesh::POSITION.m_id] = Mesh::AttributeData{
+        .m_attribute = Mesh::POSITION,
+        .m_data = std::vector<f32>(vertex_count * 3, 0.0F),
+    };
+    mesh.m_indices.resize(index_count);
+    return mesh;
+}
+
+// The list only compares the buffer pointers, ids are enough.
+static auto make_gpu_mesh(uintptr_t buffer, u32 vertex_offset, u32 first_index)
+    -> GPUMeshData {
+    GPUMeshData result;
+    result.m_vertex_buffer = reinterpret_cast<GPUBuffer*>(buffer);
+    result.m_index_buffer = reinterpret_cast<GPUBuffer*>(buffer + 1);
+    result.m_vertex_offset = vertex_offset;
+    result.m_first_index = first_index;
+    return result;
+}
+
+static auto at_x(f32 x) -> mat4x4 { return mat4x4::translation(v3::create(x, 0, 0)); }
+
+static auto make_command(
+    const mat4x4& transform,
+    Mesh&         mesh,
+    uintptr_t     material,
+    GPUMeshData&  gpu_mesh
+) -> RenderCommand {
+    return RenderCommand{
+        .transform = &transform,
+        .vertex_data = &mesh,
+        .material = reinterpret_cast<MaterialHandle*>(material),
+        .m_mesh = &gpu_mesh,
+    };
+}
+
+TEST(IndirectDrawList, PacksRunsIntoInstancedDraws) {
+    Mesh                quad = make_mesh(4, 6);
+    Mesh                cube = make_mesh(24, 36);
+    GPUMeshData         gpu_quad = make_gpu_mesh(16, 0, 0);
+    GPUMeshData         gpu_cube = make_gpu_mesh(16, 4, 6);
+    std::vector<mat4x4> transforms = {at_x(0), at_x(1), at_x(2), at_x(3), at_x(4)};
+
+    // Transforms out of order, they are copied anyway.
+    const std::vector<RenderCommand> commands = {
+        make_command(transforms[4], quad, 1, gpu_quad),
+        make_command(transforms[0], quad, 1, gpu_quad),
+        make_command(transforms[2], quad, 1, gpu_quad),
+        make_command(transforms[1], cube, 1, gpu_cube),
+        make_command(transforms[3], cube, 1, gpu_cube),
+    };
+    IndirectDrawList list;
+    list.add(commands);
+
+    const auto draws = list.get_indexed_draws();
+    ASSERT_EQ(draws.size(), 2);
+    EXPECT_EQ(draws[0].m_index_count, 6);
+    EXPECT_EQ(draws[0].m_instance_count, 3);
+    EXPECT_EQ(draws[0].m_first_instance, 0);
+    EXPECT_EQ(draws[1].m_index_count, 36);
+    EXPECT_EQ(draws[1].m_instance_count, 2);
+    EXPECT_EQ(draws[1].m_first_instance, 3);
+    EXPECT_EQ(draws[1].m_first_index, 6);
+    EXPECT_EQ(draws[1].m_vertex_offset, 4);
+    EXPECT_TRUE(list.get_draws().empty());
+    // Both meshes are in the same buffers.
+    EXPECT_EQ(list.get_batches().size(), 1);
+
+    const auto packed = list.get_transforms();
+    ASSERT_EQ(packed.size(), 5);
+    EXPECT_EQ(packed[0], transforms[4]);
+    EXPECT_EQ(packed[1], transforms[0]);
+    EXPECT_EQ(packed[3], transforms[1]);
+}
+
+TEST(IndirectDrawList, SplitsBatchesWhereTheBoundStateChanges) {
+    Mesh                indexed = make_mesh(4, 6);
+    Mesh                plain = make_mesh(3, 0);
+    GPUMeshData         gpu_indexed = make_gpu_mesh(16, 0, 0);
+    GPUMeshData         gpu_plain = make_gpu_mesh(16, 4, 0);
+    std::vector<mat4x4> transforms(4, mat4x4::identity());
+
+    const std::vector<RenderCommand> commands = {
+        make_command(transforms[0], indexed, 1, gpu_indexed),
+        make_command(transforms[1], plain, 1, gpu_plain),
+        make_command(transforms[2], plain, 2, gpu_plain),
+        make_command(transforms[3], indexed, 2, gpu_indexed),
+    };
+    IndirectDrawList list;
+    list.add(commands);
+
+    const auto batches = list.get_batches();
+    ASSERT_EQ(batches.size(), 4);
+    EXPECT_TRUE(batches[0].m_is_indexed);
+    EXPECT_FALSE(batches[1].m_is_indexed);
+    EXPECT_EQ(batches[1].m_first, 0);
+    EXPECT_EQ(batches[2].m_first, 1);
+    EXPECT_EQ(batches[2].m_command, &commands[2]);
+    EXPECT_EQ(batches[3].m_first, 1);
+    ASSERT_EQ(list.get_draws().size(), 2);
+    EXPECT_EQ(list.get_draws()[0].m_vertex_count, 3);
+    EXPECT_EQ(list.get_draws()[0].m_first_vertex, 4);
+    EXPECT_EQ(list.get_draws()[1].m_first_instance, 2);
+
+    // The indexed draws come first in the argument buffer.
+    std::vector<u8> args(list.get_args_size());
+    list.write_args(args.data());
+    constexpr size_t INDEXED_SIZE = sizeof(DrawIndexedIndirectCommand);
+    constexpr size_t SIZE = sizeof(DrawIndirectCommand);
+    EXPECT_EQ(args.size(), 2 * INDEXED_SIZE + 2 * SIZE);
+    EXPECT_EQ(list.get_args_offset(batches[3]), INDEXED_SIZE);
+    const size_t offset = list.get_args_offset(batches[2]);
+    EXPECT_EQ(offset, 2 * INDEXED_SIZE + SIZE);
+    DrawIndirectCommand written;
+    std::memcpy(&written, args.data() + offset, sizeof(written));
+    EXPECT_EQ(written.m_first_instance, 2);
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_TRUE(list.get_transforms().empty());
+}
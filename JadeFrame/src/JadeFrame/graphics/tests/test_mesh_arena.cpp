@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "JadeFrame/graphics/mesh_arena.h"
+
+using namespace JadeFrame;
+
+TEST(OffsetAllocator, AlignsToAnyStride) {
+    OffsetAllocator allocator(100);
+
+    const auto first = allocator.allocate(10);
+    // A vertex of 3 floats, the offset has to be a multiple of it.
+    const auto second = allocator.allocate(24, 12);
+    ASSERT_TRUE(first.is_valid());
+    ASSERT_TRUE(second.is_valid());
+    EXPECT_EQ(first.m_offset, 0);
+    EXPECT_EQ(second.m_offset, 12);
+
+    // The padding stays free.
+    const auto padding = allocator.allocate(2);
+    EXPECT_EQ(padding.m_offset, 10);
+    EXPECT_EQ(allocator.get_stats().m_used, 36);
+}
+
+TEST(OffsetAllocator, MergesFreedNeighbours) {
+    OffsetAllocator allocator(40);
+    const auto      a = allocator.allocate(10);
+    const auto      b = allocator.allocate(10);
+    const auto      c = allocator.allocate(10);
+    ASSERT_TRUE(c.is_valid());
+
+    allocator.free(a);
+    allocator.free(c);
+    EXPECT_EQ(allocator.get_stats().m_free_range_count, 2);
+    EXPECT_FALSE(allocator.allocate(25).is_valid());
+
+    allocator.free(b);
+    const OffsetAllocator::Stats stats = allocator.get_stats();
+    EXPECT_EQ(stats.m_free_range_count, 1);
+    EXPECT_EQ(stats.m_largest_free, 40);
+    EXPECT_EQ(stats.m_allocation_count, 0);
+    EXPECT_EQ(allocator.allocate(40).m_offset, 0);
+}
+
+TEST(OffsetAllocator, TakesTheSmallestRangeWhichFits) {
+    OffsetAllocator allocator(100);
+    const auto      large = allocator.allocate(30);
+    allocator.allocate(10);
+    const auto small = allocator.allocate(10);
+    allocator.allocate(10);
+    allocator.free(large);
+    allocator.free(small);
+
+    // Both freed ranges and the tail fit, the small range fits best.
+    EXPECT_EQ(allocator.allocate(8).m_offset, small.m_offset);
+}
+
+TEST(OffsetAllocator, ReportsFragmentation) {
+    OffsetAllocator allocator(40);
+    EXPECT_EQ(allocator.get_stats().get_fragmentation(), 0.0F);
+
+    const auto a = allocator.allocate(10);
+    allocator.allocate(10);
+    allocator.free(a);
+
+    // 30 free, at most 20 in one piece.
+    const OffsetAllocator::Stats stats = allocator.get_stats();
+    EXPECT_EQ(stats.get_free(), 30);
+    EXPECT_EQ(stats.m_largest_free, 20);
+    EXPECT_FLOAT_EQ(stats.get_fragmentation(), 1.0F / 3.0F);
+}
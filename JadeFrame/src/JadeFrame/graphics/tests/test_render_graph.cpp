@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include "JadeFrame/graphics/vulkan/render_graph.h"
+
+using namespace JadeFrame;
+using namespace JadeFrame::vulkan;
+
+using ImageDesc = RenderGraph::ImageDesc;
+using PassBuilder = RenderGraph::PassBuilder;
+using ResourceId = RenderGraph::ResourceId;
+
+static const ImageDesc COLOR_DESC = {
+    .m_format = VK_FORMAT_R8G8B8A8_UNORM,
+    .m_extent = {.width = 64, .height = 64},
+    .m_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+    .m_aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+};
+
+static auto no_op(CommandBuffer& /*cb*/, const RenderGraph& /*graph*/) -> void {}
+
+static auto import_backbuffer(RenderGraph& graph) -> ResourceId {
+    const ImageState acquired = {
+        .m_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+        .m_access = 0,
+        .m_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    return graph.import_image("backbuffer", COLOR_DESC, acquired, ACCESS::PRESENT);
+}
+
+static auto find_barrier(std::span<const RenderGraph::Barrier> barriers, ResourceId r)
+    -> const RenderGraph::Barrier* {
+    for (const RenderGraph::Barrier& barrier : barriers) {
+        if (barrier.m_resource == r) { return &barrier; }
+    }
+    return nullptr;
+}
+
+TEST(RenderGraph, CullsPassesWhoseResultsAreUnused) {
+    RenderGraph      graph;
+    const ResourceId backbuffer = import_backbuffer(graph);
+    const ResourceId unused = graph.create_image("unused", COLOR_DESC);
+    const ResourceId logged = graph.create_image("logged", COLOR_DESC);
+
+    const auto dead = graph.add_pass(
+        "dead", [&](PassBuilder& b) { b.write(unused, ACCESS::COLOR_ATTACHMENT); }, no_op
+    );
+    const auto side_effect = graph.add_pass(
+        "side effect",
+        [&](PassBuilder& b) {
+            b.write(logged, ACCESS::TRANSFER_DST);
+            b.set_side_effect();
+        },
+        no_op
+    );
+    const auto main = graph.add_pass(
+        "main",
+        [&](PassBuilder& b) { b.write(backbuffer, ACCESS::COLOR_ATTACHMENT); },
+        no_op
+    );
+    graph.compile();
+
+    EXPECT_TRUE(graph.is_culled(dead));
+    EXPECT_FALSE(graph.is_culled(side_effect));
+    EXPECT_FALSE(graph.is_culled(main));
+    EXPECT_EQ(graph.get_memory_slot(unused), RenderGraph::INVALID);
+
+    // Independent passes share a level.
+    ASSERT_EQ(graph.get_levels().size(), 1);
+    EXPECT_EQ(graph.get_levels()[0].m_passes.size(), 2);
+}
+
+TEST(RenderGraph, OrdersPassesIntoLevelsWithBatchedBarriers) {
+    RenderGraph      graph;
+    const ResourceId backbuffer = import_backbuffer(graph);
+    const ResourceId shadow = graph.create_image("shadow", COLOR_DESC);
+    const ResourceId scene = graph.create_image("scene", COLOR_DESC);
+
+    graph.add_pass(
+        "shadow",
+        [&](PassBuilder& b) { b.write(shadow, ACCESS::COLOR_ATTACHMENT); },
+        no_op
+    );
+    graph.add_pass(
+        "scene", [&](PassBuilder& b) { b.write(scene, ACCESS::COLOR_ATTACHMENT); }, no_op
+    );
+    graph.add_pass(
+        "composite",
+        [&](PassBuilder& b) {
+            b.read(shadow, ACCESS::SAMPLED);
+            b.read(scene, ACCESS::SAMPLED);
+            b.write(backbuffer, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.compile();
+
+    const auto levels = graph.get_levels();
+    ASSERT_EQ(levels.size(), 2);
+    EXPECT_EQ(levels[0].m_passes.size(), 2);
+    EXPECT_EQ(levels[1].m_passes.size(), 1);
+
+    // Both transients start undefined, without anything to wait for.
+    ASSERT_EQ(levels[0].m_barriers.size(), 2);
+    for (const RenderGraph::Barrier& barrier : levels[0].m_barriers) {
+        EXPECT_EQ(barrier.m_old_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+        EXPECT_EQ(barrier.m_new_layout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        EXPECT_EQ(barrier.m_src_stages, 0);
+    }
+
+    // One batch for the second level: both reads and the backbuffer.
+    ASSERT_EQ(levels[1].m_barriers.size(), 3);
+    const auto* read = find_barrier(levels[1].m_barriers, shadow);
+    ASSERT_NE(read, nullptr);
+    EXPECT_EQ(read->m_src_stages, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR);
+    EXPECT_EQ(
+        read->m_src_access & VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR
+    );
+    EXPECT_EQ(read->m_dst_stages, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR);
+    EXPECT_EQ(read->m_new_layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    const auto* acquire = find_barrier(levels[1].m_barriers, backbuffer);
+    ASSERT_NE(acquire, nullptr);
+    EXPECT_EQ(acquire->m_old_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_EQ(acquire->m_src_stages, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR);
+
+    // Only the imported image is transitioned at the end.
+    ASSERT_EQ(graph.get_final_barriers().size(), 1);
+    const RenderGraph::Barrier& present = graph.get_final_barriers()[0];
+    EXPECT_EQ(present.m_resource, backbuffer);
+    EXPECT_EQ(present.m_old_layout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    EXPECT_EQ(present.m_new_layout, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+}
+
+TEST(RenderGraph, SkipsBarriersForReadsAlreadyVisible) {
+    RenderGraph      graph;
+    const ResourceId backbuffer = import_backbuffer(graph);
+    const ResourceId scene = graph.create_image("scene", COLOR_DESC);
+    const ResourceId blur = graph.create_image("blur", COLOR_DESC);
+
+    graph.add_pass(
+        "scene", [&](PassBuilder& b) { b.write(scene, ACCESS::COLOR_ATTACHMENT); }, no_op
+    );
+    graph.add_pass(
+        "blur",
+        [&](PassBuilder& b) {
+            b.read(scene, ACCESS::SAMPLED);
+            b.write(blur, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.add_pass(
+        "composite",
+        [&](PassBuilder& b) {
+            b.read(scene, ACCESS::SAMPLED);
+            b.read(blur, ACCESS::SAMPLED);
+            b.write(backbuffer, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.compile();
+
+    const auto levels = graph.get_levels();
+    ASSERT_EQ(levels.size(), 3);
+    EXPECT_NE(find_barrier(levels[1].m_barriers, scene), nullptr);
+    // The second read of `scene` is covered by the barrier before `blur`.
+    EXPECT_EQ(find_barrier(levels[2].m_barriers, scene), nullptr);
+    EXPECT_NE(find_barrier(levels[2].m_barriers, blur), nullptr);
+}
+
+TEST(RenderGraph, AliasesTransientsWithDisjointLifetimes) {
+    RenderGraph      graph;
+    const ResourceId backbuffer = import_backbuffer(graph);
+    const ResourceId a = graph.create_image("a", COLOR_DESC);
+    const ResourceId b = graph.create_image("b", COLOR_DESC);
+    const ResourceId c = graph.create_image("c", COLOR_DESC);
+
+    graph.add_pass(
+        "a", [&](PassBuilder& p) { p.write(a, ACCESS::COLOR_ATTACHMENT); }, no_op
+    );
+    graph.add_pass(
+        "b",
+        [&](PassBuilder& p) {
+            p.read(a, ACCESS::SAMPLED);
+            p.write(b, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.add_pass(
+        "c",
+        [&](PassBuilder& p) {
+            p.read(b, ACCESS::SAMPLED);
+            p.write(c, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.add_pass(
+        "present",
+        [&](PassBuilder& p) {
+            p.read(c, ACCESS::SAMPLED);
+            p.write(backbuffer, ACCESS::COLOR_ATTACHMENT);
+        },
+        no_op
+    );
+    graph.compile();
+
+    // `a` is dead once `c` is written, so they share memory. `b` overlaps both.
+    EXPECT_EQ(graph.get_memory_slot_count(), 2);
+    EXPECT_EQ(graph.get_memory_slot(a), graph.get_memory_slot(c));
+    EXPECT_NE(graph.get_memory_slot(a), graph.get_memory_slot(b));
+    EXPECT_EQ(graph.get_memory_slot(backbuffer), RenderGraph::INVALID);
+
+    // `c` waits for the last read of `a` before reusing the memory.
+    const auto* reuse = find_barrier(graph.get_levels()[2].m_barriers, c);
+    ASSERT_NE(reuse, nullptr);
+    EXPECT_EQ(reuse->m_old_layout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_EQ(
+        reuse->m_src_stages & VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR
+    );
+}
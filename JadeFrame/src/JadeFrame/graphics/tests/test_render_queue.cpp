@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "JadeFrame/graphics/camera.h"
+#include "JadeFrame/graphics/render_queue.h"
+
+using namespace JadeFrame;
+
+// Looks down +z from the origin, depth 0 at z = 0 and 1 at z = 100.
+static auto make_camera() -> Camera {
+    Camera camera;
+    camera.m_position = v3::zero();
+    camera.m_orientation.m_forward = v3::create(0.0F, 0.0F, 1.0F);
+    camera.m_volume.m_near = 0.0F;
+    camera.m_volume.m_far = 100.0F;
+    return camera;
+}
+
+static auto at_depth(f32 z) -> mat4x4 { return mat4x4::translation(v3::create(0, 0, z)); }
+
+TEST(RenderQueue, RadixSortMatchesStableSort) {
+    std::mt19937_64            rng(7);
+    std::vector<RenderCommand> commands(5000);
+    for (size_t i = 0; i < commands.size(); i++) {
+        // Few distinct values in the high bytes, like real keys, so passes get skipped.
+        const u64 key = sort_key::create(
+            static_cast<u32>(rng() % 2),
+            static_cast<u32>(rng() % 3),
+            static_cast<u32>(rng() % 40),
+            static_cast<u32>(rng() % 7),
+            static_cast<u32>(rng() % 4)
+        );
+        // The mesh pointer remembers the submission order.
+        commands[i].m_key = key;
+        commands[i].m_mesh = reinterpret_cast<GPUMeshData*>(i + 1);
+    }
+
+    std::vector<RenderCommand> expected = commands;
+    std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        return a.m_key < b.m_key;
+    });
+    std::vector<RenderCommand> scratch(commands.size());
+    radix_sort(commands, scratch.data());
+
+    for (size_t i = 0; i < commands.size(); i++) {
+        ASSERT_EQ(commands[i].m_key, expected[i].m_key) << i;
+        ASSERT_EQ(commands[i].m_mesh, expected[i].m_mesh) << i;
+    }
+}
+
+TEST(RenderQueue, SortsByPipelineThenMaterialThenMeshThenDepth) {
+    RenderQueue queue;
+    queue.push({.m_key = sort_key::create(0, 2, 0, 0, 0)}, at_depth(10.0F));
+    queue.push({.m_key = sort_key::create(0, 1, 5, 0, 0)}, at_depth(10.0F));
+    queue.push({.m_key = sort_key::create(0, 1, 3, 9, 0)}, at_depth(90.0F));
+    queue.push({.m_key = sort_key::create(0, 1, 3, 9, 0)}, at_depth(20.0F));
+    queue.push({.m_key = sort_key::create(0, 1, 3, 4, 0)}, at_depth(50.0F));
+    queue.sort(make_camera());
+
+    const std::span<const RenderCommand> commands = queue.get_commands();
+    ASSERT_EQ(commands.size(), 5U);
+    const f32 expected_z[] = {50.0F, 20.0F, 90.0F, 10.0F, 10.0F};
+    for (size_t i = 0; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].transform->w_axis.z, expected_z[i]) << i;
+        if (i > 0) { EXPECT_LE(commands[i - 1].m_key, commands[i].m_key) << i; }
+    }
+    // The first four share pipeline 1, the material decides next.
+    EXPECT_EQ(commands[3].m_key >> sort_key::MATERIAL_SHIFT, (u64{1} << 16) | 5);
+}
+
+TEST(RenderQueue, RunsOfTheSameMeshAndMaterialAreInstanced) {
+    auto* mesh_a = reinterpret_cast<GPUMeshData*>(0x10);
+    auto* mesh_b = reinterpret_cast<GPUMeshData*>(0x20);
+    auto* material = reinterpret_cast<MaterialHandle*>(0x30);
+
+    RenderQueue queue;
+    for (u32 i = 0; i < 10; i++) {
+        GPUMeshData* mesh = i % 3 == 0 ? mesh_b : mesh_a;
+        queue.push(
+            {.m_key = sort_key::create(0, 0, 0, mesh == mesh_a ? 1 : 2, 0),
+             .material = material,
+             .m_mesh = mesh},
+            at_depth(static_cast<f32>(i))
+        );
+    }
+    queue.sort(make_camera());
+
+    // Six of mesh a, then four of mesh b, with their transforms next to each other.
+    const std::span<const RenderCommand> commands = queue.get_commands();
+    EXPECT_EQ(count_instances(commands, 256), 6U);
+    EXPECT_EQ(count_instances(commands, 4), 4U);
+    EXPECT_EQ(count_instances(commands.subspan(6), 256), 4U);
+    EXPECT_EQ(count_instances(commands.subspan(10), 256), 0U);
+    for (size_t i = 1; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].transform, commands[i - 1].transform + 1) << i;
+    }
+    EXPECT_EQ(commands[6].m_mesh, mesh_b);
+    EXPECT_EQ(commands[6].transform->w_axis.z, 0.0F);
+}
+
+TEST(RenderQueue, SteadyFramesDoNotGrowTheArena) {
+    RenderQueue  queue;
+    const Camera camera = make_camera();
+    auto         submit_frame = [&]() {
+        for (u32 i = 0; i < 3000; i++) {
+            queue.push(
+                {.m_key = sort_key::create(0, i % 3, i % 5, 0, 0)},
+                at_depth(static_cast<f32>(i % 100))
+            );
+        }
+        queue.sort(camera);
+        EXPECT_EQ(queue.size(), 3000U);
+        queue.clear();
+    };
+
+    // The first frame grows the arena through several blocks, which are merged on clear.
+    submit_frame();
+    EXPECT_EQ(queue.m_arena.get_block_count(), 1U);
+    const size_t capacity = queue.m_arena.get_capacity();
+    for (u32 frame = 0; frame < 3; frame++) {
+        submit_frame();
+        EXPECT_EQ(queue.m_arena.get_block_count(), 1U);
+        EXPECT_EQ(queue.m_arena.get_capacity(), capacity);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(RenderQueue, AppendedTransformsCanBeCopied) {
+    std::vector<mat4x4>        transforms = {at_depth(1.0F), at_depth(2.0F)};
+    std::vector<RenderCommand> commands(2);
+    commands[0].transform = &transforms[0];
+    commands[1].transform = &transforms[1];
+
+    RenderQueue queue;
+    queue.append(commands, {.m_visible = 2}, true);
+    transforms[0] = at_depth(5.0F);
+
+    const auto appended = queue.get_commands();
+    ASSERT_EQ(appended.size(), 2);
+    EXPECT_EQ(*appended[0].transform, at_depth(1.0F));
+    // Still next to each other, so the two can be instanced.
+    EXPECT_EQ(appended[1].transform, appended[0].transform + 1);
+}
+
+TEST(FrameArena, AlignsAndGrows) {
+    FrameArena arena(64);
+    auto*      a = arena.allocate(3, 1);
+    auto*      b = arena.allocate(8, 32);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 32, 0U);
+
+    // Larger than a block, gets its own.
+    auto* big = arena.allocate_array<u64>(100);
+    big[99] = 1;
+    EXPECT_EQ(arena.get_block_count(), 2U);
+
+    arena.reset();
+    EXPECT_EQ(arena.get_block_count(), 1U);
+    EXPECT_GE(arena.get_capacity(), 64U + 100 * sizeof(u64));
+}
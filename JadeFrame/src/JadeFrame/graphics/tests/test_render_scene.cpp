@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "JadeFrame/graphics/camera.h"
+#include "JadeFrame/graphics/graphics_shared.h"
+#include "JadeFrame/graphics/render_scene.h"
+
+using namespace JadeFrame;
+
+static auto make_camera() -> Camera {
+    return Camera::perspective(v3::zero(), 1.5F, 1.0F, 0.1F, 100.0F);
+}
+
+static auto make_frustum() -> Frustum { return make_camera().get_frustum(); }
+
+// `distance` in front of the camera and `side` to the right of it.
+static auto make_object(
+    GPUMeshData*    mesh,
+    MaterialHandle* material,
+    f32             side,
+    f32             distance
+) -> Object {
+    const Camera::Orientation& orientation = make_camera().m_orientation;
+
+    Object obj;
+    obj.m_mesh = mesh;
+    obj.m_material = material;
+    obj.m_transform.m_translation =
+        orientation.m_forward * distance + orientation.m_right * side;
+    return obj;
+}
+
+static auto get_distance(const v3& position) -> f32 {
+    return position.dot(make_camera().m_orientation.m_forward);
+}
+
+static auto get_distance(const mat4x4& m) -> f32 {
+    return get_distance(v3::create(m.w_axis.x, m.w_axis.y, m.w_axis.z));
+}
+
+static auto get_distance(const RenderCommand& command) -> f32 {
+    return get_distance(*command.transform);
+}
+
+class RenderSceneTest : public testing::Test {
+protected:
+    auto SetUp() -> void override {
+        m_mesh_a.m_id = 1;
+        m_mesh_b.m_id = 2;
+        for (GPUMeshData* mesh : {&m_mesh_a, &m_mesh_b}) {
+            mesh->m_bounds.m_sphere = {.m_center = v3::zero(), .m_radius = 1.0F};
+        }
+        m_material_a.m_id = 1;
+        m_material_b.m_id = 2;
+    }
+
+    GPUMeshData    m_mesh_a;
+    GPUMeshData    m_mesh_b;
+    MaterialHandle m_material_a;
+    MaterialHandle m_material_b;
+};
+
+TEST_F(RenderSceneTest, VisibleItemsAreSortedAndInstanced) {
+    RenderScene scene;
+    for (u32 i = 0; i < 6; i++) {
+        GPUMeshData* mesh = i % 2 == 0 ? &m_mesh_b : &m_mesh_a;
+        scene.add(make_object(mesh, &m_material_a, 0.0F, 10.0F + static_cast<f32>(i)));
+    }
+    // Behind the camera.
+    scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, -10.0F));
+    scene.update();
+
+    const std::span<const RenderCommand> visible = scene.cull(make_frustum());
+    EXPECT_EQ(scene.get_cull_stats().m_visible, 6U);
+    EXPECT_EQ(scene.get_cull_stats().m_culled, 1U);
+    ASSERT_EQ(visible.size(), 6U);
+    EXPECT_EQ(count_instances(visible, 256), 3U);
+    EXPECT_EQ(count_instances(visible.subspan(3), 256), 3U);
+    EXPECT_EQ(visible[0].m_mesh, &m_mesh_a);
+    EXPECT_EQ(visible[3].m_mesh, &m_mesh_b);
+    // Same key, so in the order they were added.
+    EXPECT_FLOAT_EQ(get_distance(visible[0]), 11.0F);
+    EXPECT_FLOAT_EQ(get_distance(visible[2]), 15.0F);
+}
+
+TEST_F(RenderSceneTest, CulledItemsSplitInstanceRuns) {
+    RenderScene scene;
+    scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 10.0F));
+    const RenderScene::Id moved = scene.add(make_object(&m_mesh_a, &m_material_a, 0, 10));
+    scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 10.0F));
+    scene.update();
+    EXPECT_EQ(count_instances(scene.cull(make_frustum()), 256), 3U);
+
+    Transform transform = scene.get_transform(moved);
+    transform.m_translation = transform.m_translation * -1.0F;
+    scene.set_transform(moved, transform);
+    scene.update();
+
+    // The two visible items do not have their matrices next to each other anymore.
+    const std::span<const RenderCommand> visible = scene.cull(make_frustum());
+    ASSERT_EQ(visible.size(), 2U);
+    EXPECT_EQ(count_instances(visible, 256), 1U);
+    EXPECT_EQ(visible[1].transform - visible[0].transform, 2);
+}
+
+TEST_F(RenderSceneTest, RemovingAndChangingMaterialsKeepsIdsValid) {
+    RenderScene     scene;
+    RenderScene::Id a = scene.add(make_object(&m_mesh_a, &m_material_b, 0.0F, 11.0F));
+    RenderScene::Id b = scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 12.0F));
+    RenderScene::Id c = scene.add(make_object(&m_mesh_b, &m_material_a, 0.0F, 13.0F));
+    scene.update();
+    EXPECT_FLOAT_EQ(get_distance(scene.cull(make_frustum())[0]), 12.0F);
+
+    scene.remove(b);
+    scene.set_material(c, &m_material_b);
+    scene.update();
+    EXPECT_EQ(scene.size(), 2U);
+    EXPECT_FLOAT_EQ(get_distance(scene.get_transform(a).m_translation), 11.0F);
+    EXPECT_FLOAT_EQ(get_distance(scene.get_transform(c).m_translation), 13.0F);
+
+    const std::span<const RenderCommand> visible = scene.cull(make_frustum());
+    ASSERT_EQ(visible.size(), 2U);
+    EXPECT_EQ(visible[0].material, &m_material_b);
+    EXPECT_EQ(visible[1].material, &m_material_b);
+    EXPECT_EQ(visible[1].m_mesh, &m_mesh_b);
+
+    // The id of the removed item is reused.
+    EXPECT_EQ(scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 10.0F)), b);
+}
+
+TEST_F(RenderSceneTest, DirtyRangesOnlyCoverChangedIds) {
+    RenderScene                  scene;
+    std::vector<RenderScene::Id> ids;
+    for (u32 i = 0; i < 5; i++) {
+        ids.push_back(scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 10.0F)));
+    }
+    scene.update();
+    ASSERT_EQ(scene.get_dirty_ranges().size(), 1U);
+    EXPECT_EQ(scene.get_dirty_ranges()[0].m_first, ids[0]);
+    EXPECT_EQ(scene.get_dirty_ranges()[0].m_count, 5U);
+
+    // The visible items know their ids, consecutive ones are drawn as one.
+    const std::span<const RenderCommand> visible = scene.cull(make_frustum());
+    ASSERT_EQ(visible.size(), 5U);
+    EXPECT_EQ(visible[0].m_scene_id, ids[0]);
+    EXPECT_EQ(count_scene_instances(visible, 256), 5U);
+    EXPECT_EQ(count_scene_instances(visible, 2), 2U);
+
+    // Sorting again moves the matrices, but not those of the ids.
+    Transform transform = scene.get_transform(ids[3]);
+    transform.m_translation = transform.m_translation * 2.0F;
+    scene.set_transform(ids[3], transform);
+    scene.set_transform(ids[1], scene.get_transform(ids[1]));
+    scene.set_transform(ids[1], scene.get_transform(ids[1]));
+    scene.set_material(ids[0], &m_material_b);
+    scene.update();
+    ASSERT_EQ(scene.get_dirty_ranges().size(), 2U);
+    EXPECT_EQ(scene.get_dirty_ranges()[0].m_first, ids[1]);
+    EXPECT_EQ(scene.get_dirty_ranges()[0].m_count, 1U);
+    EXPECT_EQ(scene.get_dirty_ranges()[1].m_first, ids[3]);
+    EXPECT_FLOAT_EQ(get_distance(scene.get_world(ids[3])), 20.0F);
+
+    scene.update();
+    EXPECT_TRUE(scene.get_dirty_ranges().empty());
+}
+
+TEST_F(RenderSceneTest, AppendedToTheQueueAfterTheSubmittedCommands) {
+    RenderScene scene;
+    scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, 10.0F));
+    scene.add(make_object(&m_mesh_a, &m_material_a, 0.0F, -10.0F));
+    scene.update();
+
+    const Camera  camera = make_camera();
+    const Frustum frustum = camera.get_frustum();
+    RenderQueue   queue;
+    queue.push({}, mat4x4::identity());
+    queue.cull(frustum);
+    queue.sort(camera);
+    const std::span<const RenderCommand> visible = scene.cull(frustum);
+    queue.append(visible, scene.get_cull_stats());
+
+    ASSERT_EQ(queue.size(), 2U);
+    EXPECT_EQ(queue.get_commands()[1].m_mesh, &m_mesh_a);
+    EXPECT_EQ(queue.get_cull_stats().m_visible, 2U);
+    EXPECT_EQ(queue.get_cull_stats().m_culled, 1U);
+    queue.clear();
+}
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+
+#include "JadeFrame/graphics/mesh.h"
+#include "JadeFrame/math/math.h"
+#include "JadeFrame/graphics/software/rasterizer.h"
+#include "JadeFrame/graphics/software/shader_program.h"
+#include "JadeFrame/utils/thread_pool.h"
+
+using namespace JadeFrame;
+
+static auto make_triangle(const v3& p0, const v3& p1, const v3& p2, const v4& color)
+    -> Mesh {
+    Mesh mesh;
+    mesh.insert_attribute(
+        Mesh::POSITION, {p0.x, p0.y, p0.z, p1.x, p1.y, p1.z, p2.x, p2.y, p2.z}
+    );
+    std::vector<f32> colors;
+    for (u32 i = 0; i < 3; i++) {
+        colors.insert(colors.end(), {color.x, color.y, color.z, color.w});
+    }
+    mesh.insert_attribute(Mesh::COLOR, colors);
+    return mesh;
+}
+
+static auto count_pixels(const software::Framebuffer& fb, u32 color) -> u32 {
+    u32 count = 0;
+    for (const u32 pixel : fb.m_color) { count += pixel == color ? 1 : 0; }
+    return count;
+}
+
+static auto draw(
+    software::Framebuffer&                          fb,
+    std::span<const software::Rasterizer::DrawCall> calls,
+    ThreadPool&                                     pool
+) -> void {
+    software::Rasterizer rasterizer;
+    const software::Rasterizer::Clear clear = {
+        .m_enabled = true,
+        .m_color = software::pack_color(0, 0, 0, 1),
+        .m_depth = 1.0F,
+    };
+    rasterizer.draw(fb, software::Viewport{}, calls, clear, pool);
+}
+
+TEST(SoftwareRasterizer, FullscreenQuadHasNoGaps) {
+    // Two triangles sharing a diagonal, the top-left rule must not leave gaps.
+    Mesh quad;
+    quad.insert_attribute(
+        Mesh::POSITION,
+        {-1, -1, 0.5F, 1, -1, 0.5F, 1, 1, 0.5F, -1, -1, 0.5F, 1, 1, 0.5F, -1, 1, 0.5F}
+    );
+
+    ThreadPool            pool(3);
+    software::Framebuffer fb(130, 70);
+    const software::Rasterizer::DrawCall call = {
+        .m_mvp = mat4x4::identity(), .m_mesh = &quad, .m_texture = nullptr
+    };
+    draw(fb, std::span(&call, 1), pool);
+
+    EXPECT_EQ(count_pixels(fb, software::pack_color(1, 1, 1, 1)), 130U * 70U);
+    for (const f32 depth : fb.m_depth) { EXPECT_FLOAT_EQ(depth, 0.5F); }
+}
+
+TEST(SoftwareRasterizer, DepthTestIsIndependentOfSubmissionOrder) {
+    const v4   red = v4::create(1, 0, 0, 1);
+    const v4   green = v4::create(0, 1, 0, 1);
+    // Both triangles cover the whole screen, the far one is drawn last.
+    auto make_fullscreen = [](f32 z, const v4& color) -> Mesh {
+        return make_triangle(
+            v3::create(-1, -1, z), v3::create(3, -1, z), v3::create(-1, 3, z), color
+        );
+    };
+    const Mesh near = make_fullscreen(0.25F, red);
+    const Mesh far = make_fullscreen(0.75F, green);
+
+    ThreadPool            pool(2);
+    software::Framebuffer fb(64, 64);
+    const std::array<software::Rasterizer::DrawCall, 2> calls = {
+        software::Rasterizer::DrawCall{mat4x4::identity(), &near, nullptr},
+        software::Rasterizer::DrawCall{mat4x4::identity(), &far, nullptr},
+    };
+    draw(fb, calls, pool);
+    EXPECT_EQ(count_pixels(fb, software::pack_color(1, 0, 0, 1)), 64U * 64U);
+}
+
+TEST(SoftwareRasterizer, ClipsTrianglesBehindTheNearPlane) {
+    const Mesh behind = make_triangle(
+        v3::create(-1, -1, -0.5F),
+        v3::create(1, -1, -0.5F),
+        v3::create(0, 1, -0.5F),
+        v4::create(1, 1, 1, 1)
+    );
+
+    ThreadPool            pool(0);
+    software::Framebuffer fb(32, 32);
+    const software::Rasterizer::DrawCall call = {mat4x4::identity(), &behind, nullptr};
+    draw(fb, std::span(&call, 1), pool);
+    EXPECT_EQ(count_pixels(fb, software::pack_color(1, 1, 1, 1)), 0U);
+}
+
+// Random perspective textured triangles, on a framebuffer whose size is not a multiple
+// of any group or block size.
+static auto render_random_scene(software::RASTER_KERNEL kernel) -> software::Framebuffer {
+    u32  seed = 12345;
+    auto random = [&seed](f32 lo, f32 hi) -> f32 {
+        seed = seed * 1664525U + 1013904223U;
+        return lo + (hi - lo) * static_cast<f32>(seed >> 8) / static_cast<f32>(1U << 24);
+    };
+    Mesh             mesh;
+    std::vector<f32> positions;
+    std::vector<f32> colors;
+    std::vector<f32> uvs;
+    for (u32 i = 0; i < 3 * 200; i++) {
+        positions.insert(
+            positions.end(), {random(-4, 4), random(-3, 3), random(-12.0F, -0.5F)}
+        );
+        colors.insert(colors.end(), {random(0, 1), random(0, 1), random(0, 1), 1});
+        uvs.insert(uvs.end(), {random(-2, 2), random(-2, 2)});
+    }
+    mesh.insert_attribute(Mesh::POSITION, positions);
+    mesh.insert_attribute(Mesh::COLOR, colors);
+    mesh.insert_attribute(Mesh::UV, uvs);
+
+    std::array<u8, 4 * 4 * 3> pixels;
+    for (u32 i = 0; i < pixels.size(); i++) { pixels[i] = static_cast<u8>(i * 37); }
+    const software::Texture texture(pixels.data(), v2u32::create(4, 4), 3);
+
+    const software::Rasterizer::DrawCall call = {
+        .m_mvp = mat4x4::perspective_rh_zo(to_radians(70.0F), 203.0F / 117.0F, 0.5F, 10),
+        .m_mesh = &mesh,
+        .m_texture = &texture,
+    };
+    ThreadPool            pool(2);
+    software::Framebuffer fb(203, 117);
+    software::Rasterizer  rasterizer;
+    rasterizer.set_kernel(kernel);
+    const software::Rasterizer::Clear clear = {.m_enabled = true};
+    rasterizer.draw(fb, software::Viewport{}, std::span(&call, 1), clear, pool);
+    return fb;
+}
+
+TEST(SoftwareRasterizer, SimdKernelsMatchScalar) {
+    using software::RASTER_KERNEL;
+    const software::Framebuffer reference = render_random_scene(RASTER_KERNEL::SCALAR);
+    EXPECT_GT(reference.m_width * reference.m_height, count_pixels(reference, 0));
+    for (const RASTER_KERNEL kernel : {RASTER_KERNEL::SSE2, RASTER_KERNEL::AVX2}) {
+        if (!software::is_supported(kernel)) { continue; }
+        const software::Framebuffer fb = render_random_scene(kernel);
+        EXPECT_EQ(fb.m_color, reference.m_color) << software::to_string(kernel);
+        EXPECT_EQ(fb.m_depth, reference.m_depth) << software::to_string(kernel);
+    }
+}
+
+TEST(SoftwareRasterizer, CoarseDepthBoundsEveryBlock) {
+    using software::RASTER_KERNEL;
+    constexpr u32 SIZE = software::Framebuffer::COARSE_SIZE;
+    for (const RASTER_KERNEL kernel :
+         {RASTER_KERNEL::SCALAR, RASTER_KERNEL::SSE2, RASTER_KERNEL::AVX2}) {
+        if (!software::is_supported(kernel)) { continue; }
+        const software::Framebuffer fb = render_random_scene(kernel);
+        for (u32 y = 0; y < fb.m_height; y++) {
+            for (u32 x = 0; x < fb.m_width; x++) {
+                const f32 depth = fb.m_depth[y * fb.m_width + x];
+                const software::DepthBounds& bounds =
+                    fb.m_coarse_depth[(y / SIZE) * fb.m_coarse_width + x / SIZE];
+                ASSERT_LE(bounds.m_min, depth) << software::to_string(kernel);
+                ASSERT_GE(bounds.m_max, depth) << software::to_string(kernel);
+            }
+        }
+    }
+}
+
+// Writes the position and the color through, like the default shaders with identity
+// matrices.
+static auto make_vertex_program() -> software::ShaderProgram {
+    using software::SHADER_BUILTIN;
+    software::ShaderProgram program;
+    program.m_stage = SHADER_STAGE::VERTEX;
+    program.m_register_count = 10;
+    program.m_constants = {{.m_register = 7, .m_bits = std::bit_cast<u32>(1.0F)}};
+    program.m_inputs = {
+        {.m_location = 0, .m_registers = {0, 1, 2}},
+        {.m_location = 1, .m_registers = {3, 4, 5, 6}},
+    };
+    program.m_outputs = {
+        {.m_builtin = SHADER_BUILTIN::POSITION, .m_registers = {0, 1, 2, 7}},
+        {.m_location = 0, .m_registers = {3, 4, 5, 6}},
+    };
+    program.m_live_mask = 8;
+    program.m_discard_mask = 9;
+    return program;
+}
+
+// The color times a tint from the uniform buffer for front faces, pink for back faces.
+static auto make_fragment_program() -> software::ShaderProgram {
+    using software::SHADER_BUILTIN;
+    using software::SHADER_OPCODE;
+    software::ShaderProgram program;
+    program.m_stage = SHADER_STAGE::FRAGMENT;
+    program.m_register_count = 22;
+    program.m_constants = {
+        {.m_register = 9, .m_bits = std::bit_cast<u32>(1.0F)},
+        {.m_register = 10, .m_bits = std::bit_cast<u32>(0.25F)},
+        {.m_register = 11, .m_bits = std::bit_cast<u32>(0.75F)},
+    };
+    program.m_inputs = {
+        {.m_location = 0, .m_registers = {0, 1, 2, 3}},
+        {.m_builtin = SHADER_BUILTIN::FRONT_FACING, .m_registers = {4}},
+    };
+    program.m_outputs = {{.m_location = 0, .m_registers = {5, 6, 7, 8}}};
+    program.m_uniform_buffers = {{.m_set = 0, .m_binding = 0, .m_size = 16}};
+    const std::array<u16, 4> pink = {9, 10, 11, 9};
+    for (u16 i = 0; i < 4; i++) {
+        const u16 tint = 12 + i;
+        const u16 product = 18 + i;
+        program.m_code.push_back(
+            {.m_opcode = SHADER_OPCODE::LOAD_UNIFORM, .m_dst = tint, .m_a = u16(i * 4)}
+        );
+        program.m_code.push_back(
+            {.m_opcode = SHADER_OPCODE::F_MUL, .m_dst = product, .m_a = i, .m_b = tint}
+        );
+        program.m_code.push_back({
+            .m_opcode = SHADER_OPCODE::SELECT,
+            .m_dst = u16(5 + i),
+            .m_a = 4,
+            .m_b = product,
+            .m_c = pink[i],
+        });
+    }
+    program.m_live_mask = 16;
+    program.m_discard_mask = 17;
+    return program;
+}
+
+TEST(SoftwareRasterizer, DrawCallsWithProgramsRunThem) {
+    const software::ShaderProgram vertex = make_vertex_program();
+    const software::ShaderProgram fragment = make_fragment_program();
+    const f32                     tint[4] = {0.5F, 1.0F, 1.0F, 1.0F};
+
+    // Counter-clockwise is the front, the second triangle is wound the other way.
+    const v4   red = v4::create(1, 0, 0, 1);
+    const Mesh front = make_triangle(
+        v3::create(-1, -1, 0.5F), v3::create(3, -1, 0.5F), v3::create(-1, 3, 0.5F), red
+    );
+    const Mesh back = make_triangle(
+        v3::create(-1, -1, 0.25F), v3::create(-1, 3, 0.25F), v3::create(3, -1, 0.25F), red
+    );
+
+    for (const Mesh* mesh : {&front, &back}) {
+        ThreadPool                     pool(2);
+        software::Framebuffer          fb(70, 40);
+        software::Rasterizer::DrawCall call = {
+            .m_mvp = mat4x4::identity(),
+            .m_mesh = mesh,
+            .m_vertex = &vertex,
+            .m_fragment = &fragment,
+        };
+        call.m_fragment_uniforms[0] =
+            std::span(reinterpret_cast<const u8*>(tint), sizeof(tint));
+        draw(fb, std::span(&call, 1), pool);
+
+        const u32 expected = mesh == &front ? software::pack_color(0.5F, 0, 0, 1)
+                                            : software::pack_color(1, 0.25F, 0.75F, 1);
+        EXPECT_EQ(count_pixels(fb, expected), 70U * 40U);
+        const f32 depth = mesh == &front ? 0.5F : 0.25F;
+        for (const f32 d : fb.m_depth) { ASSERT_FLOAT_EQ(d, depth); }
+    }
+}
+
+TEST(SoftwareRasterizer, DrawCallsWithoutFragmentProgramUseFixedPipeline) {
+    const software::ShaderProgram vertex = make_vertex_program();
+    const Mesh                    mesh = make_triangle(
+        v3::create(-1, -1, 0.5F),
+        v3::create(3, -1, 0.5F),
+        v3::create(-1, 3, 0.5F),
+        v4::create(0, 1, 0, 1)
+    );
+
+    ThreadPool                           pool(1);
+    software::Framebuffer                fb(16, 16);
+    const software::Rasterizer::DrawCall call = {
+        .m_mvp = mat4x4::identity(), .m_mesh = &mesh, .m_vertex = &vertex
+    };
+    draw(fb, std::span(&call, 1), pool);
+    EXPECT_EQ(count_pixels(fb, software::pack_color(0, 1, 0, 1)), 16U * 16U);
+}
@@ -0,0 +1,656 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <initializer_list>
+#include <string_view>
+
+#include "JadeFrame/graphics/reflect.h"
+#include "JadeFrame/graphics/software/shader_program.h"
+#include "SPIRV-Cross/spirv.hpp"
+
+using namespace JadeFrame;
+using software::SHADER_BUILTIN;
+using software::SHADER_LANES;
+using software::ShaderProgram;
+using software::ShaderVM;
+
+// Hand assembles SPIR-V, so the tests do not need a GLSL compiler.
+class Assembler {
+public:
+    auto id() -> u32 { return m_bound++; }
+
+    auto op(spv::Op op, std::initializer_list<u32> operands) -> void {
+        m_words.push_back(static_cast<u32>(operands.size() + 1) << 16 | op);
+        m_words.insert(m_words.end(), operands);
+    }
+
+    // Instructions whose last operand is a string, like OpExtInstImport.
+    auto op(spv::Op op, std::initializer_list<u32> operands, std::string_view string)
+        -> void {
+        const u32 string_words = static_cast<u32>(string.size()) / 4 + 1;
+        const u32 count = static_cast<u32>(operands.size()) + string_words + 1;
+        m_words.push_back(count << 16 | op);
+        m_words.insert(m_words.end(), operands);
+        for (u32 i = 0; i < string_words; i++) {
+            u32 word = 0;
+            for (u32 c = 0; c < 4 && i * 4 + c < string.size(); c++) {
+                word |= static_cast<u32>(static_cast<u8>(string[i * 4 + c])) << (c * 8);
+            }
+            m_words.push_back(word);
+        }
+    }
+
+    auto constant(u32 type, f32 value) -> u32 {
+        const u32 result = this->id();
+        this->op(spv::OpConstant, {type, result, std::bit_cast<u32>(value)});
+        return result;
+    }
+
+    auto module(SHADER_STAGE stage) const -> ShadingCode::Module {
+        ShadingCode::Module result;
+        result.m_code = {spv::MagicNumber, 0x00010000, 0, m_bound, 0};
+        result.m_code.insert(result.m_code.end(), m_words.begin(), m_words.end());
+        result.m_stage = stage;
+        return result;
+    }
+
+private:
+    u32              m_bound = 1;
+    std::vector<u32> m_words;
+};
+
+static auto lane_mask(u32 lanes) -> u32 { return (1U << lanes) - 1; }
+
+static auto set_input(ShaderVM& vm, const ShaderProgram::Variable& input, auto value)
+    -> void {
+    for (u32 c = 0; c < input.m_registers.size(); c++) {
+        for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+            vm.get_register(input.m_registers[c]).m_lanes[lane] = value(lane, c);
+        }
+    }
+}
+
+static auto
+get_output(ShaderVM& vm, const ShaderProgram::Variable& output, u32 c, u32 lane)
+    -> f32 {
+    return vm.get_register(output.m_registers[c]).m_lanes[lane];
+}
+
+/*
+    layout(location = 0) in vec2 uv;
+    layout(location = 1) in vec4 color;
+    layout(binding = 1) uniform sampler2D tex;
+    layout(location = 0) out vec4 out_color;
+    void main() {
+        if (!gl_FrontFacing) { out_color = vec4(0, 0, 0, 1); return; }
+        out_color = texture(tex, uv) * color;
+    }
+*/
+TEST(SoftwareShader, FragmentSamplesTextureInFrontFacingLanes) {
+    Assembler a;
+    const u32 glsl = a.id();
+    const u32 main = a.id();
+    const u32 uv = a.id();
+    const u32 color = a.id();
+    const u32 tex = a.id();
+    const u32 out_color = a.id();
+    const u32 front = a.id();
+    a.op(spv::OpCapability, {spv::CapabilityShader});
+    a.op(spv::OpExtInstImport, {glsl}, "GLSL.std.450");
+    a.op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    a.op(spv::OpEntryPoint, {spv::ExecutionModelFragment, main}, "main");
+    a.op(spv::OpDecorate, {uv, spv::DecorationLocation, 0});
+    a.op(spv::OpDecorate, {color, spv::DecorationLocation, 1});
+    a.op(spv::OpDecorate, {out_color, spv::DecorationLocation, 0});
+    a.op(spv::OpDecorate, {front, spv::DecorationBuiltIn, spv::BuiltInFrontFacing});
+    a.op(spv::OpDecorate, {tex, spv::DecorationBinding, 1});
+    a.op(spv::OpDecorate, {tex, spv::DecorationDescriptorSet, 0});
+
+    const u32 t_void = a.id();
+    const u32 t_fn = a.id();
+    const u32 t_bool = a.id();
+    const u32 t_float = a.id();
+    const u32 t_vec2 = a.id();
+    const u32 t_vec4 = a.id();
+    const u32 t_image = a.id();
+    const u32 t_sampled = a.id();
+    const u32 p_in_vec2 = a.id();
+    const u32 p_in_vec4 = a.id();
+    const u32 p_in_bool = a.id();
+    const u32 p_out_vec4 = a.id();
+    const u32 p_sampled = a.id();
+    a.op(spv::OpTypeVoid, {t_void});
+    a.op(spv::OpTypeFunction, {t_fn, t_void});
+    a.op(spv::OpTypeBool, {t_bool});
+    a.op(spv::OpTypeFloat, {t_float, 32});
+    a.op(spv::OpTypeVector, {t_vec2, t_float, 2});
+    a.op(spv::OpTypeVector, {t_vec4, t_float, 4});
+    a.op(spv::OpTypeImage, {t_image, t_float, spv::Dim2D, 0, 0, 0, 1, 0});
+    a.op(spv::OpTypeSampledImage, {t_sampled, t_image});
+    a.op(spv::OpTypePointer, {p_in_vec2, spv::StorageClassInput, t_vec2});
+    a.op(spv::OpTypePointer, {p_in_vec4, spv::StorageClassInput, t_vec4});
+    a.op(spv::OpTypePointer, {p_in_bool, spv::StorageClassInput, t_bool});
+    a.op(spv::OpTypePointer, {p_out_vec4, spv::StorageClassOutput, t_vec4});
+    a.op(spv::OpTypePointer, {p_sampled, spv::StorageClassUniformConstant, t_sampled});
+    const u32 zero = a.constant(t_float, 0.0F);
+    const u32 one = a.constant(t_float, 1.0F);
+    const u32 black = a.id();
+    a.op(spv::OpConstantComposite, {t_vec4, black, zero, zero, zero, one});
+    a.op(spv::OpVariable, {p_in_vec2, uv, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_in_vec4, color, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_in_bool, front, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_out_vec4, out_color, spv::StorageClassOutput});
+    a.op(spv::OpVariable, {p_sampled, tex, spv::StorageClassUniformConstant});
+
+    const u32 entry = a.id();
+    const u32 back = a.id();
+    const u32 lit = a.id();
+    const u32 is_front = a.id();
+    const u32 is_back = a.id();
+    const u32 sampler = a.id();
+    const u32 uv_value = a.id();
+    const u32 texel = a.id();
+    const u32 color_value = a.id();
+    const u32 product = a.id();
+    a.op(spv::OpFunction, {t_void, main, 0, t_fn});
+    a.op(spv::OpLabel, {entry});
+    a.op(spv::OpLoad, {t_bool, is_front, front});
+    a.op(spv::OpLogicalNot, {t_bool, is_back, is_front});
+    a.op(spv::OpSelectionMerge, {lit, 0});
+    a.op(spv::OpBranchConditional, {is_back, back, lit});
+    a.op(spv::OpLabel, {back});
+    a.op(spv::OpStore, {out_color, black});
+    a.op(spv::OpReturn, {});
+    a.op(spv::OpLabel, {lit});
+    a.op(spv::OpLoad, {t_sampled, sampler, tex});
+    a.op(spv::OpLoad, {t_vec2, uv_value, uv});
+    a.op(spv::OpImageSampleImplicitLod, {t_vec4, texel, sampler, uv_value});
+    a.op(spv::OpLoad, {t_vec4, color_value, color});
+    a.op(spv::OpFMul, {t_vec4, product, texel, color_value});
+    a.op(spv::OpStore, {out_color, product});
+    a.op(spv::OpReturn, {});
+    a.op(spv::OpFunctionEnd, {});
+
+    ReflectedModule reflected;
+    reflected.m_sampled_images.push_back(
+        {.name = "tex", .binding = 1, .set = 0, .size = 0}
+    );
+
+    std::string                  error;
+    std::optional<ShaderProgram> program =
+        software::compile_shader(a.module(SHADER_STAGE::FRAGMENT), reflected, &error);
+    ASSERT_TRUE(program.has_value()) << error;
+    ASSERT_EQ(program->m_sampled_images.size(), 1U);
+    EXPECT_EQ(program->m_sampled_images[0].m_binding, 1U);
+
+    // Red on the left, green on the right.
+    const u8          texels[] = {255, 0, 0, 255, 0, 255, 0, 255};
+    software::Texture texture(texels, v2u32::create(2, 1), 4);
+
+    ShaderVM vm(*program);
+    set_input(vm, *program->find_input(0), [](u32 lane, u32 c) {
+        return c == 0 ? ((lane / 2) % 2 == 0 ? 0.25F : 0.75F) : 0.5F;
+    });
+    set_input(vm, *program->find_input(1), [](u32, u32 c) {
+        return c == 1 ? 0.5F : 1.0F;
+    });
+    set_input(vm, *program->find_input(SHADER_BUILTIN::FRONT_FACING), [](u32 lane, u32) {
+        return std::bit_cast<f32>(lane % 2 == 0 ? ~0U : 0U);
+    });
+
+    const software::Texture* textures[] = {&texture};
+    EXPECT_EQ(vm.execute(lane_mask(SHADER_LANES), {}, textures), lane_mask(SHADER_LANES));
+
+    const ShaderProgram::Variable& out = *program->find_output(0);
+    for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+        SCOPED_TRACE(lane);
+        const bool is_red = (lane / 2) % 2 == 0;
+        if (lane % 2 == 1) {
+            EXPECT_EQ(get_output(vm, out, 0, lane), 0.0F);
+            EXPECT_EQ(get_output(vm, out, 1, lane), 0.0F);
+        } else {
+            EXPECT_EQ(get_output(vm, out, 0, lane), is_red ? 1.0F : 0.0F);
+            EXPECT_EQ(get_output(vm, out, 1, lane), is_red ? 0.0F : 0.5F);
+        }
+        EXPECT_EQ(get_output(vm, out, 2, lane), 0.0F);
+        EXPECT_EQ(get_output(vm, out, 3, lane), 1.0F);
+    }
+}
+
+/*
+    layout(binding = 0) uniform UBO { mat4 model; vec4 tint; } ubo;
+    layout(location = 0) in vec3 position;
+    layout(location = 0) out vec4 v_tint;
+    void main() {
+        gl_Position = ubo.model * vec4(position, 1.0);
+        v_tint = ubo.tint;
+    }
+*/
+static auto assemble_transform_shader() -> ShadingCode::Module {
+    Assembler a;
+    const u32 main = a.id();
+    const u32 ubo = a.id();
+    const u32 position = a.id();
+    const u32 v_tint = a.id();
+    const u32 per_vertex = a.id();
+    a.op(spv::OpCapability, {spv::CapabilityShader});
+    a.op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    a.op(spv::OpEntryPoint, {spv::ExecutionModelVertex, main}, "main");
+
+    const u32 t_void = a.id();
+    const u32 t_fn = a.id();
+    const u32 t_int = a.id();
+    const u32 t_float = a.id();
+    const u32 t_vec3 = a.id();
+    const u32 t_vec4 = a.id();
+    const u32 t_mat4 = a.id();
+    const u32 t_ubo = a.id();
+    const u32 t_per_vertex = a.id();
+    const u32 p_ubo = a.id();
+    const u32 p_ubo_mat4 = a.id();
+    const u32 p_ubo_vec4 = a.id();
+    const u32 p_in_vec3 = a.id();
+    const u32 p_out_vec4 = a.id();
+    const u32 p_out_per_vertex = a.id();
+    a.op(spv::OpDecorate, {t_ubo, spv::DecorationBlock});
+    a.op(spv::OpMemberDecorate, {t_ubo, 0, spv::DecorationColMajor});
+    a.op(spv::OpMemberDecorate, {t_ubo, 0, spv::DecorationOffset, 0});
+    a.op(spv::OpMemberDecorate, {t_ubo, 0, spv::DecorationMatrixStride, 16});
+    a.op(spv::OpMemberDecorate, {t_ubo, 1, spv::DecorationOffset, 64});
+    a.op(spv::OpDecorate, {ubo, spv::DecorationBinding, 0});
+    a.op(spv::OpDecorate, {ubo, spv::DecorationDescriptorSet, 0});
+    a.op(spv::OpDecorate, {position, spv::DecorationLocation, 0});
+    a.op(spv::OpDecorate, {v_tint, spv::DecorationLocation, 0});
+    a.op(spv::OpDecorate, {t_per_vertex, spv::DecorationBlock});
+    a.op(
+        spv::OpMemberDecorate,
+        {t_per_vertex, 0, spv::DecorationBuiltIn, spv::BuiltInPosition}
+    );
+    a.op(
+        spv::OpMemberDecorate,
+        {t_per_vertex, 1, spv::DecorationBuiltIn, spv::BuiltInPointSize}
+    );
+
+    a.op(spv::OpTypeVoid, {t_void});
+    a.op(spv::OpTypeFunction, {t_fn, t_void});
+    a.op(spv::OpTypeInt, {t_int, 32, 1});
+    a.op(spv::OpTypeFloat, {t_float, 32});
+    a.op(spv::OpTypeVector, {t_vec3, t_float, 3});
+    a.op(spv::OpTypeVector, {t_vec4, t_float, 4});
+    a.op(spv::OpTypeMatrix, {t_mat4, t_vec4, 4});
+    a.op(spv::OpTypeStruct, {t_ubo, t_mat4, t_vec4});
+    a.op(spv::OpTypeStruct, {t_per_vertex, t_vec4, t_float});
+    a.op(spv::OpTypePointer, {p_ubo, spv::StorageClassUniform, t_ubo});
+    a.op(spv::OpTypePointer, {p_ubo_mat4, spv::StorageClassUniform, t_mat4});
+    a.op(spv::OpTypePointer, {p_ubo_vec4, spv::StorageClassUniform, t_vec4});
+    a.op(spv::OpTypePointer, {p_in_vec3, spv::StorageClassInput, t_vec3});
+    a.op(spv::OpTypePointer, {p_out_vec4, spv::StorageClassOutput, t_vec4});
+    a.op(spv::OpTypePointer, {p_out_per_vertex, spv::StorageClassOutput, t_per_vertex});
+    const u32 int_0 = a.id();
+    const u32 int_1 = a.id();
+    a.op(spv::OpConstant, {t_int, int_0, 0});
+    a.op(spv::OpConstant, {t_int, int_1, 1});
+    const u32 one = a.constant(t_float, 1.0F);
+    a.op(spv::OpVariable, {p_ubo, ubo, spv::StorageClassUniform});
+    a.op(spv::OpVariable, {p_in_vec3, position, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_out_vec4, v_tint, spv::StorageClassOutput});
+    a.op(spv::OpVariable, {p_out_per_vertex, per_vertex, spv::StorageClassOutput});
+
+    const u32 entry = a.id();
+    const u32 model_ptr = a.id();
+    const u32 model = a.id();
+    const u32 pos = a.id();
+    const u32 x = a.id();
+    const u32 y = a.id();
+    const u32 z = a.id();
+    const u32 pos4 = a.id();
+    const u32 clip = a.id();
+    const u32 out_ptr = a.id();
+    const u32 tint_ptr = a.id();
+    const u32 tint = a.id();
+    a.op(spv::OpFunction, {t_void, main, 0, t_fn});
+    a.op(spv::OpLabel, {entry});
+    a.op(spv::OpAccessChain, {p_ubo_mat4, model_ptr, ubo, int_0});
+    a.op(spv::OpLoad, {t_mat4, model, model_ptr});
+    a.op(spv::OpLoad, {t_vec3, pos, position});
+    a.op(spv::OpCompositeExtract, {t_float, x, pos, 0});
+    a.op(spv::OpCompositeExtract, {t_float, y, pos, 1});
+    a.op(spv::OpCompositeExtract, {t_float, z, pos, 2});
+    a.op(spv::OpCompositeConstruct, {t_vec4, pos4, x, y, z, one});
+    a.op(spv::OpMatrixTimesVector, {t_vec4, clip, model, pos4});
+    a.op(spv::OpAccessChain, {p_out_vec4, out_ptr, per_vertex, int_0});
+    a.op(spv::OpStore, {out_ptr, clip});
+    a.op(spv::OpAccessChain, {p_ubo_vec4, tint_ptr, ubo, int_1});
+    a.op(spv::OpLoad, {t_vec4, tint, tint_ptr});
+    a.op(spv::OpStore, {v_tint, tint});
+    a.op(spv::OpReturn, {});
+    a.op(spv::OpFunctionEnd, {});
+    return a.module(SHADER_STAGE::VERTEX);
+}
+
+TEST(SoftwareShader, VertexTransformsWithUniformMatrix) {
+    ReflectedModule reflected;
+    reflected.m_uniform_buffers.push_back(
+        {.name = "UBO", .size = 80, .binding = 0, .set = 0, .members = {}}
+    );
+
+    std::string                  error;
+    std::optional<ShaderProgram> program =
+        software::compile_shader(assemble_transform_shader(), reflected, &error);
+    ASSERT_TRUE(program.has_value()) << error;
+
+    // Scales by 2 and translates by (10, 20, 30), column major.
+    f32 ubo[20] = {};
+    ubo[0] = 2.0F;
+    ubo[5] = 2.0F;
+    ubo[10] = 2.0F;
+    ubo[12] = 10.0F;
+    ubo[13] = 20.0F;
+    ubo[14] = 30.0F;
+    ubo[15] = 1.0F;
+    ubo[16] = 0.1F;
+    ubo[17] = 0.2F;
+    ubo[18] = 0.3F;
+    ubo[19] = 0.4F;
+
+    ShaderVM vm(*program);
+    set_input(vm, *program->find_input(0), [](u32 lane, u32 c) {
+        const f32 i = static_cast<f32>(lane);
+        return c == 0 ? i : (c == 1 ? -i : 0.5F);
+    });
+    const std::span<const u8> buffers[] = {
+        std::span(reinterpret_cast<const u8*>(ubo), sizeof(ubo))
+    };
+    EXPECT_EQ(vm.execute(lane_mask(5), buffers, {}), lane_mask(5));
+
+    const ShaderProgram::Variable* position =
+        program->find_output(SHADER_BUILTIN::POSITION);
+    ASSERT_NE(position, nullptr);
+    ASSERT_NE(program->find_output(SHADER_BUILTIN::POINT_SIZE), nullptr);
+    const ShaderProgram::Variable& tint = *program->find_output(0);
+    for (u32 lane = 0; lane < 5; lane++) {
+        SCOPED_TRACE(lane);
+        const f32 i = static_cast<f32>(lane);
+        EXPECT_EQ(get_output(vm, *position, 0, lane), 2.0F * i + 10.0F);
+        EXPECT_EQ(get_output(vm, *position, 1, lane), -2.0F * i + 20.0F);
+        EXPECT_EQ(get_output(vm, *position, 2, lane), 31.0F);
+        EXPECT_EQ(get_output(vm, *position, 3, lane), 1.0F);
+        EXPECT_EQ(get_output(vm, tint, 0, lane), 0.1F);
+        EXPECT_EQ(get_output(vm, tint, 3, lane), 0.4F);
+    }
+}
+
+TEST(SoftwareShader, UniformAccessOutsideReflectedSizeIsRejected) {
+    ReflectedModule reflected;
+    reflected.m_uniform_buffers.push_back(
+        {.name = "UBO", .size = 64, .binding = 0, .set = 0, .members = {}}
+    );
+
+    std::string error;
+    const std::optional<ShaderProgram> program =
+        software::compile_shader(assemble_transform_shader(), reflected, &error);
+    EXPECT_FALSE(program.has_value());
+    EXPECT_NE(error.find("out of bounds"), std::string::npos) << error;
+}
+
+/*
+    layout(binding = 0) uniform UBO { vec4 colors[4]; } ubo;
+    layout(location = 0) out vec4 v_color;
+    void main() { v_color = ubo.colors[gl_InstanceIndex]; }
+*/
+TEST(SoftwareShader, UniformArraysIndexedByVariable) {
+    Assembler a;
+    const u32 main = a.id();
+    const u32 ubo = a.id();
+    const u32 instance = a.id();
+    const u32 v_color = a.id();
+    a.op(spv::OpCapability, {spv::CapabilityShader});
+    a.op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    a.op(spv::OpEntryPoint, {spv::ExecutionModelVertex, main}, "main");
+
+    const u32 t_void = a.id();
+    const u32 t_fn = a.id();
+    const u32 t_int = a.id();
+    const u32 t_uint = a.id();
+    const u32 t_float = a.id();
+    const u32 t_vec4 = a.id();
+    const u32 t_array = a.id();
+    const u32 t_ubo = a.id();
+    const u32 p_ubo = a.id();
+    const u32 p_ubo_vec4 = a.id();
+    const u32 p_in_int = a.id();
+    const u32 p_out_vec4 = a.id();
+    a.op(spv::OpDecorate, {t_array, spv::DecorationArrayStride, 16});
+    a.op(spv::OpDecorate, {t_ubo, spv::DecorationBlock});
+    a.op(spv::OpMemberDecorate, {t_ubo, 0, spv::DecorationOffset, 0});
+    a.op(spv::OpDecorate, {ubo, spv::DecorationBinding, 0});
+    a.op(spv::OpDecorate, {ubo, spv::DecorationDescriptorSet, 0});
+    a.op(spv::OpDecorate, {instance, spv::DecorationBuiltIn, spv::BuiltInInstanceIndex});
+    a.op(spv::OpDecorate, {v_color, spv::DecorationLocation, 0});
+
+    a.op(spv::OpTypeVoid, {t_void});
+    a.op(spv::OpTypeFunction, {t_fn, t_void});
+    a.op(spv::OpTypeInt, {t_int, 32, 1});
+    a.op(spv::OpTypeInt, {t_uint, 32, 0});
+    a.op(spv::OpTypeFloat, {t_float, 32});
+    a.op(spv::OpTypeVector, {t_vec4, t_float, 4});
+    const u32 uint_4 = a.id();
+    a.op(spv::OpConstant, {t_uint, uint_4, 4});
+    a.op(spv::OpTypeArray, {t_array, t_vec4, uint_4});
+    a.op(spv::OpTypeStruct, {t_ubo, t_array});
+    a.op(spv::OpTypePointer, {p_ubo, spv::StorageClassUniform, t_ubo});
+    a.op(spv::OpTypePointer, {p_ubo_vec4, spv::StorageClassUniform, t_vec4});
+    a.op(spv::OpTypePointer, {p_in_int, spv::StorageClassInput, t_int});
+    a.op(spv::OpTypePointer, {p_out_vec4, spv::StorageClassOutput, t_vec4});
+    const u32 int_0 = a.id();
+    a.op(spv::OpConstant, {t_int, int_0, 0});
+    a.op(spv::OpVariable, {p_ubo, ubo, spv::StorageClassUniform});
+    a.op(spv::OpVariable, {p_in_int, instance, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_out_vec4, v_color, spv::StorageClassOutput});
+
+    const u32 entry = a.id();
+    const u32 index = a.id();
+    const u32 color_ptr = a.id();
+    const u32 color = a.id();
+    a.op(spv::OpFunction, {t_void, main, 0, t_fn});
+    a.op(spv::OpLabel, {entry});
+    a.op(spv::OpLoad, {t_int, index, instance});
+    a.op(spv::OpAccessChain, {p_ubo_vec4, color_ptr, ubo, int_0, index});
+    a.op(spv::OpLoad, {t_vec4, color, color_ptr});
+    a.op(spv::OpStore, {v_color, color});
+    a.op(spv::OpReturn, {});
+    a.op(spv::OpFunctionEnd, {});
+
+    ReflectedModule reflected;
+    reflected.m_uniform_buffers.push_back(
+        {.name = "UBO", .size = 64, .binding = 0, .set = 0, .members = {}}
+    );
+    std::string                  error;
+    std::optional<ShaderProgram> program =
+        software::compile_shader(a.module(SHADER_STAGE::VERTEX), reflected, &error);
+    ASSERT_TRUE(program.has_value()) << error;
+
+    f32 ubo_data[16] = {};
+    for (u32 i = 0; i < 16; i++) { ubo_data[i] = static_cast<f32>(i + 1); }
+
+    // Lanes 4 to 6 are past the end of the array and lane 7 is negative.
+    ShaderVM vm(*program);
+    const ShaderProgram::Variable& instance_index =
+        *program->find_input(SHADER_BUILTIN::INSTANCE_INDEX);
+    set_input(vm, instance_index, [](u32 lane, u32) {
+        return std::bit_cast<f32>(lane == 7 ? ~0U : lane);
+    });
+    const std::span<const u8> buffers[] = {
+        std::span(reinterpret_cast<const u8*>(ubo_data), sizeof(ubo_data))
+    };
+    EXPECT_EQ(vm.execute(lane_mask(8), buffers, {}), lane_mask(8));
+
+    const ShaderProgram::Variable& out = *program->find_output(0);
+    for (u32 lane = 0; lane < SHADER_LANES; lane++) {
+        SCOPED_TRACE(lane);
+        for (u32 c = 0; c < 4; c++) {
+            const f32 expected = lane < 4 ? static_cast<f32>(lane * 4 + c + 1) : 0.0F;
+            EXPECT_EQ(get_output(vm, out, c, lane), expected);
+        }
+    }
+}
+
+/*
+    layout(location = 0) in float x;
+    layout(location = 0) out vec4 c;
+    float f(float a) {
+        if (a > 2.0) { return pow(a, 2.0); }
+        return a * 0.5;
+    }
+    void main() {
+        float y = f(x);
+        float z = x > 1.0 ? 3.0 : 4.0; // as a phi
+        if (x < 0.0) { discard; }
+        c = vec4(y, z, 0.0, 1.0);
+    }
+*/
+TEST(SoftwareShader, CallsPhisAndDiscards) {
+    Assembler a;
+    const u32 glsl = a.id();
+    const u32 main = a.id();
+    const u32 f = a.id();
+    const u32 x = a.id();
+    const u32 c = a.id();
+    a.op(spv::OpCapability, {spv::CapabilityShader});
+    a.op(spv::OpExtInstImport, {glsl}, "GLSL.std.450");
+    a.op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    a.op(spv::OpEntryPoint, {spv::ExecutionModelFragment, main}, "main");
+    a.op(spv::OpDecorate, {x, spv::DecorationLocation, 0});
+    a.op(spv::OpDecorate, {c, spv::DecorationLocation, 0});
+
+    const u32 t_void = a.id();
+    const u32 t_fn = a.id();
+    const u32 t_bool = a.id();
+    const u32 t_float = a.id();
+    const u32 t_vec4 = a.id();
+    const u32 t_fn_float = a.id();
+    const u32 p_in_float = a.id();
+    const u32 p_out_vec4 = a.id();
+    a.op(spv::OpTypeVoid, {t_void});
+    a.op(spv::OpTypeFunction, {t_fn, t_void});
+    a.op(spv::OpTypeBool, {t_bool});
+    a.op(spv::OpTypeFloat, {t_float, 32});
+    a.op(spv::OpTypeVector, {t_vec4, t_float, 4});
+    a.op(spv::OpTypeFunction, {t_fn_float, t_float, t_float});
+    a.op(spv::OpTypePointer, {p_in_float, spv::StorageClassInput, t_float});
+    a.op(spv::OpTypePointer, {p_out_vec4, spv::StorageClassOutput, t_vec4});
+    const u32 zero = a.constant(t_float, 0.0F);
+    const u32 half = a.constant(t_float, 0.5F);
+    const u32 one = a.constant(t_float, 1.0F);
+    const u32 two = a.constant(t_float, 2.0F);
+    const u32 three = a.constant(t_float, 3.0F);
+    const u32 four = a.constant(t_float, 4.0F);
+    a.op(spv::OpVariable, {p_in_float, x, spv::StorageClassInput});
+    a.op(spv::OpVariable, {p_out_vec4, c, spv::StorageClassOutput});
+
+    const u32 f_param = a.id();
+    const u32 f_entry = a.id();
+    const u32 f_big = a.id();
+    const u32 f_small = a.id();
+    const u32 f_is_big = a.id();
+    const u32 f_pow = a.id();
+    const u32 f_half = a.id();
+    a.op(spv::OpFunction, {t_float, f, 0, t_fn_float});
+    a.op(spv::OpFunctionParameter, {t_float, f_param});
+    a.op(spv::OpLabel, {f_entry});
+    a.op(spv::OpFOrdGreaterThan, {t_bool, f_is_big, f_param, two});
+    a.op(spv::OpSelectionMerge, {f_small, 0});
+    a.op(spv::OpBranchConditional, {f_is_big, f_big, f_small});
+    a.op(spv::OpLabel, {f_big});
+    a.op(spv::OpExtInst, {t_float, f_pow, glsl, 26 /* Pow */, f_param, two});
+    a.op(spv::OpReturnValue, {f_pow});
+    a.op(spv::OpLabel, {f_small});
+    a.op(spv::OpFMul, {t_float, f_half, f_param, half});
+    a.op(spv::OpReturnValue, {f_half});
+    a.op(spv::OpFunctionEnd, {});
+
+    const u32 entry = a.id();
+    const u32 above = a.id();
+    const u32 below = a.id();
+    const u32 merge = a.id();
+    const u32 kill = a.id();
+    const u32 write = a.id();
+    const u32 x_value = a.id();
+    const u32 y = a.id();
+    const u32 is_above = a.id();
+    const u32 z = a.id();
+    const u32 is_negative = a.id();
+    const u32 result = a.id();
+    a.op(spv::OpFunction, {t_void, main, 0, t_fn});
+    a.op(spv::OpLabel, {entry});
+    a.op(spv::OpLoad, {t_float, x_value, x});
+    a.op(spv::OpFunctionCall, {t_float, y, f, x_value});
+    a.op(spv::OpFOrdGreaterThan, {t_bool, is_above, x_value, one});
+    a.op(spv::OpSelectionMerge, {merge, 0});
+    a.op(spv::OpBranchConditional, {is_above, above, below});
+    a.op(spv::OpLabel, {above});
+    a.op(spv::OpBranch, {merge});
+    a.op(spv::OpLabel, {below});
+    a.op(spv::OpBranch, {merge});
+    a.op(spv::OpLabel, {merge});
+    a.op(spv::OpPhi, {t_float, z, three, above, four, below});
+    a.op(spv::OpFOrdLessThan, {t_bool, is_negative, x_value, zero});
+    a.op(spv::OpSelectionMerge, {write, 0});
+    a.op(spv::OpBranchConditional, {is_negative, kill, write});
+    a.op(spv::OpLabel, {kill});
+    a.op(spv::OpKill, {});
+    a.op(spv::OpLabel, {write});
+    a.op(spv::OpCompositeConstruct, {t_vec4, result, y, z, zero, one});
+    a.op(spv::OpStore, {c, result});
+    a.op(spv::OpReturn, {});
+    a.op(spv::OpFunctionEnd, {});
+
+    std::string                  error;
+    std::optional<ShaderProgram> program =
+        software::compile_shader(a.module(SHADER_STAGE::FRAGMENT), {}, &error);
+    ASSERT_TRUE(program.has_value()) << error;
+
+    constexpr f32 xs[SHADER_LANES] = {-1.0F, 0.0F, 1.0F, 1.5F, 2.0F, 3.0F, 4.0F, -5.0F};
+    ShaderVM      vm(*program);
+    set_input(vm, *program->find_input(0), [&](u32 lane, u32) { return xs[lane]; });
+    // The negative lanes are discarded.
+    EXPECT_EQ(vm.execute(lane_mask(SHADER_LANES), {}, {}), 0b0111'1110U);
+
+    const ShaderProgram::Variable& out = *program->find_output(0);
+    for (u32 lane = 1; lane < SHADER_LANES - 1; lane++) {
+        SCOPED_TRACE(lane);
+        const f32 value = xs[lane];
+        const f32 expected = value > 2.0F ? value * value : value * 0.5F;
+        EXPECT_FLOAT_EQ(get_output(vm, out, 0, lane), expected);
+        EXPECT_EQ(get_output(vm, out, 1, lane), value > 1.0F ? 3.0F : 4.0F);
+        EXPECT_EQ(get_output(vm, out, 3, lane), 1.0F);
+    }
+}
+
+TEST(SoftwareShader, LoopsAreRejected) {
+    Assembler a;
+    const u32 main = a.id();
+    a.op(spv::OpCapability, {spv::CapabilityShader});
+    a.op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    a.op(spv::OpEntryPoint, {spv::ExecutionModelFragment, main}, "main");
+    const u32 t_void = a.id();
+    const u32 t_fn = a.id();
+    a.op(spv::OpTypeVoid, {t_void});
+    a.op(spv::OpTypeFunction, {t_fn, t_void});
+
+    const u32 entry = a.id();
+    const u32 header = a.id();
+    a.op(spv::OpFunction, {t_void, main, 0, t_fn});
+    a.op(spv::OpLabel, {entry});
+    a.op(spv::OpBranch, {header});
+    a.op(spv::OpLabel, {header});
+    a.op(spv::OpBranch, {header});
+    a.op(spv::OpFunctionEnd, {});
+
+    std::string error;
+    EXPECT_FALSE(
+        software::compile_shader(a.module(SHADER_STAGE::FRAGMENT), {}, &error).has_value()
+    );
+    EXPECT_NE(error.find("loops"), std::string::npos) << error;
+}
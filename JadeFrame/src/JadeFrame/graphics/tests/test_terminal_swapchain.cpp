@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "JadeFrame/graphics/software/framebuffer.h"
+#include "JadeFrame/graphics/terminal/swapchain.h"
+
+using namespace JadeFrame;
+
+constexpr u32 SS = terminal::Swapchain::SUPERSAMPLING;
+
+// Fills the pixels of one half of a character cell.
+static auto fill_half(
+    software::Framebuffer& fb,
+    u32                    column,
+    u32                    row,
+    bool                   is_bottom,
+    u32                    color
+) -> void {
+    const u32 y0 = row * 2 * SS + (is_bottom ? SS : 0);
+    for (u32 y = y0; y < y0 + SS; y++) {
+        for (u32 x = column * SS; x < (column + 1) * SS; x++) {
+            fb.m_color[static_cast<size_t>(y) * fb.m_width + x] = color;
+        }
+    }
+}
+
+static auto count(std::string_view haystack, std::string_view needle) -> u32 {
+    u32 result = 0;
+    for (size_t i = haystack.find(needle); i != std::string_view::npos;
+         i = haystack.find(needle, i + needle.size())) {
+        result++;
+    }
+    return result;
+}
+
+TEST(TerminalSwapchain, UnchangedFrameWritesNothing) {
+    software::Framebuffer fb(40 * SS, 10 * 2 * SS);
+    fb.clear_rect(0, 0, fb.m_width, fb.m_height, 0xFF102030, 1.0F);
+
+    terminal::Swapchain swapchain;
+    const std::string   first(swapchain.encode(fb));
+    // The first frame clears the screen and writes every cell.
+    EXPECT_EQ(first.rfind("\x1b[?25l\x1b[0m\x1b[2J", 0), 0U);
+    EXPECT_EQ(count(first, " "), 40U * 10U);
+    // Every cell has the same color, which is only set once.
+    EXPECT_EQ(count(first, "48;2;16;32;48"), 1U);
+
+    EXPECT_TRUE(swapchain.encode(fb).empty());
+}
+
+TEST(TerminalSwapchain, OnlyChangedCellsAreWritten) {
+    software::Framebuffer fb(40 * SS, 10 * 2 * SS);
+    fb.clear_rect(0, 0, fb.m_width, fb.m_height, 0xFF000000, 1.0F);
+
+    terminal::Swapchain swapchain;
+    (void)swapchain.encode(fb);
+
+    fill_half(fb, 5, 3, false, 0xFFFF0000);
+    fill_half(fb, 6, 3, false, 0xFFFF0000);
+    const std::string frame(swapchain.encode(fb));
+    // Move to the first cell, set both colors once and draw two upper half blocks.
+    EXPECT_EQ(
+        frame,
+        "\x1b[4;6H\x1b[38;2;255;0;0;48;2;0;0;0m\xE2\x96\x80\xE2\x96\x80\x1b[0m"
+    );
+}
+
+TEST(TerminalSwapchain, GlyphsReuseTheCurrentColors) {
+    software::Framebuffer fb(4 * SS, 1 * 2 * SS);
+    fb.clear_rect(0, 0, fb.m_width, fb.m_height, 0xFF000000, 1.0F);
+    // Red over blue, blue over red, all red and all blue.
+    fill_half(fb, 0, 0, false, 0xFFFF0000);
+    fill_half(fb, 0, 0, true, 0xFF0000FF);
+    fill_half(fb, 1, 0, false, 0xFF0000FF);
+    fill_half(fb, 1, 0, true, 0xFFFF0000);
+    fill_half(fb, 2, 0, false, 0xFFFF0000);
+    fill_half(fb, 2, 0, true, 0xFFFF0000);
+    fill_half(fb, 3, 0, false, 0xFF0000FF);
+    fill_half(fb, 3, 0, true, 0xFF0000FF);
+
+    terminal::Swapchain swapchain;
+    const std::string   frame(swapchain.encode(fb));
+    // Only the first cell sets colors, the others pick the glyph that fits them.
+    EXPECT_EQ(count(frame, "38;2;"), 1U);
+    EXPECT_EQ(count(frame, "48;2;"), 1U);
+    const std::string cells = "\xE2\x96\x80"
+                              "\xE2\x96\x84"
+                              "\xE2\x96\x88"
+                              " ";
+    EXPECT_NE(frame.find(cells), std::string::npos);
+}
+
+TEST(TerminalSwapchain, PixelsAreAveraged) {
+    software::Framebuffer fb(1 * SS, 1 * 2 * SS);
+    fb.clear_rect(0, 0, fb.m_width, fb.m_height, 0xFF000000, 1.0F);
+    fb.m_color[0] = 0xFFFFFFFF;
+
+    terminal::Swapchain swapchain;
+    (void)swapchain.encode(fb);
+    const u32 expected = (255 + SS * SS / 2) / (SS * SS);
+    EXPECT_EQ(swapchain.m_previous_cells[0].m_top, expected * 0x010101U);
+    EXPECT_EQ(swapchain.m_previous_cells[0].m_bottom, 0U);
+}
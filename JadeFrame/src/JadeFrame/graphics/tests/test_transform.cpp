@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "JadeFrame/graphics/software/raster_kernel.h"
+#include "JadeFrame/graphics/transform.h"
+
+using namespace JadeFrame;
+
+static auto random_transform(std::mt19937& rng) -> Transform {
+    std::uniform_real_distribution<f32> value(-10.0F, 10.0F);
+    const v3 axis = v3::create(value(rng), value(rng), value(rng) + 20.0F);
+    return Transform{
+        .m_translation = v3::create(value(rng), value(rng), value(rng)),
+        .m_rotation = Quaternion::from_axis_angle(axis, value(rng)),
+        .m_scale = v3::create(value(rng), value(rng), value(rng)),
+    };
+}
+
+static auto expect_near(const mat4x4& a, const mat4x4& b) -> void {
+    for (u32 col = 0; col < 4; col++) {
+        for (u32 row = 0; row < 4; row++) {
+            EXPECT_NEAR(a[col][row], b[col][row], 1e-4F) << col << ", " << row;
+        }
+    }
+}
+
+TEST(Transform, MatchesTheMatrixProduct) {
+    const v3  axis = v3::create(1.0F, 2.0F, 3.0F).normalize();
+    const f32 angle = 0.7F;
+    Transform transform;
+    transform.m_translation = v3::create(4.0F, -5.0F, 6.0F);
+    transform.m_rotation = Quaternion::from_axis_angle(axis, angle);
+    transform.m_scale = v3::create(2.0F, 0.5F, -3.0F);
+
+    const mat4x4 expected = mat4x4::translation(transform.m_translation) *
+                            mat4x4::rotation_rh(angle, axis) *
+                            mat4x4::scale(transform.m_scale);
+    expect_near(transform.calculate(), expected);
+}
+
+TEST(Transform, KernelsAgree) {
+    if (!software::is_supported(software::RASTER_KERNEL::AVX2)) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    constexpr u32    COUNT = 64;
+    std::mt19937     rng(9);
+    std::vector<f32> components[10];
+    for (std::vector<f32>& component : components) { component.resize(COUNT); }
+    for (u32 i = 0; i < COUNT; i++) {
+        const Transform t = random_transform(rng);
+        const f32 values[] = {
+            t.m_translation.x,
+            t.m_translation.y,
+            t.m_translation.z,
+            t.m_rotation.x,
+            t.m_rotation.y,
+            t.m_rotation.z,
+            t.m_rotation.w,
+            t.m_scale.x,
+            t.m_scale.y,
+            t.m_scale.z,
+        };
+        for (u32 c = 0; c < 10; c++) { components[c][i] = values[c]; }
+    }
+    const TransformArrays arrays = {
+        components[0].data(),
+        components[1].data(),
+        components[2].data(),
+        components[3].data(),
+        components[4].data(),
+        components[5].data(),
+        components[6].data(),
+        components[7].data(),
+        components[8].data(),
+        components[9].data(),
+    };
+
+    std::vector<mat4x4> scalar(COUNT);
+    std::vector<mat4x4> avx2(COUNT);
+    compose_transforms_scalar(arrays, 0, COUNT, scalar.data());
+    compose_transforms_avx2(arrays, 0, COUNT, avx2.data());
+    for (u32 i = 0; i < COUNT; i++) {
+        for (u32 col = 0; col < 4; col++) {
+            for (u32 row = 0; row < 4; row++) {
+                ASSERT_EQ(scalar[i][col][row], avx2[i][col][row]) << i;
+            }
+        }
+    }
+}
+
+TEST(TransformPool, UpdateComposesTheChangedTransforms) {
+    std::mt19937                   rng(1);
+    TransformPool                  pool;
+    std::vector<TransformPool::Id> ids;
+    for (u32 i = 0; i < 20; i++) { ids.push_back(pool.create(random_transform(rng))); }
+    pool.update();
+    for (u32 i = 0; i < 20; i++) {
+        expect_near(pool.get_world(ids[i]), pool.get(ids[i]).calculate());
+    }
+
+    Transform moved = pool.get(ids[13]);
+    moved.m_translation = v3::create(1.0F, 2.0F, 3.0F);
+    pool.set(ids[13], moved);
+    pool.update();
+    EXPECT_EQ(pool.get_world(ids[13]).w_axis.y, 2.0F);
+    EXPECT_EQ(pool.size(), 20U);
+}
@@ -0,0 +1,166 @@
+#include "transform.h"
+
+#include <cstring>
+
+#include "software/raster_kernel.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+/*---------------------------
+    Transform
+---------------------------*/
+
+// The columns of the rotation matrix of `q`, each scaled by one component of `s`. The
+// AVX2 kernel does the same operations in the same order, so both give the same bits.
+static auto compose(const v3& t, const Quaternion& q, const v3& s) -> mat4x4 {
+    const f32 x2 = q.x + q.x;
+    const f32 y2 = q.y + q.y;
+    const f32 z2 = q.z + q.z;
+    const f32 xx = q.x * x2;
+    const f32 yy = q.y * y2;
+    const f32 zz = q.z * z2;
+    const f32 xy = q.x * y2;
+    const f32 xz = q.x * z2;
+    const f32 yz = q.y * z2;
+    const f32 wx = q.w * x2;
+    const f32 wy = q.w * y2;
+    const f32 wz = q.w * z2;
+
+    mat4x4 result;
+    result.x_axis = v4::create(
+        (1.0F - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0.0F
+    );
+    result.y_axis = v4::create(
+        (xy - wz) * s.y, (1.0F - (xx + zz)) * s.y, (yz + wx) * s.y, 0.0F
+    );
+    result.z_axis = v4::create(
+        (xz + wy) * s.z, (yz - wx) * s.z, (1.0F - (xx + yy)) * s.z, 0.0F
+    );
+    result.w_axis = v4::create(t.x, t.y, t.z, 1.0F);
+    return result;
+}
+
+auto Transform::calculate() const -> mat4x4 {
+    return compose(m_translation, m_rotation, m_scale);
+}
+
+auto compose_transforms_scalar(
+    const TransformArrays& transforms,
+    u32                    begin,
+    u32                    end,
+    mat4x4*                world
+) -> void {
+    const TransformArrays& a = transforms;
+    for (u32 i = begin; i < end; i++) {
+        world[i] = compose(
+            v3::create(a.m_tx[i], a.m_ty[i], a.m_tz[i]),
+            Quaternion::create(a.m_qx[i], a.m_qy[i], a.m_qz[i], a.m_qw[i]),
+            v3::create(a.m_sx[i], a.m_sy[i], a.m_sz[i])
+        );
+    }
+}
+
+/*---------------------------
+    TransformPool
+---------------------------*/
+
+auto TransformPool::create(const Transform& transform) -> Id {
+    const Id id = m_count++;
+    if (id == m_dirty.size()) {
+        const size_t padded = m_dirty.size() + 8;
+        for (std::vector<f32>& component : m_components) { component.resize(padded); }
+        m_dirty.resize(padded, 0);
+        m_world.resize(padded, mat4x4::identity());
+    }
+    this->set(id, transform);
+    return id;
+}
+
+auto TransformPool::set(Id id, const Transform& transform) -> void {
+    JF_ASSERT(id < m_count, "invalid transform id");
+    m_components[TX][id] = transform.m_translation.x;
+    m_components[TY][id] = transform.m_translation.y;
+    m_components[TZ][id] = transform.m_translation.z;
+    m_components[QX][id] = transform.m_rotation.x;
+    m_components[QY][id] = transform.m_rotation.y;
+    m_components[QZ][id] = transform.m_rotation.z;
+    m_components[QW][id] = transform.m_rotation.w;
+    m_components[SX][id] = transform.m_scale.x;
+    m_components[SY][id] = transform.m_scale.y;
+    m_components[SZ][id] = transform.m_scale.z;
+    m_dirty[id] = 1;
+    m_has_dirty = true;
+}
+
+auto TransformPool::get(Id id) const -> Transform {
+    JF_ASSERT(id < m_count, "invalid transform id");
+    return Transform{
+        .m_translation = v3::create(
+            m_components[TX][id], m_components[TY][id], m_components[TZ][id]
+        ),
+        .m_rotation = Quaternion::create(
+            m_components[QX][id],
+            m_components[QY][id],
+            m_components[QZ][id],
+            m_components[QW][id]
+        ),
+        .m_scale = v3::create(
+            m_components[SX][id], m_components[SY][id], m_components[SZ][id]
+        ),
+    };
+}
+
+auto TransformPool::update() -> void {
+    if (!m_has_dirty) { return; }
+    m_has_dirty = false;
+
+    auto compose_fn = &compose_transforms_scalar;
+#if JF_SOFTWARE_X86_KERNELS
+    if (software::is_supported(software::RASTER_KERNEL::AVX2)) {
+        compose_fn = &compose_transforms_avx2;
+    }
+#endif
+
+    // Works on blocks of 8 transforms. A block with any dirty transform is composed as a
+    // whole, consecutive dirty blocks with one call.
+    const TransformArrays arrays = this->get_arrays();
+    const u32             padded_count = static_cast<u32>(m_dirty.size());
+    u32                   run_begin = 0;
+    u32                   run_end = 0;
+    for (u32 block = 0; block < padded_count; block += 8) {
+        u64 flags = 0;
+        std::memcpy(&flags, &m_dirty[block], sizeof(flags));
+        if (flags == 0) { continue; }
+        std::memset(&m_dirty[block], 0, sizeof(flags));
+        if (block != run_end) {
+            compose_fn(arrays, run_begin, run_end, m_world.data());
+            run_begin = block;
+        }
+        run_end = block + 8;
+    }
+    compose_fn(arrays, run_begin, run_end, m_world.data());
+}
+
+auto TransformPool::get_world(Id id) const -> const mat4x4& {
+    JF_ASSERT(id < m_count, "invalid transform id");
+    JF_ASSERT(m_dirty[id] == 0, "the transform was set after the last update");
+    return m_world[id];
+}
+
+auto TransformPool::get_arrays() const -> TransformArrays {
+    return TransformArrays{
+        .m_tx = m_components[TX].data(),
+        .m_ty = m_components[TY].data(),
+        .m_tz = m_components[TZ].data(),
+        .m_qx = m_components[QX].data(),
+        .m_qy = m_components[QY].data(),
+        .m_qz = m_components[QZ].data(),
+        .m_qw = m_components[QW].data(),
+        .m_sx = m_components[SX].data(),
+        .m_sy = m_components[SY].data(),
+        .m_sz = m_components[SZ].data(),
+    };
+}
+
+} // namespace JadeFrame
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/math/mat_4.h"
+#include "JadeFrame/math/vec.h"
+
+namespace JadeFrame {
+
+/// Translation, rotation and scale of an object. The rotation has to be normalized.
+class Transform {
+public:
+    /// Composes `translation * rotation * scale` directly, without multiplying matrices.
+    [[nodiscard]] auto calculate() const -> mat4x4;
+
+public:
+    v3         m_translation = v3::zero();
+    Quaternion m_rotation = Quaternion::identity();
+    v3         m_scale = v3::one();
+};
+
+/// The components of many transforms, one array per component.
+struct TransformArrays {
+    const f32* m_tx = nullptr;
+    const f32* m_ty = nullptr;
+    const f32* m_tz = nullptr;
+    const f32* m_qx = nullptr;
+    const f32* m_qy = nullptr;
+    const f32* m_qz = nullptr;
+    const f32* m_qw = nullptr;
+    const f32* m_sx = nullptr;
+    const f32* m_sy = nullptr;
+    const f32* m_sz = nullptr;
+};
+
+/// Writes the matrices of the transforms in [begin, end) to `world`, at the same
+/// indices. The AVX2 kernel composes 8 at a time, `begin` and `end` have to be multiples
+/// of 8. It is only built for x86-64 and must only be called if
+/// `software::is_supported(RASTER_KERNEL::AVX2)`.
+auto compose_transforms_scalar(
+    const TransformArrays& transforms,
+    u32                    begin,
+    u32                    end,
+    mat4x4*                world
+) -> void;
+auto compose_transforms_avx2(
+    const TransformArrays& transforms,
+    u32                    begin,
+    u32                    end,
+    mat4x4*                world
+) -> void;
+
+/*
+    Transforms of objects which live longer than a frame. They are stored one array per
+   component and their world matrices are cached. `set` only marks a transform as dirty,
+   `update` composes the matrices of the dirty ones once per frame, 8 at a time where the
+   CPU supports it. Objects which do not move cost nothing after their first frame.
+*/
+class TransformPool {
+public:
+    using Id = u32;
+    constexpr static Id INVALID = ~Id{0};
+
+    TransformPool() = default;
+    ~TransformPool() = default;
+    TransformPool(const TransformPool&) = delete;
+    auto operator=(const TransformPool&) -> TransformPool& = delete;
+    TransformPool(TransformPool&&) noexcept = default;
+    auto operator=(TransformPool&&) noexcept -> TransformPool& = default;
+
+    auto create(const Transform& transform) -> Id;
+    auto set(Id id, const Transform& transform) -> void;
+    [[nodiscard]] auto get(Id id) const -> Transform;
+
+    /// Composes the world matrices of the transforms set since the last `update`.
+    auto update() -> void;
+    /// Only valid if `update` was called after the last `set` of `id`.
+    [[nodiscard]] auto get_world(Id id) const -> const mat4x4&;
+
+    [[nodiscard]] auto size() const -> u32 { return m_count; }
+
+private:
+    enum COMPONENT : u8 {
+        TX,
+        TY,
+        TZ,
+        QX,
+        QY,
+        QZ,
+        QW,
+        SX,
+        SY,
+        SZ,
+        MAX,
+    };
+
+    [[nodiscard]] auto get_arrays() const -> TransformArrays;
+
+private:
+    /// Padded to a multiple of 8, so the AVX2 kernel never needs a scalar tail.
+    std::array<std::vector<f32>, COMPONENT::MAX> m_components;
+    std::vector<u8>                              m_dirty;
+    std::vector<mat4x4>                          m_world;
+    u32                                          m_count = 0;
+    bool                                         m_has_dirty = false;
+};
+
+} // namespace JadeFrame
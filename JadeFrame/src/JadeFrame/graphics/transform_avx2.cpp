@@ -0,0 +1,110 @@
+#include "transform.h"
+
+#include "software/raster_kernel.h"
+
+// NOTE: The code after `JF_BEGIN_AVX2` is compiled for AVX2, it must only be entered
+// after the check in `TransformPool::update`.
+#if JF_SOFTWARE_X86_KERNELS
+    #include <immintrin.h>
+
+JF_BEGIN_AVX2
+namespace JadeFrame {
+
+// Afterwards `rows[i]` holds lane i of every input register.
+static auto transpose_8x8(__m256 (&rows)[8]) -> void {
+    const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    rows[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    rows[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    rows[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    rows[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    rows[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    rows[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    rows[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    rows[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+auto compose_transforms_avx2(
+    const TransformArrays& transforms,
+    u32                    begin,
+    u32                    end,
+    mat4x4*                world
+) -> void {
+    const TransformArrays& a = transforms;
+    const __m256           zero = _mm256_setzero_ps();
+    const __m256           one = _mm256_set1_ps(1.0F);
+    for (u32 i = begin; i < end; i += 8) {
+        const __m256 qx = _mm256_loadu_ps(a.m_qx + i);
+        const __m256 qy = _mm256_loadu_ps(a.m_qy + i);
+        const __m256 qz = _mm256_loadu_ps(a.m_qz + i);
+        const __m256 qw = _mm256_loadu_ps(a.m_qw + i);
+        const __m256 sx = _mm256_loadu_ps(a.m_sx + i);
+        const __m256 sy = _mm256_loadu_ps(a.m_sy + i);
+        const __m256 sz = _mm256_loadu_ps(a.m_sz + i);
+
+        const __m256 x2 = _mm256_add_ps(qx, qx);
+        const __m256 y2 = _mm256_add_ps(qy, qy);
+        const __m256 z2 = _mm256_add_ps(qz, qz);
+        const __m256 xx = _mm256_mul_ps(qx, x2);
+        const __m256 yy = _mm256_mul_ps(qy, y2);
+        const __m256 zz = _mm256_mul_ps(qz, z2);
+        const __m256 xy = _mm256_mul_ps(qx, y2);
+        const __m256 xz = _mm256_mul_ps(qx, z2);
+        const __m256 yz = _mm256_mul_ps(qy, z2);
+        const __m256 wx = _mm256_mul_ps(qw, x2);
+        const __m256 wy = _mm256_mul_ps(qw, y2);
+        const __m256 wz = _mm256_mul_ps(qw, z2);
+
+        // The first two columns of the 8 matrices, one element per register.
+        __m256 low[8] = {
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+            _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+            _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+            zero,
+            _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+            _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+            zero,
+        };
+        // The last two.
+        __m256 high[8] = {
+            _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+            _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+            zero,
+            _mm256_loadu_ps(a.m_tx + i),
+            _mm256_loadu_ps(a.m_ty + i),
+            _mm256_loadu_ps(a.m_tz + i),
+            one,
+        };
+        transpose_8x8(low);
+        transpose_8x8(high);
+
+        // A matrix is 16 consecutive floats, column after column.
+        for (u32 lane = 0; lane < 8; lane++) {
+            f32* out = &world[i + lane][0][0];
+            _mm256_storeu_ps(out, low[lane]);
+            _mm256_storeu_ps(out + 8, high[lane]);
+        }
+    }
+}
+
+} // namespace JadeFrame
+JF_END_AVX2
+#endif
@@ -0,0 +1,113 @@
+#include "bindless.h"
+
+#include <array>
+
+#include "JadeFrame/utils/assert.h"
+
+#include "buffer.h"
+#include "logical_device.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+auto BindlessTextures::Slots::allocate() -> u32 {
+    if (!m_free.empty()) {
+        const u32 index = m_free.back();
+        m_free.pop_back();
+        return index;
+    }
+    if (m_next == m_capacity) { return INVALID_INDEX; }
+    return m_next++;
+}
+
+auto BindlessTextures::Slots::free(u32 index) -> void {
+    JF_ASSERT(index < m_next, "");
+    m_free.push_back(index);
+}
+
+BindlessTextures::BindlessTextures(const LogicalDevice& device)
+    : m_layout(create_layout(device))
+    , m_device(&device)
+    , m_texture_slots{.m_capacity = TEXTURE_CAPACITY}
+    , m_material_slots{.m_capacity = MATERIAL_CAPACITY} {
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes = {{
+        {        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,                1},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, TEXTURE_CAPACITY},
+    }};
+    const auto flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    m_pool = DescriptorPool(device, 1, pool_sizes, flags);
+    m_set = m_pool.allocate_set(m_layout);
+
+    const size_t size = MATERIAL_CAPACITY * sizeof(MaterialParams);
+    m_materials = device.create_buffer(Buffer::TYPE::STORAGE, nullptr, size);
+    m_set.bind_storage_buffer(MATERIAL_BINDING, *m_materials);
+    m_set.update();
+}
+
+BindlessTextures::~BindlessTextures() {
+    if (m_materials != nullptr) { m_device->destroy_buffer(m_materials); }
+}
+
+auto BindlessTextures::create_layout(const LogicalDevice& device) -> DescriptorSetLayout {
+    // Every stage, so it does not depend on which of them a shader uses it in.
+    const VkShaderStageFlags stages = VK_SHADER_STAGE_ALL_GRAPHICS;
+    const DescriptorSetLayout::Binding materials = {
+        .binding = MATERIAL_BINDING,
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .count = 1,
+        .stage_flags = stages,
+    };
+    const DescriptorSetLayout::Binding textures = {
+        .binding = TEXTURE_BINDING,
+        .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .count = TEXTURE_CAPACITY,
+        .stage_flags = stages,
+        .flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                 VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+    };
+    std::array<DescriptorSetLayout::Binding, 2> bindings = {materials, textures};
+    return device.create_descriptor_set_layout(bindings);
+}
+
+auto BindlessTextures::add_texture(const Vulkan_Texture& texture) -> u32 {
+    const u32 index = m_texture_slots.allocate();
+    JF_ASSERT(index != INVALID_INDEX, "more than TEXTURE_CAPACITY textures");
+
+    const VkDescriptorImageInfo info = {
+        .sampler = texture.m_sampler.m_handle,
+        .imageView = texture.m_image_view.m_handle,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+    const VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = m_set.m_handle,
+        .dstBinding = TEXTURE_BINDING,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &info,
+        .pBufferInfo = nullptr,
+        .pTexelBufferView = nullptr,
+    };
+    vkUpdateDescriptorSets(m_device->m_handle, 1, &write, 0, nullptr);
+    return index;
+}
+
+auto BindlessTextures::remove_texture(u32 index) -> void { m_texture_slots.free(index); }
+
+auto BindlessTextures::add_material(const MaterialParams& params) -> u32 {
+    const u32 index = m_material_slots.allocate();
+    JF_ASSERT(index != INVALID_INDEX, "more than MATERIAL_CAPACITY materials");
+    // Only this element changes, the frames in flight do not read it.
+    m_materials->write(params, index * sizeof(MaterialParams));
+    return index;
+}
+
+auto BindlessTextures::remove_material(u32 index) -> void {
+    m_material_slots.free(index);
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/prelude.h"
+#include "descriptor_set.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class LogicalDevice;
+class Buffer;
+class Vulkan_Texture;
+
+/*
+    Every texture of the device in one array of combined image samplers, next to a storage
+   buffer with the parameters of every material. Shaders which declare the array index it
+   with the texture of their material, the material is a push constant. So the materials
+   of such a shader share a single set, the renderer binds it once per pipeline.
+    The array is updated after it was bound, only its used elements have to be valid.
+   Needs descriptor indexing, the device only creates it if that is supported.
+*/
+class BindlessTextures {
+public:
+    /// One per material, `std430` in the shaders.
+    struct MaterialParams {
+        u32 m_texture = 0;
+    };
+
+    constexpr static u32 MATERIAL_BINDING = 0;
+    constexpr static u32 TEXTURE_BINDING = 1;
+    /// Far below what devices with descriptor indexing have to support.
+    constexpr static u32 TEXTURE_CAPACITY = 4096;
+    constexpr static u32 MATERIAL_CAPACITY = 4096;
+    constexpr static u32 INVALID_INDEX = ~0U;
+
+public:
+    explicit BindlessTextures(const LogicalDevice& device);
+    ~BindlessTextures();
+    BindlessTextures(const BindlessTextures&) = delete;
+    auto operator=(const BindlessTextures&) -> BindlessTextures& = delete;
+    BindlessTextures(BindlessTextures&&) = delete;
+    auto operator=(BindlessTextures&&) -> BindlessTextures& = delete;
+
+    /// For the pipelines of the shaders which use the set. Defined like `m_layout`, which
+    /// makes them compatible.
+    static auto create_layout(const LogicalDevice& device) -> DescriptorSetLayout;
+
+    /// Returns the index of the texture in the array.
+    auto add_texture(const Vulkan_Texture& texture) -> u32;
+    /// The element is left as it is, no draw may use it anymore.
+    auto remove_texture(u32 index) -> void;
+    /// Returns the index of the material the shaders are given.
+    auto add_material(const MaterialParams& params) -> u32;
+    auto remove_material(u32 index) -> void;
+
+public:
+    DescriptorSetLayout m_layout;
+    DescriptorPool      m_pool;
+    DescriptorSet       m_set;
+    /// The `MaterialParams`, written once when a material is added.
+    Buffer*             m_materials = nullptr;
+
+private:
+    /// Hands out the indices of an array, the freed ones first.
+    struct Slots {
+        u32              m_capacity = 0;
+        u32              m_next = 0;
+        std::vector<u32> m_free = {};
+
+        auto allocate() -> u32;
+        auto free(u32 index) -> void;
+    };
+
+    const LogicalDevice* m_device = nullptr;
+    Slots                m_texture_slots;
+    Slots                m_material_slots;
+};
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -62,6 +62,8 @@ static auto to_string(const Buffer::TYPE type) -> const char* {
         case Buffer::TYPE::INDEX: return "INDEX";
         case Buffer::TYPE::UNIFORM: return "UNIFORM";
         case Buffer::TYPE::STAGING: return "STAGING";
+        case Buffer::TYPE::STORAGE: return "STORAGE";
+        case Buffer::TYPE::INDIRECT: return "INDIRECT";
         default: JF_ASSERT(false, ""); return "";
     }
 }
@@ -72,7 +74,9 @@ static auto does_use_staging_buffer(const Buffer::TYPE type) -> bool {
         case Buffer::TYPE::VERTEX:;
         case Buffer::TYPE::INDEX: result = true; break;
         case Buffer::TYPE::UNIFORM:;
-        case Buffer::TYPE::STAGING: result = false; break;
+        case Buffer::TYPE::STAGING:;
+        case Buffer::TYPE::STORAGE:;
+        case Buffer::TYPE::INDIRECT: result = false; break;
         default: JF_ASSERT(false, ""); break;
     }
     return result;
@@ -84,7 +88,9 @@ static auto get_vma_usage(const Buffer::TYPE type) -> VmaMemoryUsage {
         case Buffer::TYPE::VERTEX:
         case Buffer::TYPE::INDEX: result = VMA_MEMORY_USAGE_GPU_ONLY; break;
         case Buffer::TYPE::UNIFORM:
-        case Buffer::TYPE::STAGING: result = VMA_MEMORY_USAGE_CPU_TO_GPU; break;
+        case Buffer::TYPE::STAGING:
+        case Buffer::TYPE::STORAGE:
+        case Buffer::TYPE::INDIRECT: result = VMA_MEMORY_USAGE_CPU_TO_GPU; break;
         default: JF_ASSERT(false, ""); break;
     }
     return result;
@@ -102,6 +108,8 @@ static auto get_usage(const Buffer::TYPE type) -> VkBufferUsageFlags {
             break;
         case Buffer::TYPE::UNIFORM: result = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; break;
         case Buffer::TYPE::STAGING: result = VK_BUFFER_USAGE_TRANSFER_SRC_BIT; break;
+        case Buffer::TYPE::STORAGE: result = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; break;
+        case Buffer::TYPE::INDIRECT: result = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT; break;
         default: JF_ASSERT(false, ""); break;
     }
     return result;
@@ -114,6 +122,8 @@ static auto get_properties(const Buffer::TYPE type) -> VkMemoryPropertyFlags {
         case Buffer::TYPE::INDEX: result = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT; break;
         case Buffer::TYPE::UNIFORM:
         case Buffer::TYPE::STAGING:
+        case Buffer::TYPE::STORAGE:
+        case Buffer::TYPE::INDIRECT:
             result = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
             break;
@@ -131,8 +141,8 @@ Buffer::Buffer(Buffer&& other) noexcept
 #else
     , m_memory(std::exchange(other.m_memory, VK_NULL_HANDLE))
 #endif
-    , m_device(std::exchange(other.m_device, nullptr)) {
-}
+    , m_device(std::exchange(other.m_device, nullptr))
+    , m_upload(std::exchange(other.m_upload, 0)) {}
 
 auto Buffer::operator=(Buffer&& other) noexcept -> Buffer& {
     if (this == &other) { return *this; }
@@ -148,37 +158,19 @@ auto Buffer::operator=(Buffer&& other) noexcept -> Buffer& {
     m_memory = std::exchange(other.m_memory, VK_NULL_HANDLE);
 #endif
     m_device = std::exchange(other.m_device, nullptr);
+    m_upload = std::exchange(other.m_upload, 0);
 
     return *this;
 }
 
-#define JF_USE_MANAGED_STAGING_BUFFER 0
-#if JF_USE_MANAGED_STAGING_BUFFER
-static Buffer* g_staging_buffer = nullptr;
-#endif
-
 static auto transfer_through_staging_buffer(
     const LogicalDevice& device,
-    void*                data,
+    const void*          data,
     size_t               size,
-    Buffer*              buffer
-) -> void {
-#if JF_USE_MANAGED_STAGING_BUFFER
-
-    if (g_staging_buffer == nullptr) {
-        g_staging_buffer = device.create_buffer(Buffer::TYPE::STAGING, nullptr, size);
-    }
-
-    if (g_staging_buffer->m_size != size) { g_staging_buffer->resize(size); }
-
-    g_staging_buffer->write(data, size, 0);
-    device.m_command_pool.copy_buffer(*g_staging_buffer, *buffer, size);
-#else
-    Buffer* sb = device.create_buffer(Buffer::TYPE::STAGING, nullptr, size);
-    sb->write(data, size, 0);
-    device.m_command_pool.copy_buffer(*sb, *buffer, size);
-    device.destroy_buffer(sb);
-#endif
+    Buffer*              buffer,
+    VkDeviceSize         offset = 0
+) -> u64 {
+    return device.m_uploader->upload(*buffer, data, size, offset);
 }
 
 Buffer::Buffer(
@@ -202,7 +194,10 @@ Buffer::Buffer(
 #endif
 
     if (b_with_staging_buffer) {
-        transfer_through_staging_buffer(device, data, size, this);
+        // Without data the contents are uploaded later, e.g. by a `MeshArena`.
+        if (data != nullptr) {
+            m_upload = transfer_through_staging_buffer(device, data, size, this);
+        }
     } else {
         assert(data == nullptr && "If staging buffer is not used, it cannot have data");
     }
@@ -213,6 +208,10 @@ Buffer::~Buffer() { this->destroy(); }
 auto Buffer::destroy() -> void {
     if (m_handle == VK_NULL_HANDLE) { return; }
     if (m_device == nullptr) { return; }
+    if (m_upload != 0 && m_device->m_uploader != nullptr) {
+        m_device->m_uploader->forget_buffer(m_handle, m_upload);
+    }
+    m_upload = 0;
 
 #if JF_USE_VMA
     if (m_allocation != VK_NULL_HANDLE) {
@@ -251,8 +250,35 @@ auto Buffer::write(const void* data, VkDeviceSize size, VkDeviceSize offset) con
 #endif
 }
 
+auto Buffer::upload(const void* data, VkDeviceSize size, VkDeviceSize offset) -> u64 {
+    JF_ASSERT(does_use_staging_buffer(m_type), "use `write` instead");
+    JF_ASSERT(offset + size <= m_size, "out of bounds");
+    m_upload = transfer_through_staging_buffer(*m_device, data, size, this, offset);
+    return m_upload;
+}
+
+auto Buffer::map() const -> u8* {
+    void* mapped_data = nullptr;
+#if JF_USE_VMA
+    VkResult result = vmaMapMemory(m_device->m_vma_allocator, m_allocation, &mapped_data);
+#else
+    VkResult result =
+        vkMapMemory(m_device->m_handle, m_memory, 0, m_size, 0, &mapped_data);
+#endif
+    JF_ASSERT(result == VK_SUCCESS, "");
+    return static_cast<u8*>(mapped_data);
+}
+
+auto Buffer::unmap() const -> void {
+#if JF_USE_VMA
+    vmaUnmapMemory(m_device->m_vma_allocator, m_allocation);
+#else
+    vkUnmapMemory(m_device->m_handle, m_memory);
+#endif
+}
+
 auto Buffer::resize(size_t size) -> void {
-    assert(m_type == TYPE::UNIFORM || m_type == TYPE::STAGING);
+    assert(does_use_staging_buffer(m_type) == false);
     if (size == m_size) { return; }
 
     const LogicalDevice* device = m_device;
@@ -362,6 +388,10 @@ auto Image::destroy() -> void {
         case SOURCE::SWAPCHAIN: {
             // Swapchain images are owned by VkSwapchainKHR.
         } break;
+        case SOURCE::ALIASED: {
+            // The memory is owned by whoever bound it.
+            vkDestroyImage(m_device->m_handle, m_handle, Instance::allocator());
+        } break;
         default: JF_ASSERT(false, "");
     }
 
@@ -376,11 +406,13 @@ Image::Image(
     const LogicalDevice& device,
     const v2u32&         size,
     VkFormat             format,
-    VkImageUsageFlags    usage
+    VkImageUsageFlags    usage,
+    SOURCE               source
 )
     : m_device(&device)
-    , m_source(SOURCE::REGULAR)
+    , m_source(source)
     , m_size(size) {
+    JF_ASSERT(source != SOURCE::SWAPCHAIN, "swapchain images are not created here");
 
     VkImageFormatProperties props;
 
@@ -426,9 +458,9 @@ Image::Image(
         Logger::trace("-mip levels: {}", image_info.mipLevels);
         Logger::trace("-array layers: {}", image_info.arrayLayers);
     }
+    if (m_source == SOURCE::ALIASED) { return; }
 
-    VkMemoryRequirements mem_requirements;
-    vkGetImageMemoryRequirements(device.m_handle, m_handle, &mem_requirements);
+    const VkMemoryRequirements mem_requirements = this->get_memory_requirements();
 
     VkMemoryAllocateInfo alloc_info = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
@@ -452,6 +484,19 @@ Image::Image(const LogicalDevice& device, VkImage image)
     , m_device(&device)
     , m_source(SOURCE::SWAPCHAIN) {}
 
+auto Image::get_memory_requirements() const -> VkMemoryRequirements {
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_device->m_handle, m_handle, &requirements);
+    return requirements;
+}
+
+auto Image::bind_memory(VkDeviceMemory memory, VkDeviceSize offset) -> void {
+    JF_ASSERT(m_source == SOURCE::ALIASED, "only aliased images are bound from outside");
+    const VkResult result =
+        vkBindImageMemory(m_device->m_handle, m_handle, memory, offset);
+    JF_ASSERT(result == VK_SUCCESS, "");
+}
+
 /*---------------------------
     Image View
 ---------------------------*/
@@ -595,29 +640,29 @@ Vulkan_Texture::Vulkan_Texture(
     );
     m_image_view = ImageView(device, m_image, format, VK_IMAGE_ASPECT_COLOR_BIT);
 
-    m_device->m_command_pool.transition_layout(
-        m_image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    );
-
-    auto   image_size = static_cast<VkDeviceSize>(size.x) *
-                        static_cast<VkDeviceSize>(size.y) * comp_count;
-    Buffer staging_buffer(device, Buffer::TYPE::STAGING, nullptr, image_size);
-    staging_buffer.write(data, image_size, 0);
-    m_device->m_command_pool.copy_buffer_to_image(staging_buffer, m_image, size);
-
-    m_device->m_command_pool.transition_layout(
-        m_image,
-        format,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+    // The uploader also moves the image into the layout for sampling.
+    auto image_size = static_cast<VkDeviceSize>(size.x) *
+                      static_cast<VkDeviceSize>(size.y) * comp_count;
+    m_upload = m_device->m_uploader->upload(m_image, data, image_size, comp_count);
 
     m_sampler.init(device);
+    if (device.m_bindless != nullptr) {
+        m_bindless_index = device.m_bindless->add_texture(*this);
+    }
 }
 
 Vulkan_Texture::~Vulkan_Texture() { this->deinit(); }
 
 auto Vulkan_Texture::deinit() -> void {
+    if (m_upload != 0 && m_device != nullptr && m_device->m_uploader != nullptr) {
+        m_device->m_uploader->forget_image(m_image.m_handle, m_upload);
+    }
+    m_upload = 0;
+    if (m_bindless_index != BindlessTextures::INVALID_INDEX && m_device != nullptr &&
+        m_device->m_bindless != nullptr) {
+        m_device->m_bindless->remove_texture(m_bindless_index);
+    }
+    m_bindless_index = BindlessTextures::INVALID_INDEX;
     m_sampler.deinit();
     m_image_view = ImageView();
     m_image = Image();
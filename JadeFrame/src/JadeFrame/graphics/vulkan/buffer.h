@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "bindless.h"
 #include "shared.h"
 #include "VulkanMemoryAllocator/include/vk_mem_alloc.h"
 #include "../graphics_shared.h"
@@ -31,7 +32,10 @@ public:
         VERTEX,
         INDEX,
         UNIFORM,
-        STAGING
+        STAGING,
+        /// Written by the host every frame, like `UNIFORM`.
+        STORAGE,
+        INDIRECT,
     };
 
     Buffer() = delete;
@@ -53,9 +57,16 @@ public:
         this->write((void*)&data, sizeof(T), offset);
     }
 
+    /// Only for buffers the host can see, see `upload` for the others.
     auto write(const void* data, VkDeviceSize size, VkDeviceSize offset) const -> void;
+    /// Copies on the transfer queue, see `Uploader`. Returns the value of its batch.
+    auto upload(const void* data, VkDeviceSize size, VkDeviceSize offset) -> u64;
     auto resize(size_t size) -> void;
 
+    /// Keeps the memory mapped until `unmap`, for buffers the host writes all the time.
+    [[nodiscard]] auto map() const -> u8*;
+    auto               unmap() const -> void;
+
 private:
     auto destroy() -> void;
     auto create_buffer(
@@ -83,13 +94,18 @@ public:
     VkDeviceMemory m_memory = VK_NULL_HANDLE;
 #endif
     const LogicalDevice* m_device = nullptr;
+    /// The value of the batch of the last `upload`, 0 if there was none.
+    u64                  m_upload = 0;
 };
 
 class Image {
 public:
     enum class SOURCE {
         REGULAR,
-        SWAPCHAIN
+        SWAPCHAIN,
+        /// Owns the image but not its memory, which is bound with `bind_memory`. Used
+        /// for images sharing memory.
+        ALIASED
     };
     Image() = default;
     ~Image();
@@ -103,10 +119,14 @@ public:
         const LogicalDevice& device,
         const v2u32&         size,
         VkFormat             format,
-        VkImageUsageFlags    usage
+        VkImageUsageFlags    usage,
+        SOURCE               source = SOURCE::REGULAR
     );
     Image(const LogicalDevice& device, VkImage image);
 
+    [[nodiscard]] auto get_memory_requirements() const -> VkMemoryRequirements;
+    auto bind_memory(VkDeviceMemory memory, VkDeviceSize offset) -> void;
+
 public:
     VkImage              m_handle = VK_NULL_HANDLE;
     const LogicalDevice* m_device = nullptr;
@@ -179,6 +199,10 @@ public:
     ImageView            m_image_view;
     const LogicalDevice* m_device = nullptr;
     Sampler              m_sampler;
+    /// The value of the batch which uploads the texels.
+    u64                  m_upload = 0;
+    /// Where it is in the `BindlessTextures` of the device, if it has them.
+    u32                  m_bindless_index = BindlessTextures::INVALID_INDEX;
 };
 } // namespace vulkan
 
@@ -22,7 +22,8 @@ CommandBuffer::CommandBuffer(CommandBuffer&& other) noexcept
     , m_alloc_info(other.m_alloc_info)
     , m_device(std::exchange(other.m_device, nullptr))
     , m_command_pool(std::exchange(other.m_command_pool, nullptr))
-    , m_stage(std::exchange(other.m_stage, STAGE::INVALID)) {}
+    , m_stage(std::exchange(other.m_stage, STAGE::INVALID))
+    , m_level(other.m_level) {}
 
 auto CommandBuffer::operator=(CommandBuffer&& other) noexcept -> CommandBuffer& {
     m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
@@ -30,6 +31,7 @@ auto CommandBuffer::operator=(CommandBuffer&& other) noexcept -> CommandBuffer&
     m_device = std::exchange(other.m_device, nullptr);
     m_command_pool = std::exchange(other.m_command_pool, nullptr);
     m_stage = std::exchange(other.m_stage, STAGE::INVALID);
+    m_level = other.m_level;
 
     return *this;
 }
@@ -48,6 +50,38 @@ auto CommandBuffer::record_begin() -> void {
     m_stage = STAGE::RECORDING;
 }
 
+auto CommandBuffer::record_begin(
+    const RenderPass&  render_pass,
+    const Framebuffer& framebuffer
+) -> void {
+    assert(
+        m_level == LEVEL::SECONDARY &&
+        "Only secondary command buffers can continue a render pass"
+    );
+
+    const VkCommandBufferInheritanceInfo inheritance_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = nullptr,
+        .renderPass = render_pass.m_handle,
+        .subpass = 0,
+        .framebuffer = framebuffer.m_handle,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags = 0,
+        .pipelineStatistics = 0,
+    };
+    const VkCommandBufferBeginInfo info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                 VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance_info,
+    };
+
+    VkResult result = vkBeginCommandBuffer(m_handle, &info);
+    JF_ASSERT(result == VK_SUCCESS, "");
+    m_stage = STAGE::RECORDING;
+}
+
 auto CommandBuffer::record_end() -> void {
     VkResult result = vkEndCommandBuffer(m_handle);
     JF_ASSERT(result == VK_SUCCESS, "");
@@ -58,7 +92,8 @@ auto CommandBuffer::render_pass_begin(
     const Framebuffer& framebuffer,
     const RenderPass&  render_pass,
     const VkExtent2D&  extent,
-    VkClearValue       clear_color
+    VkClearValue       clear_color,
+    VkSubpassContents  contents
 ) -> void {
     assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
     assert(
@@ -83,7 +118,7 @@ auto CommandBuffer::render_pass_begin(
         .pClearValues = clear_values.data(),
     };
 
-    vkCmdBeginRenderPass(m_handle, &info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_handle, &info, contents);
 }
 
 auto CommandBuffer::render_pass_end() -> void {
@@ -102,18 +137,23 @@ auto CommandBuffer::reset() -> void {
     m_stage = STAGE::INITIAL;
 }
 
-auto CommandBuffer::copy_buffer(const Buffer& src, const Buffer& dst, u64 size) const
-    -> void {
+auto CommandBuffer::copy_buffer(
+    const Buffer& src,
+    const Buffer& dst,
+    u64           size,
+    u64           dst_offset
+) const -> void {
     assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
 
-    // TODO: include bounds checking
     if (size == 0) { assert(false && "size is 0"); }
     if (size > src.m_size) { assert(false && "size is greater than src buffer size"); }
-    if (size > dst.m_size) { assert(false && "size is greater than dst buffer size"); }
+    if (dst_offset + size > dst.m_size) {
+        assert(false && "size is greater than dst buffer size");
+    }
 
     const VkBufferCopy region = {
         .srcOffset = 0,
-        .dstOffset = 0,
+        .dstOffset = dst_offset,
         .size = size,
     };
     vkCmdCopyBuffer(m_handle, src.m_handle, dst.m_handle, 1, &region);
@@ -224,6 +264,37 @@ auto CommandBuffer::bind_index_buffer(const Buffer& buffer, VkDeviceSize offset)
     );
 }
 
+auto CommandBuffer::push_constants(
+    const Pipeline& pipeline,
+    u32             offset,
+    const void*     data,
+    u32             size
+) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
+
+    // Every stage whose range overlaps the bytes has to be given, and has to have all of
+    // them in its range.
+    VkShaderStageFlags stages = 0;
+    for (const Pipeline::PushConstantRange& range : pipeline.m_push_constant_ranges) {
+        const u32 end = range.offset + range.size;
+        if (offset >= end || offset + size <= range.offset) { continue; }
+        JF_ASSERT(range.offset <= offset && offset + size <= end, "not in the block");
+        stages |= range.shader_stage;
+    }
+    JF_ASSERT(stages != 0, "no stage reads these push constants");
+    vkCmdPushConstants(m_handle, pipeline.m_layout.m_handle, stages, offset, size, data);
+}
+
+auto CommandBuffer::set_viewport(const VkViewport& viewport) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
+    vkCmdSetViewport(m_handle, 0, 1, &viewport);
+}
+
+auto CommandBuffer::set_scissor(const VkRect2D& scissor) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
+    vkCmdSetScissor(m_handle, 0, 1, &scissor);
+}
+
 auto CommandBuffer::draw(
     u32 vertex_count,
     u32 instance_count,
@@ -260,6 +331,38 @@ auto CommandBuffer::draw_indexed(
     );
 }
 
+auto CommandBuffer::draw_indirect(
+    const Buffer& buffer,
+    VkDeviceSize  offset,
+    u32           draw_count
+) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
+
+    vkCmdDrawIndirect(
+        m_handle,                     // commandBuffer
+        buffer.m_handle,              // buffer
+        offset,                       // offset
+        draw_count,                   // drawCount
+        sizeof(VkDrawIndirectCommand) // stride
+    );
+}
+
+auto CommandBuffer::draw_indexed_indirect(
+    const Buffer& buffer,
+    VkDeviceSize  offset,
+    u32           draw_count
+) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
+
+    vkCmdDrawIndexedIndirect(
+        m_handle,                            // commandBuffer
+        buffer.m_handle,                     // buffer
+        offset,                              // offset
+        draw_count,                          // drawCount
+        sizeof(VkDrawIndexedIndirectCommand) // stride
+    );
+}
+
 static auto to_string_from_command_pool_create_flags(const VkCommandPoolCreateFlags& flag)
     -> std::string {
     std::string result = "{ ";
@@ -410,115 +513,89 @@ auto CommandPool::free_buffer(const CommandBuffer& command_buffer) const -> void
     }
 }
 
-auto CommandPool::copy_buffer(
-    const Buffer& src_buffer,
-    const Buffer& dst_buffer,
-    VkDeviceSize  size
-) const -> void {
-
-    CommandBuffer cmd = this->allocate_buffer();
-
-    cmd.record([&] { cmd.copy_buffer(src_buffer, dst_buffer, size); });
+auto CommandPool::reset() const -> void {
+    VkResult result = vkResetCommandPool(m_device->m_handle, m_handle, 0);
+    JF_ASSERT(result == VK_SUCCESS, "");
+}
 
-    // TODO: the queue should be provided by the user. It does not make sense for the
-    // command pool to decide which queue to use.
-    cmd.m_device->m_graphics_queue.submit(cmd);
-    cmd.m_device->m_graphics_queue.wait_idle();
+auto CommandBuffer::execute_command(const CommandBuffer& command_buffer) -> void {
+    assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
 
-    this->free_buffer(cmd);
+    vkCmdExecuteCommands(m_handle, 1, &command_buffer.m_handle);
 }
 
-auto CommandPool::transition_layout(
-    const Image& image,
-    VkFormat /*format*/,
-    VkImageLayout old_layout,
-    VkImageLayout new_layout
-    // VkImageSubresourceRange subresource_range
-) const -> void {
-    auto cmd = this->allocate_buffer();
+auto CommandBuffer::pipeline_barrier(std::span<const VkImageMemoryBarrier2KHR> barriers)
+    -> void {
+    if (barriers.empty()) { return; }
 
-    cmd.record([&] {
-        VkImageMemoryBarrier barrier = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    if (m_device->m_cmd_pipeline_barrier_2 != nullptr) {
+        const VkDependencyInfoKHR dependency_info = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
             .pNext = nullptr,
-            .srcAccessMask = 0,
-            .dstAccessMask = 0,
-            .oldLayout = old_layout,
-            .newLayout = new_layout,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = image.m_handle,
-            .subresourceRange = {
-                                 .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                 .baseMipLevel = 0,
-                                 .levelCount = 1,
-                                 .baseArrayLayer = 0,
-                                 .layerCount = 1
-            },
+            .dependencyFlags = 0,
+            .memoryBarrierCount = 0,
+            .pMemoryBarriers = nullptr,
+            .bufferMemoryBarrierCount = 0,
+            .pBufferMemoryBarriers = nullptr,
+            .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+            .pImageMemoryBarriers = barriers.data(),
         };
+        m_device->m_cmd_pipeline_barrier_2(m_handle, &dependency_info);
+        return;
+    }
 
-        VkPipelineStageFlags source_stage = {};
-        VkPipelineStageFlags destination_stage = {};
-
-        if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-            new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-                   new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else {
-            assert(false);
-        }
-
-        vkCmdPipelineBarrier(
-            cmd.m_handle,
-            source_stage,
-            destination_stage,
-            0,
-            0,
-            nullptr,
-            0,
-            nullptr,
-            1,
-            &barrier
-        );
-    });
-    // cb[0].record_end();
-
-    cmd.m_device->m_graphics_queue.submit(cmd);
-    cmd.m_device->m_graphics_queue.wait_idle();
-
-    this->free_buffer(cmd);
-}
-
-auto CommandPool::copy_buffer_to_image(
-    const Buffer& buffer,
-    const Image&  image,
-    v2u32         size
-) const -> void {
-
-    const CommandPool& cmd_pool = m_device->m_command_pool;
-    auto               cmd = cmd_pool.allocate_buffer();
-
-    cmd.record([&] { cmd.copy_buffer_to_image(buffer, image, size); });
-    cmd.m_device->m_graphics_queue.submit(cmd);
-    cmd.m_device->m_graphics_queue.wait_idle();
+    // The stages and access bits used by the render graph all exist in the original
+    // flags, with the same values.
+    VkPipelineStageFlags              src_stages = 0;
+    VkPipelineStageFlags              dst_stages = 0;
+    std::vector<VkImageMemoryBarrier> legacy(barriers.size());
+    for (size_t i = 0; i < barriers.size(); i++) {
+        const VkImageMemoryBarrier2KHR& barrier = barriers[i];
+        src_stages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+        dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+        legacy[i] = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask),
+            .dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask),
+            .oldLayout = barrier.oldLayout,
+            .newLayout = barrier.newLayout,
+            .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+            .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+            .image = barrier.image,
+            .subresourceRange = barrier.subresourceRange,
+        };
+    }
+    // A stage mask of 0 is only valid with synchronization2.
+    if (src_stages == 0) { src_stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; }
+    if (dst_stages == 0) { dst_stages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
 
-    cmd_pool.free_buffer(cmd);
+    vkCmdPipelineBarrier(
+        m_handle,
+        src_stages,
+        dst_stages,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        static_cast<u32>(legacy.size()),
+        legacy.data()
+    );
 }
 
-auto CommandBuffer::execute_command(const CommandBuffer& command_buffer) -> void {
+auto CommandBuffer::execute_commands(std::span<const CommandBuffer> command_buffers)
+    -> void {
     assert(m_stage == STAGE::RECORDING && "Command buffer must be in recording stage");
 
-    vkCmdExecuteCommands(m_handle, 1, &command_buffer.m_handle);
+    std::vector<VkCommandBuffer> handles(command_buffers.size());
+    for (size_t i = 0; i < command_buffers.size(); i++) {
+        assert(command_buffers[i].m_level == LEVEL::SECONDARY);
+        handles[i] = command_buffers[i].m_handle;
+    }
+    vkCmdExecuteCommands(
+        m_handle, static_cast<u32>(command_buffers.size()), handles.data()
+    );
 }
 } // namespace vulkan
 } // namespace JadeFrame
@@ -1,4 +1,5 @@
 #pragma once
+#include <span>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -29,12 +30,17 @@ public:
     auto operator=(CommandBuffer&& other) noexcept -> CommandBuffer&;
 
     auto record_begin() -> void;
+    /// Begins a secondary command buffer which continues `render_pass`. The primary
+    /// buffer runs it with `execute_commands`.
+    auto record_begin(const RenderPass& render_pass, const Framebuffer& framebuffer)
+        -> void;
     auto record_end() -> void;
     auto render_pass_begin(
         const Framebuffer& framebuffer,
         const RenderPass&  render_pass,
         const VkExtent2D&  swapchain,
-        VkClearValue       color
+        VkClearValue       color,
+        VkSubpassContents  contents = VK_SUBPASS_CONTENTS_INLINE
     ) -> void;
     auto render_pass_end() -> void;
 
@@ -61,7 +67,12 @@ public:
     auto reset() -> void;
 
 public: // copy methods
-    auto copy_buffer(const Buffer& src, const Buffer& dst, u64 size) const -> void;
+    auto copy_buffer(
+        const Buffer& src,
+        const Buffer& dst,
+        u64           size,
+        u64           dst_offset = 0
+    ) const -> void;
     auto copy_buffer_to_image(const Buffer& src, const Image& dst, v2u32 size) const
         -> void;
 
@@ -91,6 +102,13 @@ public: // bind methods
     ) const -> void;
 
     auto bind_index_buffer(const Buffer& buffer, VkDeviceSize offset) -> void;
+    /// For every stage of the pipeline whose range has these bytes.
+    auto push_constants(const Pipeline& pipeline, u32 offset, const void* data, u32 size)
+        -> void;
+
+public: // dynamic state methods
+    auto set_viewport(const VkViewport& viewport) -> void;
+    auto set_scissor(const VkRect2D& scissor) -> void;
 
 public: // draw methods
     auto draw(u32 vertex_count, u32 instance_count, u32 first_vertex, u32 first_instance)
@@ -102,9 +120,23 @@ public: // draw methods
         u32 vertex_offset,
         u32 first_instance
     ) -> void;
+    /// `draw_count` tightly packed `VkDrawIndirectCommand`s starting at `offset`. More
+    /// than one needs the `multiDrawIndirect` feature.
+    auto draw_indirect(const Buffer& buffer, VkDeviceSize offset, u32 draw_count)
+        -> void;
+    /// Like `draw_indirect`, with `VkDrawIndexedIndirectCommand`s.
+    auto draw_indexed_indirect(const Buffer& buffer, VkDeviceSize offset, u32 draw_count)
+        -> void;
+
+public: // sync methods
+    /// Records all barriers with one call. Uses `vkCmdPipelineBarrier2KHR` if the device
+    /// supports synchronization2, otherwise one `vkCmdPipelineBarrier` whose stages are
+    /// the union of the barriers' stages.
+    auto pipeline_barrier(std::span<const VkImageMemoryBarrier2KHR> barriers) -> void;
 
 public:
     auto execute_command(const CommandBuffer& command_buffer) -> void;
+    auto execute_commands(std::span<const CommandBuffer> command_buffers) -> void;
 
 public:
     enum class STAGE {
@@ -146,22 +178,8 @@ public:
     [[nodiscard]] auto allocate_buffer() const -> CommandBuffer;
     auto free_buffers(const std::span<CommandBuffer>& command_buffers) const -> void;
     auto free_buffer(const CommandBuffer& command_buffer) const -> void;
-
-    auto copy_buffer(
-        const Buffer& src_buffer,
-        const Buffer& dst_buffer,
-        VkDeviceSize  size
-    ) const -> void;
-
-    auto transition_layout(
-        const Image& image,
-        VkFormat /*format*/,
-        VkImageLayout old_layout,
-        VkImageLayout new_layout
-    ) const -> void;
-
-    auto copy_buffer_to_image(const Buffer& buffer, const Image& image, v2u32 size) const
-        -> void;
+    /// Resets every buffer allocated from the pool at once. None of them may be pending.
+    auto reset() const -> void;
 
 public:
     const LogicalDevice*    m_device = nullptr;
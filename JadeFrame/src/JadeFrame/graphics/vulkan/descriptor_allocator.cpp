@@ -0,0 +1,205 @@
+#include "descriptor_allocator.h"
+
+#include <algorithm>
+#include <array>
+
+#include "JadeFrame/utils/assert.h"
+#include "JadeFrame/utils/logger.h"
+#include "JadeFrame/utils/utils.h"
+
+#include "buffer.h"
+#include "logical_device.h"
+#include "shared.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+/// How many descriptors of each type a pool has per set. Most sets have a uniform buffer
+/// or a texture or two, the other types are rare.
+constexpr static std::array<std::pair<VkDescriptorType, u32>, 10> POOL_RATIOS = {{
+    {        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+    {  VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1},
+    {        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1},
+    {  VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2},
+    {               VK_DESCRIPTOR_TYPE_SAMPLER, 1},
+    {         VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1},
+    {         VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
+}};
+
+static auto is_out_of_memory(VkResult result) -> bool {
+    return result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL;
+}
+
+/*---------------------------
+    Descriptor Allocator
+---------------------------*/
+
+DescriptorAllocator::DescriptorAllocator(
+    const LogicalDevice&        device,
+    u32                         sets_per_pool,
+    VkDescriptorPoolCreateFlags flags
+)
+    : m_device(&device)
+    , m_sets_per_pool(sets_per_pool)
+    , m_flags(flags) {
+    JF_ASSERT(sets_per_pool > 0, "");
+}
+
+auto DescriptorAllocator::add_pool() -> void {
+    std::vector<VkDescriptorPoolSize> pool_sizes;
+    pool_sizes.reserve(POOL_RATIOS.size());
+    for (const auto& [type, ratio] : POOL_RATIOS) {
+        pool_sizes.push_back({type, ratio * m_sets_per_pool});
+    }
+    m_pools.emplace_back(*m_device, m_sets_per_pool, pool_sizes, m_flags);
+    Logger::debug(
+        "Added descriptor pool {} for {} sets", m_pools.size(), m_sets_per_pool
+    );
+    m_sets_per_pool = std::min(m_sets_per_pool * 2, MAX_SETS_PER_POOL);
+}
+
+auto DescriptorAllocator::allocate(const DescriptorSetLayout& layout) -> DescriptorSet {
+    JF_ASSERT(m_device != nullptr, "");
+
+    const VkDescriptorSetLayout layout_handle = layout.m_handle;
+    VkDescriptorSet             handle = VK_NULL_HANDLE;
+    VkResult                    result = VK_ERROR_OUT_OF_POOL_MEMORY;
+    while (true) {
+        const bool is_new = m_current == m_pools.size();
+        if (is_new) { this->add_pool(); }
+
+        const VkDescriptorSetAllocateInfo info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = m_pools[m_current].m_handle,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &layout_handle,
+        };
+        result = vkAllocateDescriptorSets(m_device->m_handle, &info, &handle);
+        // A full pool is left until the reset, the next one is tried. If even a new pool
+        // has no room, the layout needs more descriptors than a pool has.
+        if (!is_out_of_memory(result) || is_new) { break; }
+        m_current++;
+    }
+    if (result != VK_SUCCESS) {
+        Logger::err("Failed to allocate descriptor set {}", to_string(result));
+        assert(false);
+    }
+
+    DescriptorSet set(*m_device, handle, layout);
+    set.m_pool = m_pools[m_current].m_handle;
+    return set;
+}
+
+auto DescriptorAllocator::free(DescriptorSet& set) -> void {
+    JF_ASSERT(
+        (m_flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT) != 0,
+        "the pools can only be reset"
+    );
+    if (set.m_handle == VK_NULL_HANDLE) { return; }
+
+    for (size_t i = 0; i < m_pools.size(); i++) {
+        if (m_pools[i].m_handle != set.m_pool) { continue; }
+        m_pools[i].free_sets(std::span(&set, 1));
+        // The pool has room again, it is filled before the ones after it.
+        m_current = std::min(m_current, i);
+        return;
+    }
+}
+
+auto DescriptorAllocator::reset() -> void {
+    for (const DescriptorPool& pool : m_pools) {
+        VkResult result = vkResetDescriptorPool(m_device->m_handle, pool.m_handle, 0);
+        if (result != VK_SUCCESS) { assert(false); }
+    }
+    m_current = 0;
+}
+
+/*---------------------------
+    Descriptor Set Cache
+---------------------------*/
+
+static auto is_storage(const DescriptorSetLayout& layout, u32 binding) -> bool {
+    for (const VkDescriptorSetLayoutBinding& b : layout.m_bindings) {
+        if (b.binding == binding) {
+            return b.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        }
+    }
+    return false;
+}
+
+auto DescriptorSetCache::Key::hash() const -> u64 {
+    u64 result = 0;
+    for (const Binding& binding : m_bindings) {
+        result = hash_combine(result, binding.m_binding);
+        result = hash_combine(result, static_cast<u64>(binding.m_type));
+        result = hash_combine(result, binding.m_count);
+        result = hash_combine(result, binding.m_stages);
+    }
+    for (const VkDescriptorBindingFlags flags : m_binding_flags) {
+        result = hash_combine(result, flags);
+    }
+    for (const BoundBuffer& buffer : m_buffers) {
+        result = hash_combine(result, buffer.m_binding);
+        result = hash_combine(result, reinterpret_cast<u64>(buffer.m_handle));
+        result = hash_combine(result, buffer.m_range);
+    }
+    return result;
+}
+
+DescriptorSetCache::DescriptorSetCache(const LogicalDevice& device)
+    : m_allocator(device, 64) {}
+
+auto DescriptorSetCache::get(
+    const DescriptorSetLayout&     layout,
+    std::span<const BufferBinding> buffers
+) -> const DescriptorSet& {
+    // The layouts of different pipelines are compatible if they are defined the same, so
+    // the definition is the key, not the handle.
+    m_lookup.m_bindings.clear();
+    for (const VkDescriptorSetLayoutBinding& binding : layout.m_bindings) {
+        m_lookup.m_bindings.push_back({
+            .m_binding = binding.binding,
+            .m_type = binding.descriptorType,
+            .m_count = binding.descriptorCount,
+            .m_stages = binding.stageFlags,
+        });
+    }
+    m_lookup.m_binding_flags.assign(
+        layout.m_binding_flags.begin(), layout.m_binding_flags.end()
+    );
+    m_lookup.m_buffers.clear();
+    for (const BufferBinding& buffer : buffers) {
+        m_lookup.m_buffers.push_back({
+            .m_binding = buffer.m_binding,
+            .m_handle = buffer.m_buffer->m_handle,
+            .m_range = buffer.m_range,
+        });
+    }
+    if (auto it = m_sets.find(m_lookup); it != m_sets.end()) { return it->second; }
+
+    // The nodes of the map do not move, the sets can be pointed to.
+    DescriptorSet& set = m_sets.try_emplace(m_lookup).first->second;
+    set = m_allocator.allocate(layout);
+    for (const BufferBinding& buffer : buffers) {
+        if (is_storage(layout, buffer.m_binding)) {
+            set.bind_storage_buffer(buffer.m_binding, *buffer.m_buffer);
+        } else {
+            const VkDeviceSize range = buffer.m_range;
+            set.bind_uniform_buffer(buffer.m_binding, *buffer.m_buffer, 0, range);
+        }
+    }
+    set.update();
+    return set;
+}
+
+auto DescriptorSetCache::reset() -> void {
+    m_sets.clear();
+    m_allocator.reset();
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,134 @@
+#pragma once
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/prelude.h"
+#include "descriptor_set.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class LogicalDevice;
+class Buffer;
+
+/*
+    Hands out descriptor sets of any layout from a list of pools. When a pool runs out of
+   memory the next one is used, a new one is only created after the last, each twice as
+   large as the one before. So there is no upper limit for the sets, and no pool has to be
+   sized for the layouts up front.
+    `reset` returns every set to the pools at once. Single sets can only be freed if the
+   pools were created with `VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT`.
+*/
+class DescriptorAllocator {
+public:
+    /// The most sets a pool grows to.
+    constexpr static u32 MAX_SETS_PER_POOL = 4096;
+
+public:
+    DescriptorAllocator() = default;
+    ~DescriptorAllocator() = default;
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    auto operator=(const DescriptorAllocator&) -> DescriptorAllocator& = delete;
+    DescriptorAllocator(DescriptorAllocator&&) noexcept = default;
+    auto operator=(DescriptorAllocator&&) noexcept -> DescriptorAllocator& = default;
+
+    /// `sets_per_pool` is the size of the first pool, no pool is created before the
+    /// first set is allocated.
+    DescriptorAllocator(
+        const LogicalDevice&        device,
+        u32                         sets_per_pool,
+        VkDescriptorPoolCreateFlags flags = 0
+    );
+
+    [[nodiscard]] auto allocate(const DescriptorSetLayout& layout) -> DescriptorSet;
+    /// Does nothing if the pool of the set was destroyed already.
+    auto               free(DescriptorSet& set) -> void;
+    /// The sets must not be used by the device anymore. The pools are kept.
+    auto               reset() -> void;
+
+private:
+    auto add_pool() -> void;
+
+    const LogicalDevice*        m_device = nullptr;
+    std::vector<DescriptorPool> m_pools;
+    /// The pool the next set is allocated from, the ones before it are full.
+    size_t                      m_current = 0;
+    u32                         m_sets_per_pool = 0;
+    VkDescriptorPoolCreateFlags m_flags = 0;
+};
+
+/*
+    The sets of one frame in flight which only point to buffers, like the ones of the
+   `UniformRing` or the storage buffers of the indirect draws. They are looked up by the
+   definition of their layout and their buffers, so the materials whose sets would be the
+   same share a single one. The frame calls `reset` once its fence was waited on, which
+   returns all of them to the pools at once.
+*/
+class DescriptorSetCache {
+public:
+    struct BufferBinding {
+        u32           m_binding = 0;
+        const Buffer* m_buffer = nullptr;
+        VkDeviceSize  m_range = 0;
+    };
+
+public:
+    DescriptorSetCache() = default;
+    ~DescriptorSetCache() = default;
+    DescriptorSetCache(const DescriptorSetCache&) = delete;
+    auto operator=(const DescriptorSetCache&) -> DescriptorSetCache& = delete;
+    DescriptorSetCache(DescriptorSetCache&&) noexcept = default;
+    auto operator=(DescriptorSetCache&&) noexcept -> DescriptorSetCache& = default;
+
+    explicit DescriptorSetCache(const LogicalDevice& device);
+
+    /// The set of `layout` with `buffers` bound at offset 0, as uniform or storage
+    /// buffers depending on the layout. Allocated and updated on the first request of the
+    /// frame, stays valid until `reset`.
+    [[nodiscard]] auto get(
+        const DescriptorSetLayout&     layout,
+        std::span<const BufferBinding> buffers
+    ) -> const DescriptorSet&;
+    auto reset() -> void;
+
+private:
+    /// The definition of the layout and the buffers of a set. Compared in full, the hash
+    /// only picks the bucket.
+    struct Key {
+        struct Binding {
+            u32                m_binding = 0;
+            VkDescriptorType   m_type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+            u32                m_count = 0;
+            VkShaderStageFlags m_stages = 0;
+
+            auto operator==(const Binding& other) const -> bool = default;
+        };
+        struct BoundBuffer {
+            u32          m_binding = 0;
+            VkBuffer     m_handle = VK_NULL_HANDLE;
+            VkDeviceSize m_range = 0;
+
+            auto operator==(const BoundBuffer& other) const -> bool = default;
+        };
+
+        std::vector<Binding>                  m_bindings;
+        std::vector<VkDescriptorBindingFlags> m_binding_flags;
+        std::vector<BoundBuffer>              m_buffers;
+
+        auto operator==(const Key& other) const -> bool = default;
+        [[nodiscard]] auto hash() const -> u64;
+    };
+    struct KeyHash {
+        auto operator()(const Key& key) const -> size_t { return key.hash(); }
+    };
+
+    DescriptorAllocator                             m_allocator;
+    std::unordered_map<Key, DescriptorSet, KeyHash> m_sets;
+    /// Filled for every lookup, so only new sets allocate a key.
+    Key                                             m_lookup;
+};
+
+} // namespace vulkan
+} // namespace JadeFrame
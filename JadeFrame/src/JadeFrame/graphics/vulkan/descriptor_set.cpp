@@ -72,12 +72,14 @@ DescriptorSet::DescriptorSet(DescriptorSet&& other) noexcept
     : m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
     , m_device(std::exchange(other.m_device, nullptr))
     , m_layout(std::exchange(other.m_layout, nullptr))
+    , m_pool(std::exchange(other.m_pool, VK_NULL_HANDLE))
     , m_descriptors(std::move(other.m_descriptors)) {}
 
 auto DescriptorSet::operator=(DescriptorSet&& other) noexcept -> DescriptorSet& {
     m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
     m_device = std::exchange(other.m_device, nullptr);
     m_layout = std::exchange(other.m_layout, nullptr);
+    m_pool = std::exchange(other.m_pool, VK_NULL_HANDLE);
     this->m_descriptors = std::move(other.m_descriptors);
     return *this;
 }
@@ -163,7 +165,8 @@ auto DescriptorSet::bind_uniform_buffer(
     VkDeviceSize  range
 ) -> void {
 
-    JF_ASSERT(buffer.m_size < from_kibibyte(64), "Guaranteed only between 16K and 64K");
+    // The buffer may be larger, e.g. the `UniformRing` holds the data of several frames.
+    JF_ASSERT(range < from_kibibyte(64), "Guaranteed only between 16K and 64K");
     JF_ASSERT(offset < buffer.m_size, "offset mustn't be greater than buffer size");
     JF_ASSERT(range != VK_WHOLE_SIZE && range > 0, "range mustn't be 0 or VK_WHOLE_SIZE");
     JF_ASSERT(
@@ -182,6 +185,18 @@ auto DescriptorSet::bind_uniform_buffer(
     JF_ASSERT(false, "");
 }
 
+auto DescriptorSet::bind_storage_buffer(u32 binding, const Buffer& buffer) -> void {
+    for (u32 i = 0; i < m_descriptors.size(); i++) {
+        const auto& l_binding = m_layout->m_bindings[i];
+        if (l_binding.binding == binding) {
+            JF_ASSERT(true == is_storage(l_binding.descriptorType), "type mismatch");
+            m_descriptors[i] = Descriptor(buffer, 0, VK_WHOLE_SIZE, l_binding);
+            return;
+        }
+    }
+    JF_ASSERT(false, "");
+}
+
 auto DescriptorSet::rebind_uniform_buffer(u32 binding, const Buffer& buffer) -> void {
 
     for (u32 i = 0; i < m_descriptors.size(); i++) {
@@ -269,6 +284,7 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout&& other) noexcept
     : m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
     , m_device(std::exchange(other.m_device, nullptr))
     , m_bindings(std::exchange(other.m_bindings, {}))
+    , m_binding_flags(std::exchange(other.m_binding_flags, {}))
     , m_dynamic_count(std::exchange(other.m_dynamic_count, 0)) {}
 
 auto DescriptorSetLayout::operator=(DescriptorSetLayout&& other) noexcept
@@ -282,6 +298,7 @@ auto DescriptorSetLayout::operator=(DescriptorSetLayout&& other) noexcept
         m_device = std::exchange(other.m_device, nullptr);
         m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
         this->m_bindings = std::exchange(other.m_bindings, {});
+        this->m_binding_flags = std::exchange(other.m_binding_flags, {});
         this->m_dynamic_count = std::exchange(other.m_dynamic_count, 0);
     }
     return *this;
@@ -314,14 +331,30 @@ DescriptorSetLayout::DescriptorSetLayout(
             bindings[i].type,
             bindings[i].count,
             bindings[i].stage_flags,
-            bindings[i].p_immutable_samplers
+            bindings[i].p_immutable_samplers,
+            bindings[i].flags
         );
     }
 
+    // The flags are only chained if there are any, as they need descriptor indexing.
+    VkDescriptorBindingFlags all_flags = 0;
+    for (const VkDescriptorBindingFlags flags : m_binding_flags) { all_flags |= flags; }
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext = nullptr,
+        .bindingCount = static_cast<u32>(m_binding_flags.size()),
+        .pBindingFlags = m_binding_flags.data(),
+    };
+    const bool is_update_after_bind =
+        (all_flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) != 0;
     const VkDescriptorSetLayoutCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0,
+        .pNext = all_flags != 0 ? &flags_info : nullptr,
+        .flags = is_update_after_bind
+                     ? static_cast<VkDescriptorSetLayoutCreateFlags>(
+                           VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT
+                       )
+                     : static_cast<VkDescriptorSetLayoutCreateFlags>(0),
         .bindingCount = static_cast<u32>(m_bindings.size()),
         .pBindings = m_bindings.data(),
     };
@@ -347,11 +380,12 @@ DescriptorSetLayout::DescriptorSetLayout(
 }
 
 auto DescriptorSetLayout::add_binding(
-    u32                binding,
-    VkDescriptorType   descriptor_type,
-    u32                descriptor_count,
-    VkShaderStageFlags stage_flags,
-    const VkSampler*   p_immutable_samplers
+    u32                      binding,
+    VkDescriptorType         descriptor_type,
+    u32                      descriptor_count,
+    VkShaderStageFlags       stage_flags,
+    const VkSampler*         p_immutable_samplers,
+    VkDescriptorBindingFlags flags
 ) -> void {
     JF_ASSERT(m_handle == VK_NULL_HANDLE, "");
     const VkDescriptorSetLayoutBinding layout = {
@@ -368,6 +402,7 @@ auto DescriptorSetLayout::add_binding(
         assert(false);
     }
     m_bindings.push_back(layout);
+    m_binding_flags.push_back(flags);
 
     if (is_dynamic(descriptor_type)) { m_dynamic_count++; }
 
@@ -415,7 +450,8 @@ auto DescriptorPool::add_pool_size(const VkDescriptorPoolSize& pool_size) -> voi
 DescriptorPool::DescriptorPool(
     const LogicalDevice&                   device,
     u32                                    max_sets,
-    const std::span<VkDescriptorPoolSize>& pool_sizes
+    const std::span<VkDescriptorPoolSize>& pool_sizes,
+    VkDescriptorPoolCreateFlags            flags
 )
     : m_device(&device) {
 
@@ -424,7 +460,7 @@ DescriptorPool::DescriptorPool(
     const VkDescriptorPoolCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .pNext = nullptr,
-        .flags = 0 /* | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT*/,
+        .flags = flags /* | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT*/,
         .maxSets = max_sets,
         .poolSizeCount = static_cast<u32>(m_pool_sizes.size()),
         .pPoolSizes = m_pool_sizes.data(),
@@ -495,6 +531,7 @@ auto DescriptorPool::allocate_sets(const DescriptorSetLayout& layout, u32 amount
     sets.resize(handles.size());
     for (u32 i = 0; i < sets.size(); i++) {
         sets[i] = DescriptorSet(*m_device, handles[i], layout);
+        sets[i].m_pool = m_handle;
     }
 
     {
@@ -528,22 +565,20 @@ auto DescriptorPool::allocate_set(const DescriptorSetLayout& descriptor_set_layo
     return std::move(this->allocate_sets(descriptor_set_layout, 1)[0]);
 }
 
-auto DescriptorPool::free_sets(const std::span<DescriptorSet>& /*descriptor_sets*/)
-    -> void {
-    // for(u32 i = 0; i < descriptor_sets.size(); i++) {
-    //	VkResult result;
-    //	result = vkFreeDescriptorSets(m_device->m_handle, m_handle, 1,
-    //&descriptor_sets[i].m_handle); 	if (result != VK_SUCCESS) assert(false);
-    // }
-    // VkResult result;
-    // result = vkResetDescriptorPool(m_device->m_handle, m_handle, 0);
-    // if (result != VK_SUCCESS) assert(false);
-    vkDestroyDescriptorPool(m_device->m_handle, m_handle, Instance::allocator());
-    m_handle = VK_NULL_HANDLE;
-    m_device = nullptr;
+auto DescriptorPool::free_sets(const std::span<DescriptorSet>& descriptor_sets) -> void {
+    std::vector<VkDescriptorSet> handles;
+    handles.reserve(descriptor_sets.size());
+    for (DescriptorSet& set : descriptor_sets) {
+        JF_ASSERT(set.m_pool == m_handle, "the set is from another pool");
+        handles.push_back(std::exchange(set.m_handle, VK_NULL_HANDLE));
+    }
+    VkResult result = vkFreeDescriptorSets(
+        m_device->m_handle, m_handle, static_cast<u32>(handles.size()), handles.data()
+    );
+    if (result != VK_SUCCESS) { assert(false); }
     {
         Logger::trace(
-            "Destroyed descriptor pool {} at {}", fmt::ptr(this), fmt::ptr(m_handle)
+            "Freed {} descriptor sets from pool {}", handles.size(), fmt::ptr(this)
         );
     }
 }
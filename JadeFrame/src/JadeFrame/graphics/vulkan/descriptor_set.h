@@ -70,6 +70,8 @@ public:
         VkDeviceSize  offset,
         VkDeviceSize  range
     ) -> void;
+    /// Unlike uniform buffers, the whole buffer is bound and it may be of any size.
+    auto bind_storage_buffer(u32 binding, const Buffer& buffer) -> void;
     auto bind_combined_image_sampler(u32 binding, const Vulkan_Texture& texture) -> void;
     auto rebind_uniform_buffer(u32 binding, const Buffer& buffer) -> void;
 
@@ -77,6 +79,8 @@ public:
     VkDescriptorSet            m_handle = VK_NULL_HANDLE;
     const LogicalDevice*       m_device = nullptr;
     const DescriptorSetLayout* m_layout = nullptr;
+    /// The pool it was allocated from, to free it.
+    VkDescriptorPool           m_pool = VK_NULL_HANDLE;
 
     std::vector<Descriptor> m_descriptors;
 };
@@ -84,11 +88,14 @@ public:
 class DescriptorSetLayout {
 public:
     struct Binding {
-        u32                binding;
-        VkDescriptorType   type;
-        u32                count;
-        VkShaderStageFlags stage_flags;
-        const VkSampler*   p_immutable_samplers = nullptr;
+        u32                      binding;
+        VkDescriptorType         type;
+        u32                      count;
+        VkShaderStageFlags       stage_flags;
+        const VkSampler*         p_immutable_samplers = nullptr;
+        /// With `VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT` the sets have to come from
+        /// a pool created with `VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT`.
+        VkDescriptorBindingFlags flags = 0;
     };
 
 public:
@@ -104,17 +111,19 @@ public:
 
 private:
     auto add_binding(
-        u32                binding,
-        VkDescriptorType   descriptor_type,
-        u32                descriptor_count,
-        VkShaderStageFlags stage_flags,
-        const VkSampler*   p_immutable_samplers = nullptr
+        u32                      binding,
+        VkDescriptorType         descriptor_type,
+        u32                      descriptor_count,
+        VkShaderStageFlags       stage_flags,
+        const VkSampler*         p_immutable_samplers = nullptr,
+        VkDescriptorBindingFlags flags = 0
     ) -> void;
 
 public:
     VkDescriptorSetLayout                     m_handle = VK_NULL_HANDLE;
     const LogicalDevice*                      m_device = nullptr;
     std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+    std::vector<VkDescriptorBindingFlags>     m_binding_flags;
 
     u32 m_dynamic_count = 0;
 };
@@ -132,7 +141,8 @@ public:
     DescriptorPool(
         const LogicalDevice&                   device,
         u32                                    max_sets,
-        const std::span<VkDescriptorPoolSize>& pool_sizes
+        const std::span<VkDescriptorPoolSize>& pool_sizes,
+        VkDescriptorPoolCreateFlags            flags = 0
     );
 
 public:
@@ -144,6 +154,7 @@ public:
     ) const -> std::vector<DescriptorSet>;
     [[nodiscard]] auto allocate_set(const DescriptorSetLayout& descriptor_set_layout
     ) const -> DescriptorSet;
+    /// Needs a pool created with `VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT`.
     auto               free_sets(const std::span<DescriptorSet>& descriptor_sets) -> void;
     auto               free_set(const DescriptorSet& descriptor_sets) -> void;
 
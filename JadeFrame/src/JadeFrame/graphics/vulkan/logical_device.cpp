@@ -12,6 +12,9 @@
 
 namespace JadeFrame {
 
+/// Relative to the working directory, next to the executable when started from there.
+static const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
 static auto VkResult_to_string(VkResult x) {
     std::string str;
 #define JF_SET_ENUM_STRING(str, name)                                                    \
@@ -50,10 +53,15 @@ LogicalDevice::LogicalDevice(LogicalDevice&& other) noexcept {
     m_instance = std::exchange(other.m_instance, nullptr);
     m_physical_device = std::exchange(other.m_physical_device, nullptr);
     m_graphics_queue = std::move(other.m_graphics_queue);
+    m_transfer_queue = std::move(other.m_transfer_queue);
+    m_uploader = std::move(other.m_uploader);
+    m_pipeline_cache = std::move(other.m_pipeline_cache);
+    m_bindless = std::move(other.m_bindless);
     m_command_pool = std::move(other.m_command_pool);
-    m_set_pool = std::move(other.m_set_pool);
+    m_set_allocator = std::move(other.m_set_allocator);
     m_buffers = std::move(other.m_buffers);
     m_vma_allocator = std::exchange(other.m_vma_allocator, VK_NULL_HANDLE);
+    m_cmd_pipeline_barrier_2 = std::exchange(other.m_cmd_pipeline_barrier_2, nullptr);
 }
 
 auto LogicalDevice::operator=(LogicalDevice&& other) noexcept -> LogicalDevice& {
@@ -63,10 +71,16 @@ auto LogicalDevice::operator=(LogicalDevice&& other) noexcept -> LogicalDevice&
         m_instance = std::exchange(other.m_instance, nullptr);
         m_physical_device = std::exchange(other.m_physical_device, nullptr);
         m_graphics_queue = std::move(other.m_graphics_queue);
+        m_transfer_queue = std::move(other.m_transfer_queue);
+        m_uploader = std::move(other.m_uploader);
+        m_pipeline_cache = std::move(other.m_pipeline_cache);
+        m_bindless = std::move(other.m_bindless);
         m_command_pool = std::move(other.m_command_pool);
-        m_set_pool = std::move(other.m_set_pool);
+        m_set_allocator = std::move(other.m_set_allocator);
         m_buffers = std::move(other.m_buffers);
         m_vma_allocator = std::exchange(other.m_vma_allocator, VK_NULL_HANDLE);
+        m_cmd_pipeline_barrier_2 =
+            std::exchange(other.m_cmd_pipeline_barrier_2, nullptr);
     }
     return *this;
 }
@@ -121,17 +135,60 @@ auto LogicalDevice::init(const Instance& instance, const PhysicalDevice& physica
         queue_create_infos.push_back(queue_create_info);
     }
 
+    // synchronization2 is core only since Vulkan 1.3, so it is enabled as an extension
+    // when available. Without it the barriers fall back to vkCmdPipelineBarrier.
+    std::vector<const char*> extensions = physical_device.m_device_extensions;
+    const bool               has_sync_2 = physical_device.check_extension_support(
+        {VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME}
+    );
+    VkPhysicalDeviceSynchronization2FeaturesKHR sync_2_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+        .pNext = nullptr,
+        .synchronization2 = VK_TRUE,
+    };
+    if (has_sync_2) { extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME); }
+
+    // Descriptor indexing is core since Vulkan 1.2, but only some of its features are
+    // required. Without them there are no `BindlessTextures`.
+    VkPhysicalDeviceDescriptorIndexingFeatures indexing_support = {};
+    indexing_support.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    VkPhysicalDeviceFeatures2 features_2 = {};
+    features_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features_2.pNext = &indexing_support;
+    vkGetPhysicalDeviceFeatures2(physical_device.m_handle, &features_2);
+    const bool has_bindless =
+        indexing_support.shaderSampledImageArrayNonUniformIndexing == VK_TRUE &&
+        indexing_support.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+        indexing_support.descriptorBindingPartiallyBound == VK_TRUE &&
+        indexing_support.runtimeDescriptorArray == VK_TRUE;
+    VkPhysicalDeviceDescriptorIndexingFeatures indexing_features = {};
+    indexing_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    indexing_features.pNext = has_sync_2 ? &sync_2_features : nullptr;
+    indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    indexing_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+    indexing_features.runtimeDescriptorArray = VK_TRUE;
+
+    // Timeline semaphores are core since Vulkan 1.2 and every device of it has them.
+    // The `Uploader` tracks its batches with one.
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+        .pNext = has_bindless ? &indexing_features : indexing_features.pNext,
+        .timelineSemaphore = VK_TRUE,
+    };
+
     const VkDeviceCreateInfo create_info = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = nullptr,
+        .pNext = &timeline_features,
         .flags = 0,
         .queueCreateInfoCount = static_cast<u32>(queue_create_infos.size()),
         .pQueueCreateInfos = queue_create_infos.data(),
         .enabledLayerCount = 0,         // this is deprecated and ignored
         .ppEnabledLayerNames = nullptr, // this is deprecated and ignored
-        .enabledExtensionCount =
-            static_cast<u32>(physical_device.m_device_extensions.size()),
-        .ppEnabledExtensionNames = physical_device.m_device_extensions.data(),
+        .enabledExtensionCount = static_cast<u32>(extensions.size()),
+        .ppEnabledExtensionNames = extensions.data(),
         .pEnabledFeatures = &physical_device.m_features,
     };
 
@@ -140,6 +197,12 @@ auto LogicalDevice::init(const Instance& instance, const PhysicalDevice& physica
     );
     if (result != VK_SUCCESS) { assert(false); }
 
+    if (has_sync_2) {
+        m_cmd_pipeline_barrier_2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+            vkGetDeviceProcAddr(m_handle, "vkCmdPipelineBarrier2KHR")
+        );
+    }
+
     // TODO: Maybe the VMA allocator should be created somewhere else, but for now it is
     // here.
     m_vma_allocator = init_vma(instance, physical_device, *this);
@@ -153,24 +216,17 @@ auto LogicalDevice::init(const Instance& instance, const PhysicalDevice& physica
         "maxBoundDescriptorSets too low, it must be at least 4"
     );
     m_graphics_queue = pointers.m_graphics_family->query_queues(*this, 0);
+    m_transfer_queue = pointers.m_transfer_family->query_queues(*this, 0);
 
     m_command_pool = this->create_command_pool(
         *m_physical_device->m_chosen_queue_family_pointers.m_graphics_family
     );
-    const u32                         descriptor_count = 1000;
-    std::vector<VkDescriptorPoolSize> pool_sizes = {
-        {        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descriptor_count},
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, descriptor_count},
-        {  VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, descriptor_count},
-        {        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptor_count},
-        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, descriptor_count},
-        {  VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, descriptor_count},
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descriptor_count},
-        {               VK_DESCRIPTOR_TYPE_SAMPLER, descriptor_count},
-        {         VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, descriptor_count},
-        {         VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, descriptor_count},
-    };
-    m_set_pool = this->create_descriptor_pool(descriptor_count, pool_sizes);
+    m_set_allocator = DescriptorAllocator(
+        *this, 256, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+    );
+    m_uploader = std::make_unique<Uploader>(*this);
+    m_pipeline_cache = PipelineCache(*this, PIPELINE_CACHE_PATH);
+    if (has_bindless) { m_bindless = std::make_unique<BindlessTextures>(*this); }
 }
 
 auto LogicalDevice::wait_until_idle() const -> void {
@@ -186,7 +242,12 @@ auto LogicalDevice::deinit() -> void {
 
     this->wait_until_idle();
 
-    m_set_pool = DescriptorPool();
+    // Before the buffers, it holds some of them.
+    m_uploader.reset();
+    m_bindless.reset();
+    m_pipeline_cache.save();
+    m_pipeline_cache = PipelineCache();
+    m_set_allocator = DescriptorAllocator();
     m_command_pool = CommandPool();
     m_buffers.clear();
 
@@ -200,6 +261,7 @@ auto LogicalDevice::deinit() -> void {
     m_instance = nullptr;
     m_physical_device = nullptr;
     m_graphics_queue = Queue();
+    m_transfer_queue = Queue();
 }
 
 auto LogicalDevice::wait_for_fence(const Fence& fences, bool wait_all, u64 timeout) const
@@ -266,7 +328,7 @@ auto LogicalDevice::create_descriptor_set_layout(
 }
 
 auto LogicalDevice::create_shader(
-    const Vulkan_Renderer&     renderer,
+    Vulkan_Renderer&           renderer,
     const Vulkan_Shader::Desc& desc
 ) -> Vulkan_Shader {
     return {*this, renderer, desc};
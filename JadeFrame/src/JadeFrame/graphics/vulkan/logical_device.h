@@ -4,16 +4,20 @@
 
 #include "VulkanMemoryAllocator/include/vk_mem_alloc.h"
 
+#include "bindless.h"
 #include "swapchain.h"
 #include "physical_device.h"
 #include "pipeline.h"
+#include "pipeline_cache.h"
 #include "buffer.h"
 #include "shader.h"
+#include "descriptor_allocator.h"
 #include "descriptor_set.h"
 #include "command_buffer.h"
 #include "queue.h"
 #include "sync_object.h"
 #include "surface.h"
+#include "uploader.h"
 
 // #include "JadeFrame/prelude.h"
 
@@ -54,6 +58,14 @@ public:
 
 public:
     Queue m_graphics_queue;
+    /// The same queue as `m_graphics_queue` if there is no transfer family of its own.
+    Queue m_transfer_queue;
+    /// Uploads the contents of the device local buffers and images.
+    std::unique_ptr<Uploader> m_uploader;
+    /// Used by every pipeline, saved to `PIPELINE_CACHE_PATH` in `deinit`.
+    PipelineCache m_pipeline_cache;
+    /// `nullptr` if the device does not support descriptor indexing.
+    std::unique_ptr<BindlessTextures> m_bindless;
 
 public:
     auto create_command_pool(QueueFamily& queue_family) -> CommandPool;
@@ -67,7 +79,8 @@ public:
     auto create_descriptor_set_layout(
         const std::span<vulkan::DescriptorSetLayout::Binding>& bindings
     ) const -> DescriptorSetLayout;
-    DescriptorPool m_set_pool;
+    /// The sets the materials own, freed when they are destroyed.
+    DescriptorAllocator m_set_allocator;
 
 public: // Swapchain stuff
     auto create_swapchain(Window* window) -> Swapchain;
@@ -98,7 +111,7 @@ public:
         -> Buffer*;
     auto destroy_buffer(Buffer* buffer) const -> void;
 
-    auto create_shader(const Vulkan_Renderer& renderer, const Vulkan_Shader::Desc& desc)
+    auto create_shader(Vulkan_Renderer& renderer, const Vulkan_Shader::Desc& desc)
         -> Vulkan_Shader;
 
 public:
@@ -107,6 +120,9 @@ public:
     mutable std::unordered_map<u32, vulkan::Buffer> m_buffers;
 
     VmaAllocator m_vma_allocator = VK_NULL_HANDLE;
+
+    /// `nullptr` if the device does not support VK_KHR_synchronization2.
+    PFN_vkCmdPipelineBarrier2KHR m_cmd_pipeline_barrier_2 = nullptr;
 };
 
 } // namespace vulkan
@@ -322,11 +322,19 @@ auto PhysicalDevice::choose_fitting_queue_families(
         if (is_compute) { fam_pointers.m_compute_family = &family; }
     }
 
+    // Uploads go to a transfer queue, preferably of a family made for it, which runs
+    // on the DMA engines next to the rendering. The graphics family can transfer too.
+    fam_pointers.m_transfer_family = fam_pointers.m_graphics_family;
     for (u32 i = 0; i < queue_families.size(); i++) {
         auto& family = queue_families[i];
 
-        const bool is_transfer = family.supports_compute();
-        if (is_transfer) { fam_pointers.m_transfer_family = &family; }
+        const bool is_transfer = family.supports_transfer() &&
+                                 !family.supports_graphics() &&
+                                 !family.supports_compute();
+        if (is_transfer) {
+            fam_pointers.m_transfer_family = &family;
+            break;
+        }
     }
 
     return fam_pointers;
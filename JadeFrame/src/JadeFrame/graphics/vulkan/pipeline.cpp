@@ -5,6 +5,9 @@
 #include "swapchain.h"
 #include "descriptor_set.h"
 #include "shared.h"
+#include "bindless.h"
+#include "JadeFrame/graphics/graphics_language.h"
+#include "JadeFrame/utils/utils.h"
 
 #include <array>
 #include <span>
@@ -82,28 +85,6 @@ static auto check_compatiblity(
 /*--------------------
     ShaderModule
 ----------------------*/
-class ShaderModule {
-public:
-    ShaderModule() = default;
-    ~ShaderModule();
-    ShaderModule(const ShaderModule&) = delete;
-    auto operator=(const ShaderModule&) -> ShaderModule& = delete;
-    ShaderModule(ShaderModule&& other) noexcept;
-    auto operator=(ShaderModule&& other) noexcept -> ShaderModule&;
-
-    ShaderModule(
-        const LogicalDevice&    device,
-        const std::vector<u32>& spirv,
-        SHADER_STAGE            stage
-    );
-
-public:
-    const LogicalDevice* m_device = nullptr;
-    VkShaderModule       m_handle = VK_NULL_HANDLE;
-    SHADER_STAGE         m_stage = SHADER_STAGE::VERTEX;
-    std::vector<u32>     m_spirv;
-    ReflectedModule      m_reflected;
-};
 
 ShaderModule::~ShaderModule() {
     if (m_handle != VK_NULL_HANDLE && m_device != nullptr) {
@@ -117,7 +98,8 @@ ShaderModule::ShaderModule(ShaderModule&& other) noexcept
     : m_device(std::exchange(other.m_device, nullptr))
     , m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
     , m_stage(other.m_stage)
-    , m_spirv(std::move(other.m_spirv)) {}
+    , m_spirv(std::move(other.m_spirv))
+    , m_reflected(std::move(other.m_reflected)) {}
 
 auto ShaderModule::operator=(ShaderModule&& other) noexcept -> ShaderModule& {
     if (this != &other) {
@@ -160,10 +142,12 @@ ShaderModule::ShaderModule(
     }
 }
 
-// Here it is deccided which `FREQUNCY` create a dynamic uniform buffer.
+// Here it is deccided which `FREQUNCY` create a dynamic uniform buffer. Those are written
+// every frame, into the `UniformRing` of the renderer.
 static auto get_uniform_buffer_type(FREQUENCY freq) -> VkDescriptorType {
     VkDescriptorType result = {};
     switch (freq) {
+        case FREQUENCY::PER_FRAME:
         case FREQUENCY::PER_OBJECT: {
             result = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         } break;
@@ -313,17 +297,17 @@ shader_stage_create_info(VkShaderStageFlagBits stage, VkShaderModule shader_modu
     return info;
 }
 
-static auto
-viewport_state_create_info(const VkViewport& viewport, const VkRect2D& scissor)
-    -> VkPipelineViewportStateCreateInfo {
+// The viewport and scissor are dynamic, so a pipeline does not depend on the extent of
+// the swapchain.
+static auto viewport_state_create_info() -> VkPipelineViewportStateCreateInfo {
     const VkPipelineViewportStateCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
         .viewportCount = 1,
-        .pViewports = &viewport,
+        .pViewports = nullptr,
         .scissorCount = 1,
-        .pScissors = &scissor,
+        .pScissors = nullptr,
     };
     return info;
 }
@@ -389,22 +373,17 @@ static auto input_assembly_state_create_info(VkPrimitiveTopology topology)
     return info;
 }
 
-static auto rasterization_state_create_info() -> VkPipelineRasterizationStateCreateInfo {
-    auto polygon_mode = VK_POLYGON_MODE_FILL;
-    // NOTE: In debugging one might want to use VK_CULL_MODE_NONE, as opposed to
-    // VK_CULL_MODE_BACK_BIT
-    VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
-    auto            front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-
+static auto rasterization_state_create_info(const PipelineState& state)
+    -> VkPipelineRasterizationStateCreateInfo {
     const VkPipelineRasterizationStateCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
         .depthClampEnable = VK_FALSE,
         .rasterizerDiscardEnable = VK_FALSE,
-        .polygonMode = polygon_mode,
-        .cullMode = cull_mode,
-        .frontFace = front_face,
+        .polygonMode = state.m_polygon_mode,
+        .cullMode = state.m_cull_mode,
+        .frontFace = state.m_front_face,
         .depthBiasEnable = VK_FALSE,
         .depthBiasConstantFactor = {},
         .depthBiasClamp = {},
@@ -429,7 +408,8 @@ static auto multisample_state_create_info() -> VkPipelineMultisampleStateCreateI
     return info;
 }
 
-static auto color_blend_attachment_state() -> VkPipelineColorBlendAttachmentState {
+static auto color_blend_attachment_state(const PipelineState& state)
+    -> VkPipelineColorBlendAttachmentState {
 
     VkColorComponentFlags color_write_mask = {};
     color_write_mask |= VK_COLOR_COMPONENT_R_BIT;
@@ -437,7 +417,7 @@ static auto color_blend_attachment_state() -> VkPipelineColorBlendAttachmentStat
     color_write_mask |= VK_COLOR_COMPONENT_B_BIT;
     color_write_mask |= VK_COLOR_COMPONENT_A_BIT;
     const VkPipelineColorBlendAttachmentState color_blend_attachment = {
-        .blendEnable = VK_TRUE,
+        .blendEnable = state.m_blend ? VK_TRUE : VK_FALSE,
         .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
         .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
         .colorBlendOp = VK_BLEND_OP_ADD,
@@ -482,8 +462,10 @@ Pipeline::Pipeline(Pipeline&& other) noexcept
     , m_device(std::exchange(other.m_device, nullptr))
     , m_render_pass(std::exchange(other.m_render_pass, nullptr))
     , m_set_layouts(std::exchange(other.m_set_layouts, {}))
-    , m_code(std::exchange(other.m_code, {}))
+    , m_modules(std::exchange(other.m_modules, {}))
+    , m_state(other.m_state)
     , m_is_compiled(std::exchange(other.m_is_compiled, false))
+    , m_is_bindless(std::exchange(other.m_is_bindless, false))
     , m_push_constant_ranges(std::exchange(other.m_push_constant_ranges, {}))
     , m_reflected_code(std::exchange(other.m_reflected_code, {}))
     , m_reflected_interface(std::exchange(other.m_reflected_interface, {})) {}
@@ -498,8 +480,10 @@ auto Pipeline::operator=(Pipeline&& other) noexcept -> Pipeline& {
         m_device = std::exchange(other.m_device, nullptr);
         m_render_pass = std::exchange(other.m_render_pass, nullptr);
         m_set_layouts = std::exchange(other.m_set_layouts, {});
-        m_code = std::exchange(other.m_code, {});
+        m_modules = std::exchange(other.m_modules, {});
+        m_state = other.m_state;
         m_is_compiled = std::exchange(other.m_is_compiled, false);
+        m_is_bindless = std::exchange(other.m_is_bindless, false);
         m_push_constant_ranges = std::exchange(other.m_push_constant_ranges, {});
         m_reflected_code = std::exchange(other.m_reflected_code, {});
         m_reflected_interface = std::exchange(other.m_reflected_interface, {});
@@ -535,6 +519,7 @@ static auto extract_descriptor_set_layouts(
 
     std::array<DescriptorSetLayout, max_sets>                       set_layouts;
     std::array<std::vector<DescriptorSetLayout::Binding>, max_sets> bindings_set;
+    std::array<bool, max_sets>                                      is_bindless = {};
 
     for (const auto& module : modules) {
         const auto stage = to_ShaderStageFlagsBits(module.m_stage);
@@ -545,13 +530,33 @@ static auto extract_descriptor_set_layouts(
             bindings_set[buffer.set].emplace_back(buffer.binding, type, 1, stage);
         }
         for (const auto& image : module.m_sampled_images) {
+            if (image.is_runtime_array) {
+                JF_ASSERT(
+                    image.set == FREQUENCY::PER_MATERIAL &&
+                        image.binding == BindlessTextures::TEXTURE_BINDING,
+                    "the textures are the second binding of the per material set"
+                );
+                is_bindless[image.set] = true;
+                continue;
+            }
             auto             freq = static_cast<FREQUENCY>(image.set);
             VkDescriptorType type = get_sampled_image_type(freq);
             bindings_set[image.set].emplace_back(image.binding, type, 1, stage);
         }
+        // Not dynamic at any frequency, the draws index them instead.
+        for (const auto& buffer : module.m_storage_buffers) {
+            VkDescriptorType type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings_set[buffer.set].emplace_back(buffer.binding, type, 1, stage);
+        }
     }
     const auto& dev = device;
     for (u32 i = 0; i < set_layouts.size(); i++) {
+        // The rest of the set is what `BindlessTextures` has, whatever the shader uses.
+        if (is_bindless[i]) {
+            JF_ASSERT(dev.m_bindless != nullptr, "the device has no descriptor indexing");
+            set_layouts[i] = BindlessTextures::create_layout(dev);
+            continue;
+        }
         set_layouts[i] = dev.create_descriptor_set_layout(bindings_set[i]);
     }
     return set_layouts;
@@ -559,26 +564,24 @@ static auto extract_descriptor_set_layouts(
 
 Pipeline::Pipeline(
     const LogicalDevice& device,
-    const VkExtent2D&    extent,
     const RenderPass&    render_pass,
-    const ShadingCode&   code
+    const ShadingCode&   code,
+    const PipelineState& state
 )
     : m_device(&device)
-    , m_render_pass(&render_pass) {
+    , m_render_pass(&render_pass)
+    , m_state(state) {
 
-    m_code.m_modules.resize(code.m_modules.size());
-    std::vector<ShaderModule> modules;
-    modules.resize(code.m_modules.size());
-    for (u32 i = 0; i < modules.size(); i++) {
+    m_modules.resize(code.m_modules.size());
+    for (u32 i = 0; i < m_modules.size(); i++) {
         const auto& module_ = code.m_modules[i];
         const auto& code_ = module_.m_code;
         const auto& stage_ = module_.m_stage;
-        modules[i] = ShaderModule(device, code_, stage_);
+        m_modules[i] = ShaderModule(device, code_, stage_);
     }
 
-    auto reflected_modules = get_reflected_modules(modules);
+    auto reflected_modules = get_reflected_modules(m_modules);
     m_reflected_interface = ReflectedModule::into_interface(reflected_modules);
-    VertexFormat vertex_format = m_reflected_interface.get_vertex_format();
 
     /*
         There are always 4 descriptor set layouts. They are grouped by binding
@@ -594,51 +597,76 @@ Pipeline::Pipeline(
     */
 
     m_set_layouts = extract_descriptor_set_layouts(reflected_modules, device);
+    for (const auto& image : m_reflected_interface.m_sampled_images) {
+        m_is_bindless |= image.is_runtime_array;
+    }
+    // Each stage with a block gets a range of its own, they may overlap.
+    const u32 max_push_size = device.m_physical_device->limits().maxPushConstantsSize;
+    for (const auto& module : reflected_modules) {
+        if (module.m_push_constant_size == 0) { continue; }
+        const PushConstantRange range = {
+            .shader_stage = to_ShaderStageFlagsBits(module.m_stage),
+            .offset = module.m_push_constant_offset,
+            .size = module.m_push_constant_size,
+        };
+        // At least 128 bytes are guaranteed, larger data belongs into buffers.
+        JF_ASSERT(range.offset + range.size <= max_push_size, "push constants too large");
+        m_push_constant_ranges.push_back(range);
+    }
 
     // bool compatible = check_compatiblity(reflected_code.m_modules, binding_description,
     // attribute_descriptions); JF_ASSERT(compatible == true, "The vertex format is not
     // compatible with the vertex shader");
 
     m_layout = PipelineLayout(device, m_set_layouts, m_push_constant_ranges);
+}
+
+auto Pipeline::has_push_constants(u32 offset, u32 size) const -> bool {
+    for (const PushConstantRange& range : m_push_constant_ranges) {
+        if (range.offset <= offset && offset + size <= range.offset + range.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto Pipeline::compile() -> void {
+    if (m_is_compiled) { return; }
+    const LogicalDevice& device = *m_device;
 
     std::vector<VkPipelineShaderStageCreateInfo> stages;
-    stages.resize(m_code.m_modules.size());
+    stages.resize(m_modules.size());
     for (u32 i = 0; i < stages.size(); i++) {
         stages[i] = shader_stage_create_info(
-            to_ShaderStageFlagsBits(modules[i].m_stage), modules[i].m_handle
+            to_ShaderStageFlagsBits(m_modules[i].m_stage), m_modules[i].m_handle
         );
     }
 
-    // NOTE: For OpenGL compatibility. make .height *= -1 and .y += .height
-    constexpr bool   gl_compat = true;
-    const VkViewport viewport = {
-        .x = 0.0F,
-        .y = gl_compat ? static_cast<f32>(extent.height) : 0.0F,
-        .width = static_cast<f32>(extent.width),
-        .height = gl_compat ? -static_cast<f32>(extent.height)
-                            : static_cast<f32>(extent.height),
-        .minDepth = 0.0F,
-        .maxDepth = 1.0F,
-    };
-
-    const VkRect2D scissor = {
-        .offset = {0, 0},
-        .extent = extent,
-    };
+    const VertexFormat vertex_format = m_reflected_interface.get_vertex_format();
 
     const VkPipelineInputAssemblyStateCreateInfo input_assembly =
-        input_assembly_state_create_info(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        input_assembly_state_create_info(m_state.m_topology);
     const VkPipelineRasterizationStateCreateInfo rasterizer =
-        rasterization_state_create_info();
+        rasterization_state_create_info(m_state);
     const VkPipelineMultisampleStateCreateInfo multisampling =
         multisample_state_create_info();
     const VkPipelineColorBlendAttachmentState color_blend_attachment =
-        color_blend_attachment_state();
-    const VkPipelineViewportStateCreateInfo viewport_state =
-        viewport_state_create_info(viewport, scissor);
+        color_blend_attachment_state(m_state);
+    const VkPipelineViewportStateCreateInfo viewport_state = viewport_state_create_info();
     const VkPipelineColorBlendStateCreateInfo color_blending =
         color_blend_state_create_info(color_blend_attachment);
 
+    const std::array<VkDynamicState, 2> dynamic_states = {
+        VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR
+    };
+    const VkPipelineDynamicStateCreateInfo dynamic_state = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .dynamicStateCount = static_cast<u32>(dynamic_states.size()),
+        .pDynamicStates = dynamic_states.data(),
+    };
+
     const VkVertexInputBindingDescription binding_description =
         get_binding_description(vertex_format);
     std::vector<VkVertexInputAttributeDescription> attribute_descriptions =
@@ -650,9 +678,9 @@ Pipeline::Pipeline(
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
-        .depthTestEnable = VK_TRUE,
-        .depthWriteEnable = VK_TRUE,
-        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthTestEnable = m_state.m_depth_test ? VK_TRUE : VK_FALSE,
+        .depthWriteEnable = m_state.m_depth_write ? VK_TRUE : VK_FALSE,
+        .depthCompareOp = m_state.m_depth_compare,
         .depthBoundsTestEnable = VK_FALSE,
         .stencilTestEnable = VK_FALSE,
         .front = {},
@@ -675,9 +703,9 @@ Pipeline::Pipeline(
         .pMultisampleState = &multisampling,
         .pDepthStencilState = &depth_stencil,
         .pColorBlendState = &color_blending,
-        .pDynamicState = nullptr,
+        .pDynamicState = &dynamic_state,
         .layout = m_layout.m_handle,
-        .renderPass = render_pass.m_handle,
+        .renderPass = m_render_pass->m_handle,
         .subpass = 0,
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = 0,
@@ -685,7 +713,7 @@ Pipeline::Pipeline(
 
     VkResult result = vkCreateGraphicsPipelines(
         device.m_handle,
-        VK_NULL_HANDLE,
+        device.m_pipeline_cache.m_handle,
         1,
         &pipeline_info,
         Instance::allocator(),
@@ -703,7 +731,55 @@ Pipeline::Pipeline(
         // }
     }
 
-    m_device = &device;
+    // Only needed to create the pipeline.
+    for (ShaderModule& module : m_modules) {
+        module = ShaderModule();
+    }
+    m_is_compiled = true;
+}
+
+auto PipelineState::hash() const -> u64 {
+    u64 result = 0;
+    result = hash_combine(result, static_cast<u64>(m_topology));
+    result = hash_combine(result, static_cast<u64>(m_polygon_mode));
+    result = hash_combine(result, static_cast<u64>(m_cull_mode));
+    result = hash_combine(result, static_cast<u64>(m_front_face));
+    result = hash_combine(result, static_cast<u64>(m_depth_test));
+    result = hash_combine(result, static_cast<u64>(m_depth_write));
+    result = hash_combine(result, static_cast<u64>(m_depth_compare));
+    result = hash_combine(result, static_cast<u64>(m_blend));
+    return result;
+}
+
+auto PipelineKey::hash() const -> u64 {
+    u64 result = m_state.hash();
+    result = hash_combine(result, static_cast<u64>(m_image_format));
+    for (const ShadingCode::Module& module : m_modules) {
+        result = hash_combine(result, hash_spirv(module.m_code));
+        result = hash_combine(result, static_cast<u64>(module.m_stage));
+    }
+    return result;
+}
+
+auto PipelineStateCache::get(
+    const LogicalDevice& device,
+    const RenderPass&    render_pass,
+    const ShadingCode&   code,
+    const PipelineState& state
+) -> Pipeline* {
+    PipelineKey key = {
+        .m_modules = code.m_modules,
+        .m_state = state,
+        .m_image_format = render_pass.m_image_format,
+    };
+    if (auto it = m_pipelines.find(key); it != m_pipelines.end()) {
+        return it->second.get();
+    }
+
+    auto [it, _] = m_pipelines.emplace(
+        std::move(key), std::make_unique<Pipeline>(device, render_pass, code, state)
+    );
+    return it->second.get();
 }
 
 } // namespace vulkan
@@ -1,4 +1,6 @@
 #pragma once
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -18,6 +20,48 @@ class DescriptorSetLayout;
 
 class RenderPass;
 
+class ShaderModule {
+public:
+    ShaderModule() = default;
+    ~ShaderModule();
+    ShaderModule(const ShaderModule&) = delete;
+    auto operator=(const ShaderModule&) -> ShaderModule& = delete;
+    ShaderModule(ShaderModule&& other) noexcept;
+    auto operator=(ShaderModule&& other) noexcept -> ShaderModule&;
+
+    ShaderModule(
+        const LogicalDevice&    device,
+        const std::vector<u32>& spirv,
+        SHADER_STAGE            stage
+    );
+
+public:
+    const LogicalDevice* m_device = nullptr;
+    VkShaderModule       m_handle = VK_NULL_HANDLE;
+    SHADER_STAGE         m_stage = SHADER_STAGE::VERTEX;
+    std::vector<u32>     m_spirv;
+    ReflectedModule      m_reflected;
+};
+
+/// The fixed function state of a pipeline, the rest comes from the shader and the render
+/// pass. The viewport and scissor are dynamic, they are set by the renderer.
+struct PipelineState {
+    VkPrimitiveTopology m_topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode       m_polygon_mode = VK_POLYGON_MODE_FILL;
+    // NOTE: In debugging one might want to use VK_CULL_MODE_NONE, as opposed to
+    // VK_CULL_MODE_BACK_BIT
+    VkCullModeFlags     m_cull_mode = VK_CULL_MODE_NONE;
+    VkFrontFace         m_front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    bool                m_depth_test = true;
+    bool                m_depth_write = true;
+    VkCompareOp         m_depth_compare = VK_COMPARE_OP_LESS;
+    /// Blends with the source alpha.
+    bool                m_blend = true;
+
+    auto operator==(const PipelineState& other) const -> bool = default;
+    [[nodiscard]] auto hash() const -> u64;
+};
+
 class Pipeline {
 public:
     Pipeline() = default;
@@ -28,13 +72,19 @@ public:
     auto operator=(Pipeline&& other) noexcept -> Pipeline&;
 
 public:
+    /// Creates the modules and the layouts, the pipeline itself only in `compile`.
     Pipeline(
         const LogicalDevice& device,
-        const VkExtent2D&    extend,
         const RenderPass&    render_pass,
-        const ShadingCode&   code
+        const ShadingCode&   code,
+        const PipelineState& state
     );
 
+    /// Does nothing if the pipeline is compiled already. Not done from several threads.
+    auto compile() -> void;
+    /// Whether a stage reads these bytes of the push constants.
+    [[nodiscard]] auto has_push_constants(u32 offset, u32 size) const -> bool;
+
 public:
     struct PushConstantRange {
         VkShaderStageFlagBits shader_stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
@@ -68,9 +118,14 @@ public:
     const RenderPass*    m_render_pass = nullptr;
 
     std::array<DescriptorSetLayout, static_cast<u8>(FREQUENCY::MAX)> m_set_layouts;
-    ShadingCode                                                      m_code;
+    /// Kept until the pipeline is compiled.
+    std::vector<ShaderModule> m_modules;
+    PipelineState             m_state;
 
     bool m_is_compiled = false;
+    /// The shader indexes the `BindlessTextures` of the device, which are bound as its
+    /// per material set. The material is given as push constant.
+    bool m_is_bindless = false;
 
     // Reflect
 
@@ -79,5 +134,39 @@ public:
     ReflectedModule                m_reflected_interface;
 };
 
+/// Everything a pipeline is created from. The vertex format is reflected from the vertex
+/// module, so the modules cover it.
+struct PipelineKey {
+    std::vector<ShadingCode::Module> m_modules;
+    PipelineState                    m_state;
+    VkFormat                         m_image_format = VK_FORMAT_UNDEFINED;
+
+    auto operator==(const PipelineKey& other) const -> bool = default;
+    [[nodiscard]] auto hash() const -> u64;
+};
+
+/// Creates every pipeline once, keyed by its modules, its state and the formats of the
+/// render pass. The keys are compared in full, the hash only picks the bucket, so only
+/// identical shaders share their pipeline. Owned by the renderer, the shaders point into
+/// it.
+class PipelineStateCache {
+public:
+    auto get(
+        const LogicalDevice& device,
+        const RenderPass&    render_pass,
+        const ShadingCode&   code,
+        const PipelineState& state
+    ) -> Pipeline*;
+
+    [[nodiscard]] auto size() const -> size_t { return m_pipelines.size(); }
+
+private:
+    struct KeyHash {
+        auto operator()(const PipelineKey& key) const -> size_t { return key.hash(); }
+    };
+
+    std::unordered_map<PipelineKey, std::unique_ptr<Pipeline>, KeyHash> m_pipelines;
+};
+
 } // namespace vulkan
 } // namespace JadeFrame
\ No newline at end of file
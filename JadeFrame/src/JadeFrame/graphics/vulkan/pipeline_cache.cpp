@@ -0,0 +1,193 @@
+#include "pipeline_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "JadeFrame/utils/assert.h"
+#include "JadeFrame/utils/logger.h"
+
+#include "context.h"
+#include "logical_device.h"
+#include "physical_device.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+/// "JFPC"
+constexpr static u32 FILE_MAGIC = 0x4350464A;
+/// Increased whenever `FileHeader` changes.
+constexpr static u32 FILE_VERSION = 1;
+
+struct FileHeader {
+    u32 m_magic = 0;
+    u32 m_version = 0;
+    u32 m_vendor_id = 0;
+    u32 m_device_id = 0;
+    u32 m_driver_version = 0;
+    u8  m_uuid[VK_UUID_SIZE] = {};
+    u64 m_data_size = 0;
+};
+
+/// What the driver puts in front of its data, `VkPipelineCacheHeaderVersionOne` in newer
+/// headers than the ones used here.
+struct VulkanHeader {
+    u32 m_header_size = 0;
+    u32 m_header_version = 0;
+    u32 m_vendor_id = 0;
+    u32 m_device_id = 0;
+    u8  m_uuid[VK_UUID_SIZE] = {};
+};
+
+static auto make_header(const VkPhysicalDeviceProperties& properties, u64 data_size)
+    -> FileHeader {
+    FileHeader header = {
+        .m_magic = FILE_MAGIC,
+        .m_version = FILE_VERSION,
+        .m_vendor_id = properties.vendorID,
+        .m_device_id = properties.deviceID,
+        .m_driver_version = properties.driverVersion,
+        .m_uuid = {},
+        .m_data_size = data_size,
+    };
+    std::memcpy(header.m_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+/// Some drivers do not check the data they are given, so it is checked here. Both the
+/// header of the file and the one the driver put in front of its data have to match.
+static auto is_valid(
+    const std::vector<u8>&            file,
+    const VkPhysicalDeviceProperties& properties
+) -> bool {
+    if (file.size() < sizeof(FileHeader)) { return false; }
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const FileHeader expected = make_header(properties, file.size() - sizeof(header));
+    if (header.m_magic != expected.m_magic || header.m_version != expected.m_version ||
+        header.m_vendor_id != expected.m_vendor_id ||
+        header.m_device_id != expected.m_device_id ||
+        header.m_driver_version != expected.m_driver_version ||
+        header.m_data_size != expected.m_data_size ||
+        std::memcmp(header.m_uuid, expected.m_uuid, VK_UUID_SIZE) != 0) {
+        return false;
+    }
+
+    VulkanHeader vk_header;
+    if (header.m_data_size < sizeof(vk_header)) { return false; }
+    std::memcpy(&vk_header, file.data() + sizeof(header), sizeof(vk_header));
+    return vk_header.m_header_size >= sizeof(vk_header) &&
+           vk_header.m_header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           vk_header.m_vendor_id == properties.vendorID &&
+           vk_header.m_device_id == properties.deviceID &&
+           std::memcmp(vk_header.m_uuid, expected.m_uuid, VK_UUID_SIZE) == 0;
+}
+
+static auto read_file(const std::string& path) -> std::vector<u8> {
+    std::vector<u8> result;
+    FILE*           f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr) { return result; }
+
+    std::error_code ec;
+    const auto      size = std::filesystem::file_size(path, ec);
+    if (!ec) {
+        result.resize(static_cast<size_t>(size));
+        if (std::fread(result.data(), 1, result.size(), f) != result.size()) {
+            result.clear();
+        }
+    }
+    std::fclose(f);
+    return result;
+}
+
+PipelineCache::PipelineCache(PipelineCache&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
+    , m_device(std::exchange(other.m_device, nullptr))
+    , m_path(std::move(other.m_path))
+    , m_saved_size(std::exchange(other.m_saved_size, 0)) {}
+
+auto PipelineCache::operator=(PipelineCache&& other) noexcept -> PipelineCache& {
+    if (this != &other) {
+        if (m_handle != VK_NULL_HANDLE && m_device != nullptr) {
+            vkDestroyPipelineCache(m_device->m_handle, m_handle, Instance::allocator());
+        }
+        m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
+        m_device = std::exchange(other.m_device, nullptr);
+        m_path = std::move(other.m_path);
+        m_saved_size = std::exchange(other.m_saved_size, 0);
+    }
+    return *this;
+}
+
+PipelineCache::~PipelineCache() {
+    if (m_handle != VK_NULL_HANDLE && m_device != nullptr) {
+        vkDestroyPipelineCache(m_device->m_handle, m_handle, Instance::allocator());
+        m_handle = VK_NULL_HANDLE;
+        m_device = nullptr;
+    }
+}
+
+PipelineCache::PipelineCache(const LogicalDevice& device, std::string path)
+    : m_device(&device)
+    , m_path(std::move(path)) {
+
+    const VkPhysicalDeviceProperties& properties = device.m_physical_device->m_properties;
+    const std::vector<u8>             file = read_file(m_path);
+    const bool                        is_file_valid = is_valid(file, properties);
+    if (!file.empty() && !is_file_valid) {
+        Logger::warn("Pipeline cache {} is outdated, starting empty", m_path);
+    }
+
+    const VkPipelineCacheCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = is_file_valid ? file.size() - sizeof(FileHeader) : 0,
+        .pInitialData = is_file_valid ? file.data() + sizeof(FileHeader) : nullptr,
+    };
+    VkResult result =
+        vkCreatePipelineCache(device.m_handle, &info, Instance::allocator(), &m_handle);
+    JF_ASSERT(result == VK_SUCCESS, "");
+    m_saved_size = info.initialDataSize;
+    Logger::info("Created pipeline cache with {} bytes", m_saved_size);
+}
+
+auto PipelineCache::save() -> bool {
+    if (m_handle == VK_NULL_HANDLE) { return false; }
+
+    const VkDevice device = m_device->m_handle;
+    size_t         size = 0;
+    VkResult       result = vkGetPipelineCacheData(device, m_handle, &size, nullptr);
+    if (result != VK_SUCCESS) { return false; }
+    if (size == m_saved_size) { return true; }
+
+    std::vector<u8> file(sizeof(FileHeader) + size);
+    u8*             data = file.data() + sizeof(FileHeader);
+    result = vkGetPipelineCacheData(device, m_handle, &size, data);
+    if (result != VK_SUCCESS) { return false; }
+    file.resize(sizeof(FileHeader) + size);
+    const FileHeader header =
+        make_header(m_device->m_physical_device->m_properties, size);
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    const std::string temp_path = m_path + ".tmp";
+    FILE*             f = std::fopen(temp_path.c_str(), "wb");
+    if (f == nullptr) { return false; }
+    bool res = std::fwrite(file.data(), 1, file.size(), f) == file.size();
+    res &= std::fclose(f) == 0;
+
+    std::error_code ec;
+    if (res) { std::filesystem::rename(temp_path, m_path, ec); }
+    if (!res || ec) {
+        std::filesystem::remove(temp_path, ec);
+        Logger::warn("Failed to write pipeline cache {}", m_path);
+        return false;
+    }
+    m_saved_size = size;
+    return true;
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
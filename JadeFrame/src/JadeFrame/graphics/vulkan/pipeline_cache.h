@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/prelude.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class LogicalDevice;
+
+/*
+    Keeps what the driver compiled for the pipelines between runs. The data is loaded
+   from a file when the cache is created and written back by `save`, which the device does
+   when it is destroyed.
+    The file starts with a header of its own, the data is only used if it was written by
+   the same version of it, for the same device and driver. Otherwise the cache starts
+   empty and the file is replaced on the next `save`.
+*/
+class PipelineCache {
+public:
+    PipelineCache() = default;
+    ~PipelineCache();
+    PipelineCache(const PipelineCache&) = delete;
+    auto operator=(const PipelineCache&) -> PipelineCache& = delete;
+    PipelineCache(PipelineCache&&) noexcept;
+    auto operator=(PipelineCache&&) noexcept -> PipelineCache&;
+
+    PipelineCache(const LogicalDevice& device, std::string path);
+
+    /// Writes the data into a file next to `m_path` and renames it over the old one, so a
+    /// crash never leaves half a file. Does nothing if the size did not change since the
+    /// last load or save. Returns false if the file could not be written.
+    auto save() -> bool;
+
+public:
+    VkPipelineCache      m_handle = VK_NULL_HANDLE;
+    const LogicalDevice* m_device = nullptr;
+    std::string          m_path;
+
+private:
+    size_t m_saved_size = 0;
+};
+} // namespace vulkan
+} // namespace JadeFrame
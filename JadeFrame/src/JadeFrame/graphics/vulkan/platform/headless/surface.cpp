@@ -0,0 +1,38 @@
+#include "surface.h"
+#include "../../context.h"
+
+#include "JadeFrame/platform/platform_shared.h"
+
+namespace JadeFrame {
+namespace vulkan {
+namespace headless {
+// Uses VK_EXT_headless_surface, which needs no display server, e.g. lavapipe on a CI
+// machine. Presenting to it does nothing. The instance enables every available extension,
+// so it is enabled whenever the loader offers it.
+auto create_surface(VkInstance instance, Window* /*window_handle*/) -> VkSurfaceKHR {
+    auto create_headless_surface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+        vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT")
+    );
+    if (create_headless_surface == nullptr) {
+        assert(false);
+        throw std::runtime_error("VK_EXT_headless_surface is not supported!");
+    }
+
+    const VkHeadlessSurfaceCreateInfoEXT create_info = {
+        .sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+        .pNext = nullptr,
+        .flags = 0,
+    };
+    VkSurfaceKHR handle;
+
+    VkResult result =
+        create_headless_surface(instance, &create_info, Instance::allocator(), &handle);
+    if (result != VK_SUCCESS) {
+        assert(false);
+        throw std::runtime_error("failed to create headless surface!");
+    }
+    return handle;
+}
+} // namespace headless
+} // namespace vulkan
+} // namespace JadeFrame
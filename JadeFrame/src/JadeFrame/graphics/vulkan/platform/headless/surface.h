@@ -0,0 +1,14 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+namespace JadeFrame {
+class Window;
+
+namespace vulkan {
+namespace headless {
+
+auto create_surface(VkInstance instance, Window* window_handle) -> VkSurfaceKHR;
+
+} // namespace headless
+} // namespace vulkan
+} // namespace JadeFrame
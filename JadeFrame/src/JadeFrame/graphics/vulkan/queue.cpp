@@ -62,6 +62,93 @@ auto Queue::submit(
     cmd_buffer.m_stage = CommandBuffer::STAGE::PENDING;
 }
 
+auto Queue::submit(
+    const CommandBuffer&     cmd_buffer,
+    const Semaphore*         wait_semaphore,
+    const Semaphore*         signal_semaphore,
+    const Fence*             fence,
+    const TimelineSemaphore& timeline,
+    u64                      wait_value
+) const -> void {
+    if (wait_value == 0) {
+        this->submit(cmd_buffer, wait_semaphore, signal_semaphore, fence);
+        return;
+    }
+    assert(cmd_buffer.m_stage == CommandBuffer::STAGE::EXCECUTABLE);
+
+    const bool has_wait_semaphore = wait_semaphore != nullptr;
+    const bool has_signal_semaphore = signal_semaphore != nullptr;
+
+    // The uploads are waited for by every stage, the frame may read them anywhere.
+    std::array<VkSemaphore, 2>          wait_semaphores = {timeline.m_handle};
+    std::array<u64, 2>                  wait_values = {wait_value};
+    std::array<VkPipelineStageFlags, 2> wait_stages = {
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+    };
+    u32 wait_count = 1;
+    if (has_wait_semaphore) {
+        wait_semaphores[wait_count] = wait_semaphore->m_handle;
+        wait_stages[wait_count] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        wait_count++;
+    }
+
+    // The values of binary semaphores are ignored.
+    const VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = wait_count,
+        .pWaitSemaphoreValues = wait_values.data(),
+        .signalSemaphoreValueCount = 0,
+        .pSignalSemaphoreValues = nullptr,
+    };
+    const VkSubmitInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_info,
+        .waitSemaphoreCount = wait_count,
+        .pWaitSemaphores = wait_semaphores.data(),
+        .pWaitDstStageMask = wait_stages.data(),
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd_buffer.m_handle,
+        .signalSemaphoreCount = has_signal_semaphore ? 1_u32 : 0,
+        .pSignalSemaphores = has_signal_semaphore ? &signal_semaphore->m_handle : nullptr,
+    };
+    VkFence  fence_handle = fence != nullptr ? fence->m_handle : nullptr;
+    VkResult result = vkQueueSubmit(m_handle, 1, &info, fence_handle);
+    if (result != VK_SUCCESS) { JF_ASSERT(false, to_string(result)); }
+    cmd_buffer.m_stage = CommandBuffer::STAGE::PENDING;
+}
+
+auto Queue::submit(
+    const CommandBuffer&     cmd_buffer,
+    const TimelineSemaphore& timeline,
+    u64                      signal_value
+) const -> void {
+    assert(cmd_buffer.m_stage == CommandBuffer::STAGE::EXCECUTABLE);
+
+    const VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = nullptr,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &signal_value,
+    };
+    const VkSubmitInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_info,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd_buffer.m_handle,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &timeline.m_handle,
+    };
+    VkResult result = vkQueueSubmit(m_handle, 1, &info, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) { JF_ASSERT(false, to_string(result)); }
+    cmd_buffer.m_stage = CommandBuffer::STAGE::PENDING;
+}
+
 auto Queue::wait_idle() const -> void {
     VkResult result = VK_SUCCESS;
     result = vkQueueWaitIdle(m_handle);
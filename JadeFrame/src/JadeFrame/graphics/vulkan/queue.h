@@ -14,6 +14,7 @@ class PhysicalDevice;
 class LogicalDevice;
 class CommandBuffer;
 class Semaphore;
+class TimelineSemaphore;
 class Fence;
 class Swapchain;
 
@@ -42,6 +43,22 @@ public: // submit methods
         const Semaphore*     signal_semaphore,
         const Fence*         p_fence
     ) const -> void;
+    /// Like the one above, and also waits until `timeline` reached `wait_value`, unless
+    /// it is 0. Used for the frames which use resources of the `Uploader`.
+    auto submit(
+        const CommandBuffer&     cmd_buffer,
+        const Semaphore*         wait_semaphore,
+        const Semaphore*         signal_semaphore,
+        const Fence*             p_fence,
+        const TimelineSemaphore& timeline,
+        u64                      wait_value
+    ) const -> void;
+    /// Sets `timeline` to `signal_value` once the commands are done.
+    auto submit(
+        const CommandBuffer&     cmd_buffer,
+        const TimelineSemaphore& timeline,
+        u64                      signal_value
+    ) const -> void;
 
 public:
     auto               wait_idle() const -> void;
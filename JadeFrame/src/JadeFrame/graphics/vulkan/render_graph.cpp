@@ -0,0 +1,623 @@
+#include "render_graph.h"
+
+#include <algorithm>
+
+#include "JadeFrame/utils/assert.h"
+
+#include "logical_device.h"
+#include "physical_device.h"
+#include "command_buffer.h"
+#include "context.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+auto get_image_state(ACCESS access) -> ImageState {
+    constexpr VkPipelineStageFlags2KHR fragment_tests =
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR |
+        VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR;
+
+    switch (access) {
+        case ACCESS::NONE: return {};
+        case ACCESS::COLOR_ATTACHMENT:
+            return {
+                .m_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                .m_access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR |
+                            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            };
+        case ACCESS::DEPTH_ATTACHMENT:
+            return {
+                .m_stages = fragment_tests,
+                .m_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR |
+                            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            };
+        case ACCESS::DEPTH_READ:
+            return {
+                .m_stages = fragment_tests,
+                .m_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+            };
+        case ACCESS::SAMPLED:
+            return {
+                .m_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+                .m_access = VK_ACCESS_2_SHADER_READ_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            };
+        case ACCESS::TRANSFER_SRC:
+            return {
+                .m_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+                .m_access = VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            };
+        case ACCESS::TRANSFER_DST:
+            return {
+                .m_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+                .m_access = VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+                .m_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            };
+        case ACCESS::PRESENT:
+            // The presentation engine waits on a semaphore, which makes the writes
+            // visible. The stage only keeps the layout transition before the signal.
+            return {
+                .m_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                .m_access = 0,
+                .m_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            };
+    }
+    JF_ASSERT(false, "unknown access");
+    return {};
+}
+
+auto is_write(ACCESS access) -> bool {
+    switch (access) {
+        case ACCESS::COLOR_ATTACHMENT:
+        case ACCESS::DEPTH_ATTACHMENT:
+        case ACCESS::TRANSFER_DST: return true;
+        default: return false;
+    }
+}
+
+using PassId = RenderGraph::PassId;
+
+static auto push_unique(std::vector<PassId>& passes, PassId pass) -> void {
+    if (std::find(passes.begin(), passes.end(), pass) == passes.end()) {
+        passes.push_back(pass);
+    }
+}
+
+/*---------------------------
+    PassBuilder
+---------------------------*/
+
+auto RenderGraph::PassBuilder::read(ResourceId resource, ACCESS access) -> void {
+    JF_ASSERT(resource < m_graph->m_resources.size(), "");
+    JF_ASSERT(!is_write(access), "use `write` for writing accesses");
+    m_graph->m_passes[m_pass].m_uses.push_back({resource, access});
+}
+
+auto RenderGraph::PassBuilder::write(ResourceId resource, ACCESS access) -> void {
+    JF_ASSERT(resource < m_graph->m_resources.size(), "");
+    JF_ASSERT(is_write(access), "use `read` for reading accesses");
+    m_graph->m_passes[m_pass].m_uses.push_back({resource, access});
+}
+
+auto RenderGraph::PassBuilder::set_side_effect() -> void {
+    m_graph->m_passes[m_pass].m_has_side_effect = true;
+}
+
+/*---------------------------
+    RenderGraph
+---------------------------*/
+
+RenderGraph::~RenderGraph() { this->release(); }
+
+RenderGraph::RenderGraph(RenderGraph&& other) noexcept
+    : m_passes(std::move(other.m_passes))
+    , m_resources(std::move(other.m_resources))
+    , m_levels(std::move(other.m_levels))
+    , m_final_barriers(std::move(other.m_final_barriers))
+    , m_memory(std::move(other.m_memory))
+    , m_device(std::exchange(other.m_device, nullptr))
+    , m_slot_count(std::exchange(other.m_slot_count, 0)) {}
+
+auto RenderGraph::operator=(RenderGraph&& other) noexcept -> RenderGraph& {
+    if (this != &other) {
+        this->release();
+        m_passes = std::move(other.m_passes);
+        m_resources = std::move(other.m_resources);
+        m_levels = std::move(other.m_levels);
+        m_final_barriers = std::move(other.m_final_barriers);
+        m_memory = std::move(other.m_memory);
+        m_device = std::exchange(other.m_device, nullptr);
+        m_slot_count = std::exchange(other.m_slot_count, 0);
+    }
+    return *this;
+}
+
+auto RenderGraph::import_image(
+    std::string      name,
+    const ImageDesc& desc,
+    ImageState       initial,
+    ACCESS           final
+) -> ResourceId {
+    Resource resource;
+    resource.m_name = std::move(name);
+    resource.m_desc = desc;
+    resource.m_is_imported = true;
+    resource.m_initial = initial;
+    resource.m_final = final;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+auto RenderGraph::create_image(std::string name, const ImageDesc& desc) -> ResourceId {
+    Resource resource;
+    resource.m_name = std::move(name);
+    resource.m_desc = desc;
+    m_resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+auto RenderGraph::add_pass(std::string name, const SetupFn& setup, ExecuteFn execute)
+    -> PassId {
+    const auto id = static_cast<PassId>(m_passes.size());
+    Pass       pass;
+    pass.m_name = std::move(name);
+    pass.m_execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+
+    PassBuilder builder(*this, id);
+    setup(builder);
+    return id;
+}
+
+auto RenderGraph::compile() -> void {
+    this->add_dependencies();
+    this->cull();
+    this->order();
+    this->assign_memory_slots();
+    this->compute_barriers();
+}
+
+auto RenderGraph::add_dependencies() -> void {
+    struct History {
+        PassId              m_last_writer = INVALID;
+        std::vector<PassId> m_readers;
+        VkImageLayout       m_read_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+    std::vector<History> histories(m_resources.size());
+
+    for (PassId id = 0; id < m_passes.size(); id++) {
+        Pass& pass = m_passes[id];
+        pass.m_dependencies.clear();
+        pass.m_producers.clear();
+
+        for (const Use& use : pass.m_uses) {
+            History&            history = histories[use.m_resource];
+            const VkImageLayout layout = get_image_state(use.m_access).m_layout;
+
+            if (history.m_last_writer != INVALID && history.m_last_writer != id) {
+                // Read after write or write after write.
+                push_unique(pass.m_dependencies, history.m_last_writer);
+                push_unique(pass.m_producers, history.m_last_writer);
+            }
+            if (is_write(use.m_access)) {
+                // Write after read.
+                for (const PassId reader : history.m_readers) {
+                    if (reader != id) { push_unique(pass.m_dependencies, reader); }
+                }
+                history.m_last_writer = id;
+                history.m_readers.clear();
+            } else {
+                // Readers may share a level only if they need the same layout.
+                if (!history.m_readers.empty() && history.m_read_layout != layout) {
+                    for (const PassId reader : history.m_readers) {
+                        if (reader != id) { push_unique(pass.m_dependencies, reader); }
+                    }
+                    history.m_readers.clear();
+                }
+                history.m_readers.push_back(id);
+                history.m_read_layout = layout;
+            }
+        }
+    }
+}
+
+auto RenderGraph::cull() -> void {
+    std::vector<PassId> stack;
+    for (Pass& pass : m_passes) { pass.m_is_culled = true; }
+
+    for (PassId id = 0; id < m_passes.size(); id++) {
+        if (m_passes[id].m_has_side_effect) { stack.push_back(id); }
+    }
+    // The last writers of the images which outlive the graph.
+    for (ResourceId r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (!resource.m_is_imported || resource.m_final == ACCESS::NONE) { continue; }
+        for (PassId id = static_cast<PassId>(m_passes.size()); id-- > 0;) {
+            const auto& uses = m_passes[id].m_uses;
+            const bool  writes = std::any_of(uses.begin(), uses.end(), [&](const Use& u) {
+                return u.m_resource == r && is_write(u.m_access);
+            });
+            if (writes) {
+                stack.push_back(id);
+                break;
+            }
+        }
+    }
+
+    while (!stack.empty()) {
+        const PassId id = stack.back();
+        stack.pop_back();
+        Pass& pass = m_passes[id];
+        if (!pass.m_is_culled) { continue; }
+        pass.m_is_culled = false;
+        for (const PassId producer : pass.m_producers) { stack.push_back(producer); }
+    }
+}
+
+auto RenderGraph::order() -> void {
+    // Dependencies are always added before their dependents, so one pass in declaration
+    // order is enough to know the level of every pass.
+    std::vector<u32> pass_levels(m_passes.size(), INVALID);
+    u32              level_count = 0;
+    for (PassId id = 0; id < m_passes.size(); id++) {
+        const Pass& pass = m_passes[id];
+        if (pass.m_is_culled) { continue; }
+        u32 level = 0;
+        for (const PassId dependency : pass.m_dependencies) {
+            if (m_passes[dependency].m_is_culled) { continue; }
+            level = std::max(level, pass_levels[dependency] + 1);
+        }
+        pass_levels[id] = level;
+        level_count = std::max(level_count, level + 1);
+    }
+
+    m_levels.clear();
+    m_levels.resize(level_count);
+    for (PassId id = 0; id < m_passes.size(); id++) {
+        if (pass_levels[id] == INVALID) { continue; }
+        m_levels[pass_levels[id]].m_passes.push_back(id);
+    }
+
+    for (Resource& resource : m_resources) {
+        resource.m_first_level = INVALID;
+        resource.m_last_level = INVALID;
+    }
+    for (u32 level = 0; level < m_levels.size(); level++) {
+        for (const PassId id : m_levels[level].m_passes) {
+            for (const Use& use : m_passes[id].m_uses) {
+                Resource& resource = m_resources[use.m_resource];
+                if (resource.m_first_level == INVALID) { resource.m_first_level = level; }
+                resource.m_last_level = level;
+            }
+        }
+    }
+}
+
+auto RenderGraph::assign_memory_slots() -> void {
+    std::vector<ResourceId> transients;
+    for (ResourceId r = 0; r < m_resources.size(); r++) {
+        Resource& resource = m_resources[r];
+        resource.m_slot = INVALID;
+        resource.m_previous_in_slot = INVALID;
+        if (!resource.m_is_imported && resource.m_first_level != INVALID) {
+            transients.push_back(r);
+        }
+    }
+    std::stable_sort(transients.begin(), transients.end(), [&](auto a, auto b) {
+        return m_resources[a].m_first_level < m_resources[b].m_first_level;
+    });
+
+    // The last image placed in each slot. A slot is free once its last image is not
+    // used anymore.
+    std::vector<ResourceId> slot_owners;
+    for (const ResourceId r : transients) {
+        Resource& resource = m_resources[r];
+        u32       slot = INVALID;
+        for (u32 s = 0; s < slot_owners.size(); s++) {
+            if (m_resources[slot_owners[s]].m_last_level < resource.m_first_level) {
+                slot = s;
+                break;
+            }
+        }
+        if (slot == INVALID) {
+            slot = static_cast<u32>(slot_owners.size());
+            slot_owners.push_back(r);
+        } else {
+            resource.m_previous_in_slot = slot_owners[slot];
+            slot_owners[slot] = r;
+        }
+        resource.m_slot = slot;
+    }
+    m_slot_count = static_cast<u32>(slot_owners.size());
+}
+
+auto RenderGraph::compute_barriers() -> void {
+    /// What the previous passes did to an image, as far as the next barrier cares.
+    struct Tracked {
+        VkImageLayout            m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        /// The last write, which has to be made available.
+        VkPipelineStageFlags2KHR m_write_stages = 0;
+        VkAccessFlags2KHR        m_write_access = 0;
+        /// The reads since the last write, later writes have to wait for them.
+        VkPipelineStageFlags2KHR m_read_stages = 0;
+        /// What the last write was already made visible to.
+        VkPipelineStageFlags2KHR m_visible_stages = 0;
+        VkAccessFlags2KHR        m_visible_access = 0;
+    };
+    std::vector<Tracked> tracked(m_resources.size());
+    for (ResourceId r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (!resource.m_is_imported) { continue; }
+        tracked[r].m_layout = resource.m_initial.m_layout;
+        tracked[r].m_write_stages = resource.m_initial.m_stages;
+        tracked[r].m_write_access = resource.m_initial.m_access;
+    }
+
+    // Returns whether a barrier is needed to go from `state` to `required`, and updates
+    // `state` as if the barrier and the access happened.
+    const auto transition = [](Tracked&          state,
+                               const ImageState& required,
+                               bool              writes,
+                               Barrier&          barrier) -> bool {
+        barrier.m_old_layout = state.m_layout;
+        barrier.m_new_layout = required.m_layout;
+        barrier.m_dst_stages = required.m_stages;
+        barrier.m_dst_access = required.m_access;
+
+        const bool changes_layout = state.m_layout != required.m_layout;
+        bool       needed = false;
+        if (changes_layout || writes) {
+            // Layout transitions are writes as well, so they wait for all earlier
+            // accesses.
+            barrier.m_src_stages = state.m_write_stages | state.m_read_stages;
+            barrier.m_src_access = state.m_write_access;
+            needed = changes_layout || barrier.m_src_stages != 0;
+        } else {
+            const bool is_visible =
+                (required.m_stages & ~state.m_visible_stages) == 0 &&
+                (required.m_access & ~state.m_visible_access) == 0;
+            barrier.m_src_stages = state.m_write_stages;
+            barrier.m_src_access = state.m_write_access;
+            needed = state.m_write_stages != 0 && !is_visible;
+        }
+
+        state.m_layout = required.m_layout;
+        if (writes) {
+            state.m_write_stages = required.m_stages;
+            state.m_write_access = required.m_access;
+            state.m_read_stages = 0;
+            state.m_visible_stages = 0;
+            state.m_visible_access = 0;
+        } else {
+            state.m_read_stages |= required.m_stages;
+            if (needed) {
+                state.m_visible_stages |= required.m_stages;
+                state.m_visible_access |= required.m_access;
+            }
+        }
+        return needed;
+    };
+
+    for (u32 level = 0; level < m_levels.size(); level++) {
+        Level& current = m_levels[level];
+        current.m_barriers.clear();
+
+        // All uses of an image in one level are merged into one barrier. They can only
+        // be reads in the same layout, or the uses of a single pass.
+        struct Merged {
+            ResourceId m_resource;
+            ImageState m_state;
+            bool       m_writes;
+        };
+        std::vector<Merged> merged;
+        for (const PassId id : current.m_passes) {
+            for (const Use& use : m_passes[id].m_uses) {
+                const ImageState state = get_image_state(use.m_access);
+                auto it = std::find_if(merged.begin(), merged.end(), [&](auto& m) {
+                    return m.m_resource == use.m_resource;
+                });
+                if (it == merged.end()) {
+                    merged.push_back({use.m_resource, state, is_write(use.m_access)});
+                    continue;
+                }
+                JF_ASSERT(
+                    it->m_state.m_layout == state.m_layout,
+                    "an image is used with two layouts in one level"
+                );
+                it->m_state.m_stages |= state.m_stages;
+                it->m_state.m_access |= state.m_access;
+                it->m_writes = it->m_writes || is_write(use.m_access);
+            }
+        }
+
+        for (const Merged& m : merged) {
+            const Resource& resource = m_resources[m.m_resource];
+            Tracked&        state = tracked[m.m_resource];
+            Barrier         barrier;
+            barrier.m_resource = m.m_resource;
+
+            if (!resource.m_is_imported && resource.m_first_level == level) {
+                // The contents are undefined, but the memory may still be used by the
+                // previous image in the slot.
+                if (resource.m_previous_in_slot != INVALID) {
+                    const Tracked& previous = tracked[resource.m_previous_in_slot];
+                    state.m_write_stages =
+                        previous.m_write_stages | previous.m_read_stages;
+                    state.m_write_access = previous.m_write_access;
+                }
+                state.m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+            if (transition(state, m.m_state, m.m_writes, barrier)) {
+                current.m_barriers.push_back(barrier);
+            }
+        }
+    }
+
+    m_final_barriers.clear();
+    for (ResourceId r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (!resource.m_is_imported || resource.m_final == ACCESS::NONE) { continue; }
+        Barrier barrier;
+        barrier.m_resource = r;
+        if (transition(tracked[r], get_image_state(resource.m_final), false, barrier)) {
+            m_final_barriers.push_back(barrier);
+        }
+    }
+}
+
+auto RenderGraph::allocate(const LogicalDevice& device) -> void {
+    this->release();
+    m_device = &device;
+
+    // Every slot gets one allocation per memory type the images in it need. Usually
+    // that is one, but nothing guarantees that e.g. color and depth images can share it.
+    struct Allocation {
+        VkDeviceSize            m_size = 0;
+        u32                     m_type_bits = ~u32{0};
+        std::vector<ResourceId> m_resources;
+    };
+    std::vector<std::vector<Allocation>> slots(m_slot_count);
+
+    for (ResourceId r = 0; r < m_resources.size(); r++) {
+        Resource& resource = m_resources[r];
+        if (resource.m_is_imported || resource.m_slot == INVALID) { continue; }
+        const ImageDesc& desc = resource.m_desc;
+
+        resource.m_transient_image = Image(
+            device,
+            v2u32::create(desc.m_extent.width, desc.m_extent.height),
+            desc.m_format,
+            desc.m_usage,
+            Image::SOURCE::ALIASED
+        );
+        const VkMemoryRequirements requirements =
+            resource.m_transient_image.get_memory_requirements();
+
+        auto& allocations = slots[resource.m_slot];
+        auto  it = std::find_if(allocations.begin(), allocations.end(), [&](auto& a) {
+            return (a.m_type_bits & requirements.memoryTypeBits) != 0;
+        });
+        if (it == allocations.end()) { it = allocations.emplace(allocations.end()); }
+        // The allocation starts at offset 0, which satisfies every alignment.
+        it->m_size = std::max(it->m_size, requirements.size);
+        it->m_type_bits &= requirements.memoryTypeBits;
+        it->m_resources.push_back(r);
+    }
+
+    for (auto& allocations : slots) {
+        for (const Allocation& allocation : allocations) {
+            const VkMemoryAllocateInfo alloc_info = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .allocationSize = allocation.m_size,
+                .memoryTypeIndex = device.m_physical_device->find_memory_type(
+                    allocation.m_type_bits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                ),
+            };
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            const VkResult result = vkAllocateMemory(
+                device.m_handle, &alloc_info, Instance::allocator(), &memory
+            );
+            JF_ASSERT(result == VK_SUCCESS, "");
+            m_memory.push_back(memory);
+
+            for (const ResourceId r : allocation.m_resources) {
+                Resource& resource = m_resources[r];
+                resource.m_transient_image.bind_memory(memory, 0);
+                resource.m_transient_view = ImageView(
+                    device,
+                    resource.m_transient_image,
+                    resource.m_desc.m_format,
+                    resource.m_desc.m_aspect
+                );
+                resource.m_image = resource.m_transient_image.m_handle;
+                resource.m_view = resource.m_transient_view.m_handle;
+            }
+        }
+    }
+}
+
+auto RenderGraph::release() -> void {
+    for (Resource& resource : m_resources) {
+        if (resource.m_is_imported) { continue; }
+        resource.m_transient_view = ImageView();
+        resource.m_transient_image = Image();
+        resource.m_image = VK_NULL_HANDLE;
+        resource.m_view = VK_NULL_HANDLE;
+    }
+    if (m_device != nullptr) {
+        for (VkDeviceMemory memory : m_memory) {
+            vkFreeMemory(m_device->m_handle, memory, Instance::allocator());
+        }
+    }
+    m_memory.clear();
+    m_device = nullptr;
+}
+
+auto RenderGraph::set_image(ResourceId resource, VkImage image, VkImageView view)
+    -> void {
+    JF_ASSERT(m_resources[resource].m_is_imported, "only imported images can be set");
+    m_resources[resource].m_image = image;
+    m_resources[resource].m_view = view;
+}
+
+auto RenderGraph::execute(CommandBuffer& cb) const -> void {
+    std::vector<VkImageMemoryBarrier2KHR> barriers;
+    const auto                            record = [&](std::span<const Barrier> from) {
+        barriers.clear();
+        for (const Barrier& barrier : from) {
+            const Resource& resource = m_resources[barrier.m_resource];
+            JF_ASSERT(resource.m_image != VK_NULL_HANDLE, "image was not set");
+            barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+                .pNext = nullptr,
+                .srcStageMask = barrier.m_src_stages,
+                .srcAccessMask = barrier.m_src_access,
+                .dstStageMask = barrier.m_dst_stages,
+                .dstAccessMask = barrier.m_dst_access,
+                .oldLayout = barrier.m_old_layout,
+                .newLayout = barrier.m_new_layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = resource.m_image,
+                .subresourceRange = {
+                    .aspectMask = resource.m_desc.m_aspect,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            });
+        }
+        cb.pipeline_barrier(barriers);
+    };
+
+    for (const Level& level : m_levels) {
+        record(level.m_barriers);
+        for (const PassId id : level.m_passes) { m_passes[id].m_execute(cb, *this); }
+    }
+    record(m_final_barriers);
+}
+
+auto RenderGraph::get_image(ResourceId resource) const -> VkImage {
+    return m_resources[resource].m_image;
+}
+
+auto RenderGraph::get_view(ResourceId resource) const -> VkImageView {
+    return m_resources[resource].m_view;
+}
+
+auto RenderGraph::is_culled(PassId pass) const -> bool {
+    return m_passes[pass].m_is_culled;
+}
+
+auto RenderGraph::get_memory_slot(ResourceId resource) const -> u32 {
+    return m_resources[resource].m_slot;
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,206 @@
+#pragma once
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/types.h"
+#include "buffer.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class CommandBuffer;
+class LogicalDevice;
+
+/// How a pass uses an image. Each one maps to the stages, access and layout in
+/// `get_image_state`.
+enum class ACCESS : u8 {
+    /// Not used anymore, e.g. the final access of an image nothing reads after the frame.
+    NONE,
+    COLOR_ATTACHMENT,
+    DEPTH_ATTACHMENT,
+    /// Depth testing without writing.
+    DEPTH_READ,
+    /// Sampled in the fragment shader.
+    SAMPLED,
+    TRANSFER_SRC,
+    TRANSFER_DST,
+    PRESENT,
+};
+
+struct ImageState {
+    VkPipelineStageFlags2KHR m_stages = 0;
+    VkAccessFlags2KHR        m_access = 0;
+    VkImageLayout            m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+[[nodiscard]] auto get_image_state(ACCESS access) -> ImageState;
+[[nodiscard]] auto is_write(ACCESS access) -> bool;
+
+/*
+    The passes of a frame and the images they use. The passes declare which images they
+   read and write, `compile` then
+    - culls the passes whose results nothing uses,
+    - orders the remaining ones into levels of passes which do not depend on each other,
+    - computes the barriers every level needs, batched into one call per level,
+    - lets transient images whose lifetimes do not overlap share memory.
+    `allocate` creates the transient images and `execute` records the frame.
+
+    The graph is meant to be built and compiled once, e.g. whenever the swapchain is
+   created, and executed every frame. Imported images, like the swapchain image, are set
+   with `set_image` before every `execute`.
+*/
+class RenderGraph {
+public:
+    using ResourceId = u32;
+    using PassId = u32;
+    constexpr static u32 INVALID = ~u32{0};
+
+    struct ImageDesc {
+        VkFormat           m_format = VK_FORMAT_UNDEFINED;
+        VkExtent2D         m_extent = {};
+        VkImageUsageFlags  m_usage = 0;
+        VkImageAspectFlags m_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    };
+
+    class PassBuilder {
+    public:
+        auto read(ResourceId resource, ACCESS access) -> void;
+        auto write(ResourceId resource, ACCESS access) -> void;
+        /// Keeps the pass even if nothing reads what it writes.
+        auto set_side_effect() -> void;
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, PassId pass)
+            : m_graph(&graph)
+            , m_pass(pass) {}
+
+        RenderGraph* m_graph;
+        PassId       m_pass;
+    };
+
+    using SetupFn = std::function<void(PassBuilder& builder)>;
+    using ExecuteFn = std::function<void(CommandBuffer& cb, const RenderGraph& graph)>;
+
+    /// A barrier which is recorded before a level, the image is only known at `execute`.
+    struct Barrier {
+        ResourceId               m_resource = INVALID;
+        VkPipelineStageFlags2KHR m_src_stages = 0;
+        VkAccessFlags2KHR        m_src_access = 0;
+        VkPipelineStageFlags2KHR m_dst_stages = 0;
+        VkAccessFlags2KHR        m_dst_access = 0;
+        VkImageLayout            m_old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout            m_new_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct Level {
+        std::vector<PassId>  m_passes;
+        std::vector<Barrier> m_barriers;
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph();
+    RenderGraph(const RenderGraph&) = delete;
+    auto operator=(const RenderGraph&) -> RenderGraph& = delete;
+    RenderGraph(RenderGraph&& other) noexcept;
+    auto operator=(RenderGraph&& other) noexcept -> RenderGraph&;
+
+    /// An image which lives outside the graph. `initial` is its state before the first
+    /// pass, e.g. `VK_IMAGE_LAYOUT_UNDEFINED` if its contents can be discarded. If
+    /// `final` is not `NONE` it is transitioned to it after the last pass, and the passes
+    /// writing it are never culled.
+    auto import_image(
+        std::string      name,
+        const ImageDesc& desc,
+        ImageState       initial,
+        ACCESS           final = ACCESS::NONE
+    ) -> ResourceId;
+    /// An image which only lives during the frame. Its contents are undefined before the
+    /// first pass writing it.
+    auto create_image(std::string name, const ImageDesc& desc) -> ResourceId;
+    /// The passes are executed in the order they were added, as far as their
+    /// dependencies allow.
+    auto add_pass(std::string name, const SetupFn& setup, ExecuteFn execute) -> PassId;
+
+    auto compile() -> void;
+    /// Creates the transient images. Has to be called after `compile`.
+    auto allocate(const LogicalDevice& device) -> void;
+    auto set_image(ResourceId resource, VkImage image, VkImageView view) -> void;
+    auto execute(CommandBuffer& cb) const -> void;
+
+    [[nodiscard]] auto get_image(ResourceId resource) const -> VkImage;
+    [[nodiscard]] auto get_view(ResourceId resource) const -> VkImageView;
+
+    [[nodiscard]] auto get_levels() const -> std::span<const Level> { return m_levels; }
+    /// The barriers recorded after the last level, into the final state of the imported
+    /// images.
+    [[nodiscard]] auto get_final_barriers() const -> std::span<const Barrier> {
+        return m_final_barriers;
+    }
+    [[nodiscard]] auto is_culled(PassId pass) const -> bool;
+    /// The memory slot of a transient image. Images with the same slot share memory.
+    /// `INVALID` for imported images and images no pass uses.
+    [[nodiscard]] auto get_memory_slot(ResourceId resource) const -> u32;
+    [[nodiscard]] auto get_memory_slot_count() const -> u32 { return m_slot_count; }
+
+private:
+    struct Use {
+        ResourceId m_resource;
+        ACCESS     m_access;
+    };
+
+    struct Pass {
+        std::string      m_name;
+        ExecuteFn        m_execute;
+        std::vector<Use> m_uses;
+        /// The passes which have to run before this one.
+        std::vector<PassId> m_dependencies;
+        /// The subset of `m_dependencies` whose writes this pass uses, only those keep
+        /// it from being culled.
+        std::vector<PassId> m_producers;
+        bool                m_has_side_effect = false;
+        bool                m_is_culled = false;
+    };
+
+    struct Resource {
+        std::string m_name;
+        ImageDesc   m_desc;
+        bool        m_is_imported = false;
+        ImageState  m_initial;
+        ACCESS      m_final = ACCESS::NONE;
+
+        /// The first and last level using the image, only set for transient ones.
+        u32 m_first_level = INVALID;
+        u32 m_last_level = INVALID;
+        u32 m_slot = INVALID;
+        /// The transient image which used the memory slot before this one.
+        ResourceId m_previous_in_slot = INVALID;
+
+        VkImage     m_image = VK_NULL_HANDLE;
+        VkImageView m_view = VK_NULL_HANDLE;
+        Image       m_transient_image;
+        ImageView   m_transient_view;
+    };
+
+    auto add_dependencies() -> void;
+    auto cull() -> void;
+    auto order() -> void;
+    auto assign_memory_slots() -> void;
+    auto compute_barriers() -> void;
+    auto release() -> void;
+
+private:
+    std::vector<Pass>           m_passes;
+    std::vector<Resource>       m_resources;
+    std::vector<Level>          m_levels;
+    std::vector<Barrier>        m_final_barriers;
+    std::vector<VkDeviceMemory> m_memory;
+    const LogicalDevice*        m_device = nullptr;
+    u32                         m_slot_count = 0;
+};
+
+} // namespace vulkan
+} // namespace JadeFrame
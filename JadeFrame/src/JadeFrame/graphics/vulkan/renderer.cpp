@@ -1,4 +1,6 @@
 #include "renderer.h"
+#include <algorithm>
+#include <cstring>
 #if defined(_WIN32)
     #include "JadeFrame/platform/windows/windows_window.h"
 #elif defined(__linux__)
@@ -10,18 +12,43 @@
 #include "shader.h"
 
 namespace JadeFrame {
-// prepare shaders and its dynamic uniform buffers
-// TODO: Find a better way to do this, but for now it works
-static auto prepare_shaders(const std::deque<RenderCommand>& commands) -> void {
-    for (u64 i = 0; i < commands.size(); i++) {
-        const auto&           cmd = commands[i];
+/// The largest range a per object uniform buffer of the materials is bound with.
+static auto get_max_transform_range(std::span<const RenderCommand> commands) -> u64 {
+    // Sorted by material, so each one is only visited once.
+    u64                   max_range = 0;
+    const MaterialHandle* previous = nullptr;
+    for (const RenderCommand& cmd : commands) {
         const MaterialHandle& mh = *cmd.material;
-        auto*                 material = static_cast<Vulkan_Material*>(mh.m_handle.get());
-        material->set_dynamic_ub_num(commands.size());
+        if (previous == &mh) { continue; }
+        auto*       material = static_cast<Vulkan_Material*>(mh.m_handle.get());
+        const auto* bg_tran = mh.m_info.get_bind_group_by_name("Transform");
+        if (bg_tran != nullptr &&
+            !material->has_storage_buffer(bg_tran->m_set, bg_tran->m_binding)) {
+            const u64 range = material->get_max_instances(bg_tran->m_binding);
+            max_range = std::max(max_range, range * sizeof(mat4x4));
+        }
+        previous = &mh;
     }
+    return max_range;
 }
 
+/// How much of the `UniformRing` the frame may write: the camera and a run of transforms
+/// per command at most. The whole range of the last binding has to be inside the region,
+/// even for a draw with fewer instances than it has room for.
+static auto get_uniform_size(size_t command_count, u64 max_range, u64 alignment) -> u64 {
+    const u64 slot = math::ceil_to_aligned(sizeof(mat4x4), alignment);
+    return slot + command_count * slot + max_range;
+}
+
+/// Where the renderer pushes what, the blocks of the shaders declare the parts they read
+/// at the same offsets. The model matrix of a draw, see `record_draws`.
+static const u32 PUSH_MODEL_OFFSET = 0;
+/// The index of a bindless material, see `BindlessTextures`.
+static const u32 PUSH_MATERIAL_OFFSET = sizeof(mat4x4);
+
 static const i32 MAX_FRAMES_IN_FLIGHT = 4;
+// Fewer draws than this per worker cost more in hand off than they save in recording.
+static const size_t MIN_DRAWS_PER_CHUNK = 256;
 
 Vulkan_Renderer::Vulkan_Renderer(RenderSystem& system, Window* window)
     : m_context(window)
@@ -46,17 +73,38 @@ Vulkan_Renderer::Vulkan_Renderer(RenderSystem& system, Window* window)
 
     m_frames.resize(MAX_FRAMES_IN_FLIGHT);
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_frames[i].init(m_logical_device);
+        m_frames[i].init(m_logical_device, m_thread_pool.worker_count());
     }
+    m_uniform_ring =
+        std::make_unique<vulkan::UniformRing>(*m_logical_device, MAX_FRAMES_IN_FLIGHT);
+    this->build_render_graph();
 }
 
-Vulkan_Renderer::~Vulkan_Renderer() { this->wait_until_idle(); }
+Vulkan_Renderer::~Vulkan_Renderer() {
+    this->wait_until_idle();
+    for (Frame& frame : m_frames) {
+        if (frame.m_indirect_transform_buffer != nullptr) {
+            m_logical_device->destroy_buffer(frame.m_indirect_transform_buffer);
+        }
+        if (frame.m_indirect_args_buffer != nullptr) {
+            m_logical_device->destroy_buffer(frame.m_indirect_args_buffer);
+        }
+        if (frame.m_object_buffer != nullptr) {
+            m_logical_device->destroy_buffer(frame.m_object_buffer);
+        }
+    }
+}
 
 auto Vulkan_Renderer::wait_until_idle() -> void {
     if (m_logical_device == nullptr) { return; }
     m_logical_device->wait_until_idle();
 }
 
+auto Vulkan_Renderer::get_frames_in_flight() const -> u32 {
+    // The fence of a frame is only waited on when its slot comes around again.
+    return static_cast<u32>(MAX_FRAMES_IN_FLIGHT);
+}
+
 auto Vulkan_Renderer::recreate_swapchain() -> void {
     m_logical_device->wait_until_idle();
 
@@ -74,6 +122,58 @@ auto Vulkan_Renderer::recreate_swapchain() -> void {
             m_swapchain.m_extent
         );
     }
+    this->build_render_graph();
+}
+
+auto Vulkan_Renderer::build_render_graph() -> void {
+    using namespace vulkan;
+    const VkExtent2D extent = m_swapchain.m_extent;
+
+    RenderGraph graph;
+    // Acquiring waits on a semaphore at the color output stage, the first transition of
+    // the image has to come after that.
+    const ImageState acquired = {
+        .m_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+        .m_access = 0,
+        .m_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    m_color_target = graph.import_image(
+        "swapchain",
+        {.m_format = m_swapchain.m_image_format,
+         .m_extent = extent,
+         .m_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+         .m_aspect = VK_IMAGE_ASPECT_COLOR_BIT},
+        acquired,
+        ACCESS::PRESENT
+    );
+    // The depth image is shared by all frames in flight and cleared by every one of
+    // them, so the previous frame's depth writes are the only thing to wait for.
+    const ImageState depth_state = get_image_state(ACCESS::DEPTH_ATTACHMENT);
+    const auto       depth = graph.import_image(
+        "depth",
+        {.m_format = VK_FORMAT_D32_SFLOAT,
+         .m_extent = extent,
+         .m_usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+         .m_aspect = VK_IMAGE_ASPECT_DEPTH_BIT},
+        {depth_state.m_stages, depth_state.m_access, VK_IMAGE_LAYOUT_UNDEFINED}
+    );
+    graph.set_image(
+        depth, m_swapchain.m_depth_image.m_handle, m_swapchain.m_depth_image_view.m_handle
+    );
+
+    graph.add_pass(
+        "main",
+        [&](RenderGraph::PassBuilder& builder) {
+            builder.write(m_color_target, ACCESS::COLOR_ATTACHMENT);
+            builder.write(depth, ACCESS::DEPTH_ATTACHMENT);
+        },
+        [this](CommandBuffer& cb, const RenderGraph& /*graph*/) {
+            this->record_main_pass(cb);
+        }
+    );
+    graph.compile();
+    graph.allocate(*m_logical_device);
+    m_graph = std::move(graph);
 }
 
 auto Vulkan_Renderer::set_clear_color(const RGBAColor& color) -> void {
@@ -83,53 +183,66 @@ auto Vulkan_Renderer::set_clear_color(const RGBAColor& color) -> void {
 auto Vulkan_Renderer::clear_background() -> void {}
 
 auto Vulkan_Renderer::render(const Camera& camera) -> void {
-    vulkan::LogicalDevice&        d = *m_logical_device;
-    const vulkan::PhysicalDevice* pd = d.m_physical_device;
+    vulkan::LogicalDevice& d = *m_logical_device;
+
+    // Every frame in flight has its own object buffer, which catches up on the ids that
+    // changed since it was last drawn. So they are noted even if this frame is skipped.
+    // The queues of a `RenderThread` copy the transforms, the scene is not read then.
+    const bool is_scene_read = m_system->m_prepared_queue == nullptr;
+    if (is_scene_read) {
+        const auto ranges = m_system->m_scene.get_dirty_ranges();
+        for (Frame& frame : m_frames) {
+            frame.m_dirty_objects.insert(
+                frame.m_dirty_objects.end(), ranges.begin(), ranges.end()
+            );
+        }
+    }
 
     auto& curr_frame = m_frames[m_frame_index];
     curr_frame.acquire_image(m_swapchain);
+    // The device is done with the sets of the frame, they are all freed at once.
+    curr_frame.m_descriptors.reset();
 
     if (m_swapchain.m_is_recreated) {
         m_swapchain.m_is_recreated = false;
         this->recreate_swapchain();
         m_skip_present = true;
+        m_system->get_draw_queue().clear();
         return;
     }
 
-    const u64 dyn_alignment = math::ceil_to_aligned(
-        sizeof(mat4x4), pd->limits().minUniformBufferOffsetAlignment
+    RenderQueue& render_queue = m_system->prepare_draw_queue(camera, &m_thread_pool);
+    const std::span<const RenderCommand> render_commands = render_queue.get_commands();
+
+    // The fence of the frame was waited on, so its region of the ring and its object
+    // buffer are free again. The uniform data is written here and the workers below only
+    // record.
+    // Runs of the same mesh are drawn instanced. The transforms of the scene items are
+    // in the object buffer already, those of the submitted commands are packed into the
+    // ring, starting at an offset they can be bound with. The camera is written once and
+    // bound with the same offset by every material.
+    vulkan::UniformRing& ring = *m_uniform_ring;
+    const u64            alignment = ring.get_alignment();
+    const u64            max_range = get_max_transform_range(render_commands);
+    ring.begin_frame(
+        static_cast<u32>(m_frame_index),
+        get_uniform_size(render_commands.size(), max_range, alignment)
     );
-
-    std::deque<RenderCommand>& render_commands = m_system->m_render_commands;
-    // prepare shaders and its dynamic uniform buffers
-    // TODO: Find a better way to do this, but for now it works
-    for (u64 i = 0; i < render_commands.size(); i++) {
-        const auto&           cmd = render_commands[i];
-        const MaterialHandle& mh = *cmd.material;
-        auto*                 material = static_cast<Vulkan_Material*>(mh.m_handle.get());
-        material->set_dynamic_ub_num(render_commands.size());
-    }
-
-    vulkan::CommandBuffer& cb = curr_frame.m_cmd;
-    // cb.record([&] {
-    cb.record_begin();
-    vulkan::Framebuffer& framebuffer = m_framebuffers[curr_frame.m_index];
-    const RGBAColor      c = m_clear_color;
-    const VkClearValue   clear_value = VkClearValue{{{c.r, c.g, c.b, c.a}}};
-
-    // cb.render_pass(framebuffer, m_render_pass, m_swapchain.m_extent, clear_value, [&] {
-    cb.render_pass_begin(framebuffer, m_render_pass, m_swapchain.m_extent, clear_value);
-    for (u64 i = 0; i < render_commands.size(); i++) {
-        using namespace vulkan;
+    if (is_scene_read) { this->upload_objects(curr_frame, max_range); }
+    const mat4x4                 cam = camera.get_view_projection("Vulkan");
+    const MaterialHandle*        prepared_material = nullptr;
+    const vulkan::DescriptorSet* ring_set = nullptr;
+    const vulkan::DescriptorSet* object_set = nullptr;
+    u32                          max_instances = 1;
+    bool                         is_model_pushed = false;
+    m_camera_offset = ring.write(&cam, sizeof(cam));
+    m_draws.clear();
+    m_indirect.clear();
+    for (size_t i = 0; i < render_commands.size();) {
         const RenderCommand& cmd = render_commands[i];
         MaterialHandle&      mh = *cmd.material;
         auto*                material = static_cast<Vulkan_Material*>(mh.m_handle.get());
 
-        const VkPipelineBindPoint bp = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        vulkan::Pipeline&         pl = material->m_shader->m_pipeline;
-        auto&                     sets = material->m_sets;
-        cb.bind_pipeline(bp, pl);
-
         const auto* bg_cam = mh.m_info.get_bind_group_by_name("Camera");
         const auto* bg_tran = mh.m_info.get_bind_group_by_name("Transform");
         if (bg_cam == nullptr || bg_tran == nullptr) {
@@ -146,41 +259,415 @@ auto Vulkan_Renderer::render(const Camera& camera) -> void {
             );
         }
 
-        mat4x4 cam = camera.get_view_projection("Vulkan");
-        auto   cam_set = static_cast<FREQUENCY>(bg_cam->m_set);
-        auto   cam_binding = bg_cam->m_binding;
-        material->write_ub(cam_set, cam_binding, &cam, sizeof(cam), 0);
-
-        const u32   dyn_offset = static_cast<u32>(dyn_alignment * i);
-        const auto& tran = cmd.transform;
-        auto        tran_set = static_cast<FREQUENCY>(bg_tran->m_set);
-        auto        tran_binding = bg_tran->m_binding;
-        material->write_ub(tran_set, tran_binding, &tran, sizeof(tran), dyn_offset);
-        const auto PER_FRAME = vulkan::FREQUENCY::PER_FRAME;
-        const auto PER_PASS = vulkan::FREQUENCY::PER_PASS;
-        const auto PER_MATERIAL = vulkan::FREQUENCY::PER_MATERIAL;
-        const auto PER_OBJECT = vulkan::FREQUENCY::PER_OBJECT;
-        cb.bind_descriptor_set(bp, pl, PER_FRAME, sets[PER_FRAME], nullptr);
-        cb.bind_descriptor_set(bp, pl, PER_PASS, sets[PER_PASS], nullptr);
-        // if (mh.m_texture != nullptr) {
-        cb.bind_descriptor_set(bp, pl, PER_MATERIAL, sets[PER_MATERIAL], nullptr);
-        //}
-        cb.bind_descriptor_set(bp, pl, PER_OBJECT, sets[PER_OBJECT], &dyn_offset);
-
-        this->render_mesh(cmd.vertex_data, cmd.m_mesh);
-    }
-    //});
-    cb.render_pass_end();
-    //});
+        const bool is_indirect =
+            material->has_storage_buffer(bg_tran->m_set, bg_tran->m_binding);
+        if (prepared_material != &mh) {
+            // Compiled on first use, before the workers bind it.
+            material->m_shader->m_pipeline->compile();
+            material->bind_frame_sets(curr_frame.m_descriptors, ring);
+            if (!is_indirect) {
+                const auto PER_OBJECT = vulkan::FREQUENCY::PER_OBJECT;
+                max_instances = material->get_max_instances(bg_tran->m_binding);
+                ring_set = &material->get_set(PER_OBJECT);
+                object_set = curr_frame.m_object_buffer != nullptr
+                                 ? &material->get_frame_set(
+                                       curr_frame.m_descriptors,
+                                       PER_OBJECT,
+                                       *curr_frame.m_object_buffer
+                                   )
+                                 : nullptr;
+            }
+            is_model_pushed = material->m_shader->m_pipeline->has_push_constants(
+                PUSH_MODEL_OFFSET, sizeof(mat4x4)
+            );
+            prepared_material = &mh;
+        }
+
+        // All draws of the material at once, their transforms are not written here.
+        if (is_indirect) {
+            size_t end = i + 1;
+            while (end < render_commands.size() && render_commands[end].material == &mh) {
+                end++;
+            }
+            m_indirect.add(render_commands.subspan(i, end - i));
+            i = end;
+            continue;
+        }
+
+        // The object buffer is bound at the aligned offset below the matrix of the item,
+        // the instance index starts at the rest. Runs of consecutive ids are instanced,
+        // as long as the bound range has room for them.
+        if (is_scene_read && cmd.m_scene_id != RenderCommand::NO_SCENE_ID) {
+            const u64  position = u64{cmd.m_scene_id} * sizeof(mat4x4);
+            const u64  offset = position - position % alignment;
+            const auto first_instance =
+                static_cast<u32>((position - offset) / sizeof(mat4x4));
+            if (first_instance < max_instances) {
+                const u32 instance_count = count_scene_instances(
+                    render_commands.subspan(i), max_instances - first_instance
+                );
+                m_draws.push_back(Draw{
+                    .m_command = &cmd,
+                    .m_object_set = object_set,
+                    .m_instance_count = instance_count,
+                    .m_first_instance = first_instance,
+                    .m_dyn_offset = static_cast<u32>(offset),
+                });
+                i += instance_count;
+                continue;
+            }
+        }
+
+        // `sort` stored the transforms of the run next to each other.
+        const u32 instance_count =
+            count_instances(render_commands.subspan(i), max_instances);
+        const u64 size = instance_count * sizeof(mat4x4);
+        // A single transform is only pushed. Its set is still bound, at the offset of the
+        // camera, where the whole range fits as well. So the draws share that binding.
+        const bool is_pushed = is_model_pushed && instance_count == 1;
+        m_draws.push_back(Draw{
+            .m_command = &cmd,
+            .m_object_set = ring_set,
+            .m_instance_count = instance_count,
+            .m_dyn_offset = is_pushed ? m_camera_offset : ring.write(cmd.transform, size),
+        });
+        i += instance_count;
+    }
+    this->upload_indirect_draws(curr_frame);
+
+    const u32 image_index = curr_frame.m_index;
+    m_graph.set_image(
+        m_color_target,
+        m_swapchain.m_images[image_index].m_handle,
+        m_swapchain.m_image_views[image_index].m_handle
+    );
+    vulkan::CommandBuffer& cb = curr_frame.m_cmd;
+    cb.record_begin();
+    // Submits the uploads of the frame and takes over what the transfer queue wrote.
+    const u64 upload = d.m_uploader->record_acquires(cb);
+    m_graph.execute(cb);
     cb.record_end();
 
-    curr_frame.submit(d.m_graphics_queue);
+    curr_frame.submit(d.m_graphics_queue, upload);
+
+    render_queue.clear();
+}
+
+auto Vulkan_Renderer::record_main_pass(vulkan::CommandBuffer& cb) -> void {
+    Frame&               curr_frame = m_frames[m_frame_index];
+    vulkan::Framebuffer& framebuffer = m_framebuffers[curr_frame.m_index];
+    const VkExtent2D     extent = m_swapchain.m_extent;
+    const RGBAColor      c = m_clear_color;
+    const VkClearValue   clear_value = VkClearValue{{{c.r, c.g, c.b, c.a}}};
+
+    // Large frames are split into chunks which the workers record into secondary buffers,
+    // each from the command pool of its chunk. Small ones are not worth the hand off.
+    const size_t max_chunks = curr_frame.m_worker_cmds.size();
+    const auto   chunk_count = static_cast<u32>(
+        std::clamp<size_t>(m_draws.size() / MIN_DRAWS_PER_CHUNK, 1, max_chunks)
+    );
+    if (chunk_count == 1) {
+        cb.render_pass_begin(framebuffer, m_render_pass, extent, clear_value);
+        this->set_dynamic_state(cb);
+        this->record_draws(cb, m_draws);
+        this->record_indirect_draws(cb);
+        cb.render_pass_end();
+    } else {
+        m_thread_pool.parallel_for(chunk_count, [&](u32 chunk, u32 /*worker*/) {
+            const size_t first = m_draws.size() * chunk / chunk_count;
+            const size_t last = m_draws.size() * (chunk + 1) / chunk_count;
+
+            vulkan::CommandBuffer& secondary = curr_frame.m_worker_cmds[chunk];
+            curr_frame.m_worker_pools[chunk].reset();
+            secondary.record_begin(m_render_pass, framebuffer);
+            this->set_dynamic_state(secondary);
+            this->record_draws(secondary, {&m_draws[first], last - first});
+            // Only a few calls, not worth a chunk of their own.
+            if (chunk == chunk_count - 1) { this->record_indirect_draws(secondary); }
+            secondary.record_end();
+        });
+
+        const auto contents = VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
+        cb.render_pass_begin(framebuffer, m_render_pass, extent, clear_value, contents);
+        cb.execute_commands({curr_frame.m_worker_cmds.data(), chunk_count});
+        cb.render_pass_end();
+    }
+}
+
+auto Vulkan_Renderer::set_dynamic_state(vulkan::CommandBuffer& cb) const -> void {
+    const VkExtent2D extent = m_swapchain.m_extent;
+    // NOTE: For OpenGL compatibility. make .height *= -1 and .y += .height
+    constexpr bool   gl_compat = true;
+    const VkViewport viewport = {
+        .x = 0.0F,
+        .y = gl_compat ? static_cast<f32>(extent.height) : 0.0F,
+        .width = static_cast<f32>(extent.width),
+        .height = gl_compat ? -static_cast<f32>(extent.height)
+                            : static_cast<f32>(extent.height),
+        .minDepth = 0.0F,
+        .maxDepth = 1.0F,
+    };
+    const VkRect2D scissor = {
+        .offset = {0, 0},
+        .extent = extent,
+    };
+    cb.set_viewport(viewport);
+    cb.set_scissor(scissor);
+}
+
+/// Binds the pipeline and all sets of the material but the per object one, unless they
+/// are bound already.
+/// The materials of a bindless pipeline only differ in their index, their sets are the
+/// same. So those are only bound with the pipeline, the material just pushes its index.
+static auto bind_material(
+    vulkan::CommandBuffer&   cb,
+    const MaterialHandle&    mh,
+    u32                      camera_offset,
+    const vulkan::Pipeline*& bound_pipeline,
+    const MaterialHandle*&   bound_material
+) -> void {
+    const VkPipelineBindPoint bp = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    auto*                     material = static_cast<Vulkan_Material*>(mh.m_handle.get());
+
+    vulkan::Pipeline& pl = *material->m_shader->m_pipeline;
+    if (bound_pipeline != &pl) {
+        cb.bind_pipeline(bp, pl);
+        bound_pipeline = &pl;
+        // The sets were bound with the layout of the old pipeline, bind them again.
+        bound_material = nullptr;
+    }
+
+    const auto PER_FRAME = vulkan::FREQUENCY::PER_FRAME;
+    const auto PER_PASS = vulkan::FREQUENCY::PER_PASS;
+    const auto PER_MATERIAL = vulkan::FREQUENCY::PER_MATERIAL;
+    if (bound_material == &mh) { return; }
+    if (!pl.m_is_bindless || bound_material == nullptr) {
+        const auto& frame_set = material->get_set(PER_FRAME);
+        cb.bind_descriptor_set(bp, pl, PER_FRAME, frame_set, &camera_offset);
+        cb.bind_descriptor_set(bp, pl, PER_PASS, material->get_set(PER_PASS), nullptr);
+        const vulkan::DescriptorSet& set = pl.m_is_bindless
+                                               ? material->m_device->m_bindless->m_set
+                                               : material->get_set(PER_MATERIAL);
+        cb.bind_descriptor_set(bp, pl, PER_MATERIAL, set, nullptr);
+    }
+    if (pl.m_is_bindless) {
+        const u32 index = material->m_material_index;
+        cb.push_constants(pl, PUSH_MATERIAL_OFFSET, &index, sizeof(index));
+    }
+    bound_material = &mh;
+}
 
-    render_commands.clear();
+/// Binds the buffers of the mesh, unless they are bound already. The meshes in one arena
+/// of the `MeshArena` share them, so the draws only differ in their offsets.
+static auto bind_mesh_buffers(
+    vulkan::CommandBuffer& cb,
+    const GPUMeshData&     mesh,
+    const GPUBuffer*&      bound_vertex_buffer,
+    const GPUBuffer*&      bound_index_buffer
+) -> void {
+    if (bound_vertex_buffer != mesh.m_vertex_buffer) {
+        const auto* vertex_buffer =
+            static_cast<vulkan::Buffer*>(mesh.m_vertex_buffer->m_handle);
+        cb.bind_vertex_buffer(0, *vertex_buffer, 0);
+        bound_vertex_buffer = mesh.m_vertex_buffer;
+    }
+    if (mesh.m_index_buffer != nullptr && bound_index_buffer != mesh.m_index_buffer) {
+        const auto* index_buffer =
+            static_cast<vulkan::Buffer*>(mesh.m_index_buffer->m_handle);
+        cb.bind_index_buffer(*index_buffer, 0);
+        bound_index_buffer = mesh.m_index_buffer;
+    }
 }
 
-auto Vulkan_Renderer::render_mesh(const Mesh* vertex_data, const GPUMeshData* gpu_data)
+auto Vulkan_Renderer::record_draws(vulkan::CommandBuffer& cb, std::span<const Draw> draws)
     -> void {
+    // The draws are sorted by pipeline and material, everything but the per object set is
+    // only bound where they change.
+    const VkPipelineBindPoint    bp = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    const vulkan::Pipeline*      bound_pipeline = nullptr;
+    const MaterialHandle*        bound_material = nullptr;
+    const GPUBuffer*             bound_vertex_buffer = nullptr;
+    const GPUBuffer*             bound_index_buffer = nullptr;
+    const vulkan::DescriptorSet* bound_object_set = nullptr;
+    u32                          bound_object_offset = 0;
+    for (const Draw& draw : draws) {
+        const RenderCommand&  cmd = *draw.m_command;
+        const MaterialHandle& mh = *cmd.material;
+        auto*                 material = static_cast<Vulkan_Material*>(mh.m_handle.get());
+
+        const vulkan::Pipeline* previous_pipeline = bound_pipeline;
+        bind_material(cb, mh, m_camera_offset, bound_pipeline, bound_material);
+
+        vulkan::Pipeline&            pl = *material->m_shader->m_pipeline;
+        const auto                   PER_OBJECT = vulkan::FREQUENCY::PER_OBJECT;
+        const vulkan::DescriptorSet& object_set = *draw.m_object_set;
+        // The set is shared by the materials of other pipelines as well, so it is bound
+        // again with the layout of a new pipeline.
+        if (previous_pipeline != bound_pipeline) { bound_object_set = nullptr; }
+        // The draws with a pushed transform share the offset, see `render`.
+        if (bound_object_set != &object_set || bound_object_offset != draw.m_dyn_offset) {
+            cb.bind_descriptor_set(bp, pl, PER_OBJECT, object_set, &draw.m_dyn_offset);
+            bound_object_set = &object_set;
+            bound_object_offset = draw.m_dyn_offset;
+        }
+        // The shaders which have it read the first instance from here.
+        if (pl.has_push_constants(PUSH_MODEL_OFFSET, sizeof(mat4x4))) {
+            cb.push_constants(pl, PUSH_MODEL_OFFSET, cmd.transform, sizeof(mat4x4));
+        }
+
+        bind_mesh_buffers(cb, *cmd.m_mesh, bound_vertex_buffer, bound_index_buffer);
+        Vulkan_Renderer::render_mesh(
+            cb, cmd.vertex_data, cmd.m_mesh, draw.m_instance_count, draw.m_first_instance
+        );
+    }
+}
+
+// Only grows, by at least half, so a growing scene does not replace it every frame. The
+// buffers belong to a single frame in flight, whose fence was waited on.
+static auto reserve_buffer(
+    vulkan::LogicalDevice& device,
+    vulkan::Buffer*&       buffer,
+    vulkan::Buffer::TYPE   type,
+    size_t                 size
+) -> void {
+    if (buffer == nullptr) {
+        buffer = device.create_buffer(type, nullptr, size);
+    } else if (buffer->m_size < size) {
+        buffer->resize(std::max<size_t>(size, buffer->m_size + buffer->m_size / 2));
+    }
+}
+
+auto Vulkan_Renderer::upload_indirect_draws(Frame& frame) -> void {
+    if (m_indirect.empty()) { return; }
+    vulkan::LogicalDevice& d = *m_logical_device;
+
+    const std::span<const mat4x4> transforms = m_indirect.get_transforms();
+    vulkan::Buffer*&              transform_buffer = frame.m_indirect_transform_buffer;
+    reserve_buffer(d, transform_buffer, vulkan::Buffer::STORAGE, transforms.size_bytes());
+    transform_buffer->write(transforms.data(), transforms.size_bytes(), 0);
+
+    m_indirect_args.resize(m_indirect.get_args_size());
+    m_indirect.write_args(m_indirect_args.data());
+    vulkan::Buffer*& args_buffer = frame.m_indirect_args_buffer;
+    reserve_buffer(d, args_buffer, vulkan::Buffer::INDIRECT, m_indirect_args.size());
+    args_buffer->write(m_indirect_args.data(), m_indirect_args.size(), 0);
+
+    const MaterialHandle* previous = nullptr;
+    for (const IndirectDrawList::Batch& batch : m_indirect.get_batches()) {
+        const MaterialHandle& mh = *batch.m_command->material;
+        if (previous == &mh) { continue; }
+        auto*       material = static_cast<Vulkan_Material*>(mh.m_handle.get());
+        const auto* bg_tran = mh.m_info.get_bind_group_by_name("Transform");
+        material->bind_frame_storage_buffer(
+            frame.m_descriptors, bg_tran->m_set, bg_tran->m_binding, *transform_buffer
+        );
+        previous = &mh;
+    }
+}
+
+// The matrix of an id is at `id * sizeof(mat4x4)`. Written like the ring, the fence of
+// the frame was waited on.
+auto Vulkan_Renderer::upload_objects(Frame& frame, u64 padding) -> void {
+    const RenderScene& scene = m_system->m_scene;
+    const u32          id_count = scene.get_id_count();
+    if (id_count == 0) { return; }
+
+    vulkan::Buffer*& buffer = frame.m_object_buffer;
+    const size_t     size = id_count * sizeof(mat4x4) + padding;
+    if (buffer == nullptr || buffer->m_size < size) {
+        reserve_buffer(*m_logical_device, buffer, vulkan::Buffer::UNIFORM, size);
+        // The contents are not kept.
+        frame.m_dirty_objects.assign(1, {.m_first = 0, .m_count = id_count});
+    }
+    if (frame.m_dirty_objects.empty()) { return; }
+
+    u8* data = buffer->map();
+    for (const RenderScene::IdRange& range : frame.m_dirty_objects) {
+        for (u32 i = 0; i < range.m_count; i++) {
+            const RenderScene::Id id = range.m_first + i;
+            // Removed since it was changed.
+            if (!scene.contains(id)) { continue; }
+            const u64 position = u64{id} * sizeof(mat4x4);
+            std::memcpy(data + position, &scene.get_world(id), sizeof(mat4x4));
+        }
+    }
+    buffer->unmap();
+    frame.m_dirty_objects.clear();
+}
+
+auto Vulkan_Renderer::record_indirect_draws(vulkan::CommandBuffer& cb) -> void {
+    // Without these features the draws are issued one by one, with the arguments from the
+    // host. They still bind nothing between draws.
+    const VkPhysicalDeviceFeatures& features =
+        m_logical_device->m_physical_device->m_features;
+    const bool multi_draw = features.multiDrawIndirect == VK_TRUE &&
+                            features.drawIndirectFirstInstance == VK_TRUE;
+
+    // Only created by the first frame which has indirect draws.
+    if (m_indirect.empty()) { return; }
+    const vulkan::Buffer& args_buffer = *m_frames[m_frame_index].m_indirect_args_buffer;
+
+    const VkPipelineBindPoint bp = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    const vulkan::Pipeline*   bound_pipeline = nullptr;
+    const MaterialHandle*     bound_material = nullptr;
+    const GPUBuffer*          bound_vertex_buffer = nullptr;
+    const GPUBuffer*          bound_index_buffer = nullptr;
+    for (const IndirectDrawList::Batch& batch : m_indirect.get_batches()) {
+        const RenderCommand&  cmd = *batch.m_command;
+        const MaterialHandle& mh = *cmd.material;
+        auto*                 material = static_cast<Vulkan_Material*>(mh.m_handle.get());
+        if (bound_material != &mh) {
+            bind_material(cb, mh, m_camera_offset, bound_pipeline, bound_material);
+            vulkan::Pipeline& pl = *material->m_shader->m_pipeline;
+            const auto        PER_OBJECT = vulkan::FREQUENCY::PER_OBJECT;
+            const auto&       object_set = material->get_set(PER_OBJECT);
+            cb.bind_descriptor_set(bp, pl, PER_OBJECT, object_set, nullptr);
+        }
+
+        bind_mesh_buffers(cb, *cmd.m_mesh, bound_vertex_buffer, bound_index_buffer);
+        const VkDeviceSize offset = m_indirect.get_args_offset(batch);
+        if (batch.m_is_indexed) {
+            if (multi_draw) {
+                cb.draw_indexed_indirect(args_buffer, offset, batch.m_count);
+                continue;
+            }
+            const auto draws =
+                m_indirect.get_indexed_draws().subspan(batch.m_first, batch.m_count);
+            for (const DrawIndexedIndirectCommand& draw : draws) {
+                cb.draw_indexed(
+                    draw.m_index_count,
+                    draw.m_instance_count,
+                    draw.m_first_index,
+                    static_cast<u32>(draw.m_vertex_offset),
+                    draw.m_first_instance
+                );
+            }
+        } else {
+            if (multi_draw) {
+                cb.draw_indirect(args_buffer, offset, batch.m_count);
+                continue;
+            }
+            const auto draws =
+                m_indirect.get_draws().subspan(batch.m_first, batch.m_count);
+            for (const DrawIndirectCommand& draw : draws) {
+                cb.draw(
+                    draw.m_vertex_count,
+                    draw.m_instance_count,
+                    draw.m_first_vertex,
+                    draw.m_first_instance
+                );
+            }
+        }
+    }
+}
+
+auto Vulkan_Renderer::render_mesh(
+    vulkan::CommandBuffer& cb,
+    const Mesh*            vertex_data,
+    const GPUMeshData*     gpu_data,
+    u32                    instance_count,
+    u32                    first_instance
+) -> void {
     // const auto& s = vertex_data->m_attributes.at(Mesh::POSITION.m_id);
     const auto& position_attribute = vertex_data->m_attributes.at(Mesh::POSITION.m_id);
     const u32   num_vertices = static_cast<u32>(
@@ -188,19 +675,16 @@ auto Vulkan_Renderer::render_mesh(const Mesh* vertex_data, const GPUMeshData* gp
     );
     const auto& num_indices = static_cast<u32>(vertex_data->m_indices.size());
 
-    const vulkan::Buffer* vertex_buffer =
-        static_cast<vulkan::Buffer*>(gpu_data->m_vertex_buffer->m_handle);
-
-    vulkan::CommandBuffer& cb = m_frames[m_frame_index].m_cmd;
-    cb.bind_vertex_buffer(0, *vertex_buffer, 0);
-
     if (!vertex_data->m_indices.empty()) {
-        const vulkan::Buffer* index_buffer =
-            static_cast<vulkan::Buffer*>(gpu_data->m_index_buffer->m_handle);
-        cb.bind_index_buffer(*index_buffer, 0);
-        cb.draw_indexed(num_indices, 1, 0, 0, 0);
+        cb.draw_indexed(
+            num_indices,
+            instance_count,
+            gpu_data->m_first_index,
+            gpu_data->m_vertex_offset,
+            first_instance
+        );
     } else {
-        cb.draw(num_vertices, 1, 0, 0);
+        cb.draw(num_vertices, instance_count, gpu_data->m_vertex_offset, first_instance);
     }
 }
 
@@ -1,9 +1,16 @@
 #pragma once
+#include <span>
+
 #include "JadeFrame/types.h"
+#include "JadeFrame/utils/thread_pool.h"
 #include "../mesh.h"
 #include "../graphics_shared.h"
+#include "../indirect_draw.h"
 #include "context.h"
+#include "descriptor_allocator.h"
+#include "render_graph.h"
 #include "sync_object.h"
+#include "uniform_ring.h"
 
 namespace JadeFrame {
 
@@ -22,6 +29,7 @@ public:
     auto render(const Camera& camera) -> void override;
     auto present() -> void override;
     auto wait_until_idle() -> void override;
+    [[nodiscard]] auto get_frames_in_flight() const -> u32 override;
     auto clear_background() -> void override;
     auto set_viewport(u32 x, u32 y, u32 width, u32 height) const -> void override;
     auto take_screenshot(const char* filename) -> Image override;
@@ -51,16 +59,42 @@ public:
         u32                    m_index;
 
         vulkan::CommandBuffer m_cmd;
+        // One pool and secondary buffer per worker of the thread pool. A pool may only be
+        // used by one thread at a time, and it is only reset once the frame has finished.
+        std::vector<vulkan::CommandPool>   m_worker_pools;
+        std::vector<vulkan::CommandBuffer> m_worker_cmds;
 
         Sync m_sync;
-
-        auto init(vulkan::LogicalDevice* device) -> void {
+        /// The sets of the uniform ring, reset once the fence was waited on.
+        vulkan::DescriptorSetCache m_descriptors;
+        /// Of the indirect draws, only rewritten once the fence was waited on.
+        vulkan::Buffer*            m_indirect_transform_buffer = nullptr;
+        vulkan::Buffer*            m_indirect_args_buffer = nullptr;
+
+        /// The world matrices of `RenderSystem::m_scene` by id, see `upload_objects`.
+        vulkan::Buffer*                   m_object_buffer = nullptr;
+        /// The ids changed since the frame was last drawn.
+        std::vector<RenderScene::IdRange> m_dirty_objects;
+
+        auto init(vulkan::LogicalDevice* device, u32 worker_count) -> void {
             m_device = device;
             m_index = 0;
+            m_descriptors = vulkan::DescriptorSetCache(*device);
             m_sync.m_in_flight = device->create_fence(true);
             m_sync.m_sem_available = device->create_semaphore();
             m_sync.m_sem_finished = device->create_semaphore();
             m_cmd = device->m_command_pool.allocate_buffer();
+
+            // Same queue family as the primary buffer. The buffers point to their pool,
+            // so the pools must not move afterwards.
+            vulkan::QueueFamily* queue_family = device->m_command_pool.m_queue_family;
+            m_worker_pools.resize(worker_count);
+            m_worker_cmds.clear();
+            for (vulkan::CommandPool& pool : m_worker_pools) {
+                pool = device->create_command_pool(*queue_family);
+                const auto level = vulkan::CommandBuffer::LEVEL::SECONDARY;
+                m_worker_cmds.push_back(std::move(pool.allocate_buffers(1, level)[0]));
+            }
         }
 
         auto acquire_image(vulkan::Swapchain& swapchain) -> void {
@@ -71,13 +105,16 @@ public:
             m_index = swapchain.acquire_image_index(&m_sync.m_sem_available, nullptr);
         }
 
-        auto submit(vulkan::Queue& queue) -> void {
+        /// Waits for the uploads up to `upload` before running.
+        auto submit(vulkan::Queue& queue, u64 upload) -> void {
             m_sync.m_in_flight.reset();
             queue.submit(
                 m_cmd,
                 &m_sync.m_sem_available,
                 &m_sync.m_sem_finished,
-                &m_sync.m_in_flight
+                &m_sync.m_in_flight,
+                m_device->m_uploader->m_timeline,
+                upload
             );
         }
 
@@ -88,6 +125,7 @@ public:
 
     std::vector<Frame> m_frames;
     size_t             m_frame_index = 0;
+    ThreadPool         m_thread_pool;
 
     vulkan::Swapchain                m_swapchain;
     vulkan::RenderPass               m_render_pass;
@@ -95,8 +133,60 @@ public:
     bool                             m_framebuffer_resized = false;
     bool                             m_skip_present = false;
 
+    /// The pipelines of all shaders. They do not depend on the extent, so they outlive
+    /// the swapchain.
+    vulkan::PipelineStateCache m_pipelines;
+
+    /// Compiled again whenever the swapchain is recreated.
+    vulkan::RenderGraph             m_graph;
+    vulkan::RenderGraph::ResourceId m_color_target = vulkan::RenderGraph::INVALID;
+
+private:
+    /// A run of instances whose transforms are already written at `m_dyn_offset` of the
+    /// buffer of `m_object_set`, the ring or the object buffer of the frame.
+    struct Draw {
+        const RenderCommand*         m_command = nullptr;
+        const vulkan::DescriptorSet* m_object_set = nullptr;
+        u32                          m_instance_count = 1;
+        /// Into the bound transforms, only the object buffer is not bound at the first.
+        u32                          m_first_instance = 0;
+        /// Of the transforms in the ring, that of the camera if the transform is pushed.
+        u32                          m_dyn_offset = 0;
+    };
+
+    std::vector<Draw> m_draws;
+
+    /// The uniform data of the frames in flight, written anew every frame.
+    std::unique_ptr<vulkan::UniformRing> m_uniform_ring;
+    u32                                  m_camera_offset = 0;
+
+    /// The draws of the materials whose shader reads the transforms from a storage
+    /// buffer. Each frame in flight has buffers of its own, see `Frame`.
+    IndirectDrawList m_indirect;
+    std::vector<u8>  m_indirect_args;
+
 private:
     auto recreate_swapchain() -> void;
-    auto render_mesh(const Mesh* vertex_data, const GPUMeshData* gpu_data) -> void;
+    auto build_render_graph() -> void;
+    /// Records the draws of the current frame into its framebuffer.
+    auto record_main_pass(vulkan::CommandBuffer& cb) -> void;
+    /// Sets the viewport and scissor, which every command buffer of the pass needs.
+    auto set_dynamic_state(vulkan::CommandBuffer& cb) const -> void;
+    /// Only records, so it can run on several threads with different command buffers.
+    auto record_draws(vulkan::CommandBuffer& cb, std::span<const Draw> draws) -> void;
+    /// Writes `m_indirect` into the buffers of `frame` and binds them to the materials.
+    auto upload_indirect_draws(Frame& frame) -> void;
+    /// Writes the matrices of the dirty ids into the object buffer of `frame`, which has
+    /// room for `padding` bytes after the last id.
+    auto upload_objects(Frame& frame, u64 padding) -> void;
+    auto record_indirect_draws(vulkan::CommandBuffer& cb) -> void;
+    /// The buffers of the mesh have to be bound already.
+    static auto render_mesh(
+        vulkan::CommandBuffer& cb,
+        const Mesh*            vertex_data,
+        const GPUMeshData*     gpu_data,
+        u32                    instance_count,
+        u32                    first_instance
+    ) -> void;
 };
 } // namespace JadeFrame
@@ -1,20 +1,22 @@
 #include "shader.h"
+#include "descriptor_allocator.h"
 #include "logical_device.h"
 #include "buffer.h"
 #include "renderer.h"
+#include "uniform_ring.h"
 
 namespace JadeFrame {
 
 Vulkan_Shader::Vulkan_Shader(
     const vulkan::LogicalDevice& device,
-    const Vulkan_Renderer&       renderer,
+    Vulkan_Renderer&             renderer,
     const Desc&                  desc
 )
     : m_device(&device) {
 
     Logger::info("Creating Vulkan shader");
-    m_pipeline = vulkan::Pipeline(
-        device, renderer.m_swapchain.m_extent, renderer.m_render_pass, desc.code
+    m_pipeline = renderer.m_pipelines.get(
+        device, renderer.m_render_pass, desc.code, vulkan::PipelineState{}
     );
     Logger::info("Created Vulkan shader");
 }
@@ -24,7 +26,7 @@ auto Vulkan_Shader::get_location(const std::string& name) -> std::tuple<u32, u32
     bool found = false;
     u32  set = 0;
     u32  binding = 0;
-    for (auto& module : m_pipeline.m_reflected_code.m_modules) {
+    for (auto& module : m_pipeline->m_reflected_code.m_modules) {
         for (size_t j = 0; j < module.m_uniform_buffers.size(); j++) {
             auto& uniform_buffer = module.m_uniform_buffers[j];
             if (uniform_buffer.name == name) {
@@ -39,15 +41,21 @@ auto Vulkan_Shader::get_location(const std::string& name) -> std::tuple<u32, u32
     return {set, binding};
 }
 
-static constexpr auto ceil_to_aligned(const u64 value, const u64 alignment) -> u64 {
-#if 0 // more efficient
-        const u64 new_val = (value + alignment - 1) & ~(alignment - 1);
-        const u64 aligned_block_size = alignment > 0 ? new_val : value;
-#else // more readable
-    const u64 new_val = (value + alignment - (value % alignment));
-    const u64 aligned_block_size = (value % alignment == 0) ? value : new_val;
-#endif
-    return aligned_block_size;
+/// The sets of the buffers the renderer rewrites every frame, the dynamic uniform buffers
+/// of the ring and the storage buffers of the indirect draws. They come from the frame,
+/// see `bind_frame_sets` and `bind_frame_storage_buffer`.
+static auto is_frame_set(const vulkan::DescriptorSetLayout& layout) -> bool {
+    bool has_storage_buffer = false;
+    for (const VkDescriptorSetLayoutBinding& binding : layout.m_bindings) {
+        has_storage_buffer |= binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    }
+    if (layout.m_dynamic_count == 0 && !has_storage_buffer) { return false; }
+    // The renderer binds each set with a single buffer and at most one offset.
+    JF_ASSERT(
+        layout.m_bindings.size() == 1 && layout.m_dynamic_count <= 1,
+        "A set with a buffer of the frame may have no other bindings"
+    );
+    return true;
 }
 
 Vulkan_Material::Vulkan_Material(
@@ -59,10 +67,14 @@ Vulkan_Material::Vulkan_Material(
     , m_shader(&shader)
     , m_texture(texture) {
 
-    const auto& pipeline = m_shader->m_pipeline;
+    const auto&    pipeline = *m_shader->m_pipeline;
+    constexpr auto PER_MATERIAL = vulkan::FREQUENCY::PER_MATERIAL;
     for (size_t i = 0; i < pipeline.m_set_layouts.size(); i++) {
+        // The renderer binds the set of the `BindlessTextures` instead.
+        if (pipeline.m_is_bindless && i == PER_MATERIAL) { continue; }
         const auto& set_layout = pipeline.m_set_layouts[i];
-        m_sets[i] = device.m_set_pool.allocate_set(set_layout);
+        if (is_frame_set(set_layout)) { continue; }
+        m_sets[i] = device.m_set_allocator.allocate(set_layout);
     }
 
     for (const auto& uniform_buffer : pipeline.m_reflected_interface.m_uniform_buffers) {
@@ -70,13 +82,21 @@ Vulkan_Material::Vulkan_Material(
         u32 binding = uniform_buffer.binding;
         u32 size = uniform_buffer.size;
 
-        JF_ASSERT(size == sizeof(mat4x4), "Uniform buffer size is not 64 bytes");
+        JF_ASSERT(
+            size % sizeof(mat4x4) == 0,
+            "Uniform buffer size is not a multiple of 64 bytes"
+        );
+        // Bound by `bind_frame_sets`.
+        if (pipeline.m_set_layouts[set].m_dynamic_count != 0) { continue; }
+        // The materials of the pipeline share the sets, see `bind_material`.
+        JF_ASSERT(!pipeline.m_is_bindless, "bindless materials own no uniform buffers");
         vulkan::Buffer* buf =
             device.create_buffer(vulkan::Buffer::TYPE::UNIFORM, nullptr, size);
         this->bind_buffer(set, binding, *buf, 0, size);
         m_uniform_buffers[set][binding] = buf;
     }
     for (const auto& sampled_image : pipeline.m_reflected_interface.m_sampled_images) {
+        if (sampled_image.is_runtime_array) { continue; }
         u32 set_index = sampled_image.set;
         u32 binding_index = sampled_image.binding;
         if (m_texture != nullptr) {
@@ -89,6 +109,12 @@ Vulkan_Material::Vulkan_Material(
             set.update();
         }
     }
+    if (pipeline.m_is_bindless) {
+        JF_ASSERT(m_texture != nullptr, "the shader samples the texture of the material");
+        m_material_index = device.m_bindless->add_material({
+            .m_texture = m_texture->m_bindless_index,
+        });
+    }
 }
 
 Vulkan_Material::~Vulkan_Material() {
@@ -102,6 +128,11 @@ Vulkan_Material::~Vulkan_Material() {
         }
     }
     m_uniform_buffers.clear();
+    for (vulkan::DescriptorSet& set : m_sets) { m_device->m_set_allocator.free(set); }
+    if (m_material_index != vulkan::BindlessTextures::INVALID_INDEX &&
+        m_device->m_bindless != nullptr) {
+        m_device->m_bindless->remove_material(m_material_index);
+    }
 }
 
 auto Vulkan_Material::bind_buffer(
@@ -121,6 +152,32 @@ auto Vulkan_Material::rebind_buffer(u32 set, u32 binding, const vulkan::Buffer&
     m_sets[set].update();
 }
 
+auto Vulkan_Material::bind_frame_storage_buffer(
+    vulkan::DescriptorSetCache& cache,
+    u32                         set,
+    u32                         binding,
+    const vulkan::Buffer&       buffer
+) -> void {
+    const vulkan::DescriptorSetCache::BufferBinding buffer_binding = {
+        .m_binding = binding,
+        .m_buffer = &buffer,
+        .m_range = VK_WHOLE_SIZE,
+    };
+    const auto& set_layout = m_shader->m_pipeline->m_set_layouts[set];
+    m_frame_sets[set] = &cache.get(set_layout, std::span(&buffer_binding, 1));
+}
+
+auto Vulkan_Material::has_storage_buffer(u32 set, u32 binding) const -> bool {
+    const auto& storage_buffers =
+        m_shader->m_pipeline->m_reflected_interface.m_storage_buffers;
+    for (const auto& storage_buffer : storage_buffers) {
+        if (storage_buffer.set == set && storage_buffer.binding == binding) {
+            return true;
+        }
+    }
+    return false;
+}
+
 auto Vulkan_Material::write_ub(
     vulkan::FREQUENCY frequency,
     u32               index,
@@ -128,30 +185,64 @@ auto Vulkan_Material::write_ub(
     size_t            size,
     size_t            offset
 ) -> void {
-    // TODO: Make it more solid
-
-    if (frequency == vulkan::FREQUENCY::PER_OBJECT) {
-        vulkan::Buffer* ub = m_uniform_buffers[frequency][index];
-        ub->write(data, size, offset);
-    } else {
-        assert(offset == 0);
-        vulkan::Buffer* ub = m_uniform_buffers[frequency][index];
-        ub->write(data, size, offset);
-    }
+    vulkan::Buffer* ub = m_uniform_buffers[frequency][index];
+    JF_ASSERT(ub != nullptr, "the uniform buffer is in the ring");
+    ub->write(data, size, offset);
 }
 
-auto Vulkan_Material::set_dynamic_ub_num(u32 num) -> void {
-    const vulkan::PhysicalDevice* pd = m_device->m_physical_device;
+auto Vulkan_Material::bind_frame_sets(
+    vulkan::DescriptorSetCache& cache,
+    const vulkan::UniformRing&  ring
+) -> void {
+    const auto& pipeline = *m_shader->m_pipeline;
+    for (const auto& uniform_buffer : pipeline.m_reflected_interface.m_uniform_buffers) {
+        const u32   set = uniform_buffer.set;
+        const auto& set_layout = pipeline.m_set_layouts[set];
+        if (set_layout.m_dynamic_count == 0) { continue; }
+        const vulkan::DescriptorSetCache::BufferBinding binding = {
+            .m_binding = uniform_buffer.binding,
+            .m_buffer = ring.m_buffer,
+            .m_range = uniform_buffer.size,
+        };
+        m_frame_sets[set] = &cache.get(set_layout, std::span(&binding, 1));
+    }
+}
 
-    auto type_size = sizeof(mat4x4);
+auto Vulkan_Material::get_set(vulkan::FREQUENCY frequency) const
+    -> const vulkan::DescriptorSet& {
+    const vulkan::DescriptorSet* frame_set = m_frame_sets[frequency];
+    return frame_set != nullptr ? *frame_set : m_sets[frequency];
+}
 
-    const u64 dyn_alignment =
-        ceil_to_aligned(type_size, pd->limits().minUniformBufferOffsetAlignment);
+auto Vulkan_Material::get_frame_set(
+    vulkan::DescriptorSetCache& cache,
+    vulkan::FREQUENCY           frequency,
+    const vulkan::Buffer&       buffer
+) const -> const vulkan::DescriptorSet& {
+    const auto& pipeline = *m_shader->m_pipeline;
+    for (const auto& uniform_buffer : pipeline.m_reflected_interface.m_uniform_buffers) {
+        if (uniform_buffer.set != static_cast<u32>(frequency)) { continue; }
+        const vulkan::DescriptorSetCache::BufferBinding binding = {
+            .m_binding = uniform_buffer.binding,
+            .m_buffer = &buffer,
+            .m_range = uniform_buffer.size,
+        };
+        return cache.get(pipeline.m_set_layouts[frequency], std::span(&binding, 1));
+    }
+    JF_ASSERT(false, "Uniform not found");
+    return m_sets[frequency];
+}
 
-    for (auto& [index, ub] : m_uniform_buffers[vulkan::FREQUENCY::PER_OBJECT]) {
-        if (num * dyn_alignment == ub->m_size) { return; }
-        ub->resize(num * dyn_alignment);
-        this->rebind_buffer(vulkan::FREQUENCY::PER_OBJECT, index, *ub);
+auto Vulkan_Material::get_max_instances(u32 binding) const -> u32 {
+    const u32   set = static_cast<u32>(vulkan::FREQUENCY::PER_OBJECT);
+    const auto& uniform_buffers =
+        m_shader->m_pipeline->m_reflected_interface.m_uniform_buffers;
+    for (const auto& uniform_buffer : uniform_buffers) {
+        if (uniform_buffer.set == set && uniform_buffer.binding == binding) {
+            return static_cast<u32>(uniform_buffer.size / sizeof(mat4x4));
+        }
     }
+    JF_ASSERT(false, "Uniform not found");
+    return 1;
 }
 } // namespace JadeFrame
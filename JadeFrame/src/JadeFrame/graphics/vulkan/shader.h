@@ -2,6 +2,7 @@
 #include <tuple>
 #include <unordered_map>
 #include "../graphics_shared.h"
+#include "bindless.h"
 #include "pipeline.h"
 
 
@@ -9,6 +10,8 @@ namespace JadeFrame {
 namespace vulkan {
 class LogicalDevice;
 class Buffer;
+class UniformRing;
+class DescriptorSetCache;
 } // namespace vulkan
 class Vulkan_Renderer;
 
@@ -21,9 +24,10 @@ public:
     Vulkan_Shader(Vulkan_Shader&&) noexcept = default;
     auto operator=(Vulkan_Shader&&) -> Vulkan_Shader& = default;
 
+    /// The pipeline is shared by identical shaders, it is compiled when first drawn.
     Vulkan_Shader(
         const vulkan::LogicalDevice& device,
-        const Vulkan_Renderer&       renderer,
+        Vulkan_Renderer&             renderer,
         const Desc&                  desc
     );
 
@@ -31,7 +35,8 @@ public:
 
 public:
     const vulkan::LogicalDevice* m_device = nullptr;
-    vulkan::Pipeline             m_pipeline;
+    /// Owned by the `PipelineStateCache` of the renderer.
+    vulkan::Pipeline*            m_pipeline = nullptr;
 };
 
 class Vulkan_Material {
@@ -58,7 +63,17 @@ public:
         VkDeviceSize          range
     ) -> void;
     auto rebind_buffer(u32 set, u32 binding, const vulkan::Buffer& buffer) -> void;
+    /// The storage buffers are owned by the renderer, each frame in flight has its own.
+    /// Like those of the ring, their sets are taken from the cache of the frame.
+    auto bind_frame_storage_buffer(
+        vulkan::DescriptorSetCache& cache,
+        u32                         set,
+        u32                         binding,
+        const vulkan::Buffer&       buffer
+    ) -> void;
+    [[nodiscard]] auto has_storage_buffer(u32 set, u32 binding) const -> bool;
 
+    /// Only for the uniform buffers the material owns, not those in the `UniformRing`.
     auto write_ub(
         vulkan::FREQUENCY frequency,
         u32               index,
@@ -67,13 +82,35 @@ public:
         size_t            offset
     ) -> void;
 
-    auto set_dynamic_ub_num(u32 num) -> void;
+    /// The dynamic uniform buffers are in the ring, each frame binds its data with the
+    /// offsets. Their sets are taken from the `DescriptorSetCache` of the frame, so they
+    /// are shared with the other materials that have the same layouts.
+    auto bind_frame_sets(
+        vulkan::DescriptorSetCache& cache,
+        const vulkan::UniformRing&  ring
+    ) -> void;
+    /// The set from the frame if it has one, else the set of the material.
+    [[nodiscard]] auto get_set(vulkan::FREQUENCY frequency) const
+        -> const vulkan::DescriptorSet&;
+    /// Like the set of `bind_frame_sets` for `frequency`, with `buffer` bound instead of
+    /// the ring.
+    [[nodiscard]] auto get_frame_set(
+        vulkan::DescriptorSetCache& cache,
+        vulkan::FREQUENCY           frequency,
+        const vulkan::Buffer&       buffer
+    ) const -> const vulkan::DescriptorSet&;
+    /// How many transforms the per object uniform buffer at `binding` has room for, which
+    /// is the most instances one draw can have.
+    [[nodiscard]] auto get_max_instances(u32 binding) const -> u32;
 
 public:
     vulkan::LogicalDevice*  m_device = nullptr;
     Vulkan_Shader*          m_shader = nullptr;
     vulkan::Vulkan_Texture* m_texture = nullptr;
     std::array<vulkan::DescriptorSet, static_cast<u8>(vulkan::FREQUENCY::MAX)> m_sets;
+    /// Set by `bind_frame_sets`, only valid during the frame that called it.
+    std::array<const vulkan::DescriptorSet*, static_cast<u8>(vulkan::FREQUENCY::MAX)>
+        m_frame_sets = {};
 
     template<typename K, typename V>
     using HashMap = std::unordered_map<K, V>;
@@ -82,5 +119,7 @@ public:
     using Hashmap2 = std::unordered_map<K0, HashMap<K0, V>>;
 
     Hashmap2<u32, vulkan::Buffer*> m_uniform_buffers;
+    /// Of its parameters in the `BindlessTextures`, if the shader uses them.
+    u32 m_material_index = vulkan::BindlessTextures::INVALID_INDEX;
 };
 } // namespace JadeFrame
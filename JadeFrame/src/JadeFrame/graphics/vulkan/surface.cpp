@@ -1,5 +1,7 @@
 #include "surface.h"
 #include "context.h"
+#include "platform/headless/surface.h"
+#include "JadeFrame/platform/headless_window.h"
 #if defined(_WIN32)
     #include "JadeFrame/platform/windows/windows_window.h"
     #include "platform/win32/surface.h"
@@ -33,6 +35,12 @@ Surface::Surface(VkInstance instance, Window* window_handle)
     , m_instance(instance) {
     Logger::trace("Surface::init start");
 
+    if (dynamic_cast<Headless_NativeWindow*>(window_handle->m_native_window.get()) !=
+        nullptr) {
+        m_handle = headless::create_surface(instance, window_handle);
+        Logger::trace("Surface::init end");
+        return;
+    }
 #if _WIN32
     m_handle = win32::create_surface(instance, window_handle);
 #elif __linux__
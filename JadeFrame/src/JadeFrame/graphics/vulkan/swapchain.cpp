@@ -90,10 +90,9 @@ static auto choose_extent(
 
         return actual_extent;
 #elif __linux__
-        const auto* win = static_cast<const JadeFrame::X11_NativeWindow*>(
-            surface.m_window_handle->m_native_window.get()
-        );
-        return VkExtent2D{win->m_size.x, win->m_size.y};
+        // NOTE: Through the platform window, so it also works for headless windows.
+        const v2u32& size = surface.m_window_handle->get_size();
+        return VkExtent2D{size.x, size.y};
 #else
         assert(false && "not implemented yet");
         return {};
@@ -107,7 +106,8 @@ static auto choose_extent(
 
 RenderPass::RenderPass(RenderPass&& other) noexcept
     : m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
-    , m_device(std::exchange(other.m_device, nullptr)) {}
+    , m_device(std::exchange(other.m_device, nullptr))
+    , m_image_format(std::exchange(other.m_image_format, VK_FORMAT_UNDEFINED)) {}
 
 auto RenderPass::operator=(RenderPass&& other) noexcept -> RenderPass& {
     if (this == &other) { return *this; }
@@ -116,6 +116,7 @@ auto RenderPass::operator=(RenderPass&& other) noexcept -> RenderPass& {
     }
     m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
     m_device = std::exchange(other.m_device, nullptr);
+    m_image_format = std::exchange(other.m_image_format, VK_FORMAT_UNDEFINED);
     return *this;
 }
 
@@ -128,7 +129,8 @@ RenderPass::~RenderPass() {
 }
 
 RenderPass::RenderPass(const LogicalDevice& device, VkFormat image_format)
-    : m_device(&device) {
+    : m_device(&device)
+    , m_image_format(image_format) {
     const VkAttachmentDescription color_attachment = {
         .flags = {},
         .format = image_format,
@@ -137,8 +139,9 @@ RenderPass::RenderPass(const LogicalDevice& device, VkFormat image_format)
         .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
         .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        // The render graph transitions the images before and after the pass.
+        .initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
     };
 
     const VkAttachmentReference color_attachment_ref = {
@@ -154,7 +157,7 @@ RenderPass::RenderPass(const LogicalDevice& device, VkFormat image_format)
         .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
         .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
     };
     const VkAttachmentReference depth_attachment_ref = {
@@ -37,6 +37,9 @@ public:
 public:
     VkRenderPass         m_handle = VK_NULL_HANDLE;
     const LogicalDevice* m_device = nullptr;
+    /// Render passes with the same formats are compatible, they can use the same
+    /// pipelines.
+    VkFormat             m_image_format = VK_FORMAT_UNDEFINED;
 };
 
 class Framebuffer {
@@ -102,5 +102,69 @@ Semaphore::Semaphore(LogicalDevice& device)
     JF_ASSERT(result == VK_SUCCESS, "");
 }
 
+TimelineSemaphore::TimelineSemaphore(TimelineSemaphore&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, VK_NULL_HANDLE))
+    , m_device(std::exchange(other.m_device, nullptr)) {}
+
+auto TimelineSemaphore::operator=(TimelineSemaphore&& other) noexcept
+    -> TimelineSemaphore& {
+    if (this != &other) {
+        if (m_handle != VK_NULL_HANDLE && m_device != nullptr) {
+            vkDestroySemaphore(m_device->m_handle, m_handle, Instance::allocator());
+        }
+        m_handle = std::exchange(other.m_handle, VK_NULL_HANDLE);
+        m_device = std::exchange(other.m_device, nullptr);
+    }
+    return *this;
+}
+
+TimelineSemaphore::~TimelineSemaphore() {
+    if (m_handle != VK_NULL_HANDLE && m_device != nullptr) {
+        vkDestroySemaphore(m_device->m_handle, m_handle, Instance::allocator());
+        m_handle = VK_NULL_HANDLE;
+        m_device = nullptr;
+    }
+}
+
+TimelineSemaphore::TimelineSemaphore(const LogicalDevice& device, u64 initial_value)
+    : m_device(&device) {
+
+    const VkSemaphoreTypeCreateInfo type_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .pNext = nullptr,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = initial_value,
+    };
+    const VkSemaphoreCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+        .flags = 0,
+    };
+
+    VkResult result =
+        vkCreateSemaphore(device.m_handle, &info, Instance::allocator(), &m_handle);
+    JF_ASSERT(result == VK_SUCCESS, "");
+}
+
+auto TimelineSemaphore::get_value() const -> u64 {
+    u64      value = 0;
+    VkResult result = vkGetSemaphoreCounterValue(m_device->m_handle, m_handle, &value);
+    JF_ASSERT(result == VK_SUCCESS, "");
+    return value;
+}
+
+auto TimelineSemaphore::wait(u64 value, u64 timeout) const -> void {
+    const VkSemaphoreWaitInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .semaphoreCount = 1,
+        .pSemaphores = &m_handle,
+        .pValues = &value,
+    };
+    VkResult result = vkWaitSemaphores(m_device->m_handle, &info, timeout);
+    JF_ASSERT(result == VK_SUCCESS, "");
+}
+
 } // namespace vulkan
 } // namespace JadeFrame
@@ -1,6 +1,8 @@
 #pragma once
 #include <vulkan/vulkan.h>
 
+#include "JadeFrame/types.h"
+
 namespace JadeFrame {
 
 namespace vulkan {
@@ -41,5 +43,25 @@ public:
     VkSemaphore    m_handle = VK_NULL_HANDLE;
     LogicalDevice* m_device = nullptr;
 };
+
+// A semaphore with a 64 bit counter which only grows. The GPU waits for and signals
+// values, the host can query and wait for them too. Needs Vulkan 1.2.
+class TimelineSemaphore {
+public:
+    TimelineSemaphore() = default;
+    ~TimelineSemaphore();
+    TimelineSemaphore(const TimelineSemaphore&) = delete;
+    auto operator=(const TimelineSemaphore&) -> TimelineSemaphore& = delete;
+    TimelineSemaphore(TimelineSemaphore&&) noexcept;
+    auto operator=(TimelineSemaphore&&) noexcept -> TimelineSemaphore&;
+
+    TimelineSemaphore(const LogicalDevice& device, u64 initial_value);
+
+    [[nodiscard]] auto get_value() const -> u64;
+    auto               wait(u64 value, u64 timeout) const -> void;
+
+    VkSemaphore          m_handle = VK_NULL_HANDLE;
+    const LogicalDevice* m_device = nullptr;
+};
 } // namespace vulkan
 } // namespace JadeFrame
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "uniform_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "JadeFrame/math/math.h"
+#include "JadeFrame/utils/assert.h"
+
+#include "logical_device.h"
+#include "physical_device.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+UniformRing::UniformRing(const LogicalDevice& device, u32 frame_count)
+    : m_device(&device)
+    , m_frame_count(frame_count)
+    , m_alignment(device.m_physical_device->limits().minUniformBufferOffsetAlignment) {}
+
+UniformRing::~UniformRing() {
+    if (m_buffer == nullptr) { return; }
+    m_buffer->unmap();
+    m_device->destroy_buffer(m_buffer);
+}
+
+auto UniformRing::begin_frame(u32 frame, VkDeviceSize size) -> bool {
+    JF_ASSERT(frame < m_frame_count, "");
+    bool is_replaced = false;
+    if (m_region_size < size) {
+        // Only grows, by at least half, so a growing scene does not replace it every
+        // frame. The other regions may still be read.
+        m_region_size = math::ceil_to_aligned(
+            std::max(size, m_region_size + m_region_size / 2), m_alignment
+        );
+        const VkDeviceSize buffer_size = m_region_size * m_frame_count;
+        if (m_buffer == nullptr) {
+            const auto type = Buffer::TYPE::UNIFORM;
+            m_buffer = m_device->create_buffer(type, nullptr, buffer_size);
+        } else {
+            m_device->wait_until_idle();
+            m_buffer->unmap();
+            m_buffer->resize(buffer_size);
+        }
+        m_data = m_buffer->map();
+        is_replaced = true;
+    }
+    m_head = frame * m_region_size;
+    m_end = m_head + m_region_size;
+    return is_replaced;
+}
+
+auto UniformRing::write(const void* data, VkDeviceSize size) -> u32 {
+    JF_ASSERT(m_head + size <= m_end, "the frame reserved too little");
+    const VkDeviceSize offset = m_head;
+    std::memcpy(m_data + offset, data, size);
+    m_head = math::ceil_to_aligned(offset + size, m_alignment);
+    return static_cast<u32>(offset);
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,52 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/prelude.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class LogicalDevice;
+class Buffer;
+
+/*
+    The uniform data the host writes every frame, like the camera and the transforms. One
+   uniform buffer stays mapped, with a region for every frame in flight. A frame only
+   writes into its own region, which the GPU is done with once the fence of the frame was
+   waited on, so nothing is written while an earlier frame still reads it.
+    The writes are aligned to `minUniformBufferOffsetAlignment` and bound with dynamic
+   offsets, the descriptors only change when the buffer has to grow.
+*/
+class UniformRing {
+public:
+    UniformRing(const LogicalDevice& device, u32 frame_count);
+    ~UniformRing();
+    UniformRing(const UniformRing&) = delete;
+    auto operator=(const UniformRing&) -> UniformRing& = delete;
+    UniformRing(UniformRing&&) = delete;
+    auto operator=(UniformRing&&) -> UniformRing& = delete;
+
+    /// Starts writing at the front of the region of `frame`. If the regions are smaller
+    /// than `size`, the buffer is replaced by a larger one, which waits for the device.
+    /// Returns whether it was, then the buffer has to be bound again.
+    auto begin_frame(u32 frame, VkDeviceSize size) -> bool;
+    /// Copies `data` into the region of the frame. Returns the offset to bind it with.
+    auto write(const void* data, VkDeviceSize size) -> u32;
+
+    [[nodiscard]] auto get_alignment() const -> VkDeviceSize { return m_alignment; }
+
+public:
+    Buffer* m_buffer = nullptr;
+
+private:
+    const LogicalDevice* m_device = nullptr;
+    u8*                  m_data = nullptr;
+    u32                  m_frame_count = 0;
+    VkDeviceSize         m_alignment = 0;
+    VkDeviceSize         m_region_size = 0;
+    /// The next write of the current frame and the end of its region.
+    VkDeviceSize         m_head = 0;
+    VkDeviceSize         m_end = 0;
+};
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,367 @@
+#include "uploader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "JadeFrame/utils/assert.h"
+
+#include "logical_device.h"
+#include "physical_device.h"
+
+namespace JadeFrame {
+namespace vulkan {
+
+/// Enough for the offsets of buffer copies and the texels of most formats.
+constexpr static VkDeviceSize STAGING_ALIGNMENT = 16;
+
+static auto make_buffer_barrier(
+    VkBuffer            buffer,
+    const VkBufferCopy& region,
+    u32                 src_family,
+    u32                 dst_family
+) -> VkBufferMemoryBarrier {
+    return VkBufferMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = src_family,
+        .dstQueueFamilyIndex = dst_family,
+        .buffer = buffer,
+        .offset = region.dstOffset,
+        .size = region.size,
+    };
+}
+
+static auto make_image_barrier(
+    VkImage       image,
+    VkImageLayout old_layout,
+    VkImageLayout new_layout,
+    u32           src_family,
+    u32           dst_family
+) -> VkImageMemoryBarrier {
+    return VkImageMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = 0,
+        .oldLayout = old_layout,
+        .newLayout = new_layout,
+        .srcQueueFamilyIndex = src_family,
+        .dstQueueFamilyIndex = dst_family,
+        .image = image,
+        .subresourceRange = {
+                             .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                             .baseMipLevel = 0,
+                             .levelCount = 1,
+                             .baseArrayLayer = 0,
+                             .layerCount = 1,
+                             },
+    };
+}
+
+Uploader::Uploader(const LogicalDevice& device, VkDeviceSize capacity)
+    : m_timeline(device, 0)
+    , m_device(&device)
+    , m_queue(&device.m_transfer_queue)
+    , m_ring(capacity) {
+
+    const QueueFamilyPointers& families =
+        device.m_physical_device->m_chosen_queue_family_pointers;
+    m_pool = CommandPool(device, *families.m_transfer_family);
+    m_transfer_family = families.m_transfer_family->m_index;
+    m_graphics_family = families.m_graphics_family->m_index;
+
+    m_ring_buffer = device.create_buffer(Buffer::TYPE::STAGING, nullptr, capacity);
+    m_ring_data = m_ring_buffer->map();
+}
+
+Uploader::~Uploader() {
+    this->wait(this->flush());
+    m_ring_buffer->unmap();
+    m_device->destroy_buffer(m_ring_buffer);
+}
+
+auto Uploader::upload(
+    const Buffer& dst,
+    const void*   data,
+    VkDeviceSize  size,
+    VkDeviceSize  offset
+) -> u64 {
+    JF_ASSERT(offset + size <= dst.m_size, "out of bounds");
+    const Staging staging = this->stage(data, size, STAGING_ALIGNMENT);
+    m_buffer_copies.push_back(BufferCopy{
+        .m_src = staging.m_buffer,
+        .m_dst = dst.m_handle,
+        .m_region = {.srcOffset = staging.m_offset, .dstOffset = offset, .size = size},
+    });
+    // `stage` may have flushed the batches before.
+    return m_submitted + 1;
+}
+
+auto Uploader::upload(
+    const Image& dst,
+    const void*  data,
+    VkDeviceSize size,
+    u32          texel_size
+) -> u64 {
+    // The offset of a copy into an image has to be a multiple of 4 and of the texel.
+    const VkDeviceSize alignment = std::lcm(STAGING_ALIGNMENT, VkDeviceSize{texel_size});
+    const Staging      staging = this->stage(data, size, alignment);
+    m_image_copies.push_back(ImageCopy{
+        .m_src = staging.m_buffer,
+        .m_dst = dst.m_handle,
+        .m_region = {
+                     .bufferOffset = staging.m_offset,
+                     .bufferRowLength = 0,
+                     .bufferImageHeight = 0,
+                     .imageSubresource = {
+                                          .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                          .mipLevel = 0,
+                                          .baseArrayLayer = 0,
+                                          .layerCount = 1,
+                                          },
+                     .imageOffset = {0, 0, 0},
+                     .imageExtent = {dst.m_size.x, dst.m_size.y, 1},
+                     },
+    });
+    return m_submitted + 1;
+}
+
+auto Uploader::stage(const void* data, VkDeviceSize size, VkDeviceSize alignment)
+    -> Staging {
+    if (m_is_batch_open) {
+        const VkDeviceSize offset =
+            (m_batch_data.size() + alignment - 1) / alignment * alignment;
+        m_batch_data.resize(offset + size);
+        std::memcpy(m_batch_data.data() + offset, data, size);
+        return Staging{.m_buffer = VK_NULL_HANDLE, .m_offset = offset};
+    }
+    if (size > m_ring.get_capacity()) {
+        Buffer* buffer = m_device->create_buffer(Buffer::TYPE::STAGING, nullptr, size);
+        buffer->write(data, size, 0);
+        m_temporaries.push_back(buffer);
+        return Staging{.m_buffer = buffer->m_handle, .m_offset = 0};
+    }
+
+    this->collect();
+    u64 offset = m_ring.allocate(size, alignment);
+    while (offset == RingAllocator::INVALID) {
+        // The ring is taken by the batches in flight, or by the one being collected.
+        if (m_batches.empty()) { this->flush(); }
+        m_timeline.wait(m_batches.front().m_value, UINT64_MAX);
+        this->collect();
+        offset = m_ring.allocate(size, alignment);
+    }
+    std::memcpy(m_ring_data + offset, data, size);
+    return Staging{.m_buffer = m_ring_buffer->m_handle, .m_offset = offset};
+}
+
+auto Uploader::begin_batch() -> void {
+    JF_ASSERT(!m_is_batch_open, "the batch was not ended");
+    // The batch is submitted on its own.
+    this->flush();
+    m_is_batch_open = true;
+}
+
+auto Uploader::end_batch() -> u64 {
+    JF_ASSERT(m_is_batch_open, "the batch was not begun");
+    m_is_batch_open = false;
+    if (m_batch_data.empty()) { return m_submitted; }
+
+    Buffer* buffer =
+        m_device->create_buffer(Buffer::TYPE::STAGING, nullptr, m_batch_data.size());
+    buffer->write(m_batch_data.data(), m_batch_data.size(), 0);
+    m_temporaries.push_back(buffer);
+    for (BufferCopy& copy : m_buffer_copies) { copy.m_src = buffer->m_handle; }
+    for (ImageCopy& copy : m_image_copies) { copy.m_src = buffer->m_handle; }
+    // Loading a scene can take a lot, which is not kept around.
+    m_batch_data = {};
+    return this->flush();
+}
+
+auto Uploader::flush() -> u64 {
+    if (m_is_batch_open) { return m_submitted; }
+    if (m_buffer_copies.empty() && m_image_copies.empty()) { return m_submitted; }
+
+    // With a family of its own, the transfer queue releases the resources to the
+    // graphics family. Otherwise only the images change their layout, the semaphore
+    // makes the writes visible to the frame.
+    const bool is_shared = m_transfer_family == m_graphics_family;
+    const u32  src_family = is_shared ? VK_QUEUE_FAMILY_IGNORED : m_transfer_family;
+    const u32  dst_family = is_shared ? VK_QUEUE_FAMILY_IGNORED : m_graphics_family;
+
+    std::vector<VkImageMemoryBarrier>  to_transfer;
+    std::vector<VkImageMemoryBarrier>  image_releases;
+    std::vector<VkBufferMemoryBarrier> buffer_releases;
+    for (const ImageCopy& copy : m_image_copies) {
+        VkImageMemoryBarrier barrier = make_image_barrier(
+            copy.m_dst,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED
+        );
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        to_transfer.push_back(barrier);
+
+        barrier = make_image_barrier(
+            copy.m_dst,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            src_family,
+            dst_family
+        );
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        image_releases.push_back(barrier);
+    }
+    if (!is_shared) {
+        for (const BufferCopy& copy : m_buffer_copies) {
+            buffer_releases.push_back(
+                make_buffer_barrier(copy.m_dst, copy.m_region, src_family, dst_family)
+            );
+        }
+    }
+
+    Batch batch;
+    batch.m_value = m_submitted + 1;
+    batch.m_cmd = m_pool.allocate_buffer();
+    batch.m_temporaries = std::move(m_temporaries);
+    m_temporaries.clear();
+
+    const CommandBuffer& cmd = batch.m_cmd;
+    batch.m_cmd.record_begin();
+    if (!to_transfer.empty()) {
+        vkCmdPipelineBarrier(
+            cmd.m_handle,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            static_cast<u32>(to_transfer.size()),
+            to_transfer.data()
+        );
+    }
+    for (const BufferCopy& copy : m_buffer_copies) {
+        vkCmdCopyBuffer(cmd.m_handle, copy.m_src, copy.m_dst, 1, &copy.m_region);
+    }
+    for (const ImageCopy& copy : m_image_copies) {
+        vkCmdCopyBufferToImage(
+            cmd.m_handle,
+            copy.m_src,
+            copy.m_dst,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1,
+            &copy.m_region
+        );
+    }
+    if (!buffer_releases.empty() || !image_releases.empty()) {
+        vkCmdPipelineBarrier(
+            cmd.m_handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0,
+            nullptr,
+            static_cast<u32>(buffer_releases.size()),
+            buffer_releases.data(),
+            static_cast<u32>(image_releases.size()),
+            image_releases.data()
+        );
+    }
+    batch.m_cmd.record_end();
+    m_queue->submit(cmd, m_timeline, batch.m_value);
+
+    m_submitted = batch.m_value;
+    m_ring.end_batch(m_submitted);
+    m_batches.push_back(std::move(batch));
+    m_buffer_copies.clear();
+    m_image_copies.clear();
+
+    if (!is_shared) {
+        // The acquires repeat the releases, with the access of the graphics queue.
+        for (VkBufferMemoryBarrier& barrier : buffer_releases) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask =
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            m_buffer_acquires.push_back(barrier);
+        }
+        for (VkImageMemoryBarrier& barrier : image_releases) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            m_image_acquires.push_back(barrier);
+        }
+    }
+    return m_submitted;
+}
+
+auto Uploader::record_acquires(const CommandBuffer& cmd) -> u64 {
+    this->flush();
+    if (!m_buffer_acquires.empty() || !m_image_acquires.empty()) {
+        // The submit waits for the batches before these stages.
+        const VkPipelineStageFlags stages =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        vkCmdPipelineBarrier(
+            cmd.m_handle,
+            stages,
+            stages,
+            0,
+            0,
+            nullptr,
+            static_cast<u32>(m_buffer_acquires.size()),
+            m_buffer_acquires.data(),
+            static_cast<u32>(m_image_acquires.size()),
+            m_image_acquires.data()
+        );
+        m_buffer_acquires.clear();
+        m_image_acquires.clear();
+    }
+    this->collect();
+    return m_submitted;
+}
+
+auto Uploader::is_done(u64 value) const -> bool {
+    return value == 0 || value <= m_timeline.get_value();
+}
+
+auto Uploader::wait(u64 value) -> void {
+    if (value == 0) { return; }
+    JF_ASSERT(value <= m_submitted || !m_is_batch_open, "the batch is not submitted yet");
+    if (value > m_submitted) { this->flush(); }
+    m_timeline.wait(value, UINT64_MAX);
+    this->collect();
+}
+
+auto Uploader::forget_buffer(VkBuffer buffer, u64 value) -> void {
+    this->wait(value);
+    std::erase_if(m_buffer_acquires, [&](const VkBufferMemoryBarrier& barrier) {
+        return barrier.buffer == buffer;
+    });
+}
+
+auto Uploader::forget_image(VkImage image, u64 value) -> void {
+    this->wait(value);
+    std::erase_if(m_image_acquires, [&](const VkImageMemoryBarrier& barrier) {
+        return barrier.image == image;
+    });
+}
+
+auto Uploader::collect() -> void {
+    if (m_batches.empty()) { return; }
+
+    const u64 done = m_timeline.get_value();
+    while (!m_batches.empty() && m_batches.front().m_value <= done) {
+        Batch& batch = m_batches.front();
+        m_pool.free_buffer(batch.m_cmd);
+        for (Buffer* buffer : batch.m_temporaries) { m_device->destroy_buffer(buffer); }
+        m_batches.pop_front();
+    }
+    m_ring.release(done);
+}
+
+} // namespace vulkan
+} // namespace JadeFrame
@@ -0,0 +1,141 @@
+#pragma once
+#include <deque>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "JadeFrame/prelude.h"
+#include "JadeFrame/utils/ring_allocator.h"
+#include "command_buffer.h"
+#include "sync_object.h"
+
+namespace JadeFrame {
+namespace vulkan {
+class LogicalDevice;
+class Queue;
+class Buffer;
+class Image;
+
+/*
+    Copies data into device local buffers and images on the transfer queue, without
+   waiting for it. The data is written into a staging ring which stays mapped, and the
+   copies are collected into a batch until `flush` submits them, once per frame by
+   `record_acquires`. Each batch sets the timeline semaphore to its value once done, the
+   `upload`s return that value so the callers can check it with `is_done`.
+    If the transfer queue is of a family of its own, the batch releases the resources to
+   the graphics family and `record_acquires` acquires them on the command buffer of the
+   frame. The frame then waits for the batch when submitted.
+    Data larger than the ring goes through a staging buffer of its own, which is
+   destroyed with its batch.
+    Many uploads at once, like the textures of a scene, are put between `begin_batch` and
+   `end_batch`. They are staged in one buffer of their total size and submitted
+   together, instead of waiting for the ring to drain again and again.
+*/
+class Uploader {
+public:
+    constexpr static VkDeviceSize DEFAULT_CAPACITY = VkDeviceSize{32} * 1024 * 1024;
+
+    explicit Uploader(
+        const LogicalDevice& device,
+        VkDeviceSize         capacity = DEFAULT_CAPACITY
+    );
+    /// Waits for every batch.
+    ~Uploader();
+    Uploader(const Uploader&) = delete;
+    auto operator=(const Uploader&) -> Uploader& = delete;
+    Uploader(Uploader&&) = delete;
+    auto operator=(Uploader&&) -> Uploader& = delete;
+
+    /// `dst` must be a `VERTEX` or `INDEX` buffer. Returns the value of the batch.
+    auto upload(
+        const Buffer& dst,
+        const void*   data,
+        VkDeviceSize  size,
+        VkDeviceSize  offset
+    ) -> u64;
+    /// Copies the whole image and leaves it in `SHADER_READ_ONLY_OPTIMAL`.
+    auto upload(const Image& dst, const void* data, VkDeviceSize size, u32 texel_size)
+        -> u64;
+
+    /// Until `end_batch`, the uploads are neither staged in the ring nor flushed. Their
+    /// data is copied, so it does not have to outlive the `upload` call.
+    auto begin_batch() -> void;
+    /// Stages the uploads since `begin_batch` and submits them. Returns their value.
+    auto end_batch() -> u64;
+
+    /// Submits the collected copies. Returns the value of the last submitted batch.
+    auto flush() -> u64;
+    /// Flushes and records the acquire barriers of the submitted batches into `cmd`.
+    /// Returns the value the submit of `cmd` has to wait for, 0 before the first batch.
+    auto record_acquires(const CommandBuffer& cmd) -> u64;
+
+    /// 0 is always done, it is returned for data which needs no upload.
+    [[nodiscard]] auto is_done(u64 value) const -> bool;
+    auto               wait(u64 value) -> void;
+
+    /// Called before a buffer or image with pending uploads is destroyed.
+    auto forget_buffer(VkBuffer buffer, u64 value) -> void;
+    auto forget_image(VkImage image, u64 value) -> void;
+
+public:
+    TimelineSemaphore m_timeline;
+
+private:
+    struct Staging {
+        VkBuffer     m_buffer = VK_NULL_HANDLE;
+        VkDeviceSize m_offset = 0;
+    };
+
+    struct BufferCopy {
+        VkBuffer     m_src = VK_NULL_HANDLE;
+        VkBuffer     m_dst = VK_NULL_HANDLE;
+        VkBufferCopy m_region = {};
+    };
+
+    struct ImageCopy {
+        VkBuffer          m_src = VK_NULL_HANDLE;
+        VkImage           m_dst = VK_NULL_HANDLE;
+        VkBufferImageCopy m_region = {};
+    };
+
+    struct Batch {
+        u64                  m_value = 0;
+        CommandBuffer        m_cmd;
+        std::vector<Buffer*> m_temporaries;
+    };
+
+    /// Writes `data` into the ring, waits for old batches if it is full.
+    auto stage(const void* data, VkDeviceSize size, VkDeviceSize alignment) -> Staging;
+    /// Frees the batches the transfer queue is done with.
+    auto collect() -> void;
+
+private:
+    const LogicalDevice* m_device = nullptr;
+    const Queue*         m_queue = nullptr;
+    CommandPool          m_pool;
+    u32                  m_transfer_family = 0;
+    u32                  m_graphics_family = 0;
+
+    Buffer*       m_ring_buffer = nullptr;
+    u8*           m_ring_data = nullptr;
+    RingAllocator m_ring;
+
+    /// The batch being collected, it is submitted with the value `m_submitted + 1`.
+    std::vector<BufferCopy> m_buffer_copies;
+    std::vector<ImageCopy>  m_image_copies;
+    std::vector<Buffer*>    m_temporaries;
+
+    /// The data of the uploads since `begin_batch`, their copies have no source yet.
+    std::vector<u8> m_batch_data;
+    bool            m_is_batch_open = false;
+
+    std::deque<Batch> m_batches;
+    u64               m_submitted = 0;
+
+    /// The release barriers of the submitted batches, acquired by the next frame.
+    std::vector<VkBufferMemoryBarrier> m_buffer_acquires;
+    std::vector<VkImageMemoryBarrier>  m_image_acquires;
+};
+
+} // namespace vulkan
+} // namespace JadeFrame
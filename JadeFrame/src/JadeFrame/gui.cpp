@@ -131,9 +131,12 @@ GUI::~GUI() { destroy(); }
 
 auto GUI::init(Window* window, GRAPHICS_API api) -> void {
     JF_ASSERT(window != nullptr, "GUI requires a window");
-    if (api != GRAPHICS_API::VULKAN && api != GRAPHICS_API::OPENGL) {
+    if (api != GRAPHICS_API::VULKAN && api != GRAPHICS_API::OPENGL &&
+        api != GRAPHICS_API::SOFTWARE && api != GRAPHICS_API::TERMINAL) {
         Logger::err("{} is not supported", to_string(api));
-        JF_ASSERT(false, "Right now only VULKAN and OPENGL are supported");
+        JF_ASSERT(
+            false, "Right now only VULKAN, OPENGL, SOFTWARE and TERMINAL are supported"
+        );
     }
     m_window = window;
     m_graphics_api = api;
@@ -191,6 +194,11 @@ auto GUI::init(Window* window, GRAPHICS_API api) -> void {
             // ImGui_ImplVulkan_Init(&info);
             // ImGui_ImplOpenGL3_Init(glsl_version);
         } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: {
+            // NOTE: There is no ImGui backend for the software renderers yet.
+            m_is_initialized = false;
+        } break;
         default: assert(0);
     }
 }
@@ -277,6 +285,8 @@ auto GUI::destroy() -> void {
         case GRAPHICS_API::VULKAN: {
             // ImGui_ImplVulkan_Shutdown();
         } break;
+        case GRAPHICS_API::SOFTWARE:
+        case GRAPHICS_API::TERMINAL: break;
         default: assert(0);
     }
 #if _WIN32
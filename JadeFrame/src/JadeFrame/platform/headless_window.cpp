@@ -0,0 +1,19 @@
+#include "headless_window.h"
+
+namespace JadeFrame {
+
+Headless_NativeWindow::Headless_NativeWindow(const Window::Desc& desc)
+    : m_size(desc.size)
+    , m_title(desc.title) {}
+
+auto Headless_NativeWindow::handle_events(bool& /*is_running*/) -> void {}
+
+auto Headless_NativeWindow::set_title(const std::string& title) -> void {
+    m_title = title;
+}
+
+auto Headless_NativeWindow::get_title() const -> std::string { return m_title; }
+
+auto Headless_NativeWindow::get_size() const -> const v2u32& { return m_size; }
+
+} // namespace JadeFrame
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "window.h"
+
+namespace JadeFrame {
+
+// A native window without a display server. It only has a fixed size, which the renderers
+// use for their offscreen surface, and never produces events. Used for benchmark and CI
+// runs on machines without X11 or Win32 desktop.
+class Headless_NativeWindow : public NativeWindow {
+public:
+    explicit Headless_NativeWindow(const Window::Desc& desc);
+
+    auto handle_events(bool& is_running) -> void override;
+    auto set_title(const std::string& title) -> void override;
+    [[nodiscard]] auto get_title() const -> std::string override;
+    [[nodiscard]] auto get_size() const -> const v2u32& override;
+
+public:
+    v2u32       m_size;
+    std::string m_title;
+};
+} // namespace JadeFrame
@@ -1,5 +1,6 @@
 #include "window.h"
 #include "JadeFrame/platform/window_event.h"
+#include "JadeFrame/platform/headless_window.h"
 #if defined(JF_PLATFORM_LINUX)
     #include "JadeFrame/platform/linux/linux_window.h"
 #elif defined(JF_PLATFORM_WINDOWS)
@@ -34,6 +35,12 @@ auto Window::operator=(Window&& other) noexcept -> Window& {
 }
 
 Window::Window(const Window::Desc& desc) {
+    if (desc.is_headless) {
+        m_native_window = std::make_unique<Headless_NativeWindow>(desc);
+        m_native_window->m_platform_window = this;
+        m_window_state = desc.window_state;
+        return;
+    }
 #if defined(JF_PLATFORM_LINUX)
     m_native_window = std::make_unique<X11_NativeWindow>(X11_NativeWindow::create(desc));
     m_native_window->m_platform_window = this;
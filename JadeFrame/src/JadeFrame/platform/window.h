@@ -50,6 +50,8 @@ public:
         WINDOW_STATE window_state = WINDOW_STATE::WINDOWED;
         bool         visible = true;
         bool         accept_drop_files = false;
+        // No display server connection, see `Headless_NativeWindow`.
+        bool is_headless = false;
     };
 
     explicit Window(const Window::Desc& desc);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "JadeFrame/types.h"
+
+namespace JadeFrame {
+
+/*
+    Hands `N` slots from one producer thread to one consumer thread, in order. The
+   producer fills a slot between `begin_write` and `end_write`, the consumer uses it
+   between `begin_read` and `end_read`, after which the slot is written again. There are
+   no locks, the two threads only share the two counters. A thread only blocks, with
+   `std::atomic::wait`, when the other one is behind: the producer when all slots are
+   written and not yet read, the consumer when none is.
+    With three slots the consumer works on one, one is ready and the producer fills the
+   third.
+*/
+template<typename T, u32 N>
+class FrameRing {
+    static_assert(N >= 2, "the threads need a slot each");
+
+public:
+    FrameRing() = default;
+    ~FrameRing() = default;
+    FrameRing(const FrameRing&) = delete;
+    auto operator=(const FrameRing&) -> FrameRing& = delete;
+    FrameRing(FrameRing&&) = delete;
+    auto operator=(FrameRing&&) -> FrameRing& = delete;
+
+    /// Waits until the consumer is done with the slot.
+    auto begin_write() -> T& {
+        const u64 written = m_written.load(std::memory_order_relaxed) & ~CLOSED;
+        u64       read = m_read.load(std::memory_order_acquire);
+        while (written - read == N) {
+            m_read.wait(read, std::memory_order_acquire);
+            read = m_read.load(std::memory_order_acquire);
+        }
+        return m_slots[written % N];
+    }
+
+    auto end_write() -> void {
+        m_written.fetch_add(1, std::memory_order_release);
+        m_written.notify_one();
+    }
+
+    /// Waits for the next written slot. `nullptr` once the ring is closed and every
+    /// written slot was read.
+    auto begin_read() -> T* {
+        const u64 read = m_read.load(std::memory_order_relaxed);
+        u64       written = m_written.load(std::memory_order_acquire);
+        while ((written & ~CLOSED) == read) {
+            if ((written & CLOSED) != 0) { return nullptr; }
+            m_written.wait(written, std::memory_order_acquire);
+            written = m_written.load(std::memory_order_acquire);
+        }
+        return &m_slots[read % N];
+    }
+
+    auto end_read() -> void {
+        m_read.fetch_add(1, std::memory_order_release);
+        m_read.notify_one();
+    }
+
+    /// Called by the producer after its last `end_write`.
+    auto close() -> void {
+        m_written.fetch_or(CLOSED, std::memory_order_release);
+        m_written.notify_one();
+    }
+
+    /// For setting up the slots before the threads start, not while they run.
+    [[nodiscard]] auto get_slots() -> std::array<T, N>& { return m_slots; }
+
+private:
+    /// Set in `m_written` by `close`, so it wakes a waiting consumer.
+    constexpr static u64 CLOSED = u64{1} << 63;
+
+    std::array<T, N> m_slots;
+    /// The number of slots written and read so far.
+    std::atomic<u64> m_written = 0;
+    std::atomic<u64> m_read = 0;
+};
+
+} // namespace JadeFrame
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "JadeFrame/types.h"
+#include "JadeFrame/utils/assert.h"
+
+namespace JadeFrame {
+
+/*
+    A 32 bit reference into a `HandlePool<T>`. The low bits are the index of the slot, the
+   high bits the generation of the slot when the handle was created. Releasing a slot
+   bumps its generation, so handles to released objects are detected instead of reaching
+   whatever reuses the slot. A slot whose generation would wrap is never reused.
+*/
+template<typename T>
+struct PoolHandle {
+    constexpr static u32 INDEX_BITS = 20;
+    constexpr static u32 GENERATION_BITS = 32 - INDEX_BITS;
+    constexpr static u32 INDEX_MASK = (u32{1} << INDEX_BITS) - 1;
+    constexpr static u32 GENERATION_MASK = (u32{1} << GENERATION_BITS) - 1;
+
+    constexpr PoolHandle() = default;
+    constexpr PoolHandle(u32 index, u32 generation)
+        : m_value(
+              ((generation & GENERATION_MASK) << INDEX_BITS) | (index & INDEX_MASK)
+          ) {}
+
+    [[nodiscard]] constexpr auto index() const -> u32 { return m_value & INDEX_MASK; }
+    [[nodiscard]] constexpr auto generation() const -> u32 {
+        return m_value >> INDEX_BITS;
+    }
+    [[nodiscard]] constexpr auto is_valid() const -> bool { return m_value != ~u32{0}; }
+
+    constexpr auto operator==(const PoolHandle&) const -> bool = default;
+
+    u32 m_value = ~u32{0};
+};
+
+/*
+    Owns objects of type `T` and hands out `PoolHandle<T>`s to them. Lookup, creation and
+   release are O(1), released slots are reused through a free list, so the pool only
+   grows to the peak number of live objects. The slots are stored in blocks, so pointers
+   to live objects stay valid while the pool grows.
+
+    Objects may still be in use after their handle was released, e.g. by frames the GPU
+   has not finished yet. `release` therefore only invalidates the handle. The object is
+   destroyed, and its slot reused, by the first `collect` with at least the `retire_at`
+   it was released with.
+    Once a slot used up its generations it is retired instead, so old handles can not
+   become valid again. That costs one empty slot per `GENERATION_MASK` reuses.
+*/
+template<typename T>
+class HandlePool {
+public:
+    using Handle = PoolHandle<T>;
+
+    HandlePool() = default;
+    ~HandlePool() = default;
+    HandlePool(const HandlePool&) = delete;
+    auto operator=(const HandlePool&) -> HandlePool& = delete;
+    HandlePool(HandlePool&&) noexcept = default;
+    auto operator=(HandlePool&&) noexcept -> HandlePool& = default;
+
+    template<typename... Args>
+    auto create(Args&&... args) -> Handle {
+        u32 index = 0;
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        } else {
+            index = static_cast<u32>(m_slots.size());
+            JF_ASSERT(index < Handle::INDEX_MASK, "handle pool is full");
+            m_slots.emplace_back();
+        }
+        Slot& slot = m_slots[index];
+        slot.m_value.emplace(std::forward<Args>(args)...);
+        slot.m_is_live = true;
+        m_count++;
+        return Handle(index, slot.m_generation);
+    }
+
+    /// `nullptr` if `handle` was released.
+    [[nodiscard]] auto get(Handle handle) -> T* {
+        return this->is_live(handle) ? &*m_slots[handle.index()].m_value : nullptr;
+    }
+    [[nodiscard]] auto get(Handle handle) const -> const T* {
+        return this->is_live(handle) ? &*m_slots[handle.index()].m_value : nullptr;
+    }
+
+    /// Returns false if `handle` was already released.
+    auto release(Handle handle, u64 retire_at = 0) -> bool {
+        if (!this->is_live(handle)) { return false; }
+        Slot& slot = m_slots[handle.index()];
+        slot.m_is_live = false;
+        slot.m_generation++;
+        m_pending.push_back({.m_index = handle.index(), .m_retire_at = retire_at});
+        m_count--;
+        return true;
+    }
+
+    /// Destroys the released objects whose `retire_at` is at most `now`.
+    auto collect(u64 now) -> void {
+        std::erase_if(m_pending, [&](const Pending& pending) {
+            if (pending.m_retire_at > now) { return false; }
+            Slot& slot = m_slots[pending.m_index];
+            slot.m_value.reset();
+            // Its next generation would wrap to one an old handle could still have.
+            if (slot.m_generation < Handle::GENERATION_MASK) {
+                m_free_indices.push_back(pending.m_index);
+            }
+            return true;
+        });
+    }
+
+    /// Destroys all objects, including released ones which did not retire yet.
+    auto clear() -> void {
+        m_slots.clear();
+        m_free_indices.clear();
+        m_pending.clear();
+        m_count = 0;
+    }
+
+    /// Calls `fn(handle, object)` for every live object, in slot order.
+    template<typename Fn>
+    auto for_each(Fn&& fn) -> void {
+        for (u32 i = 0; i < m_slots.size(); i++) {
+            Slot& slot = m_slots[i];
+            if (slot.m_is_live) { fn(Handle(i, slot.m_generation), *slot.m_value); }
+        }
+    }
+
+    /// The number of live objects.
+    [[nodiscard]] auto size() const -> u32 { return m_count; }
+    /// The number of released objects which are not destroyed yet.
+    [[nodiscard]] auto pending_count() const -> u32 {
+        return static_cast<u32>(m_pending.size());
+    }
+    /// The number of slots, live or not. Never more than the peak of `size` plus
+    /// `pending_count`.
+    [[nodiscard]] auto capacity() const -> u32 {
+        return static_cast<u32>(m_slots.size());
+    }
+
+private:
+    struct Slot {
+        std::optional<T> m_value;
+        u32              m_generation = 0;
+        bool             m_is_live = false;
+    };
+    struct Pending {
+        u32 m_index;
+        u64 m_retire_at;
+    };
+
+    [[nodiscard]] auto is_live(Handle handle) const -> bool {
+        if (!handle.is_valid() || handle.index() >= m_slots.size()) { return false; }
+        const Slot& slot = m_slots[handle.index()];
+        return slot.m_is_live && slot.m_generation == handle.generation();
+    }
+
+private:
+    std::deque<Slot>     m_slots;
+    std::vector<u32>     m_free_indices;
+    std::vector<Pending> m_pending;
+    u32                  m_count = 0;
+};
+
+} // namespace JadeFrame
@@ -5,6 +5,7 @@
 
 namespace JadeFrame {
 std::shared_ptr<spdlog::logger> Logger::s_core;
+spdlog::sink_ptr                Logger::s_console;
 
 auto Logger::init() -> void {
     std::vector<spdlog::sink_ptr> jf_sinks = {
@@ -12,6 +13,7 @@ auto Logger::init() -> void {
         std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/JadeFrame.log", true)};
 
     jf_sinks[0]->set_pattern("%^[%T] [%L] %n: %v%$");
+    s_console = jf_sinks[0];
     s_core =
         std::make_shared<spdlog::logger>("JadeFrame", jf_sinks.begin(), jf_sinks.end());
     s_core->set_level(spdlog::level::trace);
@@ -19,6 +21,12 @@ auto Logger::init() -> void {
 
 auto Logger::deinit() -> void {
     s_core.reset();
+    s_console.reset();
     spdlog::drop_all();
 }
+
+auto Logger::set_console_enabled(bool is_enabled) -> void {
+    if (s_console == nullptr) { return; }
+    s_console->set_level(is_enabled ? spdlog::level::trace : spdlog::level::off);
+}
 } // namespace JadeFrame
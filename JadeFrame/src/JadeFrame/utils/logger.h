@@ -52,12 +52,16 @@ public:
 
     static auto init() -> void;
     static auto deinit() -> void;
+    /// Turns the console output on or off, the log file gets everything either way.
+    static auto set_console_enabled(bool is_enabled) -> void;
 
     static std::shared_ptr<spdlog::logger> s_core;
     static std::shared_ptr<spdlog::logger> s_client;
     static std::shared_ptr<spdlog::logger> s_editor;
 
 private:
+    static spdlog::sink_ptr s_console;
+
     static constexpr auto to_spd(Logger::LEVEL level) noexcept
         -> spdlog::level::level_enum {
         using enum Logger::LEVEL;
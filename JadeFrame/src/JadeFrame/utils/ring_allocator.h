@@ -0,0 +1,103 @@
+#pragma once
+
+#include <deque>
+
+#include "JadeFrame/types.h"
+
+namespace JadeFrame {
+
+/*
+    Hands out ranges of a ring buffer in the order they are used. The ranges allocated
+   since the last `end_batch` form a batch, which is tagged with a value that grows with
+   every batch, e.g. of a timeline semaphore. `release` frees the oldest batches up to a
+   value at once, so the ring never has holes.
+    An allocation which does not fit before the end of the ring starts over at 0, the
+   rest of the ring is skipped until its batch is released.
+    Only the bookkeeping, it does not touch any memory.
+*/
+class RingAllocator {
+public:
+    constexpr static u64 INVALID = ~u64{0};
+
+    RingAllocator() = default;
+
+    explicit RingAllocator(u64 capacity)
+        : m_capacity(capacity) {}
+
+    /// The offset is a multiple of `alignment`. `INVALID` if the ring is too full.
+    auto allocate(u64 size, u64 alignment = 1) -> u64 {
+        if (size == 0 || size > m_capacity) { return INVALID; }
+        if (m_used == 0) {
+            // Nothing is in flight, so the next batch may start at the front.
+            m_head = 0;
+            m_tail = 0;
+        }
+
+        if (m_used != 0 && m_head == m_tail) { return INVALID; }
+
+        const u64 offset = (m_head + alignment - 1) / alignment * alignment;
+        u64       result = INVALID;
+        if (m_head >= m_tail) {
+            // Free are the end of the ring and the front up to the tail.
+            if (offset + size <= m_capacity) {
+                result = offset;
+            } else if (size <= m_tail) {
+                result = 0;
+            }
+        } else if (offset + size <= m_tail) {
+            result = offset;
+        }
+        if (result == INVALID) { return INVALID; }
+
+        // The skipped bytes are counted as used until the batch is released.
+        const u64 consumed = result == 0 && m_head != 0 ? m_capacity - m_head + size
+                                                         : result - m_head + size;
+        m_head = result + size;
+        m_used += consumed;
+        m_batch_size += consumed;
+        return result;
+    }
+
+    /// Tags the ranges allocated since the last call with `value`, which must be larger
+    /// than the values before.
+    auto end_batch(u64 value) -> void {
+        if (m_batch_size == 0) { return; }
+        m_batches.push_back(Batch{
+            .m_value = value,
+            .m_end = m_head,
+            .m_size = m_batch_size,
+        });
+        m_batch_size = 0;
+    }
+
+    /// Frees the batches tagged with `completed` or less.
+    auto release(u64 completed) -> void {
+        while (!m_batches.empty() && m_batches.front().m_value <= completed) {
+            m_tail = m_batches.front().m_end;
+            m_used -= m_batches.front().m_size;
+            m_batches.pop_front();
+        }
+    }
+
+    [[nodiscard]] auto get_capacity() const -> u64 { return m_capacity; }
+
+    [[nodiscard]] auto get_used() const -> u64 { return m_used; }
+
+private:
+    struct Batch {
+        u64 m_value = 0;
+        /// Where the ring continues after the batch.
+        u64 m_end = 0;
+        u64 m_size = 0;
+    };
+
+    std::deque<Batch> m_batches;
+    u64               m_capacity = 0;
+    u64               m_head = 0;
+    u64               m_tail = 0;
+    u64               m_used = 0;
+    /// The bytes allocated since the last `end_batch`.
+    u64               m_batch_size = 0;
+};
+
+} // namespace JadeFrame
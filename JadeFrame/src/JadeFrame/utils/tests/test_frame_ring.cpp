@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "JadeFrame/utils/frame_ring.h"
+
+using namespace JadeFrame;
+
+TEST(FrameRing, HandsSlotsOverInOrder) {
+    FrameRing<u32, 3> ring;
+    ring.begin_write() = 1;
+    ring.end_write();
+    ring.begin_write() = 2;
+    ring.end_write();
+
+    EXPECT_EQ(*ring.begin_read(), 1);
+    ring.end_read();
+    EXPECT_EQ(*ring.begin_read(), 2);
+    ring.end_read();
+
+    ring.close();
+    EXPECT_EQ(ring.begin_read(), nullptr);
+}
+
+TEST(FrameRing, ClosingStillHandsOverTheWrittenSlots) {
+    FrameRing<u32, 2> ring;
+    ring.begin_write() = 7;
+    ring.end_write();
+    ring.close();
+
+    const u32* slot = ring.begin_read();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(*slot, 7);
+    ring.end_read();
+    EXPECT_EQ(ring.begin_read(), nullptr);
+}
+
+TEST(FrameRing, ProducerWaitsForTheConsumer) {
+    constexpr u32 COUNT = 10000;
+
+    // Each slot holds its frame, so a skipped or overwritten slot shows in the order.
+    FrameRing<u32, 3> ring;
+    std::vector<u32>  received;
+    received.reserve(COUNT);
+    std::thread consumer([&]() {
+        while (const u32* slot = ring.begin_read()) {
+            received.push_back(*slot);
+            ring.end_read();
+        }
+    });
+    for (u32 i = 0; i < COUNT; i++) {
+        ring.begin_write() = i;
+        ring.end_write();
+    }
+    ring.close();
+    consumer.join();
+
+    ASSERT_EQ(received.size(), COUNT);
+    for (u32 i = 0; i < COUNT; i++) { ASSERT_EQ(received[i], i); }
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "JadeFrame/utils/handle_pool.h"
+
+using namespace JadeFrame;
+
+TEST(HandlePool, CreateAndGet) {
+    HandlePool<i32> pool;
+    const auto      a = pool.create(1);
+    const auto      b = pool.create(2);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(*pool.get(a), 1);
+    EXPECT_EQ(*pool.get(b), 2);
+    EXPECT_EQ(pool.size(), 2U);
+    EXPECT_EQ(pool.get(HandlePool<i32>::Handle()), nullptr);
+}
+
+TEST(HandlePool, ReleasedHandlesAreStale) {
+    HandlePool<i32> pool;
+    const auto      a = pool.create(1);
+    EXPECT_TRUE(pool.release(a));
+    EXPECT_EQ(pool.get(a), nullptr);
+    EXPECT_FALSE(pool.release(a));
+    pool.collect(0);
+
+    // The slot is reused, the old handle still does not reach it.
+    const auto b = pool.create(2);
+    EXPECT_EQ(b.index(), a.index());
+    EXPECT_NE(b.generation(), a.generation());
+    EXPECT_EQ(pool.get(a), nullptr);
+    EXPECT_EQ(*pool.get(b), 2);
+    EXPECT_EQ(pool.capacity(), 1U);
+}
+
+TEST(HandlePool, DestructionWaitsForRetirement) {
+    HandlePool<std::shared_ptr<i32>> pool;
+    const auto                       value = std::make_shared<i32>(1);
+    const auto                       a = pool.create(value);
+    EXPECT_EQ(value.use_count(), 2);
+
+    pool.release(a, 3);
+    EXPECT_EQ(pool.size(), 0U);
+    EXPECT_EQ(pool.pending_count(), 1U);
+    pool.collect(2);
+    EXPECT_EQ(value.use_count(), 2);
+    // Not retired yet, so the slot is not reused.
+    EXPECT_NE(pool.create(value).index(), a.index());
+
+    pool.collect(3);
+    EXPECT_EQ(value.use_count(), 2);
+    EXPECT_EQ(pool.pending_count(), 0U);
+    EXPECT_EQ(pool.create(value).index(), a.index());
+}
+
+TEST(HandlePool, PointersStayValidWhileGrowing) {
+    HandlePool<i32> pool;
+    const auto      first = pool.create(7);
+    const i32*      pointer = pool.get(first);
+    for (i32 i = 0; i < 10000; i++) { pool.create(i); }
+    EXPECT_EQ(pool.get(first), pointer);
+
+    i32 count = 0;
+    pool.for_each([&](HandlePool<i32>::Handle /*handle*/, i32& /*value*/) { count++; });
+    EXPECT_EQ(count, 10001);
+}
+
+TEST(HandlePool, SlotsAreRetiredBeforeTheirGenerationWraps) {
+    using Handle = HandlePool<i32>::Handle;
+    HandlePool<i32> pool;
+    const Handle    first = pool.create(0);
+    Handle          handle = first;
+    for (u32 i = 1; i <= Handle::GENERATION_MASK + 1; i++) {
+        pool.release(handle);
+        pool.collect(0);
+        handle = pool.create(static_cast<i32>(i));
+        EXPECT_EQ(pool.get(first), nullptr) << "reuse " << i;
+    }
+    // The first slot ran out of generations, the last handles are from a new one.
+    EXPECT_NE(handle.index(), first.index());
+    EXPECT_EQ(pool.capacity(), 2U);
+    EXPECT_EQ(*pool.get(handle), static_cast<i32>(Handle::GENERATION_MASK + 1));
+}
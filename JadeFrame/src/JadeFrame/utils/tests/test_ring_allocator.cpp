@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "JadeFrame/utils/ring_allocator.h"
+
+using namespace JadeFrame;
+
+TEST(RingAllocator, AllocatesInOrderAndAligned) {
+    RingAllocator ring(256);
+    EXPECT_EQ(ring.allocate(10), 0);
+    EXPECT_EQ(ring.allocate(10, 16), 16);
+    EXPECT_EQ(ring.get_used(), 26);
+
+    EXPECT_EQ(ring.allocate(512), RingAllocator::INVALID);
+    EXPECT_EQ(ring.allocate(0), RingAllocator::INVALID);
+}
+
+TEST(RingAllocator, ReleasesWholeBatches) {
+    RingAllocator ring(100);
+    EXPECT_EQ(ring.allocate(40), 0);
+    ring.end_batch(1);
+    EXPECT_EQ(ring.allocate(40), 40);
+    ring.end_batch(2);
+    EXPECT_EQ(ring.allocate(40), RingAllocator::INVALID);
+
+    ring.release(1);
+    EXPECT_EQ(ring.get_used(), 40);
+    // Does not fit behind the second batch, so it starts over at the front.
+    EXPECT_EQ(ring.allocate(30), 0);
+    EXPECT_EQ(ring.get_used(), 90);
+    ring.end_batch(3);
+
+    ring.release(2);
+    EXPECT_EQ(ring.get_used(), 50);
+    EXPECT_EQ(ring.allocate(30), 30);
+    EXPECT_EQ(ring.allocate(50), RingAllocator::INVALID);
+    ring.end_batch(4);
+
+    ring.release(4);
+    EXPECT_EQ(ring.get_used(), 0);
+    EXPECT_EQ(ring.allocate(100), 0);
+}
+
+TEST(RingAllocator, FullRingFailsUntilReleased) {
+    RingAllocator ring(64);
+    EXPECT_EQ(ring.allocate(32), 0);
+    EXPECT_EQ(ring.allocate(32), 32);
+    ring.end_batch(1);
+    EXPECT_EQ(ring.allocate(1), RingAllocator::INVALID);
+
+    // A batch without allocations is not tracked.
+    ring.end_batch(2);
+    ring.release(1);
+    EXPECT_EQ(ring.get_used(), 0);
+    EXPECT_EQ(ring.allocate(64), 0);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "JadeFrame/utils/thread_pool.h"
+
+using namespace JadeFrame;
+
+TEST(ThreadPool, RunsEveryIndexOnce) {
+    ThreadPool                    pool(3);
+    std::vector<std::atomic<u32>> hits(100);
+    pool.parallel_for(100, [&](u32 index, u32 worker) {
+        EXPECT_LT(worker, pool.worker_count());
+        hits[index].fetch_add(1, std::memory_order_relaxed);
+    });
+    for (const std::atomic<u32>& hit : hits) { EXPECT_EQ(hit.load(), 1); }
+}
+
+// Small and large calls back to back, like the binning and the tiles of the rasterizer.
+// The workers woken for a call which is already done must not take indices of the next.
+TEST(ThreadPool, BackToBackCallsRunEveryIndexOnce) {
+    ThreadPool                    pool(4);
+    std::vector<std::atomic<u32>> hits(256);
+    for (u32 i = 0; i < 10000; i++) {
+        const u32 count = i % 2 == 0 ? 2 + i % 7 : 64 + (i * 37) % 192;
+        for (u32 j = 0; j < count; j++) { hits[j].store(0, std::memory_order_relaxed); }
+        pool.parallel_for(count, [&](u32 index, u32 /*worker*/) {
+            hits[index].fetch_add(1, std::memory_order_relaxed);
+        });
+        for (u32 j = 0; j < count; j++) {
+            ASSERT_EQ(hits[j].load(), 1) << "call " << i << " index " << j;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "JadeFrame/types.h"
+
+namespace JadeFrame {
+
+/*
+    A small fork-join thread pool. It is meant for data parallel work inside a frame,
+   e.g. binning and rasterizing tiles in the software renderer. The calling thread takes
+   part in the work, so a pool with 0 worker threads simply runs everything inline.
+
+    NOTE: Only one `parallel_for` may be in flight at a time.
+*/
+class ThreadPool {
+public:
+    using Task = std::function<void(u32 index, u32 worker)>;
+
+    ThreadPool()
+        : ThreadPool(default_thread_count()) {}
+
+    explicit ThreadPool(u32 thread_count) {
+        m_threads.reserve(thread_count);
+        for (u32 i = 0; i < thread_count; i++) {
+            m_threads.emplace_back([this, i]() { this->worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) { thread.join(); }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+    /// Number of distinct `worker` values a task can observe, including the caller.
+    [[nodiscard]] auto worker_count() const -> u32 {
+        return static_cast<u32>(m_threads.size()) + 1;
+    }
+
+    /// Calls `task(i, worker)` for every i in [0, count) and returns once all calls
+    /// have finished. The caller runs as worker `worker_count() - 1`.
+    auto parallel_for(u32 count, const Task& task) -> void {
+        if (count == 0) { return; }
+        const u32 caller = static_cast<u32>(m_threads.size());
+        if (m_threads.empty() || count == 1) {
+            for (u32 i = 0; i < count; i++) { task(i, caller); }
+            return;
+        }
+
+        u32 generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_count = count;
+            m_generation++;
+            generation = m_generation;
+            m_done.store(0, std::memory_order_relaxed);
+            m_claim.store(pack_claim(generation, 0), std::memory_order_release);
+        }
+        m_wake.notify_all();
+
+        this->run_tasks(caller, generation, count, task);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [&]() {
+            return m_done.load(std::memory_order_acquire) == count && m_busy == 0;
+        });
+    }
+
+    [[nodiscard]] static auto default_thread_count() -> u32 {
+        const u32 hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+private:
+    /// The generation in the upper half, the next index in the lower one. So a worker
+    /// which is late for its generation can not take an index of the next one.
+    [[nodiscard]] static auto pack_claim(u32 generation, u32 index) -> u64 {
+        return (static_cast<u64>(generation) << 32) | index;
+    }
+
+    /// `generation`, `count` and `task` are those the worker was woken for. It stops as
+    /// soon as all indices are taken or `m_claim` belongs to another generation.
+    auto run_tasks(u32 worker, u32 generation, u32 count, const Task& task) -> void {
+        u64 claim = m_claim.load(std::memory_order_acquire);
+        while (true) {
+            const u32 index = static_cast<u32>(claim);
+            if (static_cast<u32>(claim >> 32) != generation || index >= count) { break; }
+            // Only taken if the counter did not change since it was read, a stale
+            // increment would skip an index of the new generation.
+            if (!m_claim.compare_exchange_weak(
+                    claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire
+                )) {
+                continue;
+            }
+            task(index, worker);
+            m_done.fetch_add(1, std::memory_order_release);
+            claim = m_claim.load(std::memory_order_acquire);
+        }
+    }
+
+    auto worker_loop(u32 worker) -> void {
+        u32 seen_generation = 0;
+        while (true) {
+            u32         count = 0;
+            const Task* task = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() {
+                    return m_is_stopping || m_generation != seen_generation;
+                });
+                if (m_is_stopping) { return; }
+                seen_generation = m_generation;
+                count = m_count;
+                task = m_task;
+                m_busy++;
+            }
+
+            this->run_tasks(worker, seen_generation, count, *task);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busy--;
+            }
+            m_finished.notify_one();
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex               m_mutex;
+    std::condition_variable  m_wake;
+    std::condition_variable  m_finished;
+
+    // Guarded by `m_mutex`, workers copy them when they wake up.
+    const Task* m_task = nullptr;
+    u32         m_count = 0;
+    u32         m_generation = 0;
+    u32         m_busy = 0;
+    bool        m_is_stopping = false;
+
+    std::atomic<u64> m_claim = 0;
+    std::atomic<u32> m_done = 0;
+};
+
+} // namespace JadeFrame
@@ -16,6 +16,11 @@ auto custom_simple_hash_0(const std::string& str) -> u32;
 //	return hash;
 // }
 
+/// Mixes `value` into `seed`, for hashes of several fields. Only fit for hash maps.
+constexpr auto hash_combine(u64 seed, u64 value) -> u64 {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
 auto get_random_number(i32 begin, i32 end) -> i32;
 auto map_range(f64 x, f64 in_min, f64 in_max, f64 out_min, f64 out_max) -> f64;
 
@@ -37,12 +37,9 @@ static auto draw_rectangle(
     jf::f32             height,
     jf::MaterialHandle* material
 ) -> void {
-    jf::mat4x4 scale = jf::mat4x4::scale(jf::v3::create(width, height, 1.0F));
-    jf::mat4x4 trans = jf::mat4x4::translation(jf::v3::create(x, y, 0.0F));
-
     jf::Object obj;
-    obj.m_transform.m_translation = trans;
-    obj.m_transform.m_scale = scale;
+    obj.m_transform.m_translation = jf::v3::create(x, y, 0.0F);
+    obj.m_transform.m_scale = jf::v3::create(width, height, 1.0F);
 
     jf::Mesh& m = g_state.rectangle_vd;
     m.set_color(jf::RGBAColor::from_rgba_u32(138, 43, 226, 255));
@@ -149,29 +146,29 @@ struct Example_0 {
             jf::Image image_face = jf::Image::load_from_path(path_picture_face.string());
             jf::Image wall_image = jf::Image::load_from_path(wall_picture_path.string());
 
-            jf::TextureHandle* texture_face =
-                app.m_render_system.register_texture(image_face);
-            jf::TextureHandle* texture_wall =
-                app.m_render_system.register_texture(wall_image);
+            jf::TextureId texture_face = app.m_render_system.register_texture(image_face);
+            jf::TextureId texture_wall = app.m_render_system.register_texture(wall_image);
 
             jf::Logger::warn(" ----- Texture loaded");
 
             jf::ShaderHandle::Desc sh_0;
             sh_0.shading_code = jf::GLSLCodeLoader::get_by_name("with_texture_0");
-            jf::ShaderHandle* shader_texture = app.m_render_system.register_shader(sh_0);
+            jf::ShaderId shader_texture = app.m_render_system.register_shader(sh_0);
 
             jf::ShaderHandle::Desc sh_1;
             sh_1.shading_code = jf::GLSLCodeLoader::get_by_name("flat_0");
-            jf::ShaderHandle* shader_color_flat =
-                app.m_render_system.register_shader(sh_1);
+            jf::ShaderId shader_color_flat = app.m_render_system.register_shader(sh_1);
 
             jf::Logger::warn(" ----- Shader loaded");
-            jf::MaterialHandle* material_texture_face =
-                app.m_render_system.register_material(shader_texture, texture_face);
-            jf::MaterialHandle* material_texture_wall =
-                app.m_render_system.register_material(shader_texture, texture_wall);
-            jf::MaterialHandle* material_color_flat =
-                app.m_render_system.register_material(shader_color_flat, nullptr);
+            jf::MaterialHandle* material_texture_face = app.m_render_system.get(
+                app.m_render_system.register_material(shader_texture, texture_face)
+            );
+            jf::MaterialHandle* material_texture_wall = app.m_render_system.get(
+                app.m_render_system.register_material(shader_texture, texture_wall)
+            );
+            jf::MaterialHandle* material_color_flat = app.m_render_system.get(
+                app.m_render_system.register_material(shader_color_flat, {})
+            );
 
             jf::MeshBuilder::Desc vdf_desc;
             vdf_desc.has_normals = false;
@@ -180,7 +177,7 @@ struct Example_0 {
             );
             rectangle_vd.set_color(jf::RGBAColor::solid_blue());
             jf::GPUMeshData* rectangle_mesh =
-                app.m_render_system.register_mesh(rectangle_vd);
+                app.m_render_system.get(app.m_render_system.register_mesh(rectangle_vd));
 
             // g_state.shader_texture = shader_texture;
             g_state.material_texture_face = material_texture_face;
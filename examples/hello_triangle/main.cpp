@@ -13,10 +13,9 @@ struct Example_Hello_Triangle {
 
         jf::ShaderHandle::Desc shader_handle_desc;
         shader_handle_desc.shading_code = jf::GLSLCodeLoader::get_by_name("spirv_test_1");
-        jf::ShaderHandle* shader =
-            app.m_render_system.register_shader(shader_handle_desc);
+        jf::ShaderId shader = app.m_render_system.register_shader(shader_handle_desc);
         jf::MaterialHandle* material =
-            app.m_render_system.register_material(shader, nullptr);
+            app.m_render_system.get(app.m_render_system.register_material(shader, {}));
 
         const jf::f32 s = 0.5F;
 
@@ -38,7 +37,8 @@ struct Example_Hello_Triangle {
             .m_attribute = jf::Mesh::COLOR, .m_data = jf::to_list(colors)
         };
 
-        jf::GPUMeshData* mesh = app.m_render_system.register_mesh(*vertex_data);
+        jf::GPUMeshData* mesh =
+            app.m_render_system.get(app.m_render_system.register_mesh(*vertex_data));
 
         m_obj.m_mesh = mesh;
         m_obj.m_vertex_data = vertex_data;
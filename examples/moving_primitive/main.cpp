@@ -23,10 +23,9 @@ struct Example_Moving_Primitive_2 {
         jf::ShaderHandle::Desc shader_handle_desc;
         shader_handle_desc.shading_code = jf::GLSLCodeLoader::get_by_name("spirv_test_1");
 
-        jf::ShaderHandle* shader =
-            app.m_render_system.register_shader(shader_handle_desc);
+        jf::ShaderId shader = app.m_render_system.register_shader(shader_handle_desc);
         jf::MaterialHandle* material =
-            app.m_render_system.register_material(shader, nullptr);
+            app.m_render_system.get(app.m_render_system.register_material(shader, {}));
 
         constexpr jf::i32 block_count = 11;
         jf::u32           win_width = win_size.x;
@@ -69,18 +68,19 @@ struct Example_Moving_Primitive_2 {
 
                 vertex_data->set_color(col[i][j]);
                 jf::Transform transform = {};
-                transform.m_translation = jf::mat4x4::translation(
-                    jf::v3::create(
-                        block_width * static_cast<jf::f32>(j),
-                        block_width * static_cast<jf::f32>(i),
-                        0.0F
-                    )
+                transform.m_translation = jf::v3::create(
+                    block_width * static_cast<jf::f32>(j),
+                    block_width * static_cast<jf::f32>(i),
+                    0.0F
                 );
 
-                jf::GPUMeshData* mesh = app.m_render_system.register_mesh(*vertex_data);
+                jf::GPUMeshData* mesh = app.m_render_system.get(
+                    app.m_render_system.register_mesh(*vertex_data)
+                );
 
                 jf::Object obj;
-                obj.m_transform = transform;
+                // The blocks never move, their matrices are only composed once.
+                obj.m_transform_id = app.m_render_system.m_transforms.create(transform);
                 obj.m_vertex_data = vertex_data;
                 obj.m_mesh = mesh;
                 obj.m_material = material;
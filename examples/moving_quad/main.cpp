@@ -24,10 +24,9 @@ struct Example_Moving_Quad {
         jf::ShaderHandle::Desc shader_handle_desc;
         shader_handle_desc.shading_code = jf::GLSLCodeLoader::get_by_name("spirv_test_1");
 
-        jf::ShaderHandle* shader =
-            app.m_render_system.register_shader(shader_handle_desc);
+        jf::ShaderId shader = app.m_render_system.register_shader(shader_handle_desc);
         jf::MaterialHandle* material =
-            app.m_render_system.register_material(shader, nullptr);
+            app.m_render_system.get(app.m_render_system.register_material(shader, {}));
 
         jf::MeshBuilder::Desc vdf_desc;
         vdf_desc.has_normals = true;
@@ -37,7 +36,8 @@ struct Example_Moving_Quad {
         );
         rectangle.set_color(jf::RGBAColor::solid_red());
 
-        jf::GPUMeshData* mesh_data = app.m_render_system.register_mesh(rectangle);
+        jf::GPUMeshData* mesh_data =
+            app.m_render_system.get(app.m_render_system.register_mesh(rectangle));
     }
 
     auto on_update(jf::Application& app) -> void {
@@ -17,9 +17,9 @@ struct Example_Rotating_Primitive {
 
         jf::ShaderHandle::Desc shader_desc;
         shader_desc.shading_code = jf::GLSLCodeLoader::get_by_name("spirv_test_1");
-        jf::ShaderHandle*   shader = app.m_render_system.register_shader(shader_desc);
+        jf::ShaderId shader = app.m_render_system.register_shader(shader_desc);
         jf::MaterialHandle* material =
-            app.m_render_system.register_material(shader, nullptr);
+            app.m_render_system.get(app.m_render_system.register_material(shader, {}));
 
         const jf::f32 s = 0.5F;
         const jf::f32 opacity = 0.1F;
@@ -42,7 +42,8 @@ struct Example_Rotating_Primitive {
             .m_attribute = jf::Mesh::COLOR, .m_data = jf::to_list(colors)
         };
 
-        jf::GPUMeshData* mesh = app.m_render_system.register_mesh(*mesh_rainbow);
+        jf::GPUMeshData* mesh =
+            app.m_render_system.get(app.m_render_system.register_mesh(*mesh_rainbow));
 
         auto* mesh_yellow = new jf::Mesh();
         auto  positions_2 = std::vector<jf::v3>{
@@ -61,7 +62,8 @@ struct Example_Rotating_Primitive {
         mesh_yellow->m_attributes[jf::Mesh::COLOR.m_id] = jf::Mesh::AttributeData{
             .m_attribute = jf::Mesh::COLOR, .m_data = jf::to_list(colors_2)
         };
-        jf::GPUMeshData* mesh_2 = app.m_render_system.register_mesh(*mesh_yellow);
+        jf::GPUMeshData* mesh_2 =
+            app.m_render_system.get(app.m_render_system.register_mesh(*mesh_yellow));
 
         m_tri_rainbow.m_mesh = mesh;
         m_tri_rainbow.m_vertex_data = mesh_rainbow;
@@ -85,9 +87,9 @@ struct Example_Rotating_Primitive {
             duration<jf::f32, seconds::period>(current_time - start_time).count();
 
         m_tri_rainbow.m_transform.m_rotation =
-            jf::mat4x4::rotation_rh(time * jf::to_radians(90.0F), jf::v3::Z());
+            jf::Quaternion::from_axis_angle(jf::v3::Z(), time * jf::to_radians(90.0F));
         m_tri_yellow.m_transform.m_rotation =
-            jf::mat4x4::rotation_rh(time * jf::to_radians(45.0F), jf::v3::Z());
+            jf::Quaternion::from_axis_angle(jf::v3::Z(), time * jf::to_radians(45.0F));
     }
 
     auto on_draw(jf::Application& app) -> void {
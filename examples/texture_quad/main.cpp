@@ -44,13 +44,9 @@ static auto draw_rectangle(
     jf::f32             height,
     jf::MaterialHandle* material
 ) -> void {
-    jf::mat4x4 scale = jf::mat4x4::scale(jf::v3::create(width, height, 1.0F));
-    jf::mat4x4 trans = jf::mat4x4::translation(jf::v3::create(x, y, 0.0F));
-
     jf::Object obj;
-    obj.m_transform.m_translation = trans;
-    obj.m_transform.m_scale = scale;
-    obj.m_transform.m_rotation = jf::mat4x4::identity();
+    obj.m_transform.m_translation = jf::v3::create(x, y, 0.0F);
+    obj.m_transform.m_scale = jf::v3::create(width, height, 1.0F);
 
     jf::Mesh& m = state.vd_rectangle;
     obj.m_mesh = state.mesh_rectangle;
@@ -62,41 +58,35 @@ static auto draw_rectangle(
 }
 
 static auto draw_gizmo(State& state, jf::f32 x, jf::f32 y) -> void {
-    jf::mat4x4 trans = jf::mat4x4::translation(jf::v3::create(x, y, 0.0F));
+    const jf::v3 trans = jf::v3::create(x, y, 0.0F);
 
     constexpr jf::f32 length = 1000.0F;
     constexpr jf::f32 thickness = 10.0F;
     constexpr jf::f32 depth = 1.0F;
     {
-        jf::mat4x4 scale_x = jf::mat4x4::scale(jf::v3::create(length, thickness, depth));
         jf::Object obj_x;
-
         obj_x.m_transform.m_translation = trans;
-        obj_x.m_transform.m_scale = scale_x;
-        obj_x.m_transform.m_rotation = jf::mat4x4::identity();
+        obj_x.m_transform.m_scale = jf::v3::create(length, thickness, depth);
         obj_x.m_mesh = state.mesh_gizmo_x;
         obj_x.m_vertex_data = &state.vd_gizmo_x;
         obj_x.m_material = state.material_flat;
         state.m_render_system->submit(obj_x);
     }
     {
-        jf::mat4x4 scale_y = jf::mat4x4::scale(jf::v3::create(thickness, length, depth));
         jf::Object obj_y;
         obj_y.m_transform.m_translation = trans;
-        obj_y.m_transform.m_scale = scale_y;
-        obj_y.m_transform.m_rotation = jf::mat4x4::identity();
+        obj_y.m_transform.m_scale = jf::v3::create(thickness, length, depth);
         obj_y.m_mesh = state.mesh_gizmo_y;
         obj_y.m_vertex_data = &state.vd_gizmo_y;
         obj_y.m_material = state.material_flat;
         state.m_render_system->submit(obj_y);
     }
     {
-        jf::mat4x4 scale_z = jf::mat4x4::scale(jf::v3::create(length, thickness, depth));
-        jf::mat4x4 rot_z = jf::mat4x4::rotation_y_rh(jf::to_radians(-90.0F));
         jf::Object obj_z;
         obj_z.m_transform.m_translation = trans;
-        obj_z.m_transform.m_rotation = rot_z;
-        obj_z.m_transform.m_scale = scale_z;
+        obj_z.m_transform.m_rotation =
+            jf::Quaternion::from_axis_angle(jf::v3::Y(), jf::to_radians(-90.0F));
+        obj_z.m_transform.m_scale = jf::v3::create(length, thickness, depth);
         obj_z.m_mesh = state.mesh_gizmo_z;
         obj_z.m_vertex_data = &state.vd_gizmo_z;
         obj_z.m_material = state.material_flat;
@@ -127,11 +117,10 @@ struct Example_Texture_Quad {
         jf::ShaderHandle::Desc shader_handle_desc;
         shader_handle_desc.shading_code =
             jf::GLSLCodeLoader::get_by_name("with_texture_0");
-        jf::ShaderHandle* shader_tex =
-            app.m_render_system.register_shader(shader_handle_desc);
+        jf::ShaderId shader_tex = app.m_render_system.register_shader(shader_handle_desc);
 
         shader_handle_desc.shading_code = jf::GLSLCodeLoader::get_by_name("spirv_test_1");
-        jf::ShaderHandle* shader_flat =
+        jf::ShaderId shader_flat =
             app.m_render_system.register_shader(shader_handle_desc);
 
         namespace fs = std::filesystem;
@@ -144,21 +133,28 @@ struct Example_Texture_Quad {
         jf::Image img_cont = jf::Image::load_from_path(path_cont.string());
         jf::Image img_face = jf::Image::load_from_path(path_face.string());
 
-        jf::TextureHandle* texture_wall = app.m_render_system.register_texture(img_wall);
-        jf::TextureHandle* texture_cont = app.m_render_system.register_texture(img_cont);
-        jf::TextureHandle* texture_face = app.m_render_system.register_texture(img_face);
+        // One submit for all three.
+        app.m_render_system.begin_upload_batch();
+        jf::TextureId texture_wall = app.m_render_system.register_texture(img_wall);
+        jf::TextureId texture_cont = app.m_render_system.register_texture(img_cont);
+        jf::TextureId texture_face = app.m_render_system.register_texture(img_face);
+        app.m_render_system.end_upload_batch();
 
         auto default_material_info = jf::MaterialInfo::default_0();
 
-        jf::MaterialHandle* material_wall =
-            app.m_render_system.register_material(shader_tex, texture_wall);
-        jf::MaterialHandle* material_cont =
-            app.m_render_system.register_material(shader_tex, texture_cont);
-        jf::MaterialHandle* material_face =
-            app.m_render_system.register_material(shader_tex, texture_face);
+        jf::MaterialHandle* material_wall = app.m_render_system.get(
+            app.m_render_system.register_material(shader_tex, texture_wall)
+        );
+        jf::MaterialHandle* material_cont = app.m_render_system.get(
+            app.m_render_system.register_material(shader_tex, texture_cont)
+        );
+        jf::MaterialHandle* material_face = app.m_render_system.get(
+            app.m_render_system.register_material(shader_tex, texture_face)
+        );
 
-        jf::MaterialHandle* material_flat =
-            app.m_render_system.register_material(shader_flat, nullptr);
+        jf::MaterialHandle* material_flat = app.m_render_system.get(
+            app.m_render_system.register_material(shader_flat, {})
+        );
 
         material_wall->m_info = default_material_info;
         material_cont->m_info = default_material_info;
@@ -171,7 +167,8 @@ struct Example_Texture_Quad {
             jf::v3::zero(), jf::v3::create(1.0F, 1.0F, 0.0F), vdf_desc
         );
         vd_rectangle.set_color(jf::RGBAColor::solid_blue());
-        jf::GPUMeshData* mesh_rectangle = app.m_render_system.register_mesh(vd_rectangle);
+        jf::GPUMeshData* mesh_rectangle =
+            app.m_render_system.get(app.m_render_system.register_mesh(vd_rectangle));
 
         jf::MeshBuilder::Desc vdf_desc_;
         vdf_desc_.has_normals = false;
@@ -191,14 +188,18 @@ struct Example_Texture_Quad {
         );
         vd_gizmo_z.set_color(jf::RGBAColor::solid_blue());
 
-        jf::GPUMeshData* mesh_gizmo_x = app.m_render_system.register_mesh(vd_gizmo_x);
-        jf::GPUMeshData* mesh_gizmo_y = app.m_render_system.register_mesh(vd_gizmo_y);
-        jf::GPUMeshData* mesh_gizmo_z = app.m_render_system.register_mesh(vd_gizmo_z);
+        jf::GPUMeshData* mesh_gizmo_x =
+            app.m_render_system.get(app.m_render_system.register_mesh(vd_gizmo_x));
+        jf::GPUMeshData* mesh_gizmo_y =
+            app.m_render_system.get(app.m_render_system.register_mesh(vd_gizmo_y));
+        jf::GPUMeshData* mesh_gizmo_z =
+            app.m_render_system.get(app.m_render_system.register_mesh(vd_gizmo_z));
 
         fs::path path_teapot = fs::path("resource") / "default_blender_cube_1.obj";
         jf::Mesh teapot = jf::AssetLoader::load_obj(path_teapot.string());
         teapot.set_color(jf::RGBAColor::solid_yellow());
-        jf::GPUMeshData* mesh_teapot = app.m_render_system.register_mesh(teapot);
+        jf::GPUMeshData* mesh_teapot =
+            app.m_render_system.get(app.m_render_system.register_mesh(teapot));
 
         state.material_wall = material_wall;
         state.material_cont = material_cont;
@@ -230,8 +231,7 @@ struct Example_Texture_Quad {
         obj_teapot.m_vertex_data = &state.vd_teapot;
         obj_teapot.m_mesh = state.mesh_teapot;
         obj_teapot.m_material = state.material_flat;
-        obj_teapot.m_transform.m_translation =
-            jf::mat4x4::translation(jf::v3::create(10.0F, 10.0F, 10.0F));
+        obj_teapot.m_transform.m_translation = jf::v3::create(10.0F, 10.0F, 10.0F);
 
         app.m_render_system.submit(obj_teapot);
     }